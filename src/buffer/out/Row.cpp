@@ -11,6 +11,56 @@
 
 extern "C" int __isa_available;
 
+void HyperlinkRefCounts::Increment(const uint16_t id)
+{
+    ++_counts[id];
+}
+
+void HyperlinkRefCounts::Decrement(const uint16_t id)
+{
+    const auto it = _counts.find(id);
+    if (it != _counts.end() && --it->second == 0)
+    {
+        _counts.erase(it);
+        _unreferenced.emplace_back(id);
+    }
+}
+
+// Marks all IDs as unreferenced. Used when all rows are discarded at once.
+void HyperlinkRefCounts::ReleaseAll()
+{
+    _unreferenced.reserve(_unreferenced.size() + _counts.size());
+    for (const auto& [id, count] : _counts)
+    {
+        _unreferenced.emplace_back(id);
+    }
+    _counts.clear();
+}
+
+// Moves the unreferenced IDs of another instance over to this one,
+// so that the next call to Prune() considers them as well.
+void HyperlinkRefCounts::TakeUnreferenced(HyperlinkRefCounts& other)
+{
+    _unreferenced.insert(_unreferenced.end(), other._unreferenced.begin(), other._unreferenced.end());
+    other._unreferenced.clear();
+}
+
+// Queues an ID that may have never been referenced by any row, like one that was copied over
+// from another buffer, so that the next call to Prune() frees it unless it gets referenced by then.
+void HyperlinkRefCounts::TrackUnreferenced(const uint16_t id)
+{
+    if (!_counts.contains(id))
+    {
+        _unreferenced.emplace_back(id);
+    }
+}
+
+uint32_t HyperlinkRefCounts::Count(const uint16_t id) const noexcept
+{
+    const auto it = _counts.find(id);
+    return it != _counts.end() ? it->second : 0;
+}
+
 // The STL is missing a std::iota_n analogue for std::iota, so I made my own.
 template<typename OutIt, typename Diff, typename T>
 constexpr OutIt iota_n(OutIt dest, Diff count, T val)
@@ -77,19 +127,29 @@ constexpr OutIt copy_n_small(InIt first, Diff count, OutIt dest)
 // - fillAttribute - the default text attribute
 // Return Value:
 // - constructed object
-ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute) :
+ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, HyperlinkRefCounts* hyperlinkRefs, RowGenerations* generations) :
     _charsBuffer{ charsBuffer },
     _chars{ charsBuffer, rowWidth },
     _charOffsets{ charOffsetsBuffer, ::base::strict_cast<size_t>(rowWidth) + 1u },
     _attr{ rowWidth, fillAttribute },
-    _columnCount{ rowWidth }
+    _columnCount{ rowWidth },
+    _hyperlinkRefs{ hyperlinkRefs },
+    _generations{ generations }
 {
     _init();
+    MarkChanged();
+
+    if (_hyperlinkRefs && fillAttribute.IsHyperlink())
+    {
+        _hyperlinkRefs->Increment(fillAttribute.GetHyperlinkId());
+        _hasHyperlinks = true;
+    }
 }
 
 void ROW::SetWrapForced(const bool wrap) noexcept
 {
     _wrapForced = wrap;
+    MarkChanged();
 }
 
 bool ROW::WasWrapForced() const noexcept
@@ -100,6 +160,7 @@ bool ROW::WasWrapForced() const noexcept
 void ROW::SetDoubleBytePadded(const bool doubleBytePadded) noexcept
 {
     _doubleBytePadded = doubleBytePadded;
+    MarkChanged();
 }
 
 bool ROW::WasDoubleBytePadded() const noexcept
@@ -110,6 +171,7 @@ bool ROW::WasDoubleBytePadded() const noexcept
 void ROW::SetLineRendition(const LineRendition lineRendition) noexcept
 {
     _lineRendition = lineRendition;
+    MarkChanged();
 }
 
 LineRendition ROW::GetLineRendition() const noexcept
@@ -123,6 +185,24 @@ uint16_t ROW::GetLineWidth() const noexcept
     return _columnCount >> scale;
 }
 
+// Returns the generation at which this row was last modified.
+// Rows modified later than others always have a larger generation.
+uint64_t ROW::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
+// Stamps this row with the next generation of its TextBuffer. All methods that modify
+// the row call this, but callers that modify a ROW in other ways (for instance by moving
+// it to another place in the buffer) need to call it themselves.
+void ROW::MarkChanged() noexcept
+{
+    if (_generations)
+    {
+        _generation = _generations->Next();
+    }
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -131,6 +211,8 @@ uint16_t ROW::GetLineWidth() const noexcept
 // - <none>
 void ROW::Reset(const TextAttribute& attr) noexcept
 {
+    HyperlinkTracker tracker{ *this, _tracksHyperlinks(attr) };
+
     _charsHeap.reset();
     _chars = { _charsBuffer, _columnCount };
     // Constructing and then moving objects into place isn't free.
@@ -140,6 +222,7 @@ void ROW::Reset(const TextAttribute& attr) noexcept
     _wrapForced = false;
     _doubleBytePadded = false;
     _init();
+    MarkChanged();
 }
 
 void ROW::_init() noexcept
@@ -259,8 +342,10 @@ void ROW::_init() noexcept
 
 void ROW::TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth)
 {
+    HyperlinkTracker tracker{ *this, _hyperlinkRefs != nullptr };
     _attr = attr;
     _attr.resize_trailing_extent(gsl::narrow<uint16_t>(newWidth));
+    MarkChanged();
 }
 
 void ROW::CopyFrom(const ROW& source)
@@ -272,6 +357,171 @@ void ROW::CopyFrom(const ROW& source)
     _wrapForced = source._wrapForced;
 }
 
+// The fixed-size part of the encoding produced by ROW::Encode().
+// It's followed by the text, the _charOffsets runs and the attribute runs.
+struct EncodedRow
+{
+    uint64_t generation;
+    // The length of the text and how much of it is stored. The remainder is whitespace.
+    uint16_t chars;
+    uint16_t storedChars;
+    uint16_t charOffsetRuns;
+    uint16_t attrRuns;
+    LineRendition lineRendition;
+    bool wrapForced;
+    bool doubleBytePadded;
+    bool hasHyperlinks;
+};
+
+// A run of successive _charOffsets, which all have the same distance to their column.
+struct EncodedCharOffsetRun
+{
+    uint16_t length;
+    uint16_t value;
+};
+
+static_assert(std::is_trivially_copyable_v<til::rle_pair<TextAttribute, uint16_t>>);
+
+template<typename T>
+static void appendEncoded(std::vector<uint8_t>& out, const T* data, size_t count)
+{
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    const auto bytes = reinterpret_cast<const uint8_t*>(data);
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+}
+
+template<typename T>
+static void readEncoded(const uint8_t*& data, T* out, size_t count) noexcept
+{
+    memcpy(out, data, count * sizeof(T));
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    data += count * sizeof(T);
+}
+
+// Appends a compact encoding of this row to `out`, which Decode() turns back into an identical row.
+// The text is stored without its trailing whitespace. _charOffsets are stored as runs of their distance
+// to the column, which is 0 for all columns unless the row contains wide glyphs or surrogate pairs.
+// The attributes are stored as their runs.
+void ROW::Encode(std::vector<uint8_t>& out) const
+{
+    const auto text = GetText();
+    const auto storedChars = text.find_last_not_of(L' ') + 1;
+    const auto& attrRuns = _attr.runs();
+
+    const auto headerOffset = out.size();
+    out.resize(headerOffset + sizeof(EncodedRow));
+    appendEncoded(out, text.data(), storedChars);
+
+    const auto distance = [&](size_t col) {
+        return gsl::narrow_cast<uint16_t>(til::at(_charOffsets, col) - col);
+    };
+    uint16_t charOffsetRuns = 0;
+    for (size_t col = 0; col <= _columnCount;)
+    {
+        EncodedCharOffsetRun run{ 1, distance(col) };
+        while (col + run.length <= _columnCount && distance(col + run.length) == run.value)
+        {
+            run.length++;
+        }
+        appendEncoded(out, &run, 1);
+        charOffsetRuns++;
+        col += run.length;
+    }
+
+    appendEncoded(out, attrRuns.data(), attrRuns.size());
+
+    const EncodedRow header{
+        .generation = _generation,
+        .chars = gsl::narrow_cast<uint16_t>(text.size()),
+        .storedChars = gsl::narrow_cast<uint16_t>(storedChars),
+        .charOffsetRuns = charOffsetRuns,
+        .attrRuns = gsl::narrow_cast<uint16_t>(attrRuns.size()),
+        .lineRendition = _lineRendition,
+        .wrapForced = _wrapForced,
+        .doubleBytePadded = _doubleBytePadded,
+        .hasHyperlinks = _hasHyperlinks,
+    };
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    memcpy(out.data() + headerOffset, &header, sizeof(header));
+}
+
+// Restores a row from the encoding produced by Encode() and advances `data` past it. The row must be as wide as the
+// encoded one. It doesn't touch the HyperlinkRefCounts, because the encoded row is expected to still be counted.
+void ROW::Decode(const uint8_t*& data, HyperlinkRefCounts* hyperlinkRefs, RowGenerations* generations)
+{
+    EncodedRow header;
+    readEncoded(data, &header, 1);
+
+    if (header.chars > _columnCount)
+    {
+        _charsHeap = std::make_unique_for_overwrite<wchar_t[]>(header.chars);
+        _chars = { _charsHeap.get(), header.chars };
+    }
+    else
+    {
+        _charsHeap.reset();
+        _chars = { _charsBuffer, _columnCount };
+    }
+    readEncoded(data, _chars.data(), header.storedChars);
+    std::fill_n(_chars.begin() + header.storedChars, header.chars - header.storedChars, L' ');
+
+    size_t col = 0;
+    for (uint16_t i = 0; i < header.charOffsetRuns; ++i)
+    {
+        EncodedCharOffsetRun run;
+        readEncoded(data, &run, 1);
+        for (const auto end = col + run.length; col < end; ++col)
+        {
+            til::at(_charOffsets, col) = gsl::narrow_cast<uint16_t>(run.value + col);
+        }
+    }
+
+    decltype(_attr)::container attrRuns;
+    attrRuns.resize(header.attrRuns);
+    readEncoded(data, attrRuns.data(), attrRuns.size());
+    _attr = decltype(_attr){ std::move(attrRuns) };
+
+    _lineRendition = header.lineRendition;
+    _wrapForced = header.wrapForced;
+    _doubleBytePadded = header.doubleBytePadded;
+    _hasHyperlinks = header.hasHyperlinks;
+    _hyperlinkRefs = hyperlinkRefs;
+    _generations = generations;
+    _generation = header.generation;
+}
+
+// Returns the fixed-size chars buffer this row currently holds. It's returned even if the text outgrew it
+// and moved to the heap. It isn't necessarily the one the row was constructed with, as SwapBuffers() exchanges them.
+const wchar_t* ROW::GetCharsBuffer() const noexcept
+{
+    return _charsBuffer;
+}
+
+// Exchanges the buffers of two equally wide rows, while each row retains its contents.
+void ROW::SwapBuffers(ROW& other) noexcept
+{
+    assert(_columnCount == other._columnCount);
+
+    const auto inBuffer = _chars.data() == _charsBuffer;
+    const auto otherInBuffer = other._chars.data() == other._charsBuffer;
+
+    const std::span chars{ _charsBuffer, _columnCount };
+    std::swap_ranges(chars.begin(), chars.end(), other._charsBuffer);
+    std::swap_ranges(_charOffsets.begin(), _charOffsets.end(), other._charOffsets.begin());
+    std::swap(_charsBuffer, other._charsBuffer);
+    std::swap(_charOffsets, other._charOffsets);
+
+    if (inBuffer)
+    {
+        _chars = { _charsBuffer, _columnCount };
+    }
+    if (otherInBuffer)
+    {
+        other._chars = { other._charsBuffer, other._columnCount };
+    }
+}
+
 // Returns the previous possible cursor position, preceding the given column.
 // Returns 0 if column is less than or equal to 0.
 til::CoordType ROW::NavigateToPrevious(til::CoordType column) const noexcept
@@ -335,6 +585,9 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(size() - 1);
 
+    // The cells may have any number of different attributes. We just always recount the IDs if needed.
+    HyperlinkTracker tracker{ *this, _hyperlinkRefs != nullptr };
+
     auto currentColor = it->TextAttr();
     uint16_t colorUses = 0;
     auto colorStarts = gsl::narrow_cast<uint16_t>(columnBegin);
@@ -438,17 +691,321 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
         _attr.replace(colorStarts, currentIndex, currentColor);
     }
 
+    MarkChanged();
     return it;
 }
 
+// Returns the DbcsAttribute of a CHAR_INFO the same way OutputCellIterator does: The leading byte flag takes precedence.
+static DbcsAttribute charInfoDbcsAttr(const CHAR_INFO& charInfo) noexcept
+{
+    if (WI_IsFlagSet(charInfo.Attributes, COMMON_LVB_LEADING_BYTE))
+    {
+        return DbcsAttribute::Leading;
+    }
+    if (WI_IsFlagSet(charInfo.Attributes, COMMON_LVB_TRAILING_BYTE))
+    {
+        return DbcsAttribute::Trailing;
+    }
+    return DbcsAttribute::Single;
+}
+
+// Routine Description:
+// - Writes CHAR_INFOs into the row, one column per CHAR_INFO. The result is identical to calling WriteCells() with an
+//   OutputCellIterator over the same CHAR_INFOs, but instead of calling ReplaceCharacters() for every single cell,
+//   narrow cells and leading/trailing pairs are gathered into runs which are written at once, and the
+//   attributes are coalesced into runs before they're applied. This is the fast path of WriteConsoleOutputW.
+// Arguments:
+// - columnBegin - column in row to start writing at
+// - charInfos - the cells to write. Cells that don't fit into the row are ignored.
+// - wrap - change the wrap flag if we wrote into the last column of the row.
+// Return Value:
+// - The number of CHAR_INFOs that were consumed. A leading half in the last column is padded with whitespace but not consumed.
+size_t ROW::WriteCharInfos(const til::CoordType columnBegin, const std::span<const CHAR_INFO>& charInfos, const std::optional<bool> wrap)
+try
+{
+    THROW_HR_IF(E_INVALIDARG, columnBegin < 0 || columnBegin >= size());
+
+    const auto colBeg = gsl::narrow_cast<uint16_t>(columnBegin);
+    const auto count = gsl::narrow_cast<uint16_t>(std::min<size_t>(charInfos.size(), _columnCount - colBeg));
+    const auto colEnd = gsl::narrow_cast<uint16_t>(colBeg + count);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // CHAR_INFOs never carry hyperlinks, but they may overwrite some.
+    HyperlinkTracker tracker{ *this, _tracksHyperlinks(TextAttribute{}) };
+
+    // The text of the current run and its offsets relative to the start of the run, in the same format as _charOffsets.
+    til::small_vector<wchar_t, 256> runChars;
+    til::small_vector<uint16_t, 256> runOffsets;
+    auto runBeg = colBeg;
+    size_t consumed = count;
+
+    // Writes the current run, which ends at `col`. The next run starts after `col`,
+    // because the cell at `col` is one of the edge cases that get written individually.
+    const auto flush = [&](uint16_t col) {
+        if (!runChars.empty())
+        {
+            runOffsets.emplace_back(gsl::narrow_cast<uint16_t>(runChars.size()));
+            _writeCharInfoRun(runBeg, { runChars.data(), runChars.size() }, { runOffsets.data(), runOffsets.size() });
+            runChars.clear();
+            runOffsets.clear();
+        }
+        runBeg = gsl::narrow_cast<uint16_t>(col + 1);
+    };
+
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        const auto col = gsl::narrow_cast<uint16_t>(colBeg + i);
+        const auto& charInfo = til::at(charInfos, i);
+        const std::wstring_view ch{ &charInfo.Char.UnicodeChar, 1 };
+        const auto offset = gsl::narrow_cast<uint16_t>(runChars.size());
+
+        switch (charInfoDbcsAttr(charInfo))
+        {
+        case DbcsAttribute::Leading:
+            if (col == _columnCount - 1)
+            {
+                // The wide char doesn't fit. Pad with whitespace and don't consume it,
+                // so that the caller can write it into the next row, just like WriteCells().
+                flush(col);
+                ClearCell(col);
+                SetDoubleBytePadded(true);
+                consumed = i;
+            }
+            else if (i + 1 < count && charInfoDbcsAttr(til::at(charInfos, i + 1)) == DbcsAttribute::Trailing)
+            {
+                // Only the leading half's character is stored. The trailing half's one is ignored like everywhere else in conhost.
+                runOffsets.emplace_back(offset);
+                runOffsets.emplace_back(gsl::narrow_cast<uint16_t>(offset | CharOffsetsTrailer));
+                runChars.emplace_back(ch.front());
+                ++i;
+            }
+            else
+            {
+                // A leading half without a trailing one. If there's a next cell, writing it will turn this one into whitespace.
+                flush(col);
+                ReplaceCharacters(col, 2, ch);
+            }
+            break;
+        case DbcsAttribute::Trailing:
+            flush(col);
+            if (col == 0)
+            {
+                ClearCell(col);
+            }
+            else if (i == 0)
+            {
+                // See WriteCells() for why only the first CHAR_INFO may be a trailing half that gets written.
+                ReplaceCharacters(col - 1, 2, ch);
+            }
+            break;
+        default:
+            runOffsets.emplace_back(offset);
+            runChars.emplace_back(ch.front());
+            break;
+        }
+    }
+
+    flush(colEnd);
+
+    // Each of the cells applies its attributes to its column, including the trailing halves and an unconsumed leading half.
+    // Most of the time consecutive cells share the same attributes, so we only construct a TextAttribute when they change.
+    til::small_vector<til::rle_pair<TextAttribute, uint16_t>, 16> attrRuns;
+    WORD previousAttributes = 0;
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        const auto attributes = gsl::narrow_cast<WORD>(til::at(charInfos, i).Attributes & ~COMMON_LVB_SBCSDBCS);
+        if (attrRuns.empty() || attributes != previousAttributes)
+        {
+            const TextAttribute attr{ attributes };
+            previousAttributes = attributes;
+            if (attrRuns.empty() || attrRuns.back().value != attr)
+            {
+                attrRuns.emplace_back(attr, uint16_t{ 0 });
+            }
+        }
+        ++attrRuns.back().length;
+    }
+    _attr.replace(colBeg, colEnd, std::span<const til::rle_pair<TextAttribute, uint16_t>>{ attrRuns.data(), attrRuns.size() });
+
+    if (wrap.has_value() && colEnd == _columnCount)
+    {
+        SetWrapForced(*wrap);
+    }
+
+    MarkChanged();
+    return consumed;
+}
+catch (...)
+{
+    Reset(TextAttribute{});
+    throw;
+}
+
+// Writes a run of glyphs gathered by WriteCharInfos() starting at columnBegin. charOffsets are
+// relative to the start of `chars` and contain 1 more item than the run is wide, just like _charOffsets.
+void ROW::_writeCharInfoRun(const uint16_t columnBegin, const std::wstring_view& chars, const std::span<const uint16_t>& charOffsets)
+{
+    WriteHelper h{ *this, columnBegin, _columnCount, chars };
+    if (!h.IsValid())
+    {
+        return;
+    }
+    h.CopyTextFrom(charOffsets);
+    h.Finish();
+}
+
+// Routine Description:
+// - Reads the cells starting at columnBegin as CHAR_INFOs, the same way CONSOLE_INFORMATION::AsCharInfo()
+//   converts them, but without going through a TextBufferCellIterator. Glyphs that consist of more than
+//   a single UTF-16 code unit are returned as U+FFFD and the attributes are converted once per run.
+// Arguments:
+// - columnBegin - column in row to start reading at
+// - charInfos - receives the cells. Items past the end of the row are left untouched.
+void ROW::ReadCharInfos(const til::CoordType columnBegin, const std::span<CHAR_INFO>& charInfos) const
+{
+    const auto colBeg = _clampedColumnInclusive(columnBegin);
+    const auto colEnd = gsl::narrow_cast<uint16_t>(std::min<size_t>(size_t{ colBeg } + charInfos.size(), _columnCount));
+
+    auto run = _attr.runs().begin();
+    size_t runEnd = run->length;
+    auto attributes = run->value.GetLegacyAttributes();
+    auto out = charInfos.begin();
+
+    for (auto col = colBeg; col < colEnd; ++col, ++out)
+    {
+        while (col >= runEnd)
+        {
+            ++run;
+            runEnd += run->length;
+            attributes = run->value.GetLegacyAttributes();
+        }
+
+        const auto trailer = _uncheckedIsTrailer(col);
+        auto next = size_t{ col } + 1;
+        for (; _uncheckedIsTrailer(next); ++next)
+        {
+        }
+
+        const auto beg = _uncheckedCharOffset(col);
+        const auto end = _uncheckedCharOffset(next);
+
+        out->Char.UnicodeChar = end - beg == 1 ? _uncheckedChar(beg) : UNICODE_REPLACEMENT;
+        out->Attributes = attributes;
+        if (trailer)
+        {
+            out->Attributes |= COMMON_LVB_TRAILING_BYTE;
+        }
+        else if (next - col > 1)
+        {
+            out->Attributes |= COMMON_LVB_LEADING_BYTE;
+        }
+    }
+}
+
 void ROW::SetAttrToEnd(const til::CoordType columnBegin, const TextAttribute attr)
 {
+    HyperlinkTracker tracker{ *this, _tracksHyperlinks(attr) };
     _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), attr);
+    MarkChanged();
 }
 
 void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const TextAttribute& newAttr)
 {
+    HyperlinkTracker tracker{ *this, _tracksHyperlinks(newAttr) };
     _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), newAttr);
+    MarkChanged();
+}
+
+// Replaces the attributes starting at beginIndex with the given runs (for instance a slice() of another row).
+// The runs will be cut off at the end of the row if they don't fit.
+void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::small_rle<TextAttribute, uint16_t, 1>& newAttrs)
+{
+    HyperlinkTracker tracker{ *this, _hyperlinkRefs != nullptr };
+    const auto begin = _clampedColumnInclusive(beginIndex);
+    const auto end = gsl::narrow_cast<uint16_t>(std::min<size_t>(_attr.size(), size_t{ begin } + newAttrs.size()));
+    _attr.replace(begin, end, newAttrs.slice(0, end - begin));
+    MarkChanged();
+}
+
+// Returns true if the given attribute may add or the row's current attributes
+// may lose hyperlink references, in which case we need a HyperlinkTracker.
+bool ROW::_tracksHyperlinks(const TextAttribute& attr) const noexcept
+{
+    return _hyperlinkRefs && (_hasHyperlinks || attr.IsHyperlink());
+}
+
+// Returns the sorted, unique list of hyperlink IDs in this row.
+til::small_vector<uint16_t, 4> ROW::_collectHyperlinks() const
+{
+    til::small_vector<uint16_t, 4> ids;
+    for (const auto& run : _attr.runs())
+    {
+        if (run.value.IsHyperlink())
+        {
+            ids.emplace_back(run.value.GetHyperlinkId());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+ROW::HyperlinkTracker::HyperlinkTracker(ROW& trackedRow, bool enabled) noexcept :
+    row{ trackedRow },
+    active{ enabled }
+{
+    if (active && row._hasHyperlinks)
+    {
+        try
+        {
+            before = row._collectHyperlinks();
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            // Without the previous state we can't compute a correct difference.
+            // Leaking a few references is better than releasing ones that are still in use.
+            active = false;
+        }
+    }
+}
+
+ROW::HyperlinkTracker::~HyperlinkTracker() noexcept
+{
+    if (!active)
+    {
+        return;
+    }
+
+    try
+    {
+        const auto after = row._collectHyperlinks();
+        row._hasHyperlinks = !after.empty();
+
+        // Both lists are sorted, so we can compute the difference in a single pass.
+        auto b = before.begin();
+        auto a = after.begin();
+        while (b != before.end() || a != after.end())
+        {
+            if (a == after.end() || (b != before.end() && *b < *a))
+            {
+                row._hyperlinkRefs->Decrement(*b++);
+            }
+            else if (b == before.end() || *a < *b)
+            {
+                row._hyperlinkRefs->Increment(*a++);
+            }
+            else
+            {
+                ++a;
+                ++b;
+            }
+        }
+    }
+    CATCH_LOG();
 }
 
 [[msvc::forceinline]] ROW::WriteHelper::WriteHelper(ROW& row, til::CoordType columnBegin, til::CoordType columnLimit, const std::wstring_view& chars) noexcept :
@@ -515,6 +1072,7 @@ void ROW::ReplaceText(RowWriteState& state)
 try
 {
     WriteHelper h{ *this, state.columnBegin, state.columnLimit, state.text };
+    h.graphemeClusters = state.graphemeClusters;
     if (!h.IsValid())
     {
         state.columnEnd = h.colBeg;
@@ -556,8 +1114,7 @@ catch (...)
     {
         if (*it >= 0x80) [[unlikely]]
         {
-            _replaceTextUnicode(ch, it);
-            return;
+            break;
         }
 
         til::at(row._charOffsets, colEnd) = gsl::narrow_cast<uint16_t>(ch);
@@ -566,44 +1123,80 @@ catch (...)
         ++it;
     }
 
+    // Two ASCII characters never form a grapheme cluster (CR LF aside, which doesn't end up in rows),
+    // but an ASCII character followed by a non-ASCII one might, for instance with a combining mark.
+    // In that case we step back and let the slow path segment the text, starting with the ASCII character.
+    if (it != chars.end() && *it >= 0x80) [[unlikely]]
+    {
+        if (graphemeClusters && it != chars.begin())
+        {
+            --it;
+            --colEnd;
+            --ch;
+        }
+        _replaceTextUnicode(ch, it);
+        return;
+    }
+
     colEndDirty = colEnd;
     charsConsumed = ch - chBeg;
 }
 
-[[msvc::forceinline]] void ROW::WriteHelper::_replaceTextUnicode(size_t ch, std::wstring_view::const_iterator it) noexcept
+// Returns the number of code units at `pos` that ReplaceText() stores in a single cell: a grapheme cluster in
+// grapheme cluster mode and a codepoint otherwise. `widths` holds the GetGlyphWidths() of chars[batchBeg, batchEnd),
+// which assigns a width of 0 to the trailing half of a surrogate pair.
+[[msvc::forceinline]] static size_t glyphLength(const std::wstring_view& chars, size_t pos, const std::array<uint8_t, 256>& widths, size_t batchBeg, size_t batchEnd, bool graphemeClusters) noexcept
 {
-    const auto end = chars.end();
-
-    while (it != end)
+    if (graphemeClusters)
     {
-        unsigned int width = 1;
-        auto ptr = &*it;
-        const auto wch = *ptr;
-        size_t advance = 1;
+        return til::utf16_next_grapheme(chars.substr(pos)).size();
+    }
+    return pos + 1 < batchEnd && til::at(widths, pos + 1 - batchBeg) == 0 ? 2 : 1;
+}
 
-        ++it;
+// Returns the number of columns taken up by the glyph of length `glyphLen` at `pos`, given the width of its first codepoint.
+// A narrow glyph followed by VARIATION SELECTOR-16 (U+FE0F) requests the emoji presentation, which is wide (e.g. U+2764 U+FE0F).
+// Only grapheme clusters can contain it, as it's otherwise stored in a cell of its own.
+[[msvc::forceinline]] static uint8_t glyphWidth(const std::wstring_view& chars, size_t pos, size_t glyphLen, uint8_t width) noexcept
+{
+    if (width == 1 && glyphLen > 1 && chars.substr(pos + 1, glyphLen - 1).find(L'\xFE0F') != std::wstring_view::npos)
+    {
+        return 2;
+    }
+    return width;
+}
 
-        // Even in our slow-path we can avoid calling IsGlyphFullWidth if the current character is ASCII.
-        // It also allows us to skip the surrogate pair decoding at the same time.
-        if (wch >= 0x80)
+[[msvc::forceinline]] void ROW::WriteHelper::_replaceTextUnicode(size_t ch, std::wstring_view::const_iterator it) noexcept
+{
+    const auto len = chars.size();
+    auto pos = gsl::narrow_cast<size_t>(it - chars.begin());
+    // The glyphs are measured in batches. Since every glyph is at least 1 column wide and at most
+    // 2 code units long, we never need to measure more than 2 code units per remaining column.
+    std::array<uint8_t, 256> widths;
+    size_t batchBeg = 0;
+    size_t batchEnd = 0;
+
+    while (pos < len)
+    {
+        if (pos >= batchEnd)
         {
-            if (til::is_surrogate(wch))
+            auto count = std::min({ len - pos, widths.size(), (size_t{ colLimit } - colEnd) * 2 + 2 });
+            // Don't split surrogate pairs across two batches.
+            if (count < len - pos && til::is_leading_surrogate(til::at(chars, pos + count - 1)))
             {
-                if (it != end && til::is_leading_surrogate(wch) && til::is_trailing_surrogate(*it))
-                {
-                    advance = 2;
-                    ++it;
-                }
-                else
-                {
-                    ptr = &UNICODE_REPLACEMENT;
-                }
+                --count;
             }
 
-            width = IsGlyphFullWidth({ ptr, advance }) + 1u;
+            GetGlyphWidths(chars.substr(pos, count), widths);
+            batchBeg = pos;
+            batchEnd = pos + count;
         }
 
-        const auto colEndNew = gsl::narrow_cast<uint16_t>(colEnd + width);
+        // In grapheme cluster mode each cluster is stored in a single cell (or two for wide ones),
+        // where the width is determined by the cluster's first codepoint, unless VS16 makes it wide.
+        // Otherwise each codepoint is.
+        const auto clusterSize = glyphLength(chars, pos, widths, batchBeg, batchEnd, graphemeClusters);
+        const auto colEndNew = gsl::narrow_cast<uint16_t>(colEnd + glyphWidth(chars, pos, clusterSize, til::at(widths, pos - batchBeg)));
         if (colEndNew > colLimit)
         {
             colEndDirty = colLimit;
@@ -621,13 +1214,75 @@ catch (...)
             til::at(row._charOffsets, colEnd++) = gsl::narrow_cast<uint16_t>(ch | CharOffsetsTrailer);
         }
 
-        ch += advance;
+        ch += clusterSize;
+        pos += clusterSize;
     }
 
     colEndDirty = colEnd;
     charsConsumed = ch - chBeg;
 }
 
+// Returns the number of columns the given text occupies when written with ReplaceText(),
+// counting only the glyphs that fit into columnLimit columns. It segments and measures
+// the text exactly like ReplaceText() does, including its fast path for ASCII.
+til::CoordType ROW::MeasureText(const std::wstring_view& chars, til::CoordType columnLimit, const bool graphemeClusters) noexcept
+{
+    const auto len = chars.size();
+    const auto limit = std::max(columnLimit, 0);
+    size_t pos = 0;
+    til::CoordType columns = 0;
+
+    while (pos < len && columns < limit && til::at(chars, pos) < 0x80)
+    {
+        ++pos;
+        ++columns;
+    }
+
+    if (pos == len || columns >= limit)
+    {
+        return columns;
+    }
+
+    // Just like in ReplaceText(), the last ASCII character may form a grapheme cluster with what follows.
+    if (graphemeClusters && pos != 0)
+    {
+        --pos;
+        --columns;
+    }
+
+    std::array<uint8_t, 256> widths;
+    size_t batchBeg = 0;
+    size_t batchEnd = 0;
+
+    while (pos < len)
+    {
+        if (pos >= batchEnd)
+        {
+            auto count = std::min({ len - pos, widths.size(), gsl::narrow_cast<size_t>(limit - columns) * 2 + 2 });
+            if (count < len - pos && til::is_leading_surrogate(til::at(chars, pos + count - 1)))
+            {
+                --count;
+            }
+
+            GetGlyphWidths(chars.substr(pos, count), widths);
+            batchBeg = pos;
+            batchEnd = pos + count;
+        }
+
+        const auto clusterSize = glyphLength(chars, pos, widths, batchBeg, batchEnd, graphemeClusters);
+        const auto width = glyphWidth(chars, pos, clusterSize, til::at(widths, pos - batchBeg));
+        if (columns + width > limit)
+        {
+            break;
+        }
+
+        columns += width;
+        pos += clusterSize;
+    }
+
+    return columns;
+}
+
 void ROW::CopyTextFrom(RowCopyTextFromState& state)
 try
 {
@@ -768,6 +1423,8 @@ catch (...)
     {
         row.SetDoubleBytePadded(colEnd < row._columnCount);
     }
+
+    row.MarkChanged();
 }
 
 // This function represents the slow path of ReplaceCharacters(),
@@ -807,11 +1464,6 @@ void ROW::_resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDi
     }
 }
 
-til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() noexcept
-{
-    return _attr;
-}
-
 const til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() const noexcept
 {
     return _attr;
@@ -958,6 +1610,20 @@ std::wstring_view ROW::GetText(til::CoordType columnBegin, til::CoordType column
     return { _chars.data() + chBeg, chEnd - chBeg };
 }
 
+// Returns the first column of the glyph that contains the character at the given offset into GetText().
+// This is the inverse of GetText(columnBegin, columnEnd) and allows callers that found something in
+// the text (like a regex match) to map it back to columns without measuring the glyphs again.
+til::CoordType ROW::GetLeadingColumnAtCharOffset(const ptrdiff_t offset) const noexcept
+{
+    return _adjustBackward(_columnAtCharOffset(offset));
+}
+
+// Same as GetLeadingColumnAtCharOffset(), but returns the last column of the glyph.
+til::CoordType ROW::GetTrailingColumnAtCharOffset(const ptrdiff_t offset) const noexcept
+{
+    return _columnAtCharOffset(offset);
+}
+
 DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept
 {
     const auto col = _clampedColumn(column);
@@ -978,6 +1644,20 @@ DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_v
     }
 }
 
+// Returns the last column whose char offset is less than or equal to the given offset.
+// _charOffsets is sorted (ignoring the CharOffsetsTrailer bit) which allows us to binary search it.
+uint16_t ROW::_columnAtCharOffset(const ptrdiff_t offset) const noexcept
+{
+    const auto off = gsl::narrow_cast<uint16_t>(std::clamp<ptrdiff_t>(offset, 0, _charSize()));
+    const auto beg = _charOffsets.begin();
+    const auto end = beg + _columnCount;
+    const auto it = std::upper_bound(beg, end, off, [](uint16_t needle, uint16_t value) {
+        return needle < (value & CharOffsetsMask);
+    });
+    // The first column always has an offset of 0 and so `it` is always past `beg`.
+    return gsl::narrow_cast<uint16_t>(std::max<ptrdiff_t>(0, it - beg - 1));
+}
+
 template<typename T>
 constexpr uint16_t ROW::_clampedUint16(T v) noexcept
 {
@@ -28,6 +28,9 @@ struct RowWriteState
     til::CoordType columnBegin = 0; // IN
     // The first column which should not be written to anymore.
     til::CoordType columnLimit = til::CoordTypeMax; // IN
+    // Whether to store each grapheme cluster (like an emoji ZWJ sequence) in a single cell, as enabled via DECSET 2027.
+    // Otherwise each codepoint gets its own cell, which is what applications that measure text with wcwidth() expect.
+    bool graphemeClusters = false; // IN
 
     // The column 1 past the last glyph that was successfully written into the row. If you need to call
     // ReplaceAttributes() to colorize the written range, etc., this is the columnEnd parameter you want.
@@ -65,6 +68,46 @@ struct RowCopyTextFromState
     til::CoordType sourceColumnEnd = 0; // OUT
 };
 
+// Counts how many ROWs reference each hyperlink ID. This allows TextBuffer to
+// free the URIs of hyperlinks that went out of use without scanning the entire buffer.
+class HyperlinkRefCounts
+{
+public:
+    void Increment(uint16_t id);
+    void Decrement(uint16_t id);
+    void ReleaseAll();
+    void TakeUnreferenced(HyperlinkRefCounts& other);
+    void TrackUnreferenced(uint16_t id);
+    uint32_t Count(uint16_t id) const noexcept;
+
+    // Calls release(id) for each ID that lost its last reference and wasn't referenced again since.
+    // IDs for which release() returns false are kept around for the next call.
+    template<typename Func>
+    void Prune(Func&& release)
+    {
+        std::erase_if(_unreferenced, [&](const uint16_t id) {
+            return _counts.contains(id) || release(id);
+        });
+    }
+
+private:
+    std::unordered_map<uint16_t, uint32_t> _counts;
+    std::vector<uint16_t> _unreferenced;
+};
+
+// The generation counter shared by all ROWs of a TextBuffer. Each time a row is modified it's stamped with
+// the next generation, which allows consumers to skip rows that didn't change since they last looked at them.
+class RowGenerations
+{
+public:
+    uint64_t Current() const noexcept { return _current; }
+    uint64_t Next() noexcept { return ++_current; }
+    void Continue(uint64_t generation) noexcept { _current = std::max(_current, generation); }
+
+private:
+    uint64_t _current = 0;
+};
+
 class ROW final
 {
 public:
@@ -92,7 +135,7 @@ public:
     }
 
     ROW() = default;
-    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
+    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, HyperlinkRefCounts* hyperlinkRefs = nullptr, RowGenerations* generations = nullptr);
 
     ROW(const ROW& other) = delete;
     ROW& operator=(const ROW& other) = delete;
@@ -107,23 +150,32 @@ public:
     void SetLineRendition(const LineRendition lineRendition) noexcept;
     LineRendition GetLineRendition() const noexcept;
     uint16_t GetLineWidth() const noexcept;
+    uint64_t GetGeneration() const noexcept;
+    void MarkChanged() noexcept;
 
     void Reset(const TextAttribute& attr) noexcept;
     void TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth);
     void CopyFrom(const ROW& source);
+    void Encode(std::vector<uint8_t>& out) const;
+    void Decode(const uint8_t*& data, HyperlinkRefCounts* hyperlinkRefs, RowGenerations* generations);
+    const wchar_t* GetCharsBuffer() const noexcept;
+    void SwapBuffers(ROW& other) noexcept;
 
     til::CoordType NavigateToPrevious(til::CoordType column) const noexcept;
     til::CoordType NavigateToNext(til::CoordType column) const noexcept;
 
     void ClearCell(til::CoordType column);
     OutputCellIterator WriteCells(OutputCellIterator it, til::CoordType columnBegin, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
+    size_t WriteCharInfos(til::CoordType columnBegin, const std::span<const CHAR_INFO>& charInfos, std::optional<bool> wrap = std::nullopt);
+    void ReadCharInfos(til::CoordType columnBegin, const std::span<CHAR_INFO>& charInfos) const;
     void SetAttrToEnd(til::CoordType columnBegin, TextAttribute attr);
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
+    void ReplaceAttributes(til::CoordType beginIndex, const til::small_rle<TextAttribute, uint16_t, 1>& newAttrs);
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
     void ReplaceText(RowWriteState& state);
+    static til::CoordType MeasureText(const std::wstring_view& chars, til::CoordType columnLimit, bool graphemeClusters) noexcept;
     void CopyTextFrom(RowCopyTextFromState& state);
 
-    til::small_rle<TextAttribute, uint16_t, 1>& Attributes() noexcept;
     const til::small_rle<TextAttribute, uint16_t, 1>& Attributes() const noexcept;
     TextAttribute GetAttrByColumn(til::CoordType column) const;
     std::vector<uint16_t> GetHyperlinks() const;
@@ -136,6 +188,8 @@ public:
     DbcsAttribute DbcsAttrAt(til::CoordType column) const noexcept;
     std::wstring_view GetText() const noexcept;
     std::wstring_view GetText(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept;
+    til::CoordType GetLeadingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
+    til::CoordType GetTrailingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
     DelimiterClass DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept;
 
     auto AttrBegin() const noexcept { return _attr.begin(); }
@@ -191,6 +245,23 @@ private:
         uint16_t leadingSpaces;
         // The amount of characters copied from WriteHelper::chars.
         size_t charsConsumed;
+        // The same as RowWriteState::graphemeClusters. Only used by ReplaceText().
+        bool graphemeClusters = false;
+    };
+
+    // Updates the HyperlinkRefCounts for all hyperlink IDs that were added to or removed from the row
+    // between the construction and destruction of this object. It's a no-op if `active` is false.
+    struct HyperlinkTracker
+    {
+        HyperlinkTracker(ROW& trackedRow, bool enabled) noexcept;
+        ~HyperlinkTracker() noexcept;
+
+        HyperlinkTracker(const HyperlinkTracker&) = delete;
+        HyperlinkTracker& operator=(const HyperlinkTracker&) = delete;
+
+        ROW& row;
+        bool active;
+        til::small_vector<uint16_t, 4> before;
     };
 
     // To simplify the detection of wide glyphs, we don't just store the simple character offset as described
@@ -208,6 +279,7 @@ private:
 
     uint16_t _adjustBackward(uint16_t column) const noexcept;
     uint16_t _adjustForward(uint16_t column) const noexcept;
+    uint16_t _columnAtCharOffset(ptrdiff_t offset) const noexcept;
 
     wchar_t _uncheckedChar(size_t off) const noexcept;
     uint16_t _charSize() const noexcept;
@@ -215,6 +287,9 @@ private:
     bool _uncheckedIsTrailer(size_t col) const noexcept;
 
     void _init() noexcept;
+    void _writeCharInfoRun(uint16_t columnBegin, const std::wstring_view& chars, const std::span<const uint16_t>& charOffsets);
+    bool _tracksHyperlinks(const TextAttribute& attr) const noexcept;
+    til::small_vector<uint16_t, 4> _collectHyperlinks() const;
     void _resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDirty, uint16_t chEndDirtyOld);
 
     // These fields are a bit "wasteful", but it makes all this a bit more robust against
@@ -268,6 +343,14 @@ private:
     bool _wrapForced = false;
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded = false;
+    // Whether any of the _attr runs has a hyperlink ID. Allows us to skip the HyperlinkTracker in the common case.
+    bool _hasHyperlinks = false;
+    // The reference counts of the TextBuffer this row belongs to or nullptr for rows that aren't counted (scratchpad).
+    HyperlinkRefCounts* _hyperlinkRefs = nullptr;
+    // The generation counter of the TextBuffer this row belongs to or nullptr for rows that aren't tracked (scratchpad).
+    RowGenerations* _generations = nullptr;
+    // The generation at which this row was last modified. See MarkChanged().
+    uint64_t _generation = 0;
 };
 
 #ifdef UNIT_TESTING
@@ -5,12 +5,7 @@
 
 #include "search.h"
 
-#include <til/unicode.h>
-
 #include "textBuffer.hpp"
-#include "../types/inc/GlyphWidth.hpp"
-
-using namespace Microsoft::Console::Types;
 
 // Routine Description:
 // - Constructs a Search object.
@@ -26,13 +21,8 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
                const std::wstring_view str,
                const Direction direction,
                const Sensitivity sensitivity) :
-    _direction(direction),
-    _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
-    _renderData(renderData),
-    _coordAnchor(s_GetInitialAnchor(renderData, direction))
+    Search(renderData, str, direction, sensitivity, s_GetInitialAnchor(renderData, direction))
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description:
@@ -51,13 +41,13 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
                const Direction direction,
                const Sensitivity sensitivity,
                const til::point anchor) :
+    _coordAnchor(anchor),
     _direction(direction),
     _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
-    _coordAnchor(anchor),
-    _renderData(renderData)
+    _renderData(renderData),
+    _results(s_FindAll(renderData, str, sensitivity)),
+    _index(_GetInitialIndex())
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description
@@ -69,28 +59,28 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
 // - NOTE: You can FindNext() again after False to go around the buffer again.
 bool Search::FindNext()
 {
-    if (_reachedEnd)
+    const auto count = gsl::narrow_cast<ptrdiff_t>(_results.size());
+    if (count == 0)
     {
-        _reachedEnd = false;
         return false;
     }
 
-    do
+    if (_step == _results.size())
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
-        {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
-        }
+        _step = 0;
+        return false;
+    }
 
-    } while (_coordNext != _coordAnchor);
+    const auto step = gsl::narrow_cast<ptrdiff_t>(_step);
+    auto index = _direction == Direction::Forward ? _index + step : _index - step;
+    // Wrap around the ends of the buffer.
+    index = (index % count + count) % count;
 
-    return false;
+    const auto& result = til::at(_results, index);
+    _coordSelStart = result.start;
+    _coordSelEnd = result.end;
+    ++_step;
+    return true;
 }
 
 // Routine Description:
@@ -177,167 +167,44 @@ til::point Search::s_GetInitialAnchor(const Microsoft::Console::Render::IRenderD
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
+// - Finds all instances of the search term in the written part of the text buffer in a single pass.
 // Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
-// Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const
-{
-    start = {};
-    end = {};
-
-    auto bufferPos = pos;
-
-    for (const auto& needleChars : _needle)
-    {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _renderData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
-    }
-
-    _DecrementCoord(bufferPos);
-
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
-// Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
+// - renderData - The reference to the IRenderData interface type object
+// - str - The search term
+// - sensitivity - Whether or not we care about case
 // Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept
+// - The start and end (inclusive) positions of all matches, sorted by position.
+std::vector<til::point_span> Search::s_FindAll(const Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view str, const Sensitivity sensitivity)
 {
-    if (one.size() != two.size())
-    {
-        return false;
-    }
-
-    for (size_t i = 0; i < one.size(); i++)
-    {
-        if (_ApplySensitivity(one.at(i)) != _ApplySensitivity(two.at(i)))
-        {
-            return false;
-        }
-    }
-
-    return true;
+    const auto& textBuffer = renderData.GetTextBuffer();
+    const auto lastRow = renderData.GetTextBufferEndPosition().y;
+    return textBuffer.SearchText(str, sensitivity == Sensitivity::CaseInsensitive, 0, lastRow + 1);
 }
 
 // Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
-// Arguments:
-// - wch - Character to adjust if necessary
+// - Finds the match at which FindNext() starts: The first one at or after the
+//   anchor when searching forward, or the last one at or before it otherwise.
 // Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const noexcept
+// - An index into _results. Unused if there are no results.
+ptrdiff_t Search::_GetInitialIndex() const noexcept
 {
-    if (_sensitivity == Sensitivity::CaseInsensitive)
-    {
-        return ::towlower(wch);
-    }
-    else
-    {
-        return wch;
-    }
-}
+    const auto beg = _results.begin();
+    const auto end = _results.end();
 
-// Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(til::point& coord) const noexcept
-{
-    _renderData.GetTextBuffer().GetSize().IncrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(til::point& coord) const noexcept
-{
-    _renderData.GetTextBuffer().GetSize().DecrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
-// Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
-{
     if (_direction == Direction::Forward)
     {
-        _IncrementCoord(_coordNext);
-    }
-    else if (_direction == Direction::Backward)
-    {
-        _DecrementCoord(_coordNext);
+        const auto it = std::lower_bound(beg, end, _coordAnchor, [](const til::point_span& result, const til::point& anchor) {
+            return result.start < anchor;
+        });
+        // If all matches precede the anchor we wrap around to the first one.
+        return it == end ? 0 : it - beg;
     }
     else
     {
-        THROW_HR(E_NOTIMPL);
-    }
-
-    // To reduce wrap-around time, if the next position is larger than
-    // the end position of the written text
-    // We put the next position to:
-    // Forward: (0, 0)
-    // Backward: the position of the end of the text buffer
-    const auto bufferEndPosition = _renderData.GetTextBufferEndPosition();
-
-    if (_coordNext.y > bufferEndPosition.y ||
-        (_coordNext.y == bufferEndPosition.y && _coordNext.x > bufferEndPosition.x))
-    {
-        if (_direction == Direction::Forward)
-        {
-            _coordNext = {};
-        }
-        else
-        {
-            _coordNext = bufferEndPosition;
-        }
-    }
-}
-
-// Routine Description:
-// - Creates a "needle" of the correct format for comparison to the screen buffer text data
-//   that we can use for our search
-// Arguments:
-// - wstr - String that will be our search term
-// Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::wstring> Search::s_CreateNeedleFromString(const std::wstring_view wstr)
-{
-    std::vector<std::wstring> cells;
-    for (const auto& chars : til::utf16_iterator{ wstr })
-    {
-        if (IsGlyphFullWidth(chars))
-        {
-            cells.emplace_back(chars);
-        }
-        cells.emplace_back(chars);
+        const auto it = std::upper_bound(beg, end, _coordAnchor, [](const til::point& anchor, const til::point_span& result) {
+            return anchor < result.start;
+        });
+        // If all matches follow the anchor we wrap around to the last one.
+        return (it == beg ? end : it) - beg - 1;
     }
-    return cells;
 }
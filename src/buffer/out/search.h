@@ -57,29 +57,26 @@ public:
     std::pair<til::point, til::point> GetFoundLocation() const noexcept;
 
 private:
-    wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
-    void _UpdateNextPosition();
-
-    void _IncrementCoord(til::point& coord) const noexcept;
-    void _DecrementCoord(til::point& coord) const noexcept;
-
     static til::point s_GetInitialAnchor(const Microsoft::Console::Render::IRenderData& renderData, const Direction dir);
 
-    static std::vector<std::wstring> s_CreateNeedleFromString(const std::wstring_view wstr);
+    static std::vector<til::point_span> s_FindAll(const Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view str, const Sensitivity sensitivity);
+
+    ptrdiff_t _GetInitialIndex() const noexcept;
 
-    bool _reachedEnd = false;
-    til::point _coordNext;
     til::point _coordSelStart;
     til::point _coordSelEnd;
 
     const til::point _coordAnchor;
-    const std::vector<std::wstring> _needle;
     const Direction _direction;
     const Sensitivity _sensitivity;
     Microsoft::Console::Render::IRenderData& _renderData;
 
+    // All matches in the buffer, sorted by their start position.
+    const std::vector<til::point_span> _results;
+    // The index into _results at which FindNext() starts and how many results it returned since.
+    const ptrdiff_t _index;
+    size_t _step = 0;
+
 #ifdef UNIT_TESTING
     friend class SearchTests;
 #endif
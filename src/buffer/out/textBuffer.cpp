@@ -18,6 +18,9 @@ using namespace Microsoft::Console::Types;
 
 using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 
+// The largest generation of all destroyed TextBuffers. See the constructor.
+static std::atomic<uint64_t> s_retiredGeneration{ 0 };
+
 // Routine Description:
 // - Creates a new instance of TextBuffer
 // Arguments:
@@ -43,6 +46,11 @@ TextBuffer::TextBuffer(til::size screenBufferSize,
     screenBufferSize.width = std::max(screenBufferSize.width, 1);
     screenBufferSize.height = std::max(screenBufferSize.height, 1);
     _reserve(screenBufferSize, defaultAttributes);
+
+    // Continue where the last destroyed TextBuffer left off. This way a consumer that holds on to a
+    // pointer to a destroyed buffer and its generation, can't mistake a new buffer at the same address for it.
+    _generations->Continue(s_retiredGeneration.load(std::memory_order_relaxed));
+    _recordChange(true);
 }
 
 TextBuffer::~TextBuffer()
@@ -51,6 +59,16 @@ TextBuffer::~TextBuffer()
     {
         _destroy();
     }
+
+    // ResizeTraditional() steals the _generations of temporary TextBuffers.
+    if (_generations)
+    {
+        const auto generation = _generations->Current();
+        auto retired = s_retiredGeneration.load(std::memory_order_relaxed);
+        while (retired < generation && !s_retiredGeneration.compare_exchange_weak(retired, generation, std::memory_order_relaxed))
+        {
+        }
+    }
 }
 
 // I put these functions in a block at the start of the class, because they're the most
@@ -98,6 +116,7 @@ void TextBuffer::_reserve(til::size screenBufferSize, const TextAttribute& defau
     _bufferOffsetCharOffsets = rowSize + charsBufferSize;
     _width = w;
     _height = h;
+    _coldChunks = std::vector<ColdChunk>((size_t{ h } + _coldChunkRowCount - 1) / _coldChunkRowCount);
 }
 
 // MEM_COMMITs the memory and constructs all ROWs up to and including the given row pointer.
@@ -123,9 +142,16 @@ __declspec(noinline) void TextBuffer::_commit(const std::byte* row)
 // You can use this (or rather the Reset() method) to fully clear the TextBuffer.
 void TextBuffer::_decommit() noexcept
 {
+    try
+    {
+        _hyperlinkRefs->ReleaseAll();
+    }
+    CATCH_LOG();
+
     _destroy();
     VirtualFree(_buffer.get(), 0, MEM_DECOMMIT);
     _commitWatermark = _buffer.get();
+    _resetColdChunks();
 }
 
 // Constructs ROWs up to (excluding) the ROW pointed to by `until`.
@@ -136,17 +162,26 @@ void TextBuffer::_construct(const std::byte* until) noexcept
         const auto row = reinterpret_cast<ROW*>(_commitWatermark);
         const auto chars = reinterpret_cast<wchar_t*>(_commitWatermark + _bufferOffsetChars);
         const auto indices = reinterpret_cast<uint16_t*>(_commitWatermark + _bufferOffsetCharOffsets);
-        std::construct_at(row, chars, indices, _width, _initialAttributes);
+        // The scratchpad row is excluded from the hyperlink reference counting, because it's not part of the buffer contents.
+        // The same applies to the generation tracking.
+        const auto isScratchpad = _commitWatermark == _buffer.get();
+        const auto hyperlinkRefs = isScratchpad ? nullptr : _hyperlinkRefs.get();
+        const auto generations = isScratchpad ? nullptr : _generations.get();
+        std::construct_at(row, chars, indices, _width, _initialAttributes, hyperlinkRefs, generations);
     }
 }
 
-// Destroys all previously constructed ROWs.
+// Destroys all previously constructed ROWs, except for cold ones, which have been destroyed already.
 // Be careful! This doesn't reset any of the members, in particular the _commitWatermark.
 void TextBuffer::_destroy() const noexcept
 {
-    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride)
+    size_t offset = 0;
+    for (auto it = _buffer.get(); it < _commitWatermark; it += _bufferRowStride, ++offset)
     {
-        std::destroy_at(reinterpret_cast<ROW*>(it));
+        if (!_isRowCold(offset))
+        {
+            std::destroy_at(reinterpret_cast<ROW*>(it));
+        }
     }
 }
 
@@ -162,10 +197,187 @@ ROW& TextBuffer::_getRowByOffsetDirect(size_t offset)
     {
         _commit(row);
     }
+    else if (_coldChunkCount != 0 && _isRowCold(offset))
+    {
+        _decodeChunk((offset - 1) / _coldChunkRowCount);
+    }
 
     return *reinterpret_cast<ROW*>(row);
 }
 
+// Returns true if the ROW at the given offset (as used by _getRowByOffsetDirect()) is encoded in _coldChunks.
+bool TextBuffer::_isRowCold(const size_t offset) const noexcept
+{
+    // The scratchpad row at offset 0 is never cold.
+    return offset != 0 && !til::at(_coldChunks, (offset - 1) / _coldChunkRowCount).data.empty();
+}
+
+// Returns the range of memory occupied by the ROWs of the given chunk.
+std::pair<std::byte*, std::byte*> TextBuffer::_coldChunkRows(const size_t chunk) const noexcept
+{
+    // +1, because the scratchpad row precedes all other rows.
+    const auto first = chunk * _coldChunkRowCount + 1;
+    const auto last = std::min(first + _coldChunkRowCount, size_t{ _height } + 1);
+    return { _buffer.get() + first * _bufferRowStride, _buffer.get() + last * _bufferRowStride };
+}
+
+// Returns the pages which only contain ROWs of the given chunk. These can be MEM_DECOMMITed while the chunk is cold.
+// The pages at either end are shared with the adjacent chunks and remain committed.
+std::pair<std::byte*, std::byte*> TextBuffer::_coldChunkPages(const size_t chunk) const noexcept
+{
+    // All architectures Windows runs on have 4KiB pages.
+    static constexpr uintptr_t pageSize = 4096;
+    const auto [rowsBeg, rowsEnd] = _coldChunkRows(chunk);
+    const auto beg = (reinterpret_cast<uintptr_t>(rowsBeg) + pageSize - 1) & ~(pageSize - 1);
+    const auto end = std::max(beg, reinterpret_cast<uintptr_t>(rowsEnd) & ~(pageSize - 1));
+    return { reinterpret_cast<std::byte*>(beg), reinterpret_cast<std::byte*>(end) };
+}
+
+// Encodes up to 2 chunks whose rows are all cold. It's called by IncrementCircularBuffer(), each call of which
+// turns 1 more row cold. Looking at 2 chunks per call is thus sufficient to keep up with the output, and to
+// eventually encode chunks again that were decoded by a search, etc. (after _coldChunkCooldown scrolls).
+void TextBuffer::_coolRows() noexcept
+try
+{
+    // Rows with a logical offset smaller than this are cold.
+    const auto coldLimit = _cursor.GetPosition().y - _hotRowCount;
+    if (coldLimit <= 0)
+    {
+        return;
+    }
+
+    for (auto i = 0; i < 2; ++i)
+    {
+        const auto chunk = _coolingCursor;
+        _coolingCursor = (_coolingCursor + 1) % _coldChunks.size();
+
+        const auto& coldChunk = til::at(_coldChunks, chunk);
+        if (!coldChunk.data.empty() || _scrolledTotal - coldChunk.decodedAt < _coldChunkCooldown)
+        {
+            continue;
+        }
+
+        // Only chunks whose ROWs have all been constructed can be encoded.
+        const auto [rowsBeg, rowsEnd] = _coldChunkRows(chunk);
+        if (rowsEnd > _commitWatermark)
+        {
+            continue;
+        }
+
+        // The rows of a chunk are physically adjacent and as such logically adjacent as well. The exception is
+        // a chunk containing the _firstRow, because the row preceding it is the logically last row of the buffer.
+        const auto first = gsl::narrow_cast<til::CoordType>(chunk * _coldChunkRowCount);
+        const auto last = first + gsl::narrow_cast<til::CoordType>((rowsEnd - rowsBeg) / _bufferRowStride) - 1;
+        if (_firstRow > first && _firstRow <= last)
+        {
+            continue;
+        }
+        if ((last - _firstRow + _height) % _height >= coldLimit)
+        {
+            continue;
+        }
+
+        _encodeChunk(chunk);
+    }
+}
+CATCH_LOG()
+
+// Encodes the ROWs of the given chunk into its ColdChunk::data, destroys them and MEM_DECOMMITs their memory.
+void TextBuffer::_encodeChunk(const size_t chunk)
+{
+    auto& coldChunk = til::at(_coldChunks, chunk);
+    const auto [rowsBeg, rowsEnd] = _coldChunkRows(chunk);
+
+    // ScrollRows() swaps ROWs including the buffers they store their text in. The memory of this chunk can only
+    // be decommitted if its buffers are used by its own ROWs. The buffers form a permutation of the ROWs:
+    // Swapping a ROW's buffer with the ROW that owns it (which is found by its address) hands the owner
+    // its own buffer back. Repeating that until the ROW got its own buffer takes one step per displaced ROW.
+    // Cold ROWs always use their own buffers, so they're never part of such a cycle.
+    for (auto it = rowsBeg; it < rowsEnd; it += _bufferRowStride)
+    {
+        auto& row = *reinterpret_cast<ROW*>(it);
+        const auto chars = reinterpret_cast<const wchar_t*>(it + _bufferOffsetChars);
+
+        while (row.GetCharsBuffer() != chars)
+        {
+            const auto used = reinterpret_cast<const std::byte*>(row.GetCharsBuffer());
+            THROW_HR_IF(E_UNEXPECTED, used < _buffer.get() || used >= _commitWatermark);
+            const auto owner = _buffer.get() + (used - _buffer.get()) / _bufferRowStride * _bufferRowStride;
+            row.SwapBuffers(*reinterpret_cast<ROW*>(owner));
+        }
+    }
+
+    std::vector<uint8_t> data;
+    data.reserve(_coldChunkRowCount * (_width + 64));
+    for (auto it = rowsBeg; it < rowsEnd; it += _bufferRowStride)
+    {
+        reinterpret_cast<const ROW*>(it)->Encode(data);
+    }
+    data.shrink_to_fit();
+
+    for (auto it = rowsBeg; it < rowsEnd; it += _bufferRowStride)
+    {
+        std::destroy_at(reinterpret_cast<ROW*>(it));
+    }
+
+    const auto [pagesBeg, pagesEnd] = _coldChunkPages(chunk);
+    if (pagesBeg < pagesEnd)
+    {
+        VirtualFree(pagesBeg, pagesEnd - pagesBeg, MEM_DECOMMIT);
+        _decommittedBytes += pagesEnd - pagesBeg;
+    }
+
+    _coldRows += gsl::narrow_cast<til::CoordType>((rowsEnd - rowsBeg) / _bufferRowStride);
+    _coldBytes += data.size();
+    _coldChunkCount++;
+    coldChunk.data = std::move(data);
+}
+
+// MEM_COMMITs the memory of the given cold chunk and constructs its ROWs from ColdChunk::data.
+// Just like _commit() it's noinline, so that _getRowByOffsetDirect() can be inlined.
+__declspec(noinline) void TextBuffer::_decodeChunk(const size_t chunk)
+{
+    auto& coldChunk = til::at(_coldChunks, chunk);
+    const auto [rowsBeg, rowsEnd] = _coldChunkRows(chunk);
+    const auto [pagesBeg, pagesEnd] = _coldChunkPages(chunk);
+
+    if (pagesBeg < pagesEnd)
+    {
+        THROW_LAST_ERROR_IF_NULL(VirtualAlloc(pagesBeg, pagesEnd - pagesBeg, MEM_COMMIT, PAGE_READWRITE));
+        _decommittedBytes -= pagesEnd - pagesBeg;
+    }
+
+    const uint8_t* data = coldChunk.data.data();
+    for (auto it = rowsBeg; it < rowsEnd; it += _bufferRowStride)
+    {
+        const auto chars = reinterpret_cast<wchar_t*>(it + _bufferOffsetChars);
+        const auto indices = reinterpret_cast<uint16_t*>(it + _bufferOffsetCharOffsets);
+        // The row is constructed without the HyperlinkRefCounts, because it's still counted from before it was encoded.
+        const auto row = std::construct_at(reinterpret_cast<ROW*>(it), chars, indices, _width, TextAttribute{}, nullptr, nullptr);
+        row->Decode(data, _hyperlinkRefs.get(), _generations.get());
+    }
+
+    _coldRows -= gsl::narrow_cast<til::CoordType>((rowsEnd - rowsBeg) / _bufferRowStride);
+    _coldBytes -= coldChunk.data.size();
+    _coldChunkCount--;
+    coldChunk.data = {};
+    coldChunk.decodedAt = _scrolledTotal;
+}
+
+// Forgets about all cold chunks, for instance after all ROWs were discarded by _decommit().
+void TextBuffer::_resetColdChunks() noexcept
+{
+    for (auto& coldChunk : _coldChunks)
+    {
+        coldChunk = {};
+    }
+    _coldChunkCount = 0;
+    _coolingCursor = 0;
+    _coldRows = 0;
+    _coldBytes = 0;
+    _decommittedBytes = 0;
+}
+
 // Returns the "user-visible" index of the last committed row, which can be used
 // to short-circuit some algorithms that try to scan the entire buffer.
 // Returns 0 if no rows are committed in.
@@ -206,6 +418,82 @@ ROW& TextBuffer::GetRowByOffset(const til::CoordType index)
     return _getRowByOffsetDirect(gsl::narrow_cast<size_t>(offset) + 1);
 }
 
+// Returns the current generation of the buffer. Any modification afterwards results in a larger generation.
+// Consumers can store it and later pass it to GetChangesSince()/HasChangedSince() to find out what changed.
+// Generations are only comparable within the same TextBuffer.
+uint64_t TextBuffer::GetGeneration() const noexcept
+{
+    return _generations->Current();
+}
+
+// Returns the changes to the buffer as a whole since the given generation (for instance, whether
+// it was scrolled). Changes to individual rows can be found via ROW::GetGeneration().
+TextBuffer::Changes TextBuffer::GetChangesSince(const uint64_t generation) const noexcept
+{
+    if (generation > _generations->Current())
+    {
+        return { .all = true };
+    }
+
+    const auto available = std::min<uint64_t>(_journalCount, _journalCapacity);
+    auto scrolledBefore = _scrolledTotal;
+    auto complete = false;
+
+    for (uint64_t i = 1; i <= available; ++i)
+    {
+        const auto& entry = til::at(_journal, gsl::narrow_cast<size_t>((_journalCount - i) % _journalCapacity));
+        if (entry.generation <= generation)
+        {
+            complete = true;
+            break;
+        }
+        if (entry.reset)
+        {
+            return { .all = true };
+        }
+        scrolledBefore = entry.scrolledBefore;
+    }
+
+    // If we ran out of entries, older ones that we don't know about anymore might have been newer than `generation`.
+    if (!complete && _journalCount > _journalCapacity)
+    {
+        return { .all = true };
+    }
+
+    const auto scrolled = std::min<uint64_t>(_scrolledTotal - scrolledBefore, _height);
+    return { .scrolled = gsl::narrow_cast<til::CoordType>(scrolled) };
+}
+
+// Returns true if any of the rows in the range [firstRow, lastRow] (inclusive) were modified since the given
+// generation, or if they now contain different rows, because the buffer was scrolled, reset or resized.
+bool TextBuffer::HasChangedSince(const uint64_t generation, const til::CoordType firstRow, const til::CoordType lastRow) const
+{
+    const auto changes = GetChangesSince(generation);
+    if (changes.all || changes.scrolled)
+    {
+        return true;
+    }
+
+    for (auto y = firstRow; y <= lastRow; ++y)
+    {
+        if (GetRowByOffset(y).GetGeneration() > generation)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TextBuffer::_recordChange(const bool reset) noexcept
+{
+    auto& entry = til::at(_journal, gsl::narrow_cast<size_t>(_journalCount % _journalCapacity));
+    entry.generation = _generations->Next();
+    entry.scrolledBefore = _scrolledTotal;
+    entry.reset = reset;
+    ++_journalCount;
+}
+
 // Returns a row filled with whitespace and the current attributes, for you to freely use.
 ROW& TextBuffer::GetScratchpadRow()
 {
@@ -233,6 +521,7 @@ ROW& TextBuffer::GetScratchpadRow(const TextAttribute& attributes)
 void TextBuffer::CopyProperties(const TextBuffer& OtherBuffer) noexcept
 {
     GetCursor().CopyProperties(OtherBuffer.GetCursor());
+    _hotRowCount = OtherBuffer._hotRowCount;
 }
 
 // Routine Description:
@@ -246,6 +535,30 @@ til::CoordType TextBuffer::TotalRowCount() const noexcept
     return _height;
 }
 
+// Routine Description:
+// - Sets how many rows above the cursor are kept as ROWs. Rows further up are encoded into a compact
+//   form once the buffer scrolls and decoded again when they're accessed. See _coldChunks.
+// - This is disabled by default (til::CoordTypeMax). See RecommendedHotRowCount.
+// Arguments:
+// - rows - The number of rows to keep decoded. til::CoordTypeMax disables encoding rows.
+void TextBuffer::SetHotRowCount(const til::CoordType rows) noexcept
+{
+    _hotRowCount = std::max(0, rows);
+}
+
+// Routine Description:
+// - Gets the memory used by the rows of the buffer.
+// Return Value:
+// - The committed memory of the ROWs and the memory used by encoded cold rows.
+TextBuffer::MemoryUsage TextBuffer::GetMemoryUsage() const noexcept
+{
+    return {
+        .committed = gsl::narrow_cast<size_t>(_commitWatermark - _buffer.get()) - _decommittedBytes,
+        .cold = _coldBytes,
+        .coldRows = _coldRows,
+    };
+}
+
 // Routine Description:
 // - Retrieves read-only text iterator at the given buffer location
 // Arguments:
@@ -441,11 +754,11 @@ void TextBuffer::_PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute
     }
 }
 
-void TextBuffer::ConsumeGrapheme(std::wstring_view& chars) noexcept
+void TextBuffer::ConsumeGrapheme(std::wstring_view& chars, const bool graphemeClusters) noexcept
 {
     // This function is supposed to mirror the behavior of ROW::Write, when it reads characters off of `chars`.
-    // (I know that a UTF-16 code point is not a grapheme, but that's what we're working towards.)
-    chars = til::utf16_pop(chars);
+    // Outside of grapheme cluster mode that's a single codepoint.
+    chars = graphemeClusters ? til::utf16_pop_grapheme(chars) : til::utf16_pop(chars);
 }
 
 // This function is intended for writing regular "lines" of text as it'll set the wrap flag on the given row.
@@ -597,6 +910,67 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes a rectangle of CHAR_INFOs into the buffer via ROW::WriteCharInfos(). The result is the same as calling
+//   Write() with an OutputCellIterator for each row of the rectangle, but a lot faster for large areas.
+// Arguments:
+// - target - the area to write to. It must be inside the buffer.
+// - source - the CHAR_INFOs to write, with the first one going into the top left corner of target
+// - stride - the distance between the beginning of two consecutive rows in source
+void TextBuffer::WriteCharInfos(const til::rect& target, const std::span<const CHAR_INFO>& source, const size_t stride)
+{
+    const auto size = GetSize().Dimensions();
+    THROW_HR_IF(E_INVALIDARG, !til::rect{ size }.contains(target));
+
+    if (!target)
+    {
+        return;
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(target.width());
+    THROW_HR_IF(E_INVALIDARG, stride < width || (gsl::narrow_cast<size_t>(target.height()) - 1) * stride + width > source.size());
+
+    for (auto y = target.top; y < target.bottom; ++y)
+    {
+        const auto offset = gsl::narrow_cast<size_t>(y - target.top) * stride;
+        // Like Write() we set the wrap flag if we write into the last column, which WriteConsoleOutput has always done.
+        GetRowByOffset(y).WriteCharInfos(target.left, source.subspan(offset, width), true);
+    }
+
+    // Overwriting half of a wide glyph turns its other half into whitespace, which may be right outside of target.
+    TriggerRedraw(Viewport::FromExclusive({ std::max(target.left - 1, 0), target.top, std::min(target.right + 1, size.width), target.bottom }));
+}
+
+// Routine Description:
+// - Reads a rectangle of the buffer as CHAR_INFOs via ROW::ReadCharInfos().
+// Arguments:
+// - source - the area to read from. It must be inside the buffer.
+// - target - receives the CHAR_INFOs, with the top left corner of source going into the first one.
+//   If it's too small, the cells that don't fit are skipped.
+// - stride - the distance between the beginning of two consecutive rows in target
+void TextBuffer::ReadCharInfos(const til::rect& source, const std::span<CHAR_INFO>& target, const size_t stride) const
+{
+    THROW_HR_IF(E_INVALIDARG, !til::rect{ GetSize().Dimensions() }.contains(source));
+
+    if (!source)
+    {
+        return;
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(source.width());
+    THROW_HR_IF(E_INVALIDARG, stride < width);
+
+    for (auto y = source.top; y < source.bottom; ++y)
+    {
+        const auto offset = gsl::narrow_cast<size_t>(y - source.top) * stride;
+        if (offset >= target.size())
+        {
+            break;
+        }
+        GetRowByOffset(y).ReadCharInfos(source.left, target.subspan(offset, std::min(width, target.size() - offset)));
+    }
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -750,11 +1124,11 @@ void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
         _renderer.TriggerFlush(true);
     }
 
-    // Prune hyperlinks to delete obsolete references
-    _PruneHyperlinks();
-
-    // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
+    // First, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     GetRowByOffset(0).Reset(fillAttributes);
+
+    // Then prune hyperlinks that are not referenced by any row anymore.
+    _PruneHyperlinks();
     {
         // Now proceed to increment.
         // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
@@ -766,6 +1140,11 @@ void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
             _firstRow = 0;
         }
     }
+
+    _recordChange(false);
+    ++_scrolledTotal;
+
+    _coolRows();
 }
 
 //Routine Description:
@@ -859,6 +1238,15 @@ void TextBuffer::_SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept
     _firstRow = FirstRowIndex;
 }
 
+// Routine Description:
+// - Moves `size` rows starting at `firstRow` up or down by `delta` rows.
+// - The rows are moved by swapping the ROW objects (which only point to their text storage),
+//   so scrolling a region costs O(rows) no matter how wide the buffer is. As a consequence the
+//   rows that were scrolled over end up in the vacated rows. Callers are expected to erase them.
+// Arguments:
+// - firstRow - The first row of the range to move.
+// - size - The number of rows to move.
+// - delta - The distance to move the rows by (positive is down, negative is up).
 void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size, const til::CoordType delta)
 {
     if (delta == 0)
@@ -866,67 +1254,56 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size,
         return;
     }
 
-    // Since the for() loop uses !=, we must ensure that size is positive.
+    // Since the for() loops use <, we must ensure that size is positive.
     // A negative size doesn't make any sense anyways.
     size = std::max(0, size);
 
-    til::CoordType y = 0;
-    til::CoordType end = 0;
-    til::CoordType step = 0;
-
-    if (delta < 0)
-    {
-        // The layout is like this:
-        // delta is -2, size is 3, firstRow is 5
-        // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3 A. firstRow + delta (because delta is negative)
-        // | 4
-        // | 5 B. firstRow
-        // | 6
-        // | 7
-        // | 8 C. firstRow + size
-        // | 9
-        // | 10
-        // | 11
-        // - end
-        // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
-        y = firstRow;
-        end = firstRow + size;
-        step = 1;
-    }
-    else
-    {
-        // The layout is like this:
-        // delta is 2, size is 3, firstRow is 5
-        // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 5 A. firstRow
-        // | 6
-        // | 7
-        // | 8 B. firstRow + size
-        // | 9
-        // | 10 C. firstRow + size + delta
-        // | 11
-        // - end
-        // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
-        y = firstRow + size - 1;
-        end = firstRow - 1;
-        step = -1;
-    }
+    const auto swapRows = [&](til::CoordType a, til::CoordType b) {
+        auto& rowA = GetRowByOffset(a);
+        auto& rowB = GetRowByOffset(b);
+        std::swap(rowA, rowB);
+        // The rows carry their generation with them, but as far as consumers are
+        // concerned, the contents at both offsets changed.
+        rowA.MarkChanged();
+        rowB.MarkChanged();
+    };
 
-    for (; y != end; y += step)
+    // If the source and target ranges don't overlap, we can simply swap them row by row.
+    // This leaves any rows in between the two ranges alone.
+    if (std::abs(delta) >= size)
     {
-        GetRowByOffset(y + delta).CopyFrom(GetRowByOffset(y));
+        for (til::CoordType i = 0; i < size; ++i)
+        {
+            swapRows(firstRow + i, firstRow + delta + i);
+        }
+        return;
     }
+
+    // Otherwise we rotate the union of the two ranges, such that the row at `mid` ends up at `beg`.
+    // The layout is like this for a delta of -2, a size of 3 and a firstRow of 5:
+    // --- (storage) ----
+    // | 3 beg (= firstRow + delta, because delta is negative)
+    // | 4
+    // | 5 mid (= firstRow)
+    // | 6
+    // | 7
+    // | 8 end (= firstRow + size)
+    // For a positive delta the source range is at the top and mid is the first row following it
+    // (= firstRow + size), which moves the rows that are scrolled over into the vacated rows at the top.
+    const auto beg = std::min(firstRow, firstRow + delta);
+    const auto end = beg + size + std::abs(delta);
+    const auto mid = delta < 0 ? firstRow : firstRow + size;
+
+    // A rotation is 3 reversals: [beg, mid), [mid, end) and then [beg, end).
+    const auto reverseRows = [&](til::CoordType first, til::CoordType last) {
+        for (--last; first < last; ++first, --last)
+        {
+            swapRows(first, last);
+        }
+    };
+    reverseRows(beg, mid);
+    reverseRows(mid, end);
+    reverseRows(beg, end);
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -1031,6 +1408,7 @@ void TextBuffer::Reset() noexcept
 {
     _decommit();
     _initialAttributes = _currentAttributes;
+    _recordChange(true);
 }
 
 // Routine Description:
@@ -1048,6 +1426,8 @@ void TextBuffer::Reset() noexcept
     try
     {
         TextBuffer newBuffer{ newSize, _currentAttributes, 0, false, _renderer };
+        // The new rows must be stamped with generations that follow ours, because we'll adopt them below.
+        newBuffer._generations->Continue(_generations->Current());
         const auto cursorRow = GetCursor().GetPosition().y;
         const auto copyableRows = std::min<til::CoordType>(_height, newSize.height);
         til::CoordType srcRow = 0;
@@ -1063,6 +1443,13 @@ void TextBuffer::Reset() noexcept
             newBuffer.GetRowByOffset(dstRow).CopyFrom(GetRowByOffset(srcRow));
         }
 
+        // Our rows are about to be discarded. Any hyperlink ID they referenced, which
+        // isn't referenced by the new rows, will be freed by the next _PruneHyperlinks().
+        _hyperlinkRefs->ReleaseAll();
+        newBuffer._hyperlinkRefs->TakeUnreferenced(*_hyperlinkRefs);
+        _hyperlinkRefs = std::move(newBuffer._hyperlinkRefs);
+        _generations = std::move(newBuffer._generations);
+
         // NOTE: Keep this in sync with _reserve().
         _buffer = std::move(newBuffer._buffer);
         _bufferEnd = newBuffer._bufferEnd;
@@ -1073,8 +1460,11 @@ void TextBuffer::Reset() noexcept
         _bufferOffsetCharOffsets = newBuffer._bufferOffsetCharOffsets;
         _width = newBuffer._width;
         _height = newBuffer._height;
+        _coldChunks = std::move(newBuffer._coldChunks);
+        _resetColdChunks();
 
         _SetFirstRowIndex(0);
+        _recordChange(true);
     }
     CATCH_RETURN();
 
@@ -1414,48 +1804,20 @@ til::point TextBuffer::_GetWordEndForSelection(const til::point target, const st
 
 void TextBuffer::_PruneHyperlinks()
 {
-    // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
-    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = GetRowByOffset(0).GetHyperlinks();
-
-    if (!hyperlinks.empty())
-    {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (til::CoordType i = 1; i < total; ++i)
-        {
-            const auto nextRowRefs = GetRowByOffset(i).GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
-        }
-
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
+    // The rows keep track of how often they reference each hyperlink ID and report
+    // the ones that have fallen to zero. That way we don't need to scan the entire
+    // buffer whenever a row with a hyperlink scrolls out of view.
+    const auto currentId = _currentAttributes.GetHyperlinkId();
+    _hyperlinkRefs->Prune([&](const uint16_t id) {
+        // The current attributes may still reference the ID, even if no row does.
+        // It'll be reconsidered once it's been written and then scrolled out of view again.
+        if (id == currentId)
         {
-            RemoveHyperlinkFromMap(hyperlinkReference);
+            return false;
         }
-    }
+        RemoveHyperlinkFromMap(id);
+        return true;
+    });
 }
 
 // Method Description:
@@ -1812,130 +2174,271 @@ void TextBuffer::_ExpandTextRow(til::inclusive_rect& textRow) const
     }
 }
 
+// Moves the given column past the trailing half of a wide glyph, if it points to one.
+// This way a range of columns [begin, end) includes the glyphs whose leading half it contains.
+static til::CoordType skipTrailer(const ROW& row, const til::CoordType column)
+{
+    return column < row.size() && row.DbcsAttrAt(column) == DbcsAttribute::Trailing ? column + 1 : column;
+}
+
+// Returns the columns [begin, end) of the given row that a selection from `left` to `right` (inclusive) covers.
+// A wide glyph whose leading half is outside of the selection is excluded and one whose trailing half is outside
+// of it is included. If trimTrailingWhitespace is set, the columns of trailing spaces are excluded as well.
+static std::pair<til::CoordType, til::CoordType> selectedColumns(const ROW& row, const til::CoordType left, const til::CoordType right, const bool trimTrailingWhitespace)
+{
+    const til::CoordType width = row.size();
+    const auto begin = skipTrailer(row, std::clamp(left, 0, width));
+    auto end = std::max(begin, skipTrailer(row, std::clamp(right + 1, 0, width)));
+
+    if (trimTrailingWhitespace)
+    {
+        while (end > begin && row.GetText(end - 1, end) == L" ")
+        {
+            --end;
+        }
+    }
+
+    return { begin, end };
+}
+
 // Routine Description:
-// - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// - Retrieves the text from the selected region, one string per selected row.
 // Arguments:
 // - includeCRLF - inject CRLF pairs to the end of each line
 // - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
 // - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
-// - GetAttributeColors - function used to map TextAttribute to RGB COLORREFs. If null, only extract the text.
 // - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
 // Return Value:
-// - The text, background color, and foreground color data of the selected region of the text buffer.
-const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
-                                                   const bool trimTrailingWhitespace,
-                                                   const std::vector<til::inclusive_rect>& selectionRects,
-                                                   std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors,
-                                                   const bool formatWrappedRows) const
+// - The text of the selected region of the text buffer.
+std::vector<std::wstring> TextBuffer::GetText(const bool includeCRLF,
+                                              const bool trimTrailingWhitespace,
+                                              const std::vector<til::inclusive_rect>& selectionRects,
+                                              const bool formatWrappedRows) const
 {
-    TextAndColor data;
-    const auto copyTextColor = GetAttributeColors != nullptr;
-
-    // preallocate our vectors to reduce reallocs
+    std::vector<std::wstring> text;
     const auto rows = selectionRects.size();
-    data.text.reserve(rows);
-    if (copyTextColor)
-    {
-        data.FgAttr.reserve(rows);
-        data.BkAttr.reserve(rows);
-    }
+    text.reserve(rows);
 
-    // for each row in the selection
     for (size_t i = 0; i < rows; i++)
     {
-        const auto iRow = selectionRects.at(i).top;
-
-        const auto highlight = Viewport::FromInclusive(selectionRects.at(i));
+        const auto& rect = til::at(selectionRects, i);
+        const auto& row = GetRowByOffset(rect.top);
 
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
+        const auto shouldFormatRow = formatWrappedRows || !row.WasWrapForced();
+        const auto [columnBegin, columnEnd] = selectedColumns(row, rect.left, rect.right, trimTrailingWhitespace && shouldFormatRow);
 
-        // allocate a string buffer
-        std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
+        auto& rowText = text.emplace_back(row.GetText(columnBegin, columnEnd));
 
-        // preallocate to avoid reallocs
-        selectionText.reserve(gsl::narrow<size_t>(highlight.Width()) + 2); // + 2 for \r\n if we munged it
-        if (copyTextColor)
+        // apply CR/LF to the end of the final string, unless we're the last line.
+        if (includeCRLF && i < rows - 1 && shouldFormatRow)
         {
-            selectionFgAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-            selectionBkAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
+            rowText.append(L"\r\n");
         }
+    }
+
+    return text;
+}
+
+// Routine Description:
+// - Serializes the selected region into plain text and optionally CF_HTML and RTF in a single pass over the rows.
+// - The formatted output is generated from the attribute runs of each row. Consecutive runs with the same
+//   colors share a single HTML span or RTF color change, instead of going through the text cell by cell.
+// Arguments:
+// - includeCRLF - inject CRLF pairs to the end of each line of the plain text
+// - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
+// - textRects - the rectangular regions from which the data will be extracted from the buffer (i.e.: selection rects)
+// - formatting - the colors and font used for HTML and RTF and which of the two to generate
+// - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
+// Return Value:
+// - The plain text and, if requested, the HTML and RTF of the selected region.
+TextBuffer::ClipboardData TextBuffer::SerializeSelection(const bool includeCRLF,
+                                                         const bool trimTrailingWhitespace,
+                                                         const std::vector<til::inclusive_rect>& selectionRects,
+                                                         const ClipboardFormatting& formatting,
+                                                         const bool formatWrappedRows) const
+{
+    ClipboardData data;
+    const auto html = formatting.html && formatting.GetAttributeColors != nullptr;
+    const auto rtf = formatting.rtf && formatting.GetAttributeColors != nullptr;
+    const auto rows = selectionRects.size();
 
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+    // The HTML clipboard header consists of byte offsets into the document, which we only know at the end.
+    // We append it then and this is where the HTML document starts and the fragment starts inside it.
+    static constexpr std::string_view htmlHeader = "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
+    static constexpr std::string_view htmlFooter = "</BODY></HTML>";
+    // The RTF header contains the color table, which we only know at the end as well.
+    std::string rtfColorTable;
+    std::unordered_map<COLORREF, int> rtfColorIndices;
+
+    const auto appendRTFColor = [&](COLORREF color) {
+        const auto [it, inserted] = rtfColorIndices.emplace(color, gsl::narrow_cast<int>(rtfColorIndices.size() + 1));
+        if (inserted)
         {
-            const auto& cell = *it;
+            fmt::format_to(std::back_inserter(rtfColorTable), FMT_COMPILE("\\red{}\\green{}\\blue{};"), GetRValue(color), GetGValue(color), GetBValue(color));
+        }
+        return it->second;
+    };
 
-            if (cell.DbcsAttr() != DbcsAttribute::Trailing)
-            {
-                const auto chars = cell.Chars();
-                selectionText.append(chars);
+    if (html)
+    {
+        data.html.append(htmlHeader);
+        data.html.append("<!--StartFragment -->");
+        // note: MS Word doesn't support padding (in this way at least)
+        fmt::format_to(std::back_inserter(data.html),
+                       FMT_COMPILE("<DIV STYLE=\"display:inline-block;white-space:pre;background-color:#{:02X}{:02X}{:02X};font-family:'{}',monospace;font-size:{}pt;padding:4px;\">"),
+                       GetRValue(formatting.backgroundColor),
+                       GetGValue(formatting.backgroundColor),
+                       GetBValue(formatting.backgroundColor),
+                       til::u16u8(formatting.fontFaceName),
+                       formatting.fontHeightPoints);
+    }
 
-                if (copyTextColor)
-                {
-                    const auto cellData = cell.TextAttr();
-                    const auto [CellFgAttr, CellBkAttr] = GetAttributeColors(cellData);
-                    for (size_t j = 0; j < chars.size(); ++j)
-                    {
-                        selectionFgAttr.push_back(CellFgAttr);
-                        selectionBkAttr.push_back(CellBkAttr);
-                    }
-                }
-            }
+    if (rtf)
+    {
+        // Color 1 is the default background color and 0 the "auto" color.
+        appendRTFColor(formatting.backgroundColor);
+        // \fs specifies font size in half-points i.e. \fs20 results in a font size
+        // of 10 pts. That's why, font size is multiplied by 2 here.
+        fmt::format_to(std::back_inserter(data.rtf), FMT_COMPILE("\\viewkind4\\uc4\\pard\\slmult1\\f0\\fs{}\\highlight1 "), 2 * formatting.fontHeightPoints);
+    }
 
-            ++it;
-        }
+    std::optional<std::pair<COLORREF, COLORREF>> lastColors;
+
+    for (size_t i = 0; i < rows; i++)
+    {
+        const auto& rect = til::at(selectionRects, i);
+        const auto& row = GetRowByOffset(rect.top);
 
         // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
-        const auto shouldFormatRow = formatWrappedRows || !GetRowByOffset(iRow).WasWrapForced();
+        const auto shouldFormatRow = formatWrappedRows || !row.WasWrapForced();
+        const auto [columnBegin, columnEnd] = selectedColumns(row, rect.left, rect.right, trimTrailingWhitespace && shouldFormatRow);
 
-        if (trimTrailingWhitespace)
+        data.text.append(row.GetText(columnBegin, columnEnd));
+        if (includeCRLF && i < rows - 1 && shouldFormatRow)
         {
-            if (shouldFormatRow)
-            {
-                // remove the spaces at the end (aka trim the trailing whitespace)
-                while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
-                {
-                    selectionText.pop_back();
-                    if (copyTextColor)
-                    {
-                        selectionFgAttr.pop_back();
-                        selectionBkAttr.pop_back();
-                    }
-                }
-            }
+            data.text.append(L"\r\n");
         }
 
-        // apply CR/LF to the end of the final string, unless we're the last line.
-        // a.k.a if we're earlier than the bottom, then apply CR/LF.
-        if (includeCRLF && i < selectionRects.size() - 1)
+        if (!html && !rtf)
         {
-            if (shouldFormatRow)
-            {
-                // then we can assume a CR/LF is proper
-                selectionText.push_back(UNICODE_CARRIAGERETURN);
-                selectionText.push_back(UNICODE_LINEFEED);
+            continue;
+        }
 
-                if (copyTextColor)
-                {
-                    // can't see CR/LF so just use black FG & BK
-                    const auto Blackness = RGB(0x00, 0x00, 0x00);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                }
+        if (i != 0)
+        {
+            if (html)
+            {
+                data.html.append("<BR>");
+            }
+            if (rtf)
+            {
+                data.rtf.append("\\line ");
             }
         }
 
-        data.text.emplace_back(std::move(selectionText));
-        if (copyTextColor)
+        til::CoordType runEnd = 0;
+        for (const auto& run : row.Attributes().runs())
         {
-            data.FgAttr.emplace_back(std::move(selectionFgAttr));
-            data.BkAttr.emplace_back(std::move(selectionBkAttr));
-        }
+            const auto runBegin = runEnd;
+            runEnd += run.length;
+            if (runEnd <= columnBegin)
+            {
+                continue;
+            }
+            if (runBegin >= columnEnd)
+            {
+                break;
+            }
+
+            // A wide glyph belongs to the run that contains its leading half.
+            const auto begin = skipTrailer(row, std::max(runBegin, columnBegin));
+            const auto end = skipTrailer(row, std::min(runEnd, columnEnd));
+            const auto text = row.GetText(begin, end);
+            if (text.empty())
+            {
+                continue;
+            }
+
+            const auto colors = formatting.GetAttributeColors(run.value);
+            const auto colorsChanged = colors != lastColors;
+
+            if (html)
+            {
+                if (colorsChanged)
+                {
+                    if (lastColors)
+                    {
+                        data.html.append("</SPAN>");
+                    }
+                    fmt::format_to(std::back_inserter(data.html),
+                                   FMT_COMPILE("<SPAN STYLE=\"color:#{:02X}{:02X}{:02X};background-color:#{:02X}{:02X}{:02X};\">"),
+                                   GetRValue(colors.first),
+                                   GetGValue(colors.first),
+                                   GetBValue(colors.first),
+                                   GetRValue(colors.second),
+                                   GetGValue(colors.second),
+                                   GetBValue(colors.second));
+                }
+                _AppendHTMLText(data.html, text);
+            }
+
+            if (rtf)
+            {
+                if (colorsChanged)
+                {
+                    const auto bkColorIndex = appendRTFColor(colors.second);
+                    const auto fgColorIndex = appendRTFColor(colors.first);
+                    fmt::format_to(std::back_inserter(data.rtf), FMT_COMPILE("\\highlight{}\\cf{} "), bkColorIndex, fgColorIndex);
+                }
+                _AppendRTFText(data.rtf, text);
+            }
+
+            lastColors = colors;
+        }
+    }
+
+    if (html)
+    {
+        if (lastColors)
+        {
+            // last opened span wasn't closed in loop above, so close it now
+            data.html.append("</SPAN>");
+        }
+        data.html.append("</DIV><!--EndFragment -->");
+        data.html.append(htmlFooter);
+
+        // header required by HTML 0.9 format
+        // once filled with values, there will be exactly 157 bytes in the clipboard header
+        static constexpr size_t clipboardHeaderSize = 157;
+        const auto htmlStartPos = clipboardHeaderSize;
+        const auto htmlEndPos = clipboardHeaderSize + data.html.size();
+        const auto fragStartPos = clipboardHeaderSize + htmlHeader.size();
+        const auto fragEndPos = htmlEndPos - htmlFooter.size();
+        const auto clipHeader = fmt::format(FMT_COMPILE("Version:0.9\r\nStartHTML:{:010}\r\nEndHTML:{:010}\r\nStartFragment:{:010}\r\nEndFragment:{:010}\r\nStartSelection:{:010}\r\nEndSelection:{:010}\r\n"),
+                                            htmlStartPos,
+                                            htmlEndPos,
+                                            fragStartPos,
+                                            fragEndPos,
+                                            fragStartPos,
+                                            fragEndPos);
+        assert(clipHeader.size() == clipboardHeaderSize);
+        data.html.insert(0, clipHeader);
+    }
+
+    if (rtf)
+    {
+        // Standard RTF header.
+        // This is similar to the header generated by WordPad.
+        // \ansi - specifies that the ANSI char set is used in the current doc
+        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
+        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
+        // \nouicompat - ?
+        const auto rtfHeader = fmt::format(FMT_COMPILE("{{\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat{{\\fonttbl{{\\f0\\fmodern\\fcharset0 {};}}}}{{\\colortbl ;{}}}"),
+                                           til::u16u8(formatting.fontFaceName),
+                                           rtfColorTable);
+        data.rtf.insert(0, rtfHeader);
+        data.rtf.push_back('}');
     }
 
     return data;
@@ -1979,368 +2482,117 @@ std::wstring TextBuffer::GetPlainText(const til::point& start, const til::point&
 }
 
 // Routine Description:
-// - Generates a CF_HTML compliant structure based on the passed in text and color data
+// - Retrieves the text between start and end (inclusive, in buffer coordinates), the same as concatenating
+//   GetText(true, false, GetTextRects(start, end, blockSelection, true)) would, but truncated to maxLength.
+// - The text is read straight out of each row and reading stops as soon as maxLength characters have been
+//   produced. This makes requests for the first few characters of a large range cheap.
 // Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
+// - start - a corner of the text region of interest (inclusive)
+// - end - the other corner of the text region of interest (inclusive)
+// - blockSelection - when enabled, only get the rectangular text region
+// - maxLength - the maximum length of the returned text
 // Return Value:
-// - string containing the generated HTML
-std::string TextBuffer::GenHTML(const TextAndColor& rows,
-                                const int fontHeightPoints,
-                                const std::wstring_view fontFaceName,
-                                const COLORREF backgroundColor)
+// - The text of the range, with rows that weren't wrapped separated by CRLF.
+std::wstring TextBuffer::GetTextRange(const til::point start, const til::point end, const bool blockSelection, const size_t maxLength) const
 {
-    try
-    {
-        std::ostringstream htmlBuilder;
-
-        // First we have to add some standard
-        // HTML boiler plate required for CF_HTML
-        // as part of the HTML Clipboard format
-        const std::string htmlHeader =
-            "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
-
-        htmlBuilder << "<!--StartFragment -->";
-
-        // apply global style in div element
-        {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
+    std::wstring text;
 
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
+    const auto bufferSize = GetSize();
+    const auto [higherCoord, lowerCoord] = bufferSize.CompareInBounds(start, end) <= 0 ?
+                                               std::make_tuple(start, end) :
+                                               std::make_tuple(end, start);
 
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
-            // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
+    // Rows are at most as long as the buffer is wide, unless they contain complex text.
+    const auto rows = gsl::narrow_cast<size_t>(lowerCoord.y - higherCoord.y) + 1;
+    const auto rowLength = gsl::narrow_cast<size_t>(bufferSize.Width()) + 2;
+    text.reserve(std::min(maxLength, rows * rowLength));
 
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
+    const auto append = [&](const std::wstring_view& str) {
+        text.append(str.substr(0, maxLength - text.size()));
+    };
 
-            // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
+    for (auto y = higherCoord.y; y <= lowerCoord.y && text.size() < maxLength; ++y)
+    {
+        const auto& row = GetRowByOffset(y);
+        til::CoordType left;
+        til::CoordType right;
 
-            htmlBuilder << "\">";
+        if (blockSelection || higherCoord.y == lowerCoord.y)
+        {
+            left = std::min(higherCoord.x, lowerCoord.x);
+            right = std::max(higherCoord.x, lowerCoord.x);
         }
-
-        // copy text and info color from buffer
-        auto hasWrittenAnyText = false;
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); row++)
+        else
         {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                htmlBuilder << "<BR>";
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    if (hasWrittenAnyText)
-                    {
-                        htmlBuilder << "</SPAN>";
-                    }
-
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
-                }
-
-                hasWrittenAnyText = true;
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
+            left = y == higherCoord.y ? higherCoord.x : bufferSize.Left();
+            right = y == lowerCoord.y ? lowerCoord.x : bufferSize.RightInclusive();
         }
 
-        if (hasWrittenAnyText)
+        // The same as _ExpandTextRow(), but without going through a TextBufferCellIterator.
+        if (row.DbcsAttrAt(left) == DbcsAttribute::Trailing)
         {
-            // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
+            left += left == bufferSize.Left() ? 1 : -1;
+        }
+        if (row.DbcsAttrAt(right) == DbcsAttribute::Leading)
+        {
+            right += right == bufferSize.RightInclusive() ? -1 : 1;
         }
 
-        htmlBuilder << "</DIV>";
-
-        htmlBuilder << "<!--EndFragment -->";
-
-        constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
-
-        // once filled with values, there will be exactly 157 bytes in the clipboard header
-        constexpr size_t ClipboardHeaderSize = 157;
-
-        // these values are byte offsets from start of clipboard
-        const auto htmlStartPos = ClipboardHeaderSize;
-        const auto htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const auto fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
-        const auto fragEndPos = htmlEndPos - HtmlFooter.length();
+        const auto [columnBegin, columnEnd] = selectedColumns(row, left, right, false);
+        append(row.GetText(columnBegin, columnEnd));
 
-        // header required by HTML 0.9 format
-        std::ostringstream clipHeaderBuilder;
-        clipHeaderBuilder << "Version:0.9\r\n";
-        clipHeaderBuilder << std::setfill('0');
-        clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
-        clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
-        clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
-        clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
-
-        return clipHeaderBuilder.str() + htmlBuilder.str();
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
+        if (y < lowerCoord.y && !row.WasWrapForced())
+        {
+            append(L"\r\n");
+        }
     }
+
+    return text;
 }
 
-// Routine Description:
-// - Generates an RTF document based on the passed in text and color data
-//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
-// Arguments:
-// - rows - the text and color data we will format & encapsulate
-// - backgroundColor - default background color for characters, also used in padding
-// - fontHeightPoints - the unscaled font height
-// - fontFaceName - the name of the font used
-// - htmlTitle - value used in title tag of html header. Used to name the application
-// Return Value:
-// - string containing the generated RTF
-std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoints, const std::wstring_view fontFaceName, const COLORREF backgroundColor)
+// Appends the text to a CF_HTML fragment as UTF-8, escaping the characters that have a meaning in HTML.
+void TextBuffer::_AppendHTMLText(std::string& content, const std::wstring_view& text)
 {
-    try
+    for (size_t i = 0; i < text.size();)
     {
-        std::ostringstream rtfBuilder;
-
-        // start rtf
-        rtfBuilder << "{";
-
-        // Standard RTF header.
-        // This is similar to the header generated by WordPad.
-        // \ansi - specifies that the ANSI char set is used in the current doc
-        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
-        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
-        // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
-
-        // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
-
-        // map to keep track of colors:
-        // keys are colors represented by COLORREF
-        // values are indices of the corresponding colors in the color table
-        std::unordered_map<COLORREF, int> colorMap;
-        auto nextColorIndex = 1; // leave 0 for the default color and start from 1.
-
-        // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
-        colorMap[backgroundColor] = nextColorIndex++;
-
-        // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
-
-        // paragraph styles
-        // \fs specifies font size in half-points i.e. \fs20 results in a font size
-        // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
-
-        std::optional<COLORREF> fgColor = std::nullopt;
-        std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); ++row)
+        const auto codeUnit = til::at(text, i);
+        if (codeUnit < 0x80)
         {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                contentBuilder << "\\line "; // new line
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
+            switch (codeUnit)
             {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto text = std::wstring_view{ rows.text.at(row) }.substr(startOffset, col - startOffset + includeCurrent);
-                        _AppendRTFText(contentBuilder, text);
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    auto bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
-
-                    auto fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
-                    }
-
-                    contentBuilder << "\\highlight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
-                }
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
+            case L'<':
+                content.append("&lt;");
+                break;
+            case L'>':
+                content.append("&gt;");
+                break;
+            case L'&':
+                content.append("&amp;");
+                break;
+            default:
+                content.push_back(gsl::narrow_cast<char>(codeUnit));
             }
+            ++i;
+            continue;
         }
 
-        // end colortbl
-        colorTableBuilder << "}";
-
-        // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
-
-        // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
-
-        // end rtf
-        rtfBuilder << "}";
+        // Convert the entire run of non-ASCII characters at once.
+        // Each UTF-16 code unit results in at most 3 bytes of UTF-8.
+        auto end = i + 1;
+        for (; end < text.size() && til::at(text, end) >= 0x80; ++end)
+        {
+        }
 
-        return rtfBuilder.str();
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-        return {};
+        const auto offset = content.size();
+        content.resize(offset + (end - i) * 3);
+        size_t written = 0;
+        std::ignore = til::u16u8(text.substr(i, end - i), std::span{ content.data(), content.size() }.subspan(offset), written);
+        content.resize(offset + written);
+        i = end;
     }
 }
 
-void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text)
+void TextBuffer::_AppendRTFText(std::string& content, const std::wstring_view& text)
 {
     for (const auto codeUnit : text)
     {
@@ -2351,16 +2603,17 @@ void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::w
             case L'\\':
             case L'{':
             case L'}':
-                contentBuilder << "\\" << gsl::narrow<char>(codeUnit);
+                content.push_back('\\');
+                content.push_back(gsl::narrow<char>(codeUnit));
                 break;
             default:
-                contentBuilder << gsl::narrow<char>(codeUnit);
+                content.push_back(gsl::narrow<char>(codeUnit));
             }
         }
         else
         {
             // Windows uses unsigned wchar_t - RTF uses signed ones.
-            contentBuilder << "\\u" << std::to_string(til::bit_cast<int16_t>(codeUnit)) << "?";
+            fmt::format_to(std::back_inserter(content), FMT_COMPILE("\\u{}?"), til::bit_cast<int16_t>(codeUnit));
         }
     }
 }
@@ -2444,25 +2697,76 @@ try
             }
         }
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
+        // Copy the row in runs of as many columns as fit into the current row of the
+        // new buffer. This replicates what calling InsertCharacter() for every cell
+        // up to the "right" boundary would do, but without the per-cell overhead.
         til::CoordType iOldCol = 0;
         const auto copyRight = iRight;
-        for (; iOldCol < copyRight; iOldCol++)
+        while (iOldCol < copyRight)
         {
-            if (iOldCol == cOldCursorPos.x && iOldRow == cOldCursorPos.y)
+            const auto newPos = newCursor.GetPosition();
+            auto& newRow = newBuffer.GetRowByOffset(newPos.y);
+            const auto newWidth = newBuffer.GetLineWidth(newPos.y);
+
+            RowCopyTextFromState state{
+                .source = row,
+                .columnBegin = newPos.x,
+                .columnLimit = newWidth,
+                .sourceColumnBegin = iOldCol,
+                .sourceColumnLimit = copyRight,
+            };
+            newRow.CopyTextFrom(state);
+
+            const auto copied = state.sourceColumnEnd - iOldCol;
+            const auto newColEnd = newPos.x + copied;
+
+            if (copied > 0)
             {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
+                // Copy the attributes of the run and extend the last one to the end of the row,
+                // just like SetAttrToEnd() for each inserted character would have done.
+                newRow.ReplaceAttributes(newPos.x, row.Attributes().slice(gsl::narrow_cast<uint16_t>(iOldCol), gsl::narrow_cast<uint16_t>(state.sourceColumnEnd)));
+                if (newColEnd < newWidth)
+                {
+                    newRow.SetAttrToEnd(newColEnd, row.GetAttrByColumn(state.sourceColumnEnd - 1));
+                }
+
+                if (!fFoundCursorPos && iOldRow == cOldCursorPos.y && cOldCursorPos.x >= iOldCol && cOldCursorPos.x < state.sourceColumnEnd)
+                {
+                    cNewCursorPos = { newPos.x + cOldCursorPos.x - iOldCol, newPos.y };
+                    fFoundCursorPos = true;
+                }
+            }
+            else if (newPos.x == 0)
+            {
+                // The glyph is wider than the entire row. There's nothing we can do but to drop it.
+                iOldCol = row.NavigateToNext(iOldCol);
+                continue;
             }
 
-            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-            const auto glyph = row.GlyphAt(iOldCol);
-            const auto dbcsAttr = row.DbcsAttrAt(iOldCol);
-            const auto textAttr = row.GetAttrByColumn(iOldCol);
+            iOldCol = state.sourceColumnEnd;
+            newCursor.SetXPosition(newColEnd);
 
-            newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr);
+            if (iOldCol < copyRight)
+            {
+                // A wide glyph didn't fit into the remaining columns. _PrepareForDoubleByteSequence()
+                // pads the row in that case and the cursor is found where the padding starts.
+                if (!fFoundCursorPos && iOldCol == cOldCursorPos.x && iOldRow == cOldCursorPos.y)
+                {
+                    cNewCursorPos = newCursor.GetPosition();
+                    fFoundCursorPos = true;
+                }
+                if (newColEnd < newWidth)
+                {
+                    newRow.SetDoubleBytePadded(true);
+                }
+            }
+
+            // Just like IncrementCursor() we wrap onto the next line once we reach the end of the row.
+            if (iOldCol < copyRight || newColEnd >= newWidth)
+            {
+                newRow.SetWrapForced(true);
+                newBuffer.NewlineCursor();
+            }
         }
 
         // GH#32: Copy the attributes from the rest of the row into this new buffer.
@@ -2487,17 +2791,17 @@ try
         //     move on.
         const auto newRowY = newCursor.GetPosition().y;
         auto& newRow = newBuffer.GetRowByOffset(newRowY);
-        auto newAttrColumn = newCursor.GetPosition().x;
+        const auto newAttrColumn = newCursor.GetPosition().x;
         const auto newWidth = newBuffer.GetLineWidth(newRowY);
         // Stop when we get to the end of the buffer width, or the new position
         // for inserting an attr would be past the right of the new buffer.
-        for (auto copyAttrCol = iOldCol;
-             copyAttrCol < cOldColsTotal && newAttrColumn < newWidth;
-             copyAttrCol++, newAttrColumn++)
+        const auto copyAttrCount = std::min(cOldColsTotal - iOldCol, newWidth - newAttrColumn);
+        if (copyAttrCount > 0)
         {
-            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-            const auto textAttr = row.GetAttrByColumn(copyAttrCol);
-            newRow.SetAttrToEnd(newAttrColumn, textAttr);
+            const auto attrEnd = newAttrColumn + copyAttrCount;
+            const auto oldAttrEnd = iOldCol + copyAttrCount;
+            newRow.ReplaceAttributes(newAttrColumn, row.Attributes().slice(gsl::narrow_cast<uint16_t>(iOldCol), gsl::narrow_cast<uint16_t>(oldAttrEnd)));
+            newRow.SetAttrToEnd(attrEnd, row.GetAttrByColumn(oldAttrEnd - 1));
         }
 
         // If we found the old row that the caller was interested in, set the
@@ -2761,6 +3065,8 @@ std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
 // Method Description:
 // - Copies the hyperlink/customID maps of the old buffer into this one,
 //   also copies currentHyperlinkId
+// - The copied IDs that none of our rows reference (for instance because they were only referenced
+//   by rows that didn't survive a reflow) are queued up to be freed by the next _PruneHyperlinks().
 // Arguments:
 // - The other buffer
 void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
@@ -2768,6 +3074,11 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
     _hyperlinkMap = other._hyperlinkMap;
     _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
     _currentHyperlinkId = other._currentHyperlinkId;
+
+    for (const auto& [id, uri] : _hyperlinkMap)
+    {
+        _hyperlinkRefs->TrackUnreferenced(id);
+    }
 }
 
 // Method Description:
@@ -2779,8 +3090,12 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 // - An ID that the caller should associate with the given pattern
 const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexString)
 {
+    // Compiling a std::wregex is far more expensive than running it over a viewport worth of text.
+    // `optimize` makes the compilation even slower, but results in faster matching, which is what we want.
+    std::wregex regex{ regexString.begin(), regexString.end(), std::regex_constants::ECMAScript | std::regex_constants::optimize };
     ++_currentPatternId;
-    _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
+    _idsAndPatterns.emplace_back(_currentPatternId, std::move(regex));
+    _patternCache.clear();
     return _currentPatternId;
 }
 
@@ -2789,6 +3104,7 @@ const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexStrin
 void TextBuffer::ClearPatternRecognizers() noexcept
 {
     _idsAndPatterns.clear();
+    _patternCache.clear();
     _currentPatternId = 0;
 }
 
@@ -2800,6 +3116,97 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
     _idsAndPatterns = OtherBuffer._idsAndPatterns;
     _currentPatternId = OtherBuffer._currentPatternId;
+    _patternCache.clear();
+}
+
+TextBuffer::LogicalLineReader::LogicalLineReader(const TextBuffer& buffer, const til::CoordType rowBeg, const til::CoordType rowEnd) noexcept :
+    _buffer{ buffer },
+    _lineEnd{ rowBeg },
+    _rowEnd{ rowEnd }
+{
+}
+
+// Advances to the next logical line. Returns false once all rows have been visited.
+bool TextBuffer::LogicalLineReader::Next()
+{
+    if (_lineEnd >= _rowEnd)
+    {
+        return false;
+    }
+
+    _lineBeg = _lineEnd;
+    while (_buffer.GetRowByOffset(_lineEnd++).WasWrapForced() && _lineEnd < _rowEnd)
+    {
+    }
+    _textRead = false;
+    return true;
+}
+
+// Returns the first row of the current line.
+til::CoordType TextBuffer::LogicalLineReader::RowBegin() const noexcept
+{
+    return _lineBeg;
+}
+
+// Returns the row past the last row of the current line.
+til::CoordType TextBuffer::LogicalLineReader::RowEnd() const noexcept
+{
+    return _lineEnd;
+}
+
+// Returns the text of all rows of the current line concatenated.
+const std::wstring& TextBuffer::LogicalLineReader::Text()
+{
+    if (!_textRead)
+    {
+        _text.clear();
+        _rowOffsets.clear();
+        for (auto y = _lineBeg; y < _lineEnd; ++y)
+        {
+            _rowOffsets.emplace_back(_text.size());
+            _text.append(_buffer.GetRowByOffset(y).GetText());
+        }
+        _textRead = true;
+    }
+    return _text;
+}
+
+// Translates the characters [begin, end) of Text() into the first and last column they occupy (inclusive).
+// Text() must have been called for the current line.
+til::point_span TextBuffer::LogicalLineReader::Resolve(const size_t begin, const size_t end) const
+{
+    const auto [begY, begOffset] = _resolveOffset(begin);
+    const auto [endY, endOffset] = _resolveOffset(end - 1);
+    const auto begX = _buffer.GetRowByOffset(begY).GetLeadingColumnAtCharOffset(begOffset);
+    const auto endX = _buffer.GetRowByOffset(endY).GetTrailingColumnAtCharOffset(endOffset);
+    return { { begX, begY }, { endX, endY } };
+}
+
+// Translates an offset into Text() into a row index and the row's char offset.
+std::pair<til::CoordType, ptrdiff_t> TextBuffer::LogicalLineReader::_resolveOffset(const size_t offset) const noexcept
+{
+    const auto it = std::upper_bound(_rowOffsets.begin(), _rowOffsets.end(), offset) - 1;
+    const auto row = _lineBeg + gsl::narrow_cast<til::CoordType>(it - _rowOffsets.begin());
+    return { row, gsl::narrow_cast<ptrdiff_t>(offset - *it) };
+}
+
+// Runs all pattern recognizers over the given text and appends their matches to `matches`.
+void TextBuffer::_scanPatterns(const std::wstring& text, std::vector<PatternMatch>& matches) const
+{
+    for (const auto& [id, regex] : _idsAndPatterns)
+    {
+        const auto end = std::wsregex_iterator{};
+        for (auto it = std::wsregex_iterator{ text.begin(), text.end(), regex }; it != end; ++it)
+        {
+            const auto position = gsl::narrow_cast<size_t>(it->position());
+            const auto length = gsl::narrow_cast<size_t>(it->length());
+            // Empty matches can't be represented as an interval and can't be clicked anyways.
+            if (length)
+            {
+                matches.emplace_back(PatternMatch{ id, position, position + length });
+            }
+        }
+    }
 }
 
 // Method Description:
@@ -2813,59 +3220,232 @@ PointTree TextBuffer::GetPatterns(const til::CoordType firstRow, const til::Coor
 {
     PointTree::interval_vector intervals;
 
-    std::wstring concatAll;
-    const auto rowSize = GetRowByOffset(0).size();
-    concatAll.reserve(gsl::narrow_cast<size_t>(rowSize) * gsl::narrow_cast<size_t>(lastRow - firstRow + 1));
-
-    // to deal with text that spans multiple lines, we will first concatenate
-    // all the text into one string and find the patterns in that string
-    for (til::CoordType i = firstRow; i <= lastRow; ++i)
+    if (_idsAndPatterns.empty())
     {
-        auto& row = GetRowByOffset(i);
-        concatAll += row.GetText();
+        return {};
     }
 
-    // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    const auto rowSize = GetRowByOffset(0).size();
+    const auto generation = GetGeneration();
+    std::vector<PatternMatch> matches;
+
+    // To deal with text that spans multiple lines, we concatenate all rows that are joined
+    // by a forced wrap into one string and find the patterns in that string.
+    LogicalLineReader line{ *this, firstRow, lastRow + 1 };
+    while (line.Next())
     {
-        std::wregex regexObj{ idAndPattern.second };
+        const auto lineBeg = line.RowBegin();
+        const auto lineEnd = line.RowEnd();
+        const auto key = _scrolledTotal + gsl::narrow_cast<uint64_t>(lineBeg);
+        const auto cached = _patternCache.find(key);
+        auto valid = cached != _patternCache.end() && cached->second.rows == lineEnd - lineBeg;
 
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
+        for (auto y = lineBeg; valid && y < lineEnd; ++y)
+        {
+            valid = GetRowByOffset(y).GetGeneration() <= cached->second.generation;
+        }
 
-        til::CoordType lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+        auto entry = valid ? &cached->second : nullptr;
+        if (!entry)
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            til::CoordType prefixSize = 0;
-            for (const auto str = i->prefix().str(); const auto& glyph : til::utf16_iterator{ str })
-            {
-                prefixSize += IsGlyphFullWidth(glyph) ? 2 : 1;
-            }
-            const auto start = lenUpToThis + prefixSize;
-            til::CoordType matchSize = 0;
-            for (const auto str = i->str(); const auto& glyph : til::utf16_iterator{ str })
+            entry = &_patternCache[key];
+
+            matches.clear();
+            _scanPatterns(line.Text(), matches);
+
+            entry->generation = generation;
+            entry->rows = lineEnd - lineBeg;
+            entry->matches.clear();
+            for (const auto& match : matches)
             {
-                matchSize += IsGlyphFullWidth(glyph) ? 2 : 1;
+                const auto span = line.Resolve(match.begin, match.end);
+                entry->matches.emplace_back(PatternSpan{
+                    match.id,
+                    { span.start.x, span.start.y - lineBeg },
+                    { span.end.x + 1, span.end.y - lineBeg },
+                });
             }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
-
-            const til::point startCoord{ start % rowSize, start / rowSize };
-            const til::point endCoord{ end % rowSize, end / rowSize };
+        }
 
-            // store the intervals
+        for (const auto& match : entry->matches)
+        {
             // NOTE: these intervals are relative to the VIEWPORT not the buffer
             // Keeping these relative to the viewport for now because its the renderer
             // that actually uses these locations and the renderer works relative to
             // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+            // The end coordinate is exclusive and wraps around to the next row at the end of a row.
+            const auto start = (lineBeg - firstRow + match.begin.y) * rowSize + match.begin.x;
+            const auto end = (lineBeg - firstRow + match.end.y) * rowSize + match.end.x;
+            const til::point startCoord{ start % rowSize, start / rowSize };
+            const til::point endCoord{ end % rowSize, end / rowSize };
+            intervals.push_back(PointTree::interval(startCoord, endCoord, match.id));
         }
     }
+
+    // Keep the cache from growing indefinitely while the user scrolls through the history, by dropping the lines
+    // furthest away from the ones we just looked at. Twice the number of lines we looked at is enough to keep the
+    // cache hot when scrolling back and forth. The lower bound prevents single-row lookups (like when hovering
+    // a link) from evicting the viewport's entries.
+    const auto cacheLimit = std::max<uint64_t>(256, 2 * gsl::narrow_cast<uint64_t>(std::max(0, lastRow - firstRow + 1)));
+    if (_patternCache.size() > 2 * cacheLimit)
+    {
+        const auto keepBeg = _scrolledTotal + gsl::narrow_cast<uint64_t>(firstRow);
+        const auto keepEnd = _scrolledTotal + gsl::narrow_cast<uint64_t>(lastRow);
+        std::erase_if(_patternCache, [&](const auto& pair) {
+            return pair.first + cacheLimit / 2 < keepBeg || pair.first > keepEnd + cacheLimit / 2;
+        });
+    }
+
     PointTree result(std::move(intervals));
     return result;
 }
+
+// Finds the next occurrence of `needle` in `hay` starting at `pos`, or returns npos if there is none.
+// `needle` must already be case folded (towlower) if `caseInsensitive` is true. This is a
+// Boyer-Moore-Horspool search with a SIMD prefilter: 8 windows are tested at once by comparing their
+// first and last character with the needle's, and only windows that pass both checks are verified.
+// `skip` is the Horspool bad character table, indexed by the low byte of the folded character.
+static size_t findNeedle(const std::wstring_view& hay, size_t pos, const std::wstring_view& needle, const bool caseInsensitive, const std::array<uint16_t, 256>& skip) noexcept
+{
+    const auto fold = [=](wchar_t wch) noexcept {
+        return caseInsensitive ? static_cast<wchar_t>(::towlower(wch)) : wch;
+    };
+    const auto verify = [&](size_t off) noexcept {
+        for (size_t i = 0; i < needle.size(); ++i)
+        {
+            if (fold(til::at(hay, off + i)) != til::at(needle, i))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const auto lastIdx = needle.size() - 1;
+    const auto lastChar = til::at(needle, lastIdx);
+
+#if defined(TIL_SSE_INTRINSICS)
+    // towlower() maps ASCII to ASCII, so as long as the haystack is ASCII, a folded needle character
+    // can only match its upper- and lowercase ASCII variants. Non-ASCII blocks take the scalar path.
+    const auto asciiUpper = [&](wchar_t wch) noexcept {
+        return caseInsensitive && wch >= L'a' && wch <= L'z' ? static_cast<wchar_t>(wch - 0x20) : wch;
+    };
+    const auto first1 = _mm_set1_epi16(static_cast<short>(til::at(needle, 0)));
+    const auto first2 = _mm_set1_epi16(static_cast<short>(asciiUpper(til::at(needle, 0))));
+    const auto last1 = _mm_set1_epi16(static_cast<short>(lastChar));
+    const auto last2 = _mm_set1_epi16(static_cast<short>(asciiUpper(lastChar)));
+    const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xff80));
+#endif
+
+    while (pos + lastIdx < hay.size())
+    {
+#if defined(TIL_SSE_INTRINSICS)
+        if (pos + lastIdx + 8 <= hay.size())
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay.data() + pos));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay.data() + pos + lastIdx));
+
+            const auto ascii = _mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), nonAscii), _mm_setzero_si128());
+            if (!caseInsensitive || _mm_movemask_epi8(ascii) == 0xffff)
+            {
+                const auto matchFirst = _mm_or_si128(_mm_cmpeq_epi16(a, first1), _mm_cmpeq_epi16(a, first2));
+                const auto matchLast = _mm_or_si128(_mm_cmpeq_epi16(b, last1), _mm_cmpeq_epi16(b, last2));
+                auto mask = gsl::narrow_cast<unsigned long>(_mm_movemask_epi8(_mm_and_si128(matchFirst, matchLast)));
+
+                while (mask)
+                {
+                    unsigned long bit;
+                    _BitScanForward(&bit, mask);
+                    const auto off = pos + bit / 2;
+                    if (verify(off))
+                    {
+                        return off;
+                    }
+                    // Each wchar_t produces 2 bits in the mask.
+                    mask &= ~(3ul << bit);
+                }
+
+                pos += 8;
+                continue;
+            }
+        }
+#endif
+
+        const auto wch = fold(til::at(hay, pos + lastIdx));
+        if (wch == lastChar && verify(pos))
+        {
+            return pos;
+        }
+        pos += til::at(skip, wch & 0xff);
+    }
+
+    return std::wstring_view::npos;
+}
+
+// Routine Description:
+// - Finds all occurrences of the given string in the entire text buffer.
+// Arguments:
+// - needle - The string to search for
+// - caseInsensitive - Whether to ignore the case of the text
+// Return Value:
+// - All matches sorted by position, with inclusive start and end coordinates
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive) const
+{
+    return SearchText(needle, caseInsensitive, 0, GetSize().Height());
+}
+
+// Routine Description:
+// - Finds all occurrences of the given string in the rows [rowBeg, rowEnd).
+// - Rows that were wrapped are joined with the next one, so matches may span multiple rows.
+//   Matches are found at every position, which means that they may overlap.
+// Arguments:
+// - needle - The string to search for
+// - caseInsensitive - Whether to ignore the case of the text
+// - rowBeg - The first row to search
+// - rowEnd - The row after the last one to search
+// Return Value:
+// - All matches sorted by position, with inclusive start and end coordinates
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    std::vector<til::point_span> results;
+
+    rowBeg = std::max(0, rowBeg);
+    rowEnd = std::min(GetSize().Height(), rowEnd);
+    if (needle.empty() || rowBeg >= rowEnd)
+    {
+        return results;
+    }
+
+    // Case folding is done once for the needle and on the fly for the haystack.
+    std::wstring foldedNeedle{ needle };
+    if (caseInsensitive)
+    {
+        for (auto& wch : foldedNeedle)
+        {
+            wch = static_cast<wchar_t>(::towlower(wch));
+        }
+    }
+
+    // Needles longer than 65535 characters simply get a smaller maximum skip distance.
+    const auto maxSkip = gsl::narrow_cast<uint16_t>(std::min<size_t>(foldedNeedle.size(), UINT16_MAX));
+    std::array<uint16_t, 256> skip;
+    skip.fill(maxSkip);
+    for (size_t i = 0, last = foldedNeedle.size() - 1; i < last; ++i)
+    {
+        const auto distance = gsl::narrow_cast<uint16_t>(std::min<size_t>(last - i, UINT16_MAX));
+        auto& entry = til::at(skip, foldedNeedle[i] & 0xff);
+        entry = std::min(entry, distance);
+    }
+
+    LogicalLineReader line{ *this, rowBeg, rowEnd };
+    while (line.Next())
+    {
+        const auto& text = line.Text();
+        for (auto pos = findNeedle(text, 0, foldedNeedle, caseInsensitive, skip); pos != std::wstring_view::npos; pos = findNeedle(text, pos + 1, foldedNeedle, caseInsensitive, skip))
+        {
+            results.emplace_back(line.Resolve(pos, pos + foldedNeedle.size()));
+        }
+    }
+
+    return results;
+}
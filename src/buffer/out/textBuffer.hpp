@@ -89,6 +89,19 @@ public:
     const ROW& GetRowByOffset(til::CoordType index) const;
     ROW& GetRowByOffset(til::CoordType index);
 
+    // The changes to the buffer as a whole since a given generation. See GetChangesSince().
+    struct Changes
+    {
+        // The number of rows the contents moved up by, due to IncrementCircularBuffer().
+        til::CoordType scrolled = 0;
+        // The buffer was reset, resized or too much happened to tell. All rows must be considered changed.
+        bool all = false;
+    };
+
+    uint64_t GetGeneration() const noexcept;
+    Changes GetChangesSince(uint64_t generation) const noexcept;
+    bool HasChangedSince(uint64_t generation, til::CoordType firstRow, til::CoordType lastRow) const;
+
     TextBufferCellIterator GetCellDataAt(const til::point at) const;
     TextBufferCellIterator GetCellLineDataAt(const til::point at) const;
     TextBufferCellIterator GetCellDataAt(const til::point at, const Microsoft::Console::Types::Viewport limit) const;
@@ -97,7 +110,7 @@ public:
     TextBufferTextIterator GetTextDataAt(const til::point at, const Microsoft::Console::Types::Viewport limit) const;
 
     // Text insertion functions
-    static void ConsumeGrapheme(std::wstring_view& chars) noexcept;
+    static void ConsumeGrapheme(std::wstring_view& chars, bool graphemeClusters) noexcept;
     void Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes);
 
@@ -112,6 +125,9 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<til::CoordType> limitRight = std::nullopt);
 
+    void WriteCharInfos(const til::rect& target, const std::span<const CHAR_INFO>& source, size_t stride);
+    void ReadCharInfos(const til::rect& source, const std::span<CHAR_INFO>& target, size_t stride) const;
+
     void InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     void InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     void IncrementCursor();
@@ -133,6 +149,22 @@ public:
 
     til::CoordType TotalRowCount() const noexcept;
 
+    // Encoding cold rows into a compact form is opt-in (see SetHotRowCount and _coldChunks).
+    // Once enabled, this is a reasonable number of rows above the cursor to keep as ROWs.
+    static constexpr til::CoordType RecommendedHotRowCount = 4096;
+
+    struct MemoryUsage
+    {
+        // The size of the committed memory of the ROW arena.
+        size_t committed = 0;
+        // The size of the encoded cold rows.
+        size_t cold = 0;
+        til::CoordType coldRows = 0;
+    };
+
+    void SetHotRowCount(til::CoordType rows) noexcept;
+    MemoryUsage GetMemoryUsage() const noexcept;
+
     const TextAttribute& GetCurrentAttributes() const noexcept;
 
     void SetCurrentAttributes(const TextAttribute& currentAttributes) noexcept;
@@ -184,33 +216,43 @@ public:
     std::wstring GetCustomIdFromId(uint16_t id) const;
     void CopyHyperlinkMaps(const TextBuffer& OtherBuffer);
 
-    class TextAndColor
+    // The options for SerializeSelection(). HTML and RTF are only generated if requested and GetAttributeColors is set.
+    struct ClipboardFormatting
     {
-    public:
-        std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        // Maps the attributes of the text to its foreground and background color.
+        std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors;
+        // The unscaled font height and the name of the font.
+        int fontHeightPoints = 0;
+        std::wstring_view fontFaceName;
+        // The default background color, which is also used for the padding.
+        COLORREF backgroundColor = 0;
+        bool html = false;
+        bool rtf = false;
     };
 
-    size_t SpanLength(const til::point coordStart, const til::point coordEnd) const;
+    // The result of SerializeSelection(). The html and rtf strings are UTF-8 encoded and empty unless requested.
+    struct ClipboardData
+    {
+        std::wstring text;
+        std::string html;
+        std::string rtf;
+    };
 
-    const TextAndColor GetText(const bool includeCRLF,
-                               const bool trimTrailingWhitespace,
-                               const std::vector<til::inclusive_rect>& textRects,
-                               std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)> GetAttributeColors = nullptr,
-                               const bool formatWrappedRows = false) const;
+    size_t SpanLength(const til::point coordStart, const til::point coordEnd) const;
 
-    std::wstring GetPlainText(const til::point& start, const til::point& end) const;
+    std::vector<std::wstring> GetText(const bool includeCRLF,
+                                      const bool trimTrailingWhitespace,
+                                      const std::vector<til::inclusive_rect>& textRects,
+                                      const bool formatWrappedRows = false) const;
 
-    static std::string GenHTML(const TextAndColor& rows,
-                               const int fontHeightPoints,
-                               const std::wstring_view fontFaceName,
-                               const COLORREF backgroundColor);
+    ClipboardData SerializeSelection(const bool includeCRLF,
+                                     const bool trimTrailingWhitespace,
+                                     const std::vector<til::inclusive_rect>& textRects,
+                                     const ClipboardFormatting& formatting,
+                                     const bool formatWrappedRows = false) const;
 
-    static std::string GenRTF(const TextAndColor& rows,
-                              const int fontHeightPoints,
-                              const std::wstring_view fontFaceName,
-                              const COLORREF backgroundColor);
+    std::wstring GetPlainText(const til::point& start, const til::point& end) const;
+    std::wstring GetTextRange(const til::point start, const til::point end, const bool blockSelection, const size_t maxLength) const;
 
     struct PositionInformation
     {
@@ -228,6 +270,9 @@ public:
     void CopyPatterns(const TextBuffer& OtherBuffer);
     interval_tree::IntervalTree<til::point, size_t> GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const;
 
+    std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive) const;
+    std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const;
+
 private:
     void _reserve(til::size screenBufferSize, const TextAttribute& defaultAttributes);
     void _commit(const std::byte* row);
@@ -235,6 +280,13 @@ private:
     void _construct(const std::byte* until) noexcept;
     void _destroy() const noexcept;
     ROW& _getRowByOffsetDirect(size_t offset);
+    bool _isRowCold(size_t offset) const noexcept;
+    std::pair<std::byte*, std::byte*> _coldChunkRows(size_t chunk) const noexcept;
+    std::pair<std::byte*, std::byte*> _coldChunkPages(size_t chunk) const noexcept;
+    void _coolRows() noexcept;
+    void _encodeChunk(size_t chunk);
+    void _decodeChunk(size_t chunk);
+    void _resetColdChunks() noexcept;
     til::CoordType _estimateOffsetOfLastCommittedRow() const noexcept;
 
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
@@ -251,17 +303,106 @@ private:
     til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
     til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
     void _PruneHyperlinks();
+    void _recordChange(bool reset) noexcept;
 
-    static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
+    static void _AppendHTMLText(std::string& content, const std::wstring_view& text);
+    static void _AppendRTFText(std::string& content, const std::wstring_view& text);
 
     Microsoft::Console::Render::Renderer& _renderer;
 
     std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
     std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
     uint16_t _currentHyperlinkId = 1;
+    // Counts the rows referencing each hyperlink ID. The ROWs hold a pointer to it, which is why it's heap allocated:
+    // ResizeTraditional() steals the rows of another TextBuffer and this way the pointer stays valid.
+    std::unique_ptr<HyperlinkRefCounts> _hyperlinkRefs = std::make_unique<HyperlinkRefCounts>();
+    // The generation counter the ROWs stamp themselves with whenever they're modified.
+    // It's heap allocated for the same reason as _hyperlinkRefs.
+    std::unique_ptr<RowGenerations> _generations = std::make_unique<RowGenerations>();
+
+    // The journal records the changes that affect the buffer as a whole, as opposed to individual rows:
+    // Scrolling via IncrementCircularBuffer() and anything that replaces all rows at once.
+    // It's a ring buffer and if a consumer falls behind by more than its capacity, it gets told that everything changed.
+    struct JournalEntry
+    {
+        // The generation of the change. All rows modified afterwards have a larger generation.
+        uint64_t generation = 0;
+        // The value of _scrolledTotal before the change.
+        uint64_t scrolledBefore = 0;
+        bool reset = false;
+    };
+    static constexpr size_t _journalCapacity = 256;
+    std::array<JournalEntry, _journalCapacity> _journal{};
+    // The number of entries ever written to _journal.
+    uint64_t _journalCount = 0;
+    // The number of times IncrementCircularBuffer() was called.
+    uint64_t _scrolledTotal = 0;
+
+    // Iterates over the logical lines (runs of rows joined via WasWrapForced()) in the rows [rowBeg, rowEnd).
+    // The first line begins at rowBeg, even if it continues the row above, and the last one is cut off at rowEnd.
+    // The text of a line is only read once Text() is called, so that GetPatterns() can skip lines it has cached.
+    class LogicalLineReader
+    {
+    public:
+        LogicalLineReader(const TextBuffer& buffer, til::CoordType rowBeg, til::CoordType rowEnd) noexcept;
+
+        bool Next();
+        til::CoordType RowBegin() const noexcept;
+        til::CoordType RowEnd() const noexcept;
+        const std::wstring& Text();
+        til::point_span Resolve(size_t begin, size_t end) const;
+
+    private:
+        std::pair<til::CoordType, ptrdiff_t> _resolveOffset(size_t offset) const noexcept;
+
+        const TextBuffer& _buffer;
+        til::CoordType _lineBeg = 0;
+        til::CoordType _lineEnd = 0;
+        til::CoordType _rowEnd = 0;
+        bool _textRead = false;
+        std::wstring _text;
+        // The offset in _text at which each row of the line starts.
+        std::vector<size_t> _rowOffsets;
+    };
+
+    // A single match of a pattern recognizer inside a logical line (a run of rows joined via WasWrapForced()).
+    // begin/end are offsets into the concatenated text of the line's rows.
+    struct PatternMatch
+    {
+        size_t id;
+        size_t begin;
+        size_t end;
+    };
+
+    // A PatternMatch translated into columns. `y` is relative to the first row of the logical line.
+    // `end` is exclusive, which means that its `x` may be equal to the width of the buffer.
+    struct PatternSpan
+    {
+        size_t id;
+        til::point begin;
+        til::point end;
+    };
+
+    // The matches of the `rows` rows following the row the entry is keyed by.
+    struct PatternCacheEntry
+    {
+        // The buffer's generation when the rows were scanned. The matches are valid as long as none of the rows is newer.
+        uint64_t generation = 0;
+        til::CoordType rows = 0;
+        std::vector<PatternSpan> matches;
+    };
 
-    std::unordered_map<size_t, std::wstring> _idsAndPatterns;
+    void _scanPatterns(const std::wstring& text, std::vector<PatternMatch>& matches) const;
+
+    // The regexes are compiled once in AddPatternRecognizer(), instead of once per GetPatterns() call.
+    std::vector<std::pair<size_t, std::wregex>> _idsAndPatterns;
     size_t _currentPatternId = 0;
+    // GetPatterns() runs very frequently (after every chunk of output), but most of the time only a few lines
+    // changed or the viewport simply scrolled. This caches the matches per logical line, keyed by the absolute
+    // index of its first row (the row offset plus _scrolledTotal), which doesn't change when the buffer circles.
+    // Only lines that contain a row with a newer generation than their entry have to be read and scanned again.
+    // It's cleared whenever the recognizers change.
+    mutable std::unordered_map<uint64_t, PatternCacheEntry> _patternCache;
 
     // This block describes the state of the underlying virtual memory buffer that holds all ROWs, text and attributes.
     // Initially memory is only allocated with MEM_RESERVE to reduce the private working set of conhost.
@@ -320,6 +461,32 @@ private:
     // The height of the buffer in rows, excluding the scratchpad row.
     uint16_t _height = 0;
 
+    // Most of a large scrollback is never looked at again. Rows that are more than _hotRowCount rows above the
+    // cursor are "cold". Once all rows of a chunk of _coldChunkRowCount physically adjacent rows are cold,
+    // _coolRows() encodes them via ROW::Encode(), destroys the ROWs and MEM_DECOMMITs their memory.
+    // _getRowByOffsetDirect() decodes the entire chunk again as soon as any of its rows is accessed,
+    // for instance by a search, a selection or when scrolling up.
+    struct ColdChunk
+    {
+        // The encoded rows, or empty if the rows are decoded.
+        std::vector<uint8_t> data;
+        // The _scrolledTotal when the chunk was last decoded. It's only encoded again _coldChunkCooldown
+        // scrolls later, so that rows that are looked at repeatedly don't get encoded and decoded in a loop.
+        uint64_t decodedAt = 0;
+    };
+    static constexpr size_t _coldChunkRowCount = 64;
+    static constexpr uint64_t _coldChunkCooldown = 256;
+    // Indexed by the row offset (excluding the scratchpad row) divided by _coldChunkRowCount.
+    std::vector<ColdChunk> _coldChunks;
+    // The number of _coldChunks that hold encoded rows. Allows _getRowByOffsetDirect() to skip checking them.
+    size_t _coldChunkCount = 0;
+    // The next chunk _coolRows() will look at.
+    size_t _coolingCursor = 0;
+    til::CoordType _hotRowCount = til::CoordTypeMax;
+    til::CoordType _coldRows = 0;
+    size_t _coldBytes = 0;
+    size_t _decommittedBytes = 0;
+
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
 
@@ -840,6 +840,40 @@ class ReflowTests
             _compareTextBufferAgainstTestBuffer(*textBuffer, testBuffer);
         }
     }
+
+    TEST_METHOD(TestReflowAttributes)
+    {
+        const TextAttribute red{ FOREGROUND_RED };
+        const TextAttribute green{ FOREGROUND_GREEN };
+
+        auto textBuffer = std::make_unique<TextBuffer>(til::size{ 6, 3 }, TextAttribute{ 0x7 }, 0, false, renderer);
+        auto& row = textBuffer->GetRowByOffset(0);
+        RowWriteState state{ .text = L"ABCDEF" };
+        row.ReplaceText(state);
+        row.ReplaceAttributes(0, 3, red);
+        row.ReplaceAttributes(3, 6, green);
+        textBuffer->GetCursor().SetPosition({ 0, 1 });
+
+        Log::Comment(L"Attribute runs must be split at the same column as the text.");
+        const auto newBuffer = _textBufferByReflowingTextBuffer(*textBuffer, { 4, 4 });
+        const auto& row0 = newBuffer->GetRowByOffset(0);
+        const auto& row1 = newBuffer->GetRowByOffset(1);
+
+        VERIFY_IS_TRUE(row0.WasWrapForced());
+        VERIFY_ARE_EQUAL(L"ABCD", row0.GetText());
+        VERIFY_ARE_EQUAL(red, row0.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(red, row0.GetAttrByColumn(2));
+        VERIFY_ARE_EQUAL(green, row0.GetAttrByColumn(3));
+
+        VERIFY_IS_FALSE(row1.WasWrapForced());
+        VERIFY_ARE_EQUAL(L"EF  ", row1.GetText());
+        VERIFY_ARE_EQUAL(green, row1.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(green, row1.GetAttrByColumn(1));
+        Log::Comment(L"The last attribute of the row is extended to the end of the new row.");
+        VERIFY_ARE_EQUAL(green, row1.GetAttrByColumn(3));
+
+        VERIFY_ARE_EQUAL((til::point{ 0, 2 }), newBuffer->GetCursor().GetPosition());
+    }
 };
 
 DummyRenderer ReflowTests::renderer{};
@@ -106,8 +106,7 @@ try
             {
                 try
                 {
-                    const auto bufferData = termCore->RetrieveSelectedTextFromBuffer(false);
-                    LOG_IF_FAILED(terminal->_CopyTextToSystemClipboard(bufferData, true));
+                    LOG_IF_FAILED(terminal->_CopyTextToSystemClipboard(true));
                     TerminalClearSelection(terminal);
                 }
                 CATCH_LOG();
@@ -633,16 +632,10 @@ const wchar_t* _stdcall TerminalGetSelection(void* terminal)
         return nullptr;
     }
 
-    const auto bufferData = publicTerminal->_terminal->RetrieveSelectedTextFromBuffer(false);
+    const auto bufferData = publicTerminal->_terminal->SerializeSelection(false, {});
     publicTerminal->_ClearSelection();
 
-    // convert text: vector<string> --> string
-    std::wstring selectedText;
-    for (const auto& text : bufferData.text)
-    {
-        selectedText += text;
-    }
-
+    const auto& selectedText = bufferData.text;
     auto returnText = wil::make_cotaskmem_string_nothrow(selectedText.c_str());
     return returnText.release();
 }
@@ -877,21 +870,22 @@ void __stdcall TerminalKillFocus(void* terminal)
 }
 
 // Routine Description:
-// - Copies the text given onto the global system clipboard.
+// - Copies the selected text onto the global system clipboard.
 // Arguments:
-// - rows - Rows of text data to copy
 // - fAlsoCopyFormatting - true if the color and formatting should also be copied, false otherwise
-HRESULT HwndTerminal::_CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, const bool fAlsoCopyFormatting)
+HRESULT HwndTerminal::_CopyTextToSystemClipboard(const bool fAlsoCopyFormatting)
 try
 {
     RETURN_HR_IF_NULL(E_NOT_VALID_STATE, _terminal);
-    std::wstring finalString;
 
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
-    {
-        finalString += str;
-    }
+    TextBuffer::ClipboardFormatting formatting;
+    formatting.fontHeightPoints = _actualFont.GetUnscaledSize().height; // this renderer uses points already
+    formatting.fontFaceName = _actualFont.GetFaceName();
+    formatting.html = fAlsoCopyFormatting;
+    formatting.rtf = fAlsoCopyFormatting;
+
+    auto bufferData = _terminal->SerializeSelection(false, std::move(formatting));
+    const auto& finalString = bufferData.text;
 
     // allocate the final clipboard data
     const auto cchNeeded = finalString.size() + 1;
@@ -921,15 +915,8 @@ try
 
         if (fAlsoCopyFormatting)
         {
-            const auto& fontData = _actualFont;
-            const int iFontHeightPoints = fontData.GetUnscaledSize().height; // this renderer uses points already
-            const auto bgColor = _terminal->GetAttributeColors({}).second;
-
-            auto HTMLToPlaceOnClip = TextBuffer::GenHTML(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor);
-            _CopyToSystemClipboard(HTMLToPlaceOnClip, L"HTML Format");
-
-            auto RTFToPlaceOnClip = TextBuffer::GenRTF(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor);
-            _CopyToSystemClipboard(RTFToPlaceOnClip, L"Rich Text Format");
+            _CopyToSystemClipboard(std::move(bufferData.html), L"HTML Format");
+            _CopyToSystemClipboard(std::move(bufferData.rtf), L"Rich Text Format");
         }
     }
 
@@ -1166,43 +1166,24 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return false;
         }
 
-        // extract text from buffer
-        // RetrieveSelectedTextFromBuffer will lock while it's reading
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
-
-        // convert text: vector<string> --> string
-        std::wstring textData;
-        for (const auto& text : bufferData.text)
-        {
-            textData += text;
-        }
-
-        const auto bgColor = _terminal->GetAttributeColors({}).second;
-
-        // convert text to HTML format
         // GH#5347 - Don't provide a title for the generated HTML, as many
         // web applications will paste the title first, followed by the HTML
         // content, which is unexpected.
-        const auto htmlData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML) ?
-                                  TextBuffer::GenHTML(bufferData,
-                                                      _actualFont.GetUnscaledSize().height,
-                                                      _actualFont.GetFaceName(),
-                                                      bgColor) :
-                                  "";
-
-        // convert to RTF format
-        const auto rtfData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF) ?
-                                 TextBuffer::GenRTF(bufferData,
-                                                    _actualFont.GetUnscaledSize().height,
-                                                    _actualFont.GetFaceName(),
-                                                    bgColor) :
-                                 "";
+        TextBuffer::ClipboardFormatting formatting;
+        formatting.fontHeightPoints = _actualFont.GetUnscaledSize().height;
+        formatting.fontFaceName = _actualFont.GetFaceName();
+        formatting.html = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML);
+        formatting.rtf = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF);
+
+        // extract text, HTML and RTF from buffer
+        // SerializeSelection will lock while it's reading
+        const auto bufferData = _terminal->SerializeSelection(singleLine, std::move(formatting));
 
         // send data up for clipboard
         _CopyToClipboardHandlers(*this,
-                                 winrt::make<CopyToClipboardEventArgs>(winrt::hstring{ textData },
-                                                                       winrt::to_hstring(htmlData),
-                                                                       winrt::to_hstring(rtfData),
+                                 winrt::make<CopyToClipboardEventArgs>(winrt::hstring{ bufferData.text },
+                                                                       winrt::to_hstring(bufferData.html),
+                                                                       winrt::to_hstring(bufferData.rtf),
                                                                        formats));
         return true;
     }
@@ -1511,7 +1492,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     Windows::Foundation::Collections::IVector<winrt::hstring> ControlCore::SelectedText(bool trimTrailingWhitespace) const
     {
         // RetrieveSelectedTextFromBuffer will lock while it's reading
-        const auto internalResult{ _terminal->RetrieveSelectedTextFromBuffer(trimTrailingWhitespace).text };
+        const auto internalResult{ _terminal->RetrieveSelectedTextFromBuffer(trimTrailingWhitespace) };
 
         auto result = winrt::single_threaded_vector<winrt::hstring>();
 
@@ -1553,8 +1534,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                      Search::Sensitivity::CaseSensitive :
                                      Search::Sensitivity::CaseInsensitive;
 
-        ::Search search(*GetRenderData(), text.c_str(), direction, sensitivity);
         auto lock = _terminal->LockForWriting();
+        ::Search search(*GetRenderData(), text.c_str(), direction, sensitivity);
         const auto foundMatch{ search.FindNext() };
         if (foundMatch)
         {
@@ -2138,67 +2119,39 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     void ControlCore::ScrollToMark(const Control::ScrollToMarkDirection& direction)
     {
         const auto currentOffset = ScrollOffset();
-        const auto& marks{ _terminal->GetScrollMarks() };
 
         std::optional<DispatchTypes::ScrollMark> tgt;
 
+        // The marks are kept sorted, so each of these is a binary search.
         switch (direction)
         {
         case ScrollToMarkDirection::Last:
         {
-            int highest = currentOffset;
-            for (const auto& mark : marks)
+            tgt = _terminal->GetPreviousScrollMark(til::CoordTypeMax);
+            if (tgt.has_value() && tgt->start.y <= currentOffset)
             {
-                const auto newY = mark.start.y;
-                if (newY > highest)
-                {
-                    tgt = mark;
-                    highest = newY;
-                }
+                tgt.reset();
             }
             break;
         }
         case ScrollToMarkDirection::First:
         {
-            int lowest = currentOffset;
-            for (const auto& mark : marks)
+            tgt = _terminal->GetNextScrollMark(-1);
+            if (tgt.has_value() && tgt->start.y >= currentOffset)
             {
-                const auto newY = mark.start.y;
-                if (newY < lowest)
-                {
-                    tgt = mark;
-                    lowest = newY;
-                }
+                tgt.reset();
             }
             break;
         }
         case ScrollToMarkDirection::Next:
         {
-            int minDistance = INT_MAX;
-            for (const auto& mark : marks)
-            {
-                const auto delta = mark.start.y - currentOffset;
-                if (delta > 0 && delta < minDistance)
-                {
-                    tgt = mark;
-                    minDistance = delta;
-                }
-            }
+            tgt = _terminal->GetNextScrollMark(currentOffset);
             break;
         }
         case ScrollToMarkDirection::Previous:
         default:
         {
-            int minDistance = INT_MAX;
-            for (const auto& mark : marks)
-            {
-                const auto delta = currentOffset - mark.start.y;
-                if (delta > 0 && delta < minDistance)
-                {
-                    tgt = mark;
-                    minDistance = delta;
-                }
-            }
+            tgt = _terminal->GetPreviousScrollMark(currentOffset);
             break;
         }
         }
@@ -1208,8 +1208,25 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
 // - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
 void Terminal::UpdatePatternsUnderLock()
 {
+    const auto& buffer = _activeBuffer();
+    const auto firstRow = _VisibleStartIndex();
+    const auto lastRow = _VisibleEndIndex();
+
+    // This is called after every chunk of output and whenever the cursor blinks, even though most of the
+    // time the visible rows didn't change. Checking the row generations is a lot cheaper than GetPatterns().
+    if (&buffer == _patternsBuffer && firstRow == _patternsFirstRow && lastRow == _patternsLastRow &&
+        !buffer.HasChangedSince(_patternsGeneration, firstRow, lastRow))
+    {
+        return;
+    }
+
+    _patternsBuffer = &buffer;
+    _patternsGeneration = buffer.GetGeneration();
+    _patternsFirstRow = firstRow;
+    _patternsLastRow = lastRow;
+
     auto oldTree = _patternIntervalTree;
-    _patternIntervalTree = _activeBuffer().GetPatterns(_VisibleStartIndex(), _VisibleEndIndex());
+    _patternIntervalTree = buffer.GetPatterns(firstRow, lastRow);
     _InvalidatePatternTree(oldTree);
     _InvalidatePatternTree(_patternIntervalTree);
 }
@@ -1222,6 +1239,7 @@ void Terminal::ClearPatternTree()
 {
     auto oldTree = _patternIntervalTree;
     _patternIntervalTree = {};
+    _patternsBuffer = nullptr;
     _InvalidatePatternTree(oldTree);
 }
 
@@ -1335,6 +1353,7 @@ void Terminal::_updateUrlDetection()
         // Add regex pattern recognizers to the buffer
         // For now, we only add the URI regex pattern
         _hyperlinkPatternId = _activeBuffer().AddPatternRecognizer(linkPattern);
+        _patternsBuffer = nullptr;
         UpdatePatternsUnderLock();
     }
     else
@@ -1357,14 +1376,26 @@ void Terminal::AddMark(const Microsoft::Console::VirtualTerminal::DispatchTypes:
     DispatchTypes::ScrollMark m = mark;
     m.start = start;
     m.end = end;
-
-    if (fromUi)
+    _offsetScrollMark(m, _scrollMarksRowOffset);
+
+    // Keep the marks sorted by their start. Marks from VT are almost always
+    // added at the cursor, below all the others, so this is usually an append.
+    // Marks added above others (i.e. from the UI) cost O(n) to insert, which is
+    // fine for the occasional user action and keeps index-based access cheap.
+    // Marks on the same position are kept in the order they were added in.
+    const auto it = std::upper_bound(_scrollMarks.begin(), _scrollMarks.end(), m.start, [](const til::point& pos, const DispatchTypes::ScrollMark& other) {
+        return pos < other.start;
+    });
+    const auto index = gsl::narrow_cast<size_t>(it - _scrollMarks.begin());
+    _scrollMarks.insert(it, m);
+
+    if (!fromUi)
     {
-        _scrollMarks.insert(_scrollMarks.begin(), m);
+        _lastVtScrollMark = index;
     }
-    else
+    else if (_lastVtScrollMark && *_lastVtScrollMark >= index)
     {
-        _scrollMarks.push_back(m);
+        ++*_lastVtScrollMark;
     }
 
     // Tell the control that the scrollbar has somehow changed. Used as a
@@ -1389,15 +1420,36 @@ void Terminal::ClearMark()
         start = til::point{ GetSelectionAnchor() };
         end = til::point{ GetSelectionEnd() };
     }
+    start = _toAbsoluteScrollMarkPosition(start);
+    end = _toAbsoluteScrollMarkPosition(end);
+
     auto inSelection = [&start, &end](const DispatchTypes::ScrollMark& m) {
         return (m.start >= start && m.start <= end) ||
                (m.end >= start && m.end <= end);
     };
 
-    _scrollMarks.erase(std::remove_if(_scrollMarks.begin(),
-                                      _scrollMarks.end(),
-                                      inSelection),
-                       _scrollMarks.end());
+    // This is std::remove_if, except that it also keeps track of where the
+    // last VT mark ends up, or whether it got removed.
+    std::optional<size_t> lastVtScrollMark;
+    size_t kept = 0;
+    for (size_t i = 0; i < _scrollMarks.size(); ++i)
+    {
+        if (inSelection(til::at(_scrollMarks, i)))
+        {
+            continue;
+        }
+        if (_lastVtScrollMark == i)
+        {
+            lastVtScrollMark = kept;
+        }
+        if (kept != i)
+        {
+            til::at(_scrollMarks, kept) = std::move(til::at(_scrollMarks, i));
+        }
+        ++kept;
+    }
+    _scrollMarks.resize(kept);
+    _lastVtScrollMark = lastVtScrollMark;
 
     // Tell the control that the scrollbar has somehow changed. Used as a
     // workaround to force the control to redraw any scrollbar marks
@@ -1406,19 +1458,168 @@ void Terminal::ClearMark()
 void Terminal::ClearAllMarks() noexcept
 {
     _scrollMarks.clear();
+    _scrollMarksRowOffset = 0;
+    _lastVtScrollMark.reset();
     // Tell the control that the scrollbar has somehow changed. Used as a
     // workaround to force the control to redraw any scrollbar marks
     _NotifyScrollEvent();
 }
 
-const std::vector<DispatchTypes::ScrollMark>& Terminal::GetScrollMarks() const noexcept
+std::vector<DispatchTypes::ScrollMark> Terminal::GetScrollMarks() const
 {
+    return GetScrollMarksInRange(0, til::CoordTypeMax);
+}
+
+// Method Description:
+// - Returns all marks starting within the given rows (inclusive), sorted by
+//   their start and translated to buffer coordinates.
+std::vector<DispatchTypes::ScrollMark> Terminal::GetScrollMarksInRange(til::CoordType top, til::CoordType bottom) const
+{
+    std::vector<DispatchTypes::ScrollMark> marks;
+
     // TODO: GH#11000 - when the marks are stored per-buffer, get rid of this.
     // We want to return _no_ marks when we're in the alt buffer, to effectively
-    // hide them. We need to return a reference, so we can't just ctor an empty
-    // list here just for when we're in the alt buffer.
-    static const std::vector<DispatchTypes::ScrollMark> _altBufferMarks{};
-    return _inAltBuffer() ? _altBufferMarks : _scrollMarks;
+    // hide them.
+    if (_inAltBuffer() || top > bottom)
+    {
+        return marks;
+    }
+
+    // Clamp before translating, so that the absolute coordinates can't overflow.
+    const auto maxRow = til::CoordTypeMax - _scrollMarksRowOffset;
+    top = std::clamp(top, 0, maxRow) + _scrollMarksRowOffset;
+    bottom = std::clamp(bottom, 0, maxRow) + _scrollMarksRowOffset;
+
+    const auto beg = std::lower_bound(_scrollMarks.begin(), _scrollMarks.end(), top, [](const DispatchTypes::ScrollMark& m, til::CoordType value) {
+        return m.start.y < value;
+    });
+    const auto end = std::upper_bound(beg, _scrollMarks.end(), bottom, [](til::CoordType value, const DispatchTypes::ScrollMark& m) {
+        return value < m.start.y;
+    });
+
+    marks.reserve(gsl::narrow_cast<size_t>(std::distance(beg, end)));
+    for (auto it = beg; it != end; ++it)
+    {
+        auto& m = marks.emplace_back(*it);
+        _offsetScrollMark(m, -_scrollMarksRowOffset);
+    }
+    return marks;
+}
+
+// Method Description:
+// - Returns the closest mark that starts above the given row, if any.
+std::optional<DispatchTypes::ScrollMark> Terminal::GetPreviousScrollMark(til::CoordType row) const
+{
+    if (_inAltBuffer() || row <= 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto y = std::min(row, til::CoordTypeMax - _scrollMarksRowOffset) + _scrollMarksRowOffset;
+    const auto it = std::lower_bound(_scrollMarks.begin(), _scrollMarks.end(), y, [](const DispatchTypes::ScrollMark& m, til::CoordType value) {
+        return m.start.y < value;
+    });
+    if (it == _scrollMarks.begin())
+    {
+        return std::nullopt;
+    }
+
+    auto m = *std::prev(it);
+    _offsetScrollMark(m, -_scrollMarksRowOffset);
+    return m;
+}
+
+// Method Description:
+// - Returns the closest mark that starts below the given row, if any.
+std::optional<DispatchTypes::ScrollMark> Terminal::GetNextScrollMark(til::CoordType row) const
+{
+    if (_inAltBuffer() || row >= til::CoordTypeMax - _scrollMarksRowOffset)
+    {
+        return std::nullopt;
+    }
+
+    const auto y = std::max(row, -1) + _scrollMarksRowOffset;
+    const auto it = std::upper_bound(_scrollMarks.begin(), _scrollMarks.end(), y, [](til::CoordType value, const DispatchTypes::ScrollMark& m) {
+        return value < m.start.y;
+    });
+    if (it == _scrollMarks.end())
+    {
+        return std::nullopt;
+    }
+
+    auto m = *it;
+    _offsetScrollMark(m, -_scrollMarksRowOffset);
+    return m;
+}
+
+// Moves all the coordinates of the given mark down by dy rows.
+void Terminal::_offsetScrollMark(DispatchTypes::ScrollMark& mark, til::CoordType dy) noexcept
+{
+    mark.start.y += dy;
+    mark.end.y += dy;
+    if (mark.commandEnd.has_value())
+    {
+        mark.commandEnd->y += dy;
+    }
+    if (mark.outputEnd.has_value())
+    {
+        mark.outputEnd->y += dy;
+    }
+}
+
+til::point Terminal::_toAbsoluteScrollMarkPosition(const til::point pos) const noexcept
+{
+    return { pos.x, pos.y + _scrollMarksRowOffset };
+}
+
+// Returns the mark that MarkCommandStart & co. should extend, or nullptr if
+// there's none (or we're in the alt buffer, where we don't track marks).
+DispatchTypes::ScrollMark* Terminal::_getLastVtScrollMark() noexcept
+{
+    if (_inAltBuffer() || !_lastVtScrollMark)
+    {
+        return nullptr;
+    }
+    return &til::at(_scrollMarks, *_lastVtScrollMark);
+}
+
+// Drops the marks that have been rotated out of the buffer. Since the
+// marks are sorted, those are always at the front.
+void Terminal::_trimScrollMarks() noexcept
+{
+    size_t trimmed = 0;
+    while (!_scrollMarks.empty() && _scrollMarks.front().start.y < _scrollMarksRowOffset)
+    {
+        _scrollMarks.pop_front();
+        ++trimmed;
+    }
+
+    if (_lastVtScrollMark)
+    {
+        if (*_lastVtScrollMark < trimmed)
+        {
+            _lastVtScrollMark.reset();
+        }
+        else
+        {
+            *_lastVtScrollMark -= trimmed;
+        }
+    }
+
+    // Rebase the marks before the absolute coordinates could overflow. With no
+    // marks left, this is free. Otherwise, it happens about once every billion rows.
+    if (_scrollMarks.empty())
+    {
+        _scrollMarksRowOffset = 0;
+    }
+    else if (_scrollMarksRowOffset > til::CoordTypeMax / 2)
+    {
+        for (auto& m : _scrollMarks)
+        {
+            _offsetScrollMark(m, -_scrollMarksRowOffset);
+        }
+        _scrollMarksRowOffset = 0;
+    }
 }
 
 til::color Terminal::GetColorForMark(const Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark& mark) const
@@ -97,7 +97,10 @@ public:
     RenderSettings& GetRenderSettings() noexcept { return _renderSettings; };
     const RenderSettings& GetRenderSettings() const noexcept { return _renderSettings; };
 
-    const std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark>& GetScrollMarks() const noexcept;
+    std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetScrollMarks() const;
+    std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetScrollMarksInRange(til::CoordType top, til::CoordType bottom) const;
+    std::optional<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetPreviousScrollMark(til::CoordType row) const;
+    std::optional<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> GetNextScrollMark(til::CoordType row) const;
     void AddMark(const Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark& mark,
                  const til::point& start,
                  const til::point& end,
@@ -284,7 +287,8 @@ public:
     til::point SelectionEndForRendering() const;
     const SelectionEndpoint SelectionEndpointTarget() const noexcept;
 
-    const TextBuffer::TextAndColor RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace);
+    std::vector<std::wstring> RetrieveSelectedTextFromBuffer(bool singleLine);
+    TextBuffer::ClipboardData SerializeSelection(bool singleLine, TextBuffer::ClipboardFormatting formatting);
 #pragma endregion
 
 private:
@@ -382,6 +386,12 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // The buffer, its generation and the rows _patternIntervalTree was computed for.
+    // Allows UpdatePatternsUnderLock() to skip GetPatterns() if nothing changed.
+    const TextBuffer* _patternsBuffer = nullptr;
+    uint64_t _patternsGeneration = 0;
+    til::CoordType _patternsFirstRow = 0;
+    til::CoordType _patternsLastRow = 0;
     void _InvalidatePatternTree(const interval_tree::IntervalTree<til::point, size_t>& tree);
     void _InvalidateFromCoords(const til::point start, const til::point end);
 
@@ -393,7 +403,15 @@ private:
     };
     std::optional<KeyEventCodes> _lastKeyEventCodes;
 
-    std::vector<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> _scrollMarks;
+    // Scroll marks are sorted by their start and stored in absolute row
+    // coordinates: a mark at buffer row y is stored at y + _scrollMarksRowOffset.
+    // Rotating the buffer then only has to bump the offset, instead of
+    // rewriting every single mark for every line that scrolls off.
+    std::deque<Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark> _scrollMarks;
+    til::CoordType _scrollMarksRowOffset = 0;
+    // Index of the most recent mark added via VT, which the MarkCommandStart
+    // & co. sequences extend. UI marks are sorted in anywhere, so this can't just be back().
+    std::optional<size_t> _lastVtScrollMark;
     enum class PromptState : uint32_t
     {
         None = 0,
@@ -428,6 +446,11 @@ private:
     TextBuffer& _activeBuffer() const noexcept;
     void _updateUrlDetection();
 
+    static void _offsetScrollMark(Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark& mark, til::CoordType dy) noexcept;
+    til::point _toAbsoluteScrollMarkPosition(const til::point pos) const noexcept;
+    Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark* _getLastVtScrollMark() noexcept;
+    void _trimScrollMarks() noexcept;
+
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     std::vector<til::inclusive_rect> _GetSelectionRects() const noexcept;
@@ -320,7 +320,7 @@ void Terminal::MarkCommandStart()
     const til::point cursorPos{ _activeBuffer().GetCursor().GetPosition() };
 
     if ((_currentPromptState == PromptState::Prompt) &&
-        (_scrollMarks.size() > 0))
+        (_getLastVtScrollMark() != nullptr))
     {
         // We were in the right state, and there's a previous mark to work
         // with.
@@ -337,7 +337,10 @@ void Terminal::MarkCommandStart()
         mark.category = DispatchTypes::MarkCategory::Prompt;
         AddMark(mark, cursorPos, cursorPos, false);
     }
-    _scrollMarks.back().end = cursorPos;
+    if (const auto mark = _getLastVtScrollMark())
+    {
+        mark->end = _toAbsoluteScrollMarkPosition(cursorPos);
+    }
     _currentPromptState = PromptState::Command;
 }
 
@@ -346,7 +349,7 @@ void Terminal::MarkOutputStart()
     const til::point cursorPos{ _activeBuffer().GetCursor().GetPosition() };
 
     if ((_currentPromptState == PromptState::Command) &&
-        (_scrollMarks.size() > 0))
+        (_getLastVtScrollMark() != nullptr))
     {
         // We were in the right state, and there's a previous mark to work
         // with.
@@ -363,7 +366,10 @@ void Terminal::MarkOutputStart()
         mark.category = DispatchTypes::MarkCategory::Prompt;
         AddMark(mark, cursorPos, cursorPos, false);
     }
-    _scrollMarks.back().commandEnd = cursorPos;
+    if (const auto mark = _getLastVtScrollMark())
+    {
+        mark->commandEnd = _toAbsoluteScrollMarkPosition(cursorPos);
+    }
     _currentPromptState = PromptState::Output;
 }
 
@@ -379,7 +385,7 @@ void Terminal::MarkCommandFinish(std::optional<unsigned int> error)
     }
 
     if ((_currentPromptState == PromptState::Output) &&
-        (_scrollMarks.size() > 0))
+        (_getLastVtScrollMark() != nullptr))
     {
         // We were in the right state, and there's a previous mark to work
         // with.
@@ -396,10 +402,16 @@ void Terminal::MarkCommandFinish(std::optional<unsigned int> error)
         DispatchTypes::ScrollMark mark;
         mark.category = DispatchTypes::MarkCategory::Prompt;
         AddMark(mark, cursorPos, cursorPos, false);
-        _scrollMarks.back().commandEnd = cursorPos;
+        if (const auto last = _getLastVtScrollMark())
+        {
+            last->commandEnd = _toAbsoluteScrollMarkPosition(cursorPos);
+        }
+    }
+    if (const auto mark = _getLastVtScrollMark())
+    {
+        mark->outputEnd = _toAbsoluteScrollMarkPosition(cursorPos);
+        mark->category = category;
     }
-    _scrollMarks.back().outputEnd = cursorPos;
-    _scrollMarks.back().category = category;
     _currentPromptState = PromptState::None;
 }
 
@@ -457,30 +469,16 @@ void Terminal::NotifyBufferRotation(const int delta)
 
     // manually erase our pattern intervals since the locations have changed now
     _patternIntervalTree = {};
+    _patternsBuffer = nullptr;
 
-    const auto hasScrollMarks = _scrollMarks.size() > 0;
+    // The marks are stored in absolute coordinates, so all we need to do is to move
+    // the origin. The marks that scrolled off the top are then popped off the front
+    // right away, which only touches the marks that are actually dropped.
+    const auto hasScrollMarks = !_scrollMarks.empty();
     if (hasScrollMarks)
     {
-        for (auto& mark : _scrollMarks)
-        {
-            // Move the mark up
-            mark.start.y -= delta;
-
-            // If the mark had sub-regions, then move those pointers too
-            if (mark.commandEnd.has_value())
-            {
-                (*mark.commandEnd).y -= delta;
-            }
-            if (mark.outputEnd.has_value())
-            {
-                (*mark.outputEnd).y -= delta;
-            }
-        }
-
-        _scrollMarks.erase(std::remove_if(_scrollMarks.begin(),
-                                          _scrollMarks.end(),
-                                          [](const auto& m) { return m.start.y < 0; }),
-                           _scrollMarks.end());
+        _scrollMarksRowOffset += delta;
+        _trimScrollMarks();
     }
 
     const auto oldScrollOffset = _scrollOffset;
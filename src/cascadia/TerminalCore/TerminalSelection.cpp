@@ -829,17 +829,11 @@ void Terminal::ClearSelection()
 // Arguments:
 // - singleLine: collapse all of the text to one line
 // Return Value:
-// - wstring text from buffer. If extended to multiple lines, each line is separated by \r\n
-const TextBuffer::TextAndColor Terminal::RetrieveSelectedTextFromBuffer(bool singleLine)
+// - wstring text from buffer, one string per row. If extended to multiple lines, each line is separated by \r\n
+std::vector<std::wstring> Terminal::RetrieveSelectedTextFromBuffer(bool singleLine)
 {
     auto lock = LockForReading();
 
-    const auto selectionRects = _GetSelectionRects();
-
-    const auto GetAttributeColors = [&](const auto& attr) {
-        return _renderSettings.GetAttributeColors(attr);
-    };
-
     // GH#6740: Block selection should preserve the visual structure:
     // - CRLFs need to be added - so the lines structure is preserved
     // - We should apply formatting above to wrapped rows as well (newline should be added).
@@ -847,7 +841,31 @@ const TextBuffer::TextAndColor Terminal::RetrieveSelectedTextFromBuffer(bool sin
     const auto includeCRLF = !singleLine || _blockSelection;
     const auto trimTrailingWhitespace = !singleLine && (!_blockSelection || _trimBlockSelection);
     const auto formatWrappedRows = _blockSelection;
-    return _activeBuffer().GetText(includeCRLF, trimTrailingWhitespace, selectionRects, GetAttributeColors, formatWrappedRows);
+    return _activeBuffer().GetText(includeCRLF, trimTrailingWhitespace, _GetSelectionRects(), formatWrappedRows);
+}
+
+// Method Description:
+// - Serializes the highlighted portion of the text buffer for the clipboard:
+//   As plain text and, if requested by `formatting`, as HTML and RTF.
+// Arguments:
+// - singleLine: collapse all of the text to one line
+// - formatting: the font to use and which formats to generate. The colors are filled in by this method.
+// Return Value:
+// - The plain text and the requested formats. If extended to multiple lines, each line of the text is separated by \r\n
+TextBuffer::ClipboardData Terminal::SerializeSelection(bool singleLine, TextBuffer::ClipboardFormatting formatting)
+{
+    auto lock = LockForReading();
+
+    formatting.GetAttributeColors = [&](const auto& attr) {
+        return _renderSettings.GetAttributeColors(attr);
+    };
+    formatting.backgroundColor = _renderSettings.GetAttributeColors({}).second;
+
+    // See RetrieveSelectedTextFromBuffer().
+    const auto includeCRLF = !singleLine || _blockSelection;
+    const auto trimTrailingWhitespace = !singleLine && (!_blockSelection || _trimBlockSelection);
+    const auto formatWrappedRows = _blockSelection;
+    return _activeBuffer().SerializeSelection(includeCRLF, trimTrailingWhitespace, _GetSelectionRects(), formatting, formatWrappedRows);
 }
 
 // Method Description:
@@ -122,6 +122,14 @@ class TerminalCoreUnitTests::ConptyRoundtripTests final
         // Enable the resize quirk, as the Terminal is going to be reacting as if it's enabled.
         vtRenderEngine->SetResizeQuirk(true);
 
+        // Look up a runtime parameter to see if we want to run the suite with the shadow frame,
+        // like VtIo does when Feature_VtShadowFrame is enabled. The expected output of the
+        // tests assumes that all invalidated cells get written, so we only compare the buffers then.
+        _shadowFrame = false;
+        RuntimeParameters::TryGetValue(L"ShadowFrame", _shadowFrame);
+        VERIFY_SUCCEEDED(vtRenderEngine->SetShadowFrame(_shadowFrame));
+        _pVtRenderEngine = vtRenderEngine.get();
+
         // Configure the OutputStateMachine's _pfnFlushToTerminal
         // Use OutputStateMachineEngine::SetTerminalConnection
         g.pRender->AddRenderEngine(vtRenderEngine.get());
@@ -157,7 +165,12 @@ class TerminalCoreUnitTests::ConptyRoundtripTests final
         auto& engines = ServiceLocator::LocateGlobals().pRender->_engines;
         std::fill(engines.begin(), engines.end(), nullptr);
 
+        if (_shadowFrame)
+        {
+            expectedOutput.clear();
+        }
         VERIFY_ARE_EQUAL(0u, expectedOutput.size(), L"Tests should drain all the output they push into the expected output buffer.");
+        _pVtRenderEngine = nullptr;
 
         emptyRenderer = nullptr;
         term = nullptr;
@@ -234,6 +247,10 @@ class TerminalCoreUnitTests::ConptyRoundtripTests final
     TEST_METHOD(TestNoExtendedAttrsOptimization);
     TEST_METHOD(TestNoBackgroundAttrsOptimization);
 
+    TEST_METHOD(GraphemeClusterMode);
+
+    TEST_METHOD(ShadowFrameSkipsUnchangedCells);
+
 private:
     bool _writeCallback(const char* const pch, const size_t cch);
     void _flushFirstFrame();
@@ -250,6 +267,9 @@ private:
     // Tests can set these variables how they link to configure the behavior of the test harness.
     bool _checkConptyOutput{ true }; // If true, the test class will check that the output from conpty was expected
     bool _logConpty{ false }; // If true, the test class will log all the output from conpty. Helpful for debugging.
+    bool _shadowFrame{ false }; // Set by the "ShadowFrame" runtime parameter. Disables the check of the output from conpty.
+
+    Xterm256Engine* _pVtRenderEngine{ nullptr };
 
     std::unique_ptr<DummyRenderer> emptyRenderer;
     std::unique_ptr<Terminal> term;
@@ -261,7 +281,7 @@ bool ConptyRoundtripTests::_writeCallback(const char* const pch, const size_t cc
 {
     auto actualString = std::string(pch, cch);
 
-    if (_checkConptyOutput)
+    if (_checkConptyOutput && !_shadowFrame)
     {
         VERIFY_IS_GREATER_THAN(expectedOutput.size(),
                                static_cast<size_t>(0),
@@ -4336,3 +4356,120 @@ void ConptyRoundtripTests::TestNoBackgroundAttrsOptimization()
     Log::Comment(L"========== Check terminal buffer ==========");
     verifyBuffer(*termTb);
 }
+
+void ConptyRoundtripTests::GraphemeClusterMode()
+{
+    Log::Comment(L"Enable grapheme cluster mode (DECSET 2027) and write a ZWJ emoji sequence. ConPTY must pass the "
+                 L"mode through, so that the host and the Terminal agree on the width of the text and the cursor position.");
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& hostSm = si.GetStateMachine();
+    auto& hostTb = si.GetTextBuffer();
+    auto& termTb = *term->_mainBuffer;
+
+    _flushFirstFrame();
+
+    _checkConptyOutput = false;
+
+    // A family emoji: man, ZWJ, woman, ZWJ, girl.
+    static constexpr std::wstring_view family{ L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67" };
+    // The cluster takes up 2 columns, followed by the "X".
+    static constexpr til::point expectedCursor{ 3, 0 };
+
+    auto verifyBuffer = [&](const TextBuffer& tb) {
+        const auto& row = tb.GetRowByOffset(0);
+        VERIFY_ARE_EQUAL(family, row.GlyphAt(0));
+        VERIFY_ARE_EQUAL(family, row.GlyphAt(1));
+        VERIFY_ARE_EQUAL(L"X", row.GlyphAt(2));
+        VERIFY_ARE_EQUAL(expectedCursor, tb.GetCursor().GetPosition());
+    };
+
+    hostSm.ProcessString(L"\x1b[?2027h");
+    hostSm.ProcessString(family);
+    hostSm.ProcessString(L"X");
+
+    Log::Comment(L"========== Check host buffer ==========");
+    verifyBuffer(hostTb);
+
+    Log::Comment(L"Painting the frame");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"========== Check terminal buffer ==========");
+    verifyBuffer(termTb);
+
+    hostSm.ProcessString(L"\x1b[?2027l");
+}
+
+void ConptyRoundtripTests::ShadowFrameSkipsUnchangedCells()
+{
+    Log::Comment(L"Enable the shadow frame and rewrite the buffer with partially identical contents. "
+                 L"Skipping the unchanged cells must still leave the Terminal with the same contents as the host.");
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& hostSm = si.GetStateMachine();
+    auto& hostTb = si.GetTextBuffer();
+    auto& termTb = *term->_mainBuffer;
+
+    _flushFirstFrame();
+
+    _checkConptyOutput = false;
+    VERIFY_SUCCEEDED(_pVtRenderEngine->SetShadowFrame(true));
+
+    hostSm.ProcessString(L"AAAAAAAAAA\r\n");
+    hostSm.ProcessString(L"BBBBBBBBBB\r\n");
+    hostSm.ProcessString(L"CCCCCCCCCC");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"Rewrite the same lines, changing a single character and the color of the second line");
+    hostSm.ProcessString(L"\x1b[H");
+    hostSm.ProcessString(L"AAAAXAAAAA\r\n");
+    hostSm.ProcessString(L"\x1b[31mBBBBBBBBBB\x1b[m\r\n");
+    hostSm.ProcessString(L"CCCCCCCCCC");
+
+    auto verifyData = [](TextBuffer& tb, const til::CoordType top) {
+        TestUtils::VerifyExpectedString(tb, L"AAAAXAAAAA", { 0, top });
+        TestUtils::VerifyExpectedString(tb, L"BBBBBBBBBB", { 0, top + 1 });
+        TestUtils::VerifyExpectedString(tb, L"CCCCCCCCCC", { 0, top + 2 });
+
+        const auto& row = tb.GetRowByOffset(top + 1);
+        for (til::CoordType x = 0; x < 10; x++)
+        {
+            VERIFY_IS_TRUE(row.GetAttrByColumn(x).GetForeground() == TextColor{ TextColor::DARK_RED, false });
+        }
+        VERIFY_IS_TRUE(row.GetAttrByColumn(10).GetForeground().IsDefault());
+    };
+
+    Log::Comment(L"========== Check host buffer ==========");
+    verifyData(hostTb, 0);
+
+    Log::Comment(L"Painting the frame");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"========== Check terminal buffer ==========");
+    verifyData(termTb, 0);
+
+    Log::Comment(L"Scroll the lines down and back up, which shifts the shadow frame, then rewrite the last line with the same text");
+    hostSm.ProcessString(L"\x1b[H\x1bM");
+    hostSm.ProcessString(L"\x1b[S");
+    hostSm.ProcessString(L"\x1b[3;1HCCCCCCCCCC");
+
+    Log::Comment(L"========== Check host buffer ==========");
+    TestUtils::VerifyExpectedString(hostTb, L"AAAAXAAAAA", { 0, 0 });
+    TestUtils::VerifyExpectedString(hostTb, L"BBBBBBBBBB", { 0, 1 });
+    TestUtils::VerifyExpectedString(hostTb, L"CCCCCCCCCC", { 0, 2 });
+
+    Log::Comment(L"Painting the frame");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"========== Check terminal buffer ==========");
+    const auto termView = term->GetViewport();
+    TestUtils::VerifyExpectedString(termTb, L"AAAAXAAAAA", { 0, termView.Top() });
+    TestUtils::VerifyExpectedString(termTb, L"BBBBBBBBBB", { 0, termView.Top() + 1 });
+    TestUtils::VerifyExpectedString(termTb, L"CCCCCCCCCC", { 0, termView.Top() + 2 });
+}
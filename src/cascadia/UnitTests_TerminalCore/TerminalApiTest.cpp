@@ -11,6 +11,7 @@
 
 using namespace winrt::Microsoft::Terminal::Core;
 using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::VirtualTerminal;
 
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -41,6 +42,8 @@ namespace TerminalCoreUnitTests
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+
+        TEST_METHOD(ScrollMarksFollowBufferRotation);
     };
 };
 
@@ -476,3 +479,65 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;D:\\中文\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"D:\\中文");
 }
+
+void TerminalCoreUnitTests::TerminalApiTest::ScrollMarksFollowBufferRotation()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 100, 10 }, 10, renderer);
+
+    auto& cursor = term.GetTextBuffer().GetCursor();
+    DispatchTypes::ScrollMark prompt;
+    prompt.category = DispatchTypes::MarkCategory::Prompt;
+
+    Log::Comment(L"Add two prompts via VT and a UI mark in between them");
+    cursor.SetPosition({ 0, 2 });
+    term.MarkPrompt(prompt);
+    cursor.SetPosition({ 0, 5 });
+    term.MarkPrompt(prompt);
+    term.AddMark({}, { 0, 3 }, { 0, 3 }, true);
+
+    Log::Comment(L"The command should extend the last VT mark, not the UI mark");
+    cursor.SetPosition({ 4, 5 });
+    term.MarkCommandStart();
+
+    auto marks = term.GetScrollMarks();
+    VERIFY_ARE_EQUAL(3u, marks.size());
+    VERIFY_ARE_EQUAL(2, marks[0].start.y);
+    VERIFY_ARE_EQUAL(3, marks[1].start.y);
+    VERIFY_ARE_EQUAL(5, marks[2].start.y);
+    VERIFY_ARE_EQUAL(til::point(4, 5), marks[2].end);
+
+    Log::Comment(L"Rotating the buffer moves the marks up and drops the ones that scrolled off");
+    term.NotifyBufferRotation(3);
+
+    marks = term.GetScrollMarks();
+    VERIFY_ARE_EQUAL(2u, marks.size());
+    VERIFY_ARE_EQUAL(0, marks[0].start.y);
+    VERIFY_ARE_EQUAL(2, marks[1].start.y);
+    VERIFY_ARE_EQUAL(til::point(4, 2), marks[1].end);
+
+    VERIFY_ARE_EQUAL(1u, term.GetScrollMarksInRange(1, 5).size());
+    VERIFY_ARE_EQUAL(0, term.GetPreviousScrollMark(2)->start.y);
+    VERIFY_ARE_EQUAL(2, term.GetNextScrollMark(0)->start.y);
+    VERIFY_IS_FALSE(term.GetNextScrollMark(2).has_value());
+    VERIFY_IS_FALSE(term.GetPreviousScrollMark(0).has_value());
+
+    Log::Comment(L"The rest of the prompt still ends up in the rotated mark");
+    cursor.SetPosition({ 0, 4 });
+    term.MarkOutputStart();
+    cursor.SetPosition({ 0, 6 });
+    term.MarkCommandFinish(0);
+
+    marks = term.GetScrollMarks();
+    VERIFY_ARE_EQUAL(2u, marks.size());
+    VERIFY_ARE_EQUAL(til::point(0, 4), *marks[1].commandEnd);
+    VERIFY_ARE_EQUAL(til::point(0, 6), *marks[1].outputEnd);
+    VERIFY_IS_TRUE(marks[1].category == DispatchTypes::MarkCategory::Success);
+
+    term.NotifyBufferRotation(1);
+    marks = term.GetScrollMarks();
+    VERIFY_ARE_EQUAL(1u, marks.size());
+    VERIFY_ARE_EQUAL(1, marks[0].start.y);
+    VERIFY_ARE_EQUAL(til::point(0, 5), *marks[0].outputEnd);
+}
@@ -50,8 +50,8 @@ public:
                                                             ULONG& events) noexcept override;
 
     [[nodiscard]] HRESULT GetConsoleInputImpl(IConsoleInputObject& context,
-                                              InputEventQueue& outEvents,
-                                              const size_t eventReadCount,
+                                              std::span<INPUT_RECORD> outRecords,
+                                              size_t& recordsRead,
                                               INPUT_READ_HANDLE_DATA& readHandleState,
                                               const bool IsUnicode,
                                               const bool IsPeek,
@@ -107,14 +107,14 @@ void VtApiRoutines::_SynchronizeCursor(std::unique_ptr<IWaitRoutine>& waiter) no
 
 [[nodiscard]] HRESULT VtApiRoutines::GetConsoleInputImpl(
     IConsoleInputObject& context,
-    InputEventQueue& outEvents,
-    const size_t eventReadCount,
+    std::span<INPUT_RECORD> outRecords,
+    size_t& recordsRead,
     INPUT_READ_HANDLE_DATA& readHandleState,
     const bool IsUnicode,
     const bool IsPeek,
     std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
-    const auto hr = m_pUsualRoutines->GetConsoleInputImpl(context, outEvents, eventReadCount, readHandleState, IsUnicode, IsPeek, waiter);
+    const auto hr = m_pUsualRoutines->GetConsoleInputImpl(context, outRecords, recordsRead, readHandleState, IsUnicode, IsPeek, waiter);
     _SynchronizeCursor(waiter);
     return hr;
 }
@@ -17,6 +17,12 @@
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::Interactivity;
 using namespace Microsoft::Console::VirtualTerminal;
+
+// Reads start out small, since most of them are individual keystrokes. Whenever a read fills
+// the buffer (for instance during a large paste), it's doubled up to the maximum size.
+static constexpr size_t initialReadSize = 4 * 1024;
+static constexpr size_t maximumReadSize = 128 * 1024;
+
 // Constructor Description:
 // - Creates the VT Input Thread.
 // Arguments:
@@ -30,12 +36,19 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
     _u8State{},
     _dwThreadId{ 0 },
     _exitRequested{ false },
-    _pfnSetLookingForDSR{}
+    _pfnSetLookingForDSR{},
+    _pfnFlushInput{}
 {
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
 
+    _buffer.resize(initialReadSize);
+
     auto dispatch = std::make_unique<InteractDispatch>();
 
+    // The dispatch collects all input generated by a single read and we need
+    // this callback to write it into the input buffer in one go afterwards.
+    _pfnFlushInput = std::bind(&InteractDispatch::FlushInput, dispatch.get());
+
     auto engine = std::make_unique<InputStateMachineEngine>(std::move(dispatch), inheritCursor);
 
     auto engineRef = engine.get();
@@ -70,14 +83,16 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 
     try
     {
-        std::wstring wstr{};
-        auto hr = til::u8u16(u8Str, wstr, _u8State);
+        // _wstr is reused across reads, so that we don't allocate for every keystroke.
+        auto hr = til::u8u16(u8Str, _wstr, _u8State);
         // If we hit a parsing error, eat it. It's bad utf-8, we can't do anything with it.
         if (FAILED(hr))
         {
             return S_FALSE;
         }
-        _pInputStateMachine->ProcessString(wstr);
+        // Even if the state machine throws, the input that was parsed until then should be written.
+        const auto flush = wil::scope_exit([&] { _pfnFlushInput(); });
+        _pInputStateMachine->ProcessString(_wstr);
     }
     CATCH_RETURN();
 
@@ -107,9 +122,8 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    char buffer[256];
     DWORD dwRead = 0;
-    auto fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
+    auto fSuccess = !!ReadFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), &dwRead, nullptr);
 
     if (!fSuccess)
     {
@@ -117,7 +131,14 @@ void VtInputThread::DoReadInput(const bool throwOnFail)
         return;
     }
 
-    auto hr = _HandleRunInput({ buffer, gsl::narrow_cast<size_t>(dwRead) });
+    auto hr = _HandleRunInput({ _buffer.data(), gsl::narrow_cast<size_t>(dwRead) });
+
+    // If the read filled the entire buffer, there's likely more where that came from.
+    if (dwRead == _buffer.size() && _buffer.size() < maximumReadSize)
+    {
+        _buffer.resize(_buffer.size() * 2);
+    }
+
     if (FAILED(hr))
     {
         if (throwOnFail)
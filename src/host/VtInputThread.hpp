@@ -39,8 +39,11 @@ namespace Microsoft::Console
         bool _exitRequested;
 
         std::function<void(bool)> _pfnSetLookingForDSR;
+        std::function<void()> _pfnFlushInput;
 
         std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _pInputStateMachine;
         til::u8state _u8State;
+        std::string _buffer;
+        std::wstring _wstr;
     };
 }
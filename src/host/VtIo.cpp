@@ -162,6 +162,9 @@ VtIo::VtIo() :
             {
                 auto xterm256Engine = std::make_unique<Xterm256Engine>(std::move(_hOutput),
                                                                        initialViewport);
+                // Only write the cells that changed since the last frame. In passthrough
+                // mode the terminal's contents don't go through our renderer.
+                auto shadowFrame = Feature_VtShadowFrame::IsEnabled();
                 if constexpr (Feature_VtPassthroughMode::IsEnabled())
                 {
                     if (_passthroughMode)
@@ -171,6 +174,7 @@ VtIo::VtIo() :
                         vtapi->m_pUsualRoutines = globals.api;
 
                         xterm256Engine->SetPassthroughMode(true);
+                        shadowFrame = false;
 
                         if (_pVtInputThread)
                         {
@@ -182,6 +186,7 @@ VtIo::VtIo() :
                     }
                 }
 
+                RETURN_IF_FAILED(xterm256Engine->SetShadowFrame(shadowFrame));
                 _pVtRenderEngine = std::move(xterm256Engine);
                 break;
             }
@@ -194,6 +199,7 @@ VtIo::VtIo() :
                 {
                     return E_NOTIMPL;
                 }
+                RETURN_IF_FAILED(_pVtRenderEngine->SetShadowFrame(Feature_VtShadowFrame::IsEnabled()));
                 break;
             }
             case VtIoMode::XTERM_ASCII:
@@ -660,13 +660,27 @@ NT_CATCH_RETURN()
         const auto codepage{ consoleInfo.OutputCP };
         auto leadByteCaptured{ false };
         auto leadByteConsumed{ false };
-        std::wstring wstr{};
-        static til::u8state u8State{};
+        std::wstring_view wstr{};
+
+        // The conversion buffer and the UTF-8 partials belong to the output handle the client wrote to,
+        // so that writes to different handles don't complete each other's partial sequences.
+        auto& conversionBuffer{ context.WriteConsoleAConversionBuffer };
+        auto& u8State{ context.WriteConsoleAUtf8State };
+        const auto reserveConversionBuffer = [&](const size_t size) {
+            if (conversionBuffer.size() < size)
+            {
+                conversionBuffer.resize(size);
+            }
+        };
 
         // Convert our input parameters to Unicode
         if (codepage == CP_UTF8)
         {
-            RETURN_IF_FAILED(til::u8u16(buffer, wstr, u8State));
+            // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1, plus the cached partials.
+            reserveConversionBuffer(buffer.size() + u8State.have);
+            size_t written{};
+            RETURN_IF_FAILED(til::u8u16(buffer, conversionBuffer, written, u8State));
+            wstr = { conversionBuffer.data(), written };
             read = buffer.size();
         }
         else
@@ -681,9 +695,9 @@ NT_CATCH_RETURN()
             // (buffer.size() + 2) I think because we might be shoving another unicode char
             // from screenInfo->WriteConsoleDbcsLeadByte in front
             // because we previously checked that buffer.size() fits into an int, +2 won't cause an overflow of size_t
-            wstr.resize(buffer.size() + 2);
+            reserveConversionBuffer(buffer.size() + 2);
 
-            auto wcPtr{ wstr.data() };
+            auto wcPtr{ conversionBuffer.data() };
             auto mbPtr{ buffer.data() };
             size_t dbcsLength{};
             if (screenInfo.WriteConsoleDbcsLeadByte[0] != 0 && gsl::narrow_cast<byte>(*mbPtr) >= byte{ ' ' })
@@ -707,6 +721,8 @@ NT_CATCH_RETURN()
                 catch (...)
                 {
                     dbcsLength = 0;
+                    // The conversion buffer is reused and thus not zero-initialized.
+                    wcPtr[0] = UNICODE_NULL;
                 }
 
                 // this looks weird to be always incrementing even if the conversion failed, but this is the
@@ -742,7 +758,7 @@ NT_CATCH_RETURN()
                 mbPtrLength = sizeof(wchar_t) * MultiByteToWideChar(codepage, 0, mbPtr, mbPtrLength, wcPtr, mbPtrLength);
             }
 
-            wstr.resize((dbcsLength + mbPtrLength) / sizeof(wchar_t));
+            wstr = { conversionBuffer.data(), (dbcsLength + mbPtrLength) / sizeof(wchar_t) };
         }
 
         // Hold the specific version of the waiter locally so we can tinker with it if we have to store additional context.
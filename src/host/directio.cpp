@@ -130,8 +130,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 //   from the input buffer and in the peek case they are not.
 // Arguments:
 // - pInputBuffer - The input buffer to take records from to return to the client
-// - outEvents - The storage location to fill with input events
-// - eventReadCount - The number of events to read
+// - outRecords - The storage location to fill with input events. Its size is the number of events to read.
+// - recordsRead - On exit, the number of events stored in outRecords
 // - pInputReadHandleData - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -150,8 +150,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // block, this will be returned along with context in *ppWaiter.
 // - Or an out of memory/math/string error message in NTSTATUS format.
 [[nodiscard]] HRESULT ApiRoutines::GetConsoleInputImpl(IConsoleInputObject& inputBuffer,
-                                                       InputEventQueue& outEvents,
-                                                       const size_t eventReadCount,
+                                                       std::span<INPUT_RECORD> outRecords,
+                                                       size_t& recordsRead,
                                                        INPUT_READ_HANDLE_DATA& readHandleState,
                                                        const bool IsUnicode,
                                                        const bool IsPeek,
@@ -160,8 +160,9 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         waiter.reset();
+        recordsRead = 0;
 
-        if (eventReadCount == 0)
+        if (outRecords.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -169,8 +170,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        const auto Status = inputBuffer.Read(outEvents,
-                                             eventReadCount,
+        const auto Status = inputBuffer.Read(outRecords,
+                                             recordsRead,
                                              IsPeek,
                                              true,
                                              IsUnicode,
@@ -182,7 +183,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             // to the read data object and send it back up to the server.
             waiter = std::make_unique<DirectReadData>(&inputBuffer,
                                                       &readHandleState,
-                                                      eventReadCount);
+                                                      outRecords.size());
         }
         return Status;
     }
@@ -200,7 +201,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // Return Value:
 // - HRESULT indicating success or failure
 [[nodiscard]] static HRESULT _WriteConsoleInputWImplHelper(InputBuffer& context,
-                                                           std::deque<std::unique_ptr<IInputEvent>>& events,
+                                                           const std::span<const INPUT_RECORD> events,
                                                            size_t& written,
                                                            const bool append) noexcept
 {
@@ -262,7 +263,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             context.StoreWritePartialByteSequence(std::move(partialEvent));
         }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        const auto records = IInputEvent::ToInputRecords(events);
+        return _WriteConsoleInputWImplHelper(context, records, written, append);
     }
     CATCH_RETURN();
 }
@@ -289,9 +291,24 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // The input buffer stores the records as is. Reject anything that isn't a known event type
+        // upfront, so that we don't write a partial set of records before encountering an invalid one.
+        for (const auto& record : buffer)
+        {
+            switch (record.EventType)
+            {
+            case KEY_EVENT:
+            case MOUSE_EVENT:
+            case WINDOW_BUFFER_SIZE_EVENT:
+            case MENU_EVENT:
+            case FOCUS_EVENT:
+                break;
+            default:
+                return E_INVALIDARG;
+            }
+        }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        return _WriteConsoleInputWImplHelper(context, buffer, written, append);
     }
     CATCH_RETURN();
 }
@@ -510,7 +527,6 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 {
     try
     {
-        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         const auto& storageBuffer = context.GetActiveBuffer().GetTextBuffer();
         const auto storageSize = storageBuffer.GetSize().Dimensions();
 
@@ -545,43 +561,14 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         // The final "request rectangle" or the area inside the buffer we want to read, is the clipped dimensions.
         const auto clippedRequestRectangle = Viewport::FromExclusive(clip);
 
-        // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
-        const auto sourcePoint = clippedRequestRectangle.Origin();
-
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        til::point targetPos;
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Copy the clipped request straight out of the rows into the user's buffer, with each row
+        // of it starting at the target point within the corresponding row of the user's buffer.
+        if (clip)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            const auto targetOffset = gsl::narrow_cast<size_t>(targetPoint.y) * targetSize.width + targetPoint.x;
+            if (targetOffset < targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                ++sourceIter;
-            }
-
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            ++targetIter;
-
-            // Increment the target
-            targetPos.x++;
-            if (targetPos.x >= targetSize.width)
-            {
-                targetPos.x = 0;
-                targetPos.y++;
+                storageBuffer.ReadCharInfos(clip, targetBuffer.subspan(targetOffset), gsl::narrow_cast<size_t>(targetSize.width));
             }
         }
 
@@ -708,28 +695,13 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
         const auto writeRectangle = Viewport::FromInclusive(writeRegion);
 
-        auto target = writeRectangle.Origin();
+        // We find the offset into the original buffer by the dimensions of the original request rectangle.
+        // Every row of the request is then written from a view into the clamped portion of just that line.
+        const auto rowOffset = (writeRectangle.Top() - requestRectangle.Top()) * requestRectangle.Width();
+        const auto colOffset = writeRectangle.Left() - requestRectangle.Left();
+        const auto totalOffset = gsl::narrow_cast<size_t>(rowOffset + colOffset);
 
-        // For every row in the request, create a view into the clamped portion of just the one line to write.
-        // This allows us to restrict the width of the call without allocating/copying any memory by just making
-        // a smaller view over the existing big blob of data from the original call.
-        for (; target.y < writeRectangle.BottomExclusive(); target.y++)
-        {
-            // We find the offset into the original buffer by the dimensions of the original request rectangle.
-            const auto rowOffset = (target.y - requestRectangle.Top()) * requestRectangle.Width();
-            const auto colOffset = target.x - requestRectangle.Left();
-            const auto totalOffset = rowOffset + colOffset;
-
-            // Now we make a subspan starting from that offset for as much of the original request as would fit
-            const auto subspan = buffer.subspan(totalOffset, writeRectangle.Width());
-
-            // Convert to a CHAR_INFO view to fit into the iterator
-            const auto charInfos = std::span<const CHAR_INFO>(subspan.data(), subspan.size());
-
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
-        }
+        storageBuffer.GetTextBuffer().WriteCharInfos(writeRectangle.ToExclusive(), buffer.subspan(totalOffset), gsl::narrow_cast<size_t>(requestRectangle.Width()));
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
         writtenRectangle = writeRectangle;
@@ -27,6 +27,12 @@ class BufferTests
     TEST_METHOD(ScrollLargeBufferPerformance);
 
     TEST_METHOD(ChafaGifPerformance);
+
+    BEGIN_TEST_METHOD(WriteConsoleAChunkPerformance)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:codepage", L"{65001, 437}")
+        TEST_METHOD_PROPERTY(L"Data:chunkSize", L"{1, 80, 65536}")
+    END_TEST_METHOD()
 };
 
 void BufferTests::TestSetConsoleActiveScreenBufferInvalid()
@@ -257,3 +263,44 @@ void BufferTests::ChafaGifPerformance()
     const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
     Log::Comment(String().Format(L"%d calls took %d ms. Avg %d ms per call", count, delta, delta / count));
 }
+
+void BufferTests::WriteConsoleAChunkPerformance()
+{
+    // Programs like MSBuild loggers or chatty scripts issue lots of small writes,
+    // which used to pay for an allocation each while holding the console lock.
+
+    DWORD codepage;
+    DWORD chunkSize;
+    VERIFY_SUCCEEDED(WEX::TestExecution::TestData::TryGetValue(L"codepage", codepage));
+    VERIFY_SUCCEEDED(WEX::TestExecution::TestData::TryGetValue(L"chunkSize", chunkSize));
+
+    const auto Out = GetStdHandle(STD_OUTPUT_HANDLE);
+    const auto originalCodepage = GetConsoleOutputCP();
+    auto restoreCodepage = wil::scope_exit([&]() { SetConsoleOutputCP(originalCodepage); });
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetConsoleOutputCP(codepage));
+
+    // 4 MiB of text, with a line break every 80 columns.
+    std::string text;
+    text.reserve(4 * 1024 * 1024);
+    for (size_t i = 0; text.size() < 4 * 1024 * 1024; ++i)
+    {
+        text.push_back(i % 80 == 79 ? '\n' : static_cast<char>('a' + i % 26));
+    }
+
+    // Writing the whole text a byte at a time would take forever, so we write less of it.
+    const auto length = std::min(text.size(), size_t{ chunkSize } * 64 * 1024);
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    DWORD count = 0;
+    for (size_t pos = 0; pos < length; pos += chunkSize)
+    {
+        DWORD written = 0;
+        WriteConsoleA(Out, text.data() + pos, gsl::narrow_cast<DWORD>(std::min<size_t>(chunkSize, length - pos)), &written, nullptr);
+        count++;
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d calls of %d bytes took %lld us. Avg %lld us per call", count, chunkSize, delta, delta / count));
+}
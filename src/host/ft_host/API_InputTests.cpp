@@ -51,6 +51,8 @@ class InputTests
     TEST_METHOD(TestMouseHorizWheelReadConsoleInputQuickEdit);
     TEST_METHOD(RawReadUnpacksCoalescedInputRecords);
 
+    TEST_METHOD(LargePasteRoundTripPerformance);
+
     BEGIN_TEST_METHOD(TestVtInputGeneration)
         TEST_METHOD_PROPERTY(L"IsolationLevel", L"Method")
     END_TEST_METHOD();
@@ -716,3 +718,57 @@ void InputTests::RawReadUnpacksCoalescedInputRecords()
     VERIFY_WIN32_BOOL_SUCCEEDED(GetNumberOfConsoleInputEvents(hIn, &eventCount));
     VERIFY_ARE_EQUAL(eventCount, static_cast<DWORD>(0));
 }
+
+void InputTests::LargePasteRoundTripPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    // Simulates pasting 1 MiB of text: Every character is written as a key down/up pair
+    // with WriteConsoleInput and then read back with ReadConsoleInput in batches.
+    static constexpr size_t characters = 1024 * 1024;
+    static constexpr size_t batchSize = 4096;
+
+    WEX::TestExecution::SetVerifyOutput verifySettings(WEX::TestExecution::VerifyOutputSettings::LogOnlyFailures);
+
+    const auto hIn = GetStdInputHandle();
+    VERIFY_WIN32_BOOL_SUCCEEDED(FlushConsoleInputBuffer(hIn));
+
+    std::vector<INPUT_RECORD> records(batchSize);
+    for (size_t i = 0; i < batchSize; i += 2)
+    {
+        const auto wch = static_cast<wchar_t>(L'A' + (i / 2) % 26);
+        FillInputRecordHelper(&records[i], wch, true);
+        FillInputRecordHelper(&records[i + 1], wch, false);
+    }
+
+    Log::Comment(L"Working. Please wait...");
+
+    const auto totalRecords = characters * 2;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < totalRecords; i += batchSize)
+    {
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteConsoleInput(hIn, records.data(), gsl::narrow_cast<DWORD>(batchSize), &written));
+    }
+
+    const auto mid = std::chrono::steady_clock::now();
+
+    size_t totalRead = 0;
+    while (totalRead < totalRecords)
+    {
+        DWORD read = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadConsoleInput(hIn, records.data(), gsl::narrow_cast<DWORD>(batchSize), &read));
+        totalRead += read;
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    VERIFY_ARE_EQUAL(totalRecords, totalRead);
+
+    const auto writeDelta = std::chrono::duration_cast<std::chrono::milliseconds>(mid - start).count();
+    const auto readDelta = std::chrono::duration_cast<std::chrono::milliseconds>(end - mid).count();
+    Log::Comment(String().Format(L"Writing %zu records took %lld ms, reading them took %lld ms", totalRecords, writeDelta, readDelta));
+}
@@ -152,58 +152,49 @@ void InputBuffer::Cache(std::wstring_view source)
     _cachedTextReaderW = std::wstring_view{ _cachedTextW }.substr(off);
 }
 
-// Moves up to `count`, previously cached events into `target`.
-size_t InputBuffer::ConsumeCached(bool isUnicode, size_t count, InputEventQueue& target)
+// Copies as many records from `source` over to `target` as fit and advances both slices accordingly.
+static void transferRecords(std::span<INPUT_RECORD>& target, std::span<const INPUT_RECORD>& source) noexcept
 {
-    _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
-
-    size_t i = 0;
-
-    while (i < count && !_cachedInputEvents.empty())
-    {
-        target.push_back(std::move(_cachedInputEvents.front()));
-        _cachedInputEvents.pop_front();
-        i++;
-    }
-
-    return i;
+    const auto count = std::min(target.size(), source.size());
+    std::copy_n(source.begin(), count, target.begin());
+    target = target.subspan(count);
+    source = source.subspan(count);
 }
 
-// Copies up to `count`, previously cached events into `target`.
-size_t InputBuffer::PeekCached(bool isUnicode, size_t count, InputEventQueue& target)
+// Moves previously cached events into `target`, until either of the two runs out.
+void InputBuffer::ConsumeCached(bool isUnicode, std::span<INPUT_RECORD>& target)
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
-
-    for (const auto& e : _cachedInputEvents)
+    if (!_cachedInputEventsReader.empty())
     {
-        if (i >= count)
+        transferRecords(target, _cachedInputEventsReader);
+
+        if (_cachedInputEventsReader.empty())
         {
-            break;
+            // This is just so that we release memory eagerly.
+            _cachedInputEvents = std::vector<INPUT_RECORD>{};
         }
-
-        target.push_back(IInputEvent::Create(e->ToInputRecord()));
-        i++;
     }
+}
 
-    return i;
+// Same as `ConsumeCached`, but doesn't remove the events from the cache.
+void InputBuffer::PeekCached(bool isUnicode, std::span<INPUT_RECORD>& target)
+{
+    _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
+
+    auto reader = _cachedInputEventsReader;
+    transferRecords(target, reader);
 }
 
-// Trims `source` to have a size below or equal to `expectedSourceSize` by
-// storing any extra events in `_cachedInputEvents` for later retrieval.
-void InputBuffer::Cache(bool isUnicode, InputEventQueue& source, size_t expectedSourceSize)
+// Stores events that didn't fit into the caller's buffer for later retrieval via `ConsumeCached`.
+void InputBuffer::Cache(bool isUnicode, std::span<const INPUT_RECORD> source)
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    if (source.size() > expectedSourceSize)
-    {
-        _cachedInputEvents.insert(
-            _cachedInputEvents.end(),
-            std::make_move_iterator(source.begin() + expectedSourceSize),
-            std::make_move_iterator(source.end()));
-        source.resize(expectedSourceSize);
-    }
+    const auto off = _cachedInputEvents.empty() ? 0 : _cachedInputEventsReader.data() - _cachedInputEvents.data();
+    _cachedInputEvents.insert(_cachedInputEvents.end(), source.begin(), source.end());
+    _cachedInputEventsReader = std::span<const INPUT_RECORD>{ _cachedInputEvents }.subspan(off);
 }
 
 void InputBuffer::_switchReadingMode(ReadingMode mode)
@@ -222,7 +213,8 @@ void InputBuffer::_switchReadingModeSlowPath(ReadingMode mode)
     _cachedTextW = std::wstring{};
     _cachedTextReaderW = {};
 
-    _cachedInputEvents = std::deque<std::unique_ptr<IInputEvent>>{};
+    _cachedInputEvents = std::vector<INPUT_RECORD>{};
+    _cachedInputEventsReader = {};
 
     _readingMode = mode;
 }
@@ -287,6 +279,7 @@ void InputBuffer::ReinitializeInputBuffer()
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     InputMode = INPUT_BUFFER_DEFAULT_INPUT_MODE;
     _storage.clear();
+    _storageBegin = 0;
 }
 
 // Routine Description:
@@ -321,7 +314,7 @@ void InputBuffer::TerminateRead(_In_ WaitTerminationReason Flag)
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 {
-    return _storage.size();
+    return _storage.size() - _storageBegin;
 }
 
 // Routine Description:
@@ -335,6 +328,7 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 void InputBuffer::Flush()
 {
     _storage.clear();
+    _storageBegin = 0;
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
@@ -348,10 +342,38 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    const auto pending = _pendingRecords();
+    const auto newEnd = std::remove_if(pending.begin(), pending.end(), [](const INPUT_RECORD& record) {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
+    _storage.resize(_storage.size() - (pending.end() - newEnd));
+    // Resets _storage in case we just removed all pending records.
+    _consumeRecords(0);
+}
+
+// Returns the slice of _storage that hasn't been read yet.
+std::span<INPUT_RECORD> InputBuffer::_pendingRecords() noexcept
+{
+    return std::span{ _storage }.subspan(_storageBegin);
+}
+
+// Marks the first `count` pending records as read.
+// The consumed head of _storage is only erased once it makes up the larger half of the vector. This keeps
+// the cost of erasing amortized O(1) per record, while the vector's capacity is retained for future writes.
+void InputBuffer::_consumeRecords(size_t count) noexcept
+{
+    _storageBegin += count;
+
+    if (_storageBegin == _storage.size())
+    {
+        _storage.clear();
+        _storageBegin = 0;
+    }
+    else if (_storageBegin > _storage.size() / 2)
+    {
+        _storage.erase(_storage.begin(), _storage.begin() + _storageBegin);
+        _storageBegin = 0;
+    }
 }
 
 void InputBuffer::SetTerminalConnection(_In_ Render::VtEngine* const pTtyConnection)
@@ -381,67 +403,97 @@ void InputBuffer::PassThroughWin32MouseRequest(bool enable)
 // Note:
 // - The console lock must be held when calling this routine.
 // Arguments:
-// - OutEvents - deque to store the read events
-// - AmountToRead - the amount of events to try to read
+// - OutRecords - buffer to store the read events in. Its size is the amount of events to try to read.
+// - RecordsRead - on exit, the number of records that were stored in OutRecords.
 // - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
 // - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
 // - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
-// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. AmountToRead must be 1 if Stream is true.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. OutRecords must have a size of 1 if Stream is true.
 // Return Value:
 // - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
 // - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
 // - otherwise a suitable memory/math/string error in NTSTATUS form.
-[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
-                                         const size_t AmountToRead,
+[[nodiscard]] NTSTATUS InputBuffer::Read(std::span<INPUT_RECORD> OutRecords,
+                                         _Out_ size_t& RecordsRead,
                                          const bool Peek,
                                          const bool WaitForData,
                                          const bool Unicode,
                                          const bool Stream)
 try
 {
-    assert(OutEvents.empty());
+    RecordsRead = 0;
 
-    const auto cp = ServiceLocator::LocateGlobals().getConsoleInformation().CP;
+    auto target = OutRecords;
 
     if (Peek)
     {
-        PeekCached(Unicode, AmountToRead, OutEvents);
+        PeekCached(Unicode, target);
     }
     else
     {
-        ConsumeCached(Unicode, AmountToRead, OutEvents);
+        ConsumeCached(Unicode, target);
     }
 
-    auto it = _storage.begin();
-    const auto end = _storage.end();
+    const auto pending = _pendingRecords();
+    size_t consumed = 0;
 
-    while (it != end && OutEvents.size() < AmountToRead)
+    if (Unicode && !Stream)
     {
-        auto event = IInputEvent::Create((*it)->ToInputRecord());
+        // Fast path: Without a codepage conversion or key repeat unpacking every stored
+        // record maps to exactly one output record and we can copy them over in bulk.
+        consumed = std::min(target.size(), pending.size());
+        std::copy_n(pending.begin(), consumed, target.begin());
+        target = target.subspan(consumed);
+    }
+    else
+    {
+        const auto cp = ServiceLocator::LocateGlobals().getConsoleInformation().CP;
+
+        // Appends `record` to `target` and caches it once `target` is full.
+        const auto put = [&](const INPUT_RECORD& record) {
+            if (target.empty())
+            {
+                Cache(Unicode, { &record, 1 });
+            }
+            else
+            {
+                target.front() = record;
+                target = target.subspan(1);
+            }
+        };
 
-        if (event->EventType() == InputEventType::KeyEvent)
+        for (; consumed < pending.size() && !target.empty(); ++consumed)
         {
-            const auto keyEvent = static_cast<KeyEvent*>(event.get());
+            auto& stored = pending[consumed];
+
+            if (stored.EventType != KEY_EVENT)
+            {
+                put(stored);
+                continue;
+            }
+
+            auto record = stored;
+            auto& keyEvent = record.Event.KeyEvent;
             WORD repeat = 1;
 
             // for stream reads we need to split any key events that have been coalesced
             if (Stream)
             {
-                repeat = keyEvent->GetRepeatCount();
-                keyEvent->SetRepeatCount(1);
+                repeat = keyEvent.wRepeatCount;
+                keyEvent.wRepeatCount = 1;
             }
 
             if (Unicode)
             {
                 do
                 {
-                    OutEvents.push_back(std::make_unique<KeyEvent>(*keyEvent));
+                    put(record);
                     repeat--;
-                } while (repeat > 0 && OutEvents.size() < AmountToRead);
+                } while (repeat > 0 && !target.empty());
             }
             else
             {
-                const auto wch = keyEvent->GetCharData();
+                const auto wch = keyEvent.uChar.UnicodeChar;
 
                 char buffer[8];
                 const auto length = WideCharToMultiByte(cp, 0, &wch, 1, &buffer[0], sizeof(buffer), nullptr, nullptr);
@@ -453,37 +505,30 @@ try
                 {
                     for (const auto& ch : str)
                     {
-                        auto tempEvent = std::make_unique<KeyEvent>(*keyEvent);
-                        tempEvent->SetCharData(ch);
-                        OutEvents.push_back(std::move(tempEvent));
+                        // Same as KeyEvent::SetCharData(char): Avoid sign-extending negative chars.
+                        keyEvent.uChar.UnicodeChar = til::as_unsigned(ch);
+                        put(record);
                     }
                     repeat--;
-                } while (repeat > 0 && OutEvents.size() < AmountToRead);
+                } while (repeat > 0 && !target.empty());
             }
 
             if (repeat && !Peek)
             {
-                const auto originalKeyEvent = static_cast<KeyEvent*>((*it).get());
-                originalKeyEvent->SetRepeatCount(repeat);
+                stored.Event.KeyEvent.wRepeatCount = repeat;
                 break;
             }
         }
-        else
-        {
-            OutEvents.push_back(std::move(event));
-        }
-
-        ++it;
     }
 
     if (!Peek)
     {
-        _storage.erase(_storage.begin(), it);
+        _consumeRecords(consumed);
     }
 
-    Cache(Unicode, OutEvents, AmountToRead);
+    RecordsRead = OutRecords.size() - target.size();
 
-    if (OutEvents.empty())
+    if (RecordsRead == 0)
     {
         return WaitForData ? CONSOLE_STATUS_WAIT : STATUS_SUCCESS;
     }
@@ -498,6 +543,48 @@ catch (...)
     return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
 }
 
+// Routine Description:
+// - This routine reads from the input buffer.
+// - Same as the INPUT_RECORD based overload, but returns the events as IInputEvent instances.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - OutEvents - deque to store the read events
+// - AmountToRead - the amount of events to try to read
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. AmountToRead must be 1 if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
+                                         const size_t AmountToRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+try
+{
+    assert(OutEvents.empty());
+
+    std::vector<INPUT_RECORD> records(AmountToRead);
+    size_t recordsRead = 0;
+    const auto Status = Read(records, recordsRead, Peek, WaitForData, Unicode, Stream);
+
+    for (size_t i = 0; i < recordsRead; ++i)
+    {
+        OutEvents.push_back(IInputEvent::Create(records[i]));
+    }
+
+    return Status;
+}
+catch (...)
+{
+    return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+}
+
 // Routine Description:
 // - This routine reads a single event from the input buffer.
 // - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
@@ -523,16 +610,17 @@ catch (...)
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
-                      1,
+        INPUT_RECORD record{};
+        size_t recordsRead = 0;
+        Status = Read({ &record, 1 },
+                      recordsRead,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (recordsRead != 0)
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(record);
         }
     }
     catch (...)
@@ -546,46 +634,53 @@ catch (...)
 // Routine Description:
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
-// - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
+// - inRecords - events to write to buffer.
 // Return Value:
-// S_OK if successful.
+// - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Prepend(std::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+
+        // Only the incoming records may suspend/resume the console. The records that are already
+        // queued were typed before and must not be consumed when they're written back below.
+        std::vector<INPUT_RECORD> filtered;
+        inRecords = _HandleConsoleSuspensionEvents(inRecords, filtered);
+        if (inRecords.empty())
         {
-            return STATUS_SUCCESS;
+            return 0;
         }
+
         // read all of the records out of the buffer, then write the
         // prepend ones, then write the original set. We need to do it
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
+        std::vector<INPUT_RECORD> existingStorage;
         existingStorage.swap(_storage);
+        const auto existingRecords = std::span<const INPUT_RECORD>{ existingStorage }.subspan(std::exchange(_storageBegin, 0));
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
-        // Then after the second one, because we've inserted some input, it will always say false.
+        // However, because we swapped the storage out from under it with an empty vector, its result
+        // is meaningless here. See below for how we determine whether to set the wait event instead.
         auto unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(unusedWaitStatus));
+        _WriteBuffer(inRecords, prependEventsWritten, unusedWaitStatus);
 
         // write all previously existing records
         size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(!unusedWaitStatus));
+        _WriteBuffer(existingRecords, existingEventsWritten, unusedWaitStatus);
+
+        if (prependEventsWritten == 0)
+        {
+            return 0;
+        }
 
         // We need to set the wait event if there were 0 events in the
         // input queue when we started.
@@ -594,7 +689,7 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // and instead need to set the event if the original backing
         // buffer (the one we swapped out at the top) was empty
         // when this whole thing started.
-        if (existingStorage.empty())
+        if (existingRecords.empty())
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
         }
@@ -610,23 +705,20 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 }
 
 // Routine Description:
-// - Writes event to the input buffer. Wakes up any readers that are
-// waiting for additional input events.
+// -  Writes events to the beginning of the input buffer.
 // Arguments:
-// - inEvent - input event to store in the buffer.
+// - inEvents - events to write to buffer.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-// - any outside references to inEvent will ben invalidated after
-// calling this method.
-size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
+size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(inRecords);
     }
     catch (...)
     {
@@ -635,23 +727,44 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
     }
 }
 
+// Routine Description:
+// - Writes event to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inRecord - input event to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const INPUT_RECORD& inRecord)
+{
+    return Write(std::span{ &inRecord, 1 });
+}
+
 // Routine Description:
 // - Writes events to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inRecords - input events to store in the buffer.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Write(std::span<const INPUT_RECORD> inRecords)
 {
     try
     {
+        if (inRecords.empty())
+        {
+            return 0;
+        }
+
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+
+        std::vector<INPUT_RECORD> filtered;
+        inRecords = _HandleConsoleSuspensionEvents(inRecords, filtered);
+        if (inRecords.empty())
         {
             return 0;
         }
@@ -659,7 +772,12 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(inRecords, EventsWritten, SetWaitEvent);
+
+        if (EventsWritten == 0)
+        {
+            return 0;
+        }
 
         if (SetWaitEvent)
         {
@@ -677,6 +795,54 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
     }
 }
 
+// Routine Description:
+// - Writes event to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inEvent - input event to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+// - any outside references to inEvent will ben invalidated after
+// calling this method.
+size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
+{
+    try
+    {
+        return Write(inEvent->ToInputRecord());
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes events to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inEvents - input events to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(inRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
 // This can be considered a "privileged" variant of Write() which allows FOCUS_EVENTs to generate focus VT sequences.
 // If we didn't do this, someone could write a FOCUS_EVENT_RECORD with WriteConsoleInput, exit without flushing the
 // input buffer and the next application will suddenly get a "\x1b[I" sequence in their input. See GH#13238.
@@ -693,7 +859,7 @@ void InputBuffer::WriteFocusEvent(bool focused) noexcept
     {
         // This is a mini-version of Write().
         const auto wasEmpty = _storage.empty();
-        _storage.push_back(std::make_unique<FocusEvent>(focused));
+        _storage.push_back(FocusEvent{ focused }.ToInputRecord());
         if (wasEmpty)
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
@@ -746,28 +912,31 @@ bool InputBuffer::WriteMouseEvent(til::point position, const unsigned int button
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(std::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const auto initiallyEmptyQueue = _storage.empty();
-    const auto initialInEventsSize = inEvents.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    // we only check for possible coalescing when storing one
+    // record at a time because this is the original behavior of
+    // the input buffer. Changing this behavior may break stuff
+    // that was depending on it.
+    const auto coalesce = inRecords.size() == 1;
+
+    for (const auto& inRecord : inRecords)
     {
-        // Pop the next event.
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
         // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
         // If it's not coalesced, append it to the buffer.
-        auto inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        if (vtInputMode && inRecord.EventType == KEY_EVENT)
         {
-            if (const auto out = _termInput.HandleKey(inEvent.get()))
+            const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+            if (const auto out = _termInput.HandleKey(&keyEvent))
             {
                 _HandleTerminalInputCallback(*out);
                 eventsWritten++;
@@ -775,46 +944,16 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
             }
         }
 
-        // we only check for possible coalescing when storing one
-        // record at a time because this is the original behavior of
-        // the input buffer. Changing this behavior may break stuff
-        // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
+        // this looks kinda weird but we don't want to coalesce a
+        // mouse event and then try to coalesce a key event right after.
+        if (coalesce && !_storage.empty() && (_CoalesceMouseMovedEvents(inRecord) || _CoalesceRepeatedKeyPressEvents(inRecord)))
         {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            auto coalesced = false;
-            // this looks kinda weird but we don't want to coalesce a
-            // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
-            {
-                eventsWritten = 1;
-                return;
-            }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
+            eventsWritten = 1;
+            return;
         }
+
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
+        _storage.push_back(inRecord);
         ++eventsWritten;
     }
     if (initiallyEmptyQueue && !_storage.empty())
@@ -824,44 +963,30 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved event and inRecord are both MOUSE_MOVED
+// events. If they are, the last saved event is updated with the new
+// mouse position in place.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
     {
-        const auto pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const auto pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            const auto pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+        // update mouse moved position
+        lastRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
@@ -892,44 +1017,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input event saved and inRecord are both a keypress down
+// event for the same key, update the repeat count of the saved event in place.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastRecord.EventType == KEY_EVENT)
     {
-        const auto pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const auto pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
+        const KeyEvent inKeyEvent{ inRecord.Event.KeyEvent };
+        const KeyEvent lastKeyEvent{ lastRecord.Event.KeyEvent };
 
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+        if (inKeyEvent.IsKeyDown() &&
+            lastKeyEvent.IsKeyDown() &&
+            !IsGlyphFullWidth(inKeyEvent.GetCharData()) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            const auto pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            WORD repeatCount = lastKeyEvent.GetRepeatCount() + inKeyEvent.GetRepeatCount();
+            lastRecord.Event.KeyEvent.wRepeatCount = repeatCount;
             return true;
         }
     }
@@ -937,44 +1053,76 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 }
 
 // Routine Description:
-// - Handles records that suspend/resume the console.
+// - Removes the records that suspend/resume the console from inRecords.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - The records to filter.
+// - filtered - Receives a copy of the remaining records, if any records were removed.
 // Return Value:
-// - None
+// - inRecords if none of them suspend/resume the console, and otherwise `filtered`.
+//   This way writing input usually doesn't need to copy the records.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+std::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const std::span<const INPUT_RECORD> inRecords, std::vector<INPUT_RECORD>& filtered)
 {
-    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto end = inRecords.end();
+    auto it = inRecords.begin();
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    for (; it != end; ++it)
     {
-        auto currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        if (_IsConsoleSuspensionEvent(*it))
         {
-            const auto pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
-            {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
-            }
+            break;
+        }
+    }
+
+    if (it == end)
+    {
+        return inRecords;
+    }
+
+    filtered.assign(inRecords.begin(), it);
+    for (++it; it != end; ++it)
+    {
+        if (!_IsConsoleSuspensionEvent(*it))
+        {
+            filtered.push_back(*it);
+        }
+    }
+    return filtered;
+}
+
+// Routine Description:
+// - Consumes key presses that suspend/resume the console: While the console is suspended, any
+//   non-system key press unblocks the suspended console output (UnblockWriteConsole()). Otherwise, in
+//   line input mode, the Pause key suspends the console. Either way the key press is swallowed.
+// Arguments:
+// - inRecord - The record to check.
+// Return Value:
+// - true if the record was consumed and must not be stored.
+// Note:
+// - The console lock must be held when calling this routine.
+// - will throw exception on error
+bool InputBuffer::_IsConsoleSuspensionEvent(const INPUT_RECORD& inRecord)
+{
+    if (inRecord.EventType == KEY_EVENT && inRecord.Event.KeyEvent.bKeyDown)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+
+        if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+            !IsSystemKey(keyEvent.GetVirtualKeyCode()))
+        {
+            UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+            return true;
+        }
+        else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && keyEvent.IsPauseKey())
+        {
+            WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+            return true;
         }
-        outEvents.push_back(std::move(currEvent));
     }
-    inEvents.swap(outEvents);
+    return false;
 }
 
 // Routine Description:
@@ -1006,7 +1154,7 @@ void InputBuffer::_HandleTerminalInputCallback(const TerminalInput::StringType&
 
         for (const auto& wch : text)
         {
-            _storage.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
+            _storage.push_back(KeyEvent{ true, 1ui16, 0ui16, 0ui16, wch, 0 }.ToInputRecord());
         }
 
         if (!_vtInputShouldSuppress)
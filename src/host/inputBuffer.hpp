@@ -47,9 +47,9 @@ public:
     void ConsumeCached(bool isUnicode, std::span<char>& target);
     void Cache(std::wstring_view source);
     // INPUT_RECORD oriented APIs
-    size_t ConsumeCached(bool isUnicode, size_t count, InputEventQueue& target);
-    size_t PeekCached(bool isUnicode, size_t count, InputEventQueue& target);
-    void Cache(bool isUnicode, InputEventQueue& source, size_t expectedSourceSize);
+    void ConsumeCached(bool isUnicode, std::span<INPUT_RECORD>& target);
+    void PeekCached(bool isUnicode, std::span<INPUT_RECORD>& target);
+    void Cache(bool isUnicode, std::span<const INPUT_RECORD> source);
 
     // storage API for partial dbcs bytes being written to the buffer
     bool IsWritePartialByteSequenceAvailable();
@@ -63,6 +63,13 @@ public:
     void Flush();
     void FlushAllButKeys();
 
+    [[nodiscard]] NTSTATUS Read(std::span<INPUT_RECORD> OutRecords,
+                                _Out_ size_t& RecordsRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     [[nodiscard]] NTSTATUS Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEvents,
                                 const size_t AmountToRead,
                                 const bool Peek,
@@ -76,8 +83,11 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    size_t Prepend(std::span<const INPUT_RECORD> inRecords);
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
+    size_t Write(const INPUT_RECORD& inRecord);
+    size_t Write(std::span<const INPUT_RECORD> inRecords);
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
@@ -102,10 +112,17 @@ private:
     std::string_view _cachedTextReaderA;
     std::wstring _cachedTextW;
     std::wstring_view _cachedTextReaderW;
-    std::deque<std::unique_ptr<IInputEvent>> _cachedInputEvents;
+    std::vector<INPUT_RECORD> _cachedInputEvents;
+    std::span<const INPUT_RECORD> _cachedInputEventsReader;
     ReadingMode _readingMode = ReadingMode::StringA;
 
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    // The queued input events are stored by value in _storage[_storageBegin..].
+    // Reading only advances _storageBegin and the consumed head of the vector is
+    // discarded lazily (see _consumeRecords), which makes this an allocation-free
+    // queue once the vector has grown to its working size. _storage is kept empty
+    // whenever there are no unread records, so _storage.empty() can be used as is.
+    std::vector<INPUT_RECORD> _storage;
+    size_t _storageBegin = 0;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
     Microsoft::Console::Render::VtEngine* _pTtyConnection;
@@ -119,14 +136,18 @@ private:
     void _switchReadingMode(ReadingMode mode);
     void _switchReadingModeSlowPath(ReadingMode mode);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    std::span<INPUT_RECORD> _pendingRecords() noexcept;
+    void _consumeRecords(size_t count) noexcept;
+
+    void _WriteBuffer(std::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
     bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord);
+    std::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(std::span<const INPUT_RECORD> inRecords, std::vector<INPUT_RECORD>& filtered);
+    bool _IsConsoleSuspensionEvent(const INPUT_RECORD& inRecord);
 
     void _HandleTerminalInputCallback(const Microsoft::Console::VirtualTerminal::TerminalInput::StringType& text);
 
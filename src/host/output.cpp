@@ -84,9 +84,20 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         const auto verticalCopyOnly = source.Left() == 0 && targetOrigin.x == 0;
         if (sourceFullRows && verticalCopyOnly)
         {
+            auto& textBuffer = screenInfo.GetTextBuffer();
             const auto delta = targetOrigin.y - source.Top();
 
-            screenInfo.GetTextBuffer().ScrollRows(source.Top(), source.Height(), delta);
+            textBuffer.ScrollRows(source.Top(), source.Height(), delta);
+
+            // ScrollRows() moves the rows that were scrolled over into the vacated part of the source.
+            // This is a copy however and the caller may not fill all of it (e.g. due to a clip rect),
+            // so we copy the original rows back, which are now found at `delta` distance.
+            const auto vacatedTop = delta < 0 ? std::max(source.Top(), source.BottomExclusive() + delta) : source.Top();
+            const auto vacatedBottom = delta < 0 ? source.BottomExclusive() : std::min(source.BottomExclusive(), source.Top() + delta);
+            for (auto y = vacatedTop; y < vacatedBottom; ++y)
+            {
+                textBuffer.GetRowByOffset(y).CopyFrom(textBuffer.GetRowByOffset(y + delta));
+            }
 
             return;
         }
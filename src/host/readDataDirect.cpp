@@ -46,9 +46,8 @@ DirectReadData::DirectReadData(_In_ InputBuffer* const pInputBuffer,
 // - pNumBytes - not used
 // - pControlKeyState - For certain types of reads, this specifies
 // which modifier keys were held.
-// - pOutputData - a pointer to a
-// std::deque<std::unique_ptr<IInputEvent>> that is used to the read
-// input events back to the server
+// - pOutputData - a pointer to a std::vector<INPUT_RECORD>
+// that is used to the read input events back to the server
 // Return Value:
 // - true if the wait is done and result buffer/status code can be sent back to the client.
 // - false if we need to continue to wait until more data is available.
@@ -69,8 +68,6 @@ try
     *pControlKeyState = 0;
     *pNumBytes = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
-
     // If ctrl-c or ctrl-break was seen, ignore it.
     if (WI_IsAnyFlagSet(TerminationReason, (WaitTerminationReason::CtrlC | WaitTerminationReason::CtrlBreak)))
     {
@@ -99,15 +96,11 @@ try
     // thread or a write routine.  both of these callers grab the
     // current console lock.
 
-    size_t amountToRead;
-    if (FAILED(SizeTSub(_eventReadCount, _outEvents.size(), &amountToRead)))
-    {
-        *pReplyStatus = STATUS_INTEGER_OVERFLOW;
-        return true;
-    }
+    std::vector<INPUT_RECORD> records(_eventReadCount);
+    size_t recordsRead = 0;
 
-    *pReplyStatus = _pInputBuffer->Read(_outEvents,
-                                        amountToRead,
+    *pReplyStatus = _pInputBuffer->Read(records,
+                                        recordsRead,
                                         false,
                                         false,
                                         fIsUnicode,
@@ -119,9 +112,10 @@ try
     }
 
     // move events to pOutputData
-    const auto pOutputDeque = static_cast<std::deque<std::unique_ptr<IInputEvent>>* const>(pOutputData);
-    *pNumBytes = _outEvents.size() * sizeof(INPUT_RECORD);
-    *pOutputDeque = std::move(_outEvents);
+    records.resize(recordsRead);
+    const auto pOutputRecords = static_cast<std::vector<INPUT_RECORD>* const>(pOutputData);
+    *pNumBytes = records.size() * sizeof(INPUT_RECORD);
+    *pOutputRecords = std::move(records);
 
     return true;
 }
@@ -24,9 +24,6 @@ Revision History:
 #pragma once
 
 #include "readData.hpp"
-#include "../types/inc/IInputEvent.hpp"
-#include <deque>
-#include <memory>
 
 class DirectReadData final : public ReadData
 {
@@ -47,5 +44,4 @@ public:
 
 private:
     const size_t _eventReadCount;
-    std::deque<std::unique_ptr<IInputEvent>> _outEvents;
 };
@@ -120,6 +120,13 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
                                                             pScreen->IsActiveScreenBuffer(),
                                                             *ServiceLocator::LocateGlobals().pRender);
 
+        // Encoding the scrollback far above the cursor is still experimental. Reflow() carries the
+        // setting over to the buffers that replace this one. Alternate buffers have no scrollback.
+        if constexpr (Feature_ColdScrollback::IsEnabled())
+        {
+            pScreen->_textBuffer->SetHotRowCount(TextBuffer::RecommendedHotRowCount);
+        }
+
         const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         pScreen->_textBuffer->GetCursor().SetType(gci.GetCursorType());
 
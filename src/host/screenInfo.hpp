@@ -173,6 +173,11 @@ public:
     BYTE WriteConsoleDbcsLeadByte[2];
     BYTE FillOutDbcsLeadChar;
 
+    // WriteConsoleA converts into this buffer. It only ever grows, so that
+    // steady-state writes don't allocate while holding the console lock.
+    std::wstring WriteConsoleAConversionBuffer;
+    til::u8state WriteConsoleAUtf8State;
+
     // non ownership pointer
     ConversionAreaInfo* ConvScreenInfo;
 
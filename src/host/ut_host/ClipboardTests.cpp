@@ -83,7 +83,7 @@ class ClipboardTests
         selection.emplace_back(til::inclusive_rect{ 0, 3, 8, 3 });
 
         const auto& buffer = screenInfo.GetTextBuffer();
-        return buffer.GetText(true, fLineSelection, selection).text;
+        return buffer.GetText(true, fLineSelection, selection);
     }
 
 #pragma prefast(push)
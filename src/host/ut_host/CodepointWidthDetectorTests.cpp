@@ -50,6 +50,48 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(CanGetWidthsInBatches)
+    {
+        CodepointWidthDetector widthDetector;
+
+        // ASCII, ambiguous, wide, a surrogate pair, an unpaired surrogate and a wide glyph again.
+        static constexpr std::wstring_view text{ L"a\x414\x306A\xD83D\xDC7E\xD83Dz\x72D7" };
+        static constexpr std::array<uint8_t, 8> expected{ 1, 1, 2, 2, 0, 1, 1, 2 };
+
+        std::array<uint8_t, 8> widths{};
+        widthDetector.GetWidths(text, widths);
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i], widths[i]);
+        }
+
+        for (const auto& data : testData)
+        {
+            const auto& wstr = std::get<1>(data);
+            widthDetector.GetWidths(wstr, widths);
+            VERIFY_ARE_EQUAL(WI_EnumValue(std::get<2>(data)), widths[0]);
+        }
+    }
+
+    TEST_METHOD(NarrowPrefixLength)
+    {
+        CodepointWidthDetector widthDetector;
+
+        // Long enough to cover both the vectorized and the scalar loop.
+        std::wstring text(37, L'\x414');
+        text[2] = L'a';
+        VERIFY_ARE_EQUAL(37u, widthDetector.NarrowPrefixLength(text));
+        text[21] = L'\x1104';
+        VERIFY_ARE_EQUAL(21u, widthDetector.NarrowPrefixLength(text));
+        text[3] = L'\xD83D';
+        VERIFY_ARE_EQUAL(3u, widthDetector.NarrowPrefixLength(text));
+
+        // With a fallback method ambiguous glyphs may be wide and can't be skipped anymore.
+        widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
+        VERIFY_ARE_EQUAL(2u, widthDetector.NarrowPrefixLength(L"ab\x414"));
+        VERIFY_ARE_EQUAL(0u, widthDetector.NarrowPrefixLength(L""));
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
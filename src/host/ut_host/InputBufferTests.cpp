@@ -78,7 +78,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +98,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +121,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const auto pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().x, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const auto& mouseEvent = inputBuffer._storage.front().Event.MouseEvent;
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +161,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +220,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +238,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -593,26 +592,53 @@ class InputBufferTests
                                            false));
     }
 
+    TEST_METHOD(PrependingWhilePausedKeepsQueuedKeys)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        InputBuffer inputBuffer;
+
+        // queue up some keys, which nobody reads yet
+        INPUT_RECORD records[3];
+        for (unsigned int i = 0; i < std::size(records); ++i)
+        {
+            records[i] = MakeKeyEvent(true, 1, static_cast<WCHAR>(L'a' + i), 0, static_cast<WCHAR>(L'a' + i), 0);
+        }
+        VERIFY_ARE_EQUAL(std::size(records), inputBuffer.Write(records));
+
+        // pause the screen
+        auto pauseRecord = MakeKeyEvent(true, 1, VK_PAUSE, 0, 0, 0);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(pauseRecord), 0u);
+        VERIFY_IS_TRUE(WI_IsFlagSet(gci.Flags, CONSOLE_OUTPUT_SUSPENDED));
+
+        // prepending a record must not treat the already queued keys as
+        // key presses that unpause the console, which would discard them
+        auto systemRecord = MakeKeyEvent(true, 1, VK_CONTROL, 0, 0, 0);
+        VERIFY_ARE_EQUAL(inputBuffer.Prepend(std::span{ &systemRecord, 1 }), 1u);
+        VERIFY_IS_TRUE(WI_IsFlagSet(gci.Flags, CONSOLE_OUTPUT_SUSPENDED));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+
+        // unpause again, discarding the key press
+        auto unpauseRecord = MakeKeyEvent(true, 1, L'z', 0, L'z', 0);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(unpauseRecord), 0u);
+        VERIFY_IS_FALSE(WI_IsFlagSet(gci.Flags, CONSOLE_OUTPUT_SUSPENDED));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 4u);
+    }
+
     TEST_METHOD(WritingToEmptyBufferSignalsWaitEvent)
     {
         InputBuffer inputBuffer;
         auto record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        auto inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         auto waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         auto record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        auto inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -632,8 +658,8 @@ class InputBufferTests
                                            true,
                                            true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
-        VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer._pendingRecords().front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -652,8 +678,55 @@ class InputBufferTests
                                            true,
                                            true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
-        VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer._pendingRecords().front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(CanWriteAndReadRecordsInBulk)
+    {
+        InputBuffer inputBuffer;
+
+        std::vector<INPUT_RECORD> inRecords;
+        for (WORD i = 0; i < 100; ++i)
+        {
+            inRecords.push_back(MakeKeyEvent(TRUE, 1, static_cast<WORD>(L'A' + i % 26), 0, static_cast<WCHAR>(L'0' + i), 0));
+        }
+
+        // Interleave writes and partial reads, so that the storage has to move
+        // the unread records to the front at least once while they're pending.
+        std::vector<INPUT_RECORD> outRecords;
+        std::array<INPUT_RECORD, 30> buffer{};
+        size_t recordsRead = 0;
+
+        VERIFY_ARE_EQUAL(inputBuffer.Write(std::span{ inRecords }.subspan(0, 50)), 50u);
+
+        VERIFY_NT_SUCCESS(inputBuffer.Read(buffer, recordsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, buffer.size());
+        outRecords.insert(outRecords.end(), buffer.begin(), buffer.begin() + recordsRead);
+
+        VERIFY_ARE_EQUAL(inputBuffer.Write(std::span{ inRecords }.subspan(50)), 50u);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 70u);
+
+        // Peeking must not consume anything.
+        VERIFY_NT_SUCCESS(inputBuffer.Read(buffer, recordsRead, true, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, buffer.size());
+        VERIFY_ARE_EQUAL(buffer[0], inRecords[30]);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 70u);
+
+        while (inputBuffer.GetNumberOfReadyEvents() != 0)
+        {
+            VERIFY_NT_SUCCESS(inputBuffer.Read(buffer, recordsRead, false, false, true, false));
+            outRecords.insert(outRecords.end(), buffer.begin(), buffer.begin() + recordsRead);
+        }
+
+        VERIFY_ARE_EQUAL(outRecords.size(), inRecords.size());
+        for (size_t i = 0; i < inRecords.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
+        }
+
+        VERIFY_ARE_EQUAL(inputBuffer.Read(buffer, recordsRead, false, true, true, false), CONSOLE_STATUS_WAIT);
+        VERIFY_ARE_EQUAL(recordsRead, 0u);
+    }
 };
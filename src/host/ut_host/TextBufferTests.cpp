@@ -141,6 +141,9 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsMovesRowStorage);
+    TEST_METHOD(GenerationTracksChanges);
+    TEST_METHOD(ColdScrollback);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -158,9 +161,20 @@ class TextBufferTests
 
     TEST_METHOD(GetTextRects);
     TEST_METHOD(GetText);
+    TEST_METHOD(SerializeSelection);
+    TEST_METHOD(GetTextRange);
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+    TEST_METHOD(HyperlinkRefCounting);
+    TEST_METHOD(HyperlinkReflowPruning);
+
+    TEST_METHOD(GetPatterns);
+
+    TEST_METHOD(SearchText);
+    TEST_METHOD(WriteGraphemeClusters);
+    TEST_METHOD(WriteCharInfos);
+    TEST_METHOD(ReadCharInfos);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -1906,6 +1920,192 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that ScrollRows moves the rows in a region along with their attributes and flags,
+// and that the rows that were scrolled over end up in the vacated rows.
+void TextBufferTests::ScrollRowsMovesRowStorage()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // Mark every row with a letter, a color and a wrap flag derived from its original index.
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        auto& row = _buffer->GetRowByOffset(y);
+        row.ReplaceCharacters(0, 1, std::wstring(1, gsl::narrow_cast<wchar_t>(L'A' + y)));
+        row.SetAttrToEnd(0, TextAttribute{ gsl::narrow_cast<WORD>(y) });
+        row.SetWrapForced(y % 2 != 0);
+    }
+
+    const auto verifyRows = [&](std::initializer_list<til::CoordType> expected) {
+        til::CoordType y = 0;
+        for (const auto original : expected)
+        {
+            const auto& row = _buffer->GetRowByOffset(y);
+            VERIFY_ARE_EQUAL(gsl::narrow_cast<wchar_t>(L'A' + original), row.GlyphAt(0).front());
+            VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(original) }, row.GetAttrByColumn(0));
+            VERIFY_ARE_EQUAL(original % 2 != 0, row.WasWrapForced());
+            ++y;
+        }
+    };
+
+    Log::Comment(L"Scroll rows 2 to 6 up by one. Row 1 is scrolled over and ends up in row 6.");
+    _buffer->ScrollRows(2, 5, -1);
+    verifyRows({ 0, 2, 3, 4, 5, 6, 1, 7, 8, 9 });
+
+    Log::Comment(L"Scroll rows 1 to 5 down by two. Rows 6 and 7 end up in rows 1 and 2.");
+    _buffer->ScrollRows(1, 5, 2);
+    verifyRows({ 0, 1, 7, 2, 3, 4, 5, 6, 8, 9 });
+
+    Log::Comment(L"Scroll rows 0 and 1 down by five, past themselves. Rows 2 to 4 stay where they are.");
+    _buffer->ScrollRows(0, 2, 5);
+    verifyRows({ 4, 5, 7, 2, 3, 0, 1, 6, 8, 9 });
+}
+
+// This tests that the row generations and the change journal tell which rows changed since a given generation.
+void TextBufferTests::GenerationTracksChanges()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // Construct all rows up front, because constructing a row counts as a change.
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        std::ignore = _buffer->GetRowByOffset(y);
+    }
+    auto generation = _buffer->GetGeneration();
+
+    Log::Comment(L"Reading the buffer doesn't change anything.");
+    std::ignore = _buffer->GetRowByOffset(3).GetText();
+    VERIFY_ARE_EQUAL(generation, _buffer->GetGeneration());
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 0, bufferSize.height - 1));
+
+    Log::Comment(L"Writing into a row only marks that row as changed.");
+    _buffer->GetRowByOffset(3).ReplaceCharacters(0, 1, L"A");
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 3, 3));
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 0, 2));
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 4, bufferSize.height - 1));
+    generation = _buffer->GetGeneration();
+
+    Log::Comment(L"Changing the wrap flag or the attributes counts as a change, too.");
+    _buffer->GetRowByOffset(4).SetWrapForced(true);
+    _buffer->GetRowByOffset(5).SetAttrToEnd(10, TextAttribute{ 0x12 });
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 0, 3));
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 4, 4));
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 5, 5));
+    generation = _buffer->GetGeneration();
+
+    Log::Comment(L"ScrollRows marks the moved rows as changed.");
+    _buffer->ScrollRows(6, 2, 1);
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 0, 5));
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 6, 6));
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 7, 7));
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 8, 8));
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 9, 9));
+    generation = _buffer->GetGeneration();
+
+    Log::Comment(L"IncrementCircularBuffer is reported as scrolling.");
+    _buffer->IncrementCircularBuffer();
+    _buffer->IncrementCircularBuffer();
+    {
+        const auto changes = _buffer->GetChangesSince(generation);
+        VERIFY_IS_FALSE(changes.all);
+        VERIFY_ARE_EQUAL(2, changes.scrolled);
+    }
+    VERIFY_IS_TRUE(_buffer->HasChangedSince(generation, 0, 0));
+    generation = _buffer->GetGeneration();
+    {
+        const auto changes = _buffer->GetChangesSince(generation);
+        VERIFY_IS_FALSE(changes.all);
+        VERIFY_ARE_EQUAL(0, changes.scrolled);
+    }
+
+    Log::Comment(L"Reset and ResizeTraditional change everything.");
+    _buffer->Reset();
+    VERIFY_IS_TRUE(_buffer->GetChangesSince(generation).all);
+    generation = _buffer->GetGeneration();
+    VERIFY_SUCCEEDED(_buffer->ResizeTraditional({ 60, 10 }));
+    VERIFY_IS_TRUE(_buffer->GetChangesSince(generation).all);
+    generation = _buffer->GetGeneration();
+
+    Log::Comment(L"Falling behind by more than the journal holds changes everything.");
+    for (size_t i = 0; i <= TextBuffer::_journalCapacity; ++i)
+    {
+        _buffer->IncrementCircularBuffer();
+    }
+    VERIFY_IS_TRUE(_buffer->GetChangesSince(generation).all);
+    VERIFY_IS_FALSE(_buffer->GetChangesSince(_buffer->GetGeneration()).all);
+
+    Log::Comment(L"Generations from the future are treated as unknown.");
+    VERIFY_IS_TRUE(_buffer->GetChangesSince(_buffer->GetGeneration() + 1).all);
+}
+
+// This tests that rows far enough above the cursor get encoded as the buffer scrolls,
+// and that they're decoded into identical rows as soon as they're accessed again.
+void TextBufferTests::ColdScrollback()
+{
+    const til::size bufferSize{ 10, 1000 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    _buffer->SetHotRowCount(10);
+
+    const auto bottom = bufferSize.height - 1;
+    const auto rowText = [](int i) {
+        return fmt::format(L"{}\x304B", i);
+    };
+    const auto rowAttr = [](int i) {
+        return TextAttribute{ gsl::narrow_cast<WORD>(i % 16) };
+    };
+
+    Log::Comment(L"Swap the buffers of the blank rows around, which encoding the rows has to undo.");
+    _buffer->ScrollRows(0, 500, 300);
+
+    _buffer->GetCursor().SetPosition({ 0, bottom });
+    for (auto i = 0; i < 3000; ++i)
+    {
+        _buffer->WriteLine(OutputCellIterator{ rowText(i), rowAttr(i) }, { 0, bottom });
+        _buffer->GetRowByOffset(bottom).SetWrapForced(i % 3 == 0);
+        _buffer->IncrementCircularBuffer();
+    }
+
+    Log::Comment(L"Buffers don't encode rows unless they opted in.");
+    {
+        auto defaultBuffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+        defaultBuffer->GetCursor().SetPosition({ 0, bottom });
+        for (auto i = 0; i < 3000; ++i)
+        {
+            defaultBuffer->WriteLine(OutputCellIterator{ rowText(i), rowAttr(i) }, { 0, bottom });
+            defaultBuffer->IncrementCircularBuffer();
+        }
+        VERIFY_ARE_EQUAL(0, defaultBuffer->GetMemoryUsage().coldRows);
+    }
+
+    const auto usage = _buffer->GetMemoryUsage();
+    VERIFY_IS_GREATER_THAN(usage.coldRows, 0);
+    VERIFY_IS_GREATER_THAN(usage.cold, size_t{ 0 });
+
+    Log::Comment(L"Decoding rows doesn't count as a change.");
+    const auto generation = _buffer->GetGeneration();
+
+    for (til::CoordType y = 0; y < bottom; ++y)
+    {
+        const auto i = 3000 - bottom + y;
+        const auto text = rowText(i);
+        const auto& row = _buffer->GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(text, std::wstring{ row.GetText().substr(0, text.size()) });
+        VERIFY_IS_TRUE(row.DbcsAttrAt(gsl::narrow_cast<til::CoordType>(text.size())) == DbcsAttribute::Trailing);
+        VERIFY_ARE_EQUAL(rowAttr(i), row.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(i % 3 == 0, row.WasWrapForced());
+    }
+
+    VERIFY_IS_FALSE(_buffer->HasChangedSince(generation, 0, bottom - 1));
+    VERIFY_ARE_EQUAL(0, _buffer->GetMemoryUsage().coldRows);
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -2127,31 +2327,31 @@ void TextBufferTests::TestRowReplaceText()
 void TextBufferTests::TestAppendRTFText()
 {
     {
-        std::ostringstream contentStream;
+        std::string content;
         const auto ascii = L"This is some Ascii \\ {}";
-        TextBuffer::_AppendRTFText(contentStream, ascii);
-        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", contentStream.str());
+        TextBuffer::_AppendRTFText(content, ascii);
+        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", content);
     }
     {
-        std::ostringstream contentStream;
+        std::string content;
         // "Low code units: á é í ó ú ⮁ ⮂" in UTF-16
         const auto lowCodeUnits = L"Low code units: \x00E1 \x00E9 \x00ED \x00F3 \x00FA \x2B81 \x2B82";
-        TextBuffer::_AppendRTFText(contentStream, lowCodeUnits);
-        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", contentStream.str());
+        TextBuffer::_AppendRTFText(content, lowCodeUnits);
+        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", content);
     }
     {
-        std::ostringstream contentStream;
+        std::string content;
         // "High code units: ꞵ ꞷ" in UTF-16
         const auto highCodeUnits = L"High code units: \xA7B5 \xA7B7";
-        TextBuffer::_AppendRTFText(contentStream, highCodeUnits);
-        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", contentStream.str());
+        TextBuffer::_AppendRTFText(content, highCodeUnits);
+        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", content);
     }
     {
-        std::ostringstream contentStream;
+        std::string content;
         // "Surrogates: 🍦 👾 👀" in UTF-16
         const auto surrogates = L"Surrogates: \xD83C\xDF66 \xD83D\xDC7E \xD83D\xDC40";
-        TextBuffer::_AppendRTFText(contentStream, surrogates);
-        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", contentStream.str());
+        TextBuffer::_AppendRTFText(content, surrogates);
+        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", content);
     }
 }
 
@@ -2528,7 +2728,7 @@ void TextBufferTests::GetText()
         const auto textRects = _buffer->GetTextRects({ 0, 0 }, { 4, 4 }, blockSelection, false);
 
         std::wstring result = L"";
-        const auto textData = _buffer->GetText(includeCRLF, trimTrailingWhitespace, textRects).text;
+        const auto textData = _buffer->GetText(includeCRLF, trimTrailingWhitespace, textRects);
         for (auto& text : textData)
         {
             result += text;
@@ -2631,7 +2831,7 @@ void TextBufferTests::GetText()
         std::wstring result = L"";
 
         const auto formatWrappedRows = blockSelection;
-        const auto textData = _buffer->GetText(includeCRLF, trimTrailingWhitespace, textRects, nullptr, formatWrappedRows).text;
+        const auto textData = _buffer->GetText(includeCRLF, trimTrailingWhitespace, textRects, formatWrappedRows);
         for (auto& text : textData)
         {
             result += text;
@@ -2735,6 +2935,91 @@ void TextBufferTests::GetText()
     }
 }
 
+// This tests that SerializeSelection produces the same text as GetText and
+// HTML and RTF with one color change per attribute run, even across rows.
+void TextBufferTests::SerializeSelection()
+{
+    const til::size bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const TextAttribute green{ 0x0A };
+    const TextAttribute red{ 0x0C };
+    _buffer->WriteLine(OutputCellIterator{ L"a<b", green }, { 0, 0 });
+    _buffer->WriteLine(OutputCellIterator{ L"cd", red }, { 3, 0 });
+    _buffer->WriteLine(OutputCellIterator{ L"ef", red }, { 0, 1 });
+
+    TextBuffer::ClipboardFormatting formatting;
+    formatting.GetAttributeColors = [&](const TextAttribute& attr) {
+        return std::pair{ attr == green ? RGB(0, 255, 0) : RGB(255, 0, 0), RGB(0, 0, 0) };
+    };
+    formatting.fontHeightPoints = 12;
+    formatting.fontFaceName = L"Cascadia Mono";
+    formatting.html = true;
+    formatting.rtf = true;
+
+    const std::vector<til::inclusive_rect> rects{ { 0, 0, 9, 0 }, { 0, 1, 9, 1 } };
+    const auto data = _buffer->SerializeSelection(true, true, rects, formatting);
+
+    VERIFY_ARE_EQUAL(L"a<bcd\r\nef", data.text);
+    VERIFY_ARE_EQUAL(L"a<bcd\r\n", _buffer->GetText(true, true, rects).at(0));
+
+    const auto count = [](const std::string& haystack, const std::string_view& needle) {
+        size_t n = 0;
+        for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1))
+        {
+            ++n;
+        }
+        return n;
+    };
+
+    VERIFY_IS_TRUE(data.html.starts_with("Version:0.9\r\nStartHTML:0000000157\r\n"));
+    VERIFY_ARE_EQUAL(size_t{ 2 }, count(data.html, "<SPAN "));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, data.html.find("<SPAN STYLE=\"color:#00FF00;background-color:#000000;\">a&lt;b</SPAN>"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, data.html.find("<SPAN STYLE=\"color:#FF0000;background-color:#000000;\">cd<BR>ef</SPAN>"));
+    VERIFY_IS_TRUE(data.html.ends_with("</SPAN></DIV><!--EndFragment --></BODY></HTML>"));
+
+    VERIFY_IS_TRUE(data.rtf.starts_with("{\\rtf1"));
+    VERIFY_ARE_EQUAL(size_t{ 2 }, count(data.rtf, "\\cf"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, data.rtf.find("{\\colortbl ;\\red0\\green0\\blue0;\\red0\\green255\\blue0;\\red255\\green0\\blue0;}"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, data.rtf.find("\\highlight1\\cf2 a<b\\highlight1\\cf3 cd\\line ef}"));
+}
+
+// This tests that GetTextRange produces the same text as GetTextRects + GetText,
+// for both line and block ranges, and that it stops once maxLength is reached.
+void TextBufferTests::GetTextRange()
+{
+    const til::size bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    _buffer->WriteLine(OutputCellIterator{ L"ab\x304Bcd", attr }, { 0, 0 });
+    _buffer->WriteLine(OutputCellIterator{ L"efghijklmn", attr }, { 0, 1 });
+    _buffer->WriteLine(OutputCellIterator{ L"op", attr }, { 0, 2 });
+    _buffer->GetMutableRowByOffset(1).SetWrapForced(true);
+
+    const auto expected = [&](const til::point start, const til::point end, const bool blockSelection) {
+        std::wstring text;
+        for (const auto& str : _buffer->GetText(true, false, _buffer->GetTextRects(start, end, blockSelection, true)))
+        {
+            text.append(str);
+        }
+        return text;
+    };
+
+    VERIFY_ARE_EQUAL(L"b\x304Bcd    \r\nefghijklmnop  ", _buffer->GetTextRange({ 1, 0 }, { 3, 2 }, false, SIZE_MAX));
+    VERIFY_ARE_EQUAL(expected({ 1, 0 }, { 3, 2 }, false), _buffer->GetTextRange({ 1, 0 }, { 3, 2 }, false, SIZE_MAX));
+    VERIFY_ARE_EQUAL(expected({ 1, 0 }, { 3, 2 }, false), _buffer->GetTextRange({ 3, 2 }, { 1, 0 }, false, SIZE_MAX));
+
+    // The block starts on the trailing half of the wide glyph, which must be expanded to include its leading half.
+    VERIFY_ARE_EQUAL(expected({ 3, 0 }, { 4, 2 }, true), _buffer->GetTextRange({ 3, 0 }, { 4, 2 }, true, SIZE_MAX));
+
+    VERIFY_ARE_EQUAL(L"b\x304Bcd", _buffer->GetTextRange({ 1, 0 }, { 3, 2 }, false, 4));
+    VERIFY_ARE_EQUAL(L"", _buffer->GetTextRange({ 1, 0 }, { 3, 2 }, false, 0));
+}
+
 // This tests that when we increment the circular buffer, obsolete hyperlink references
 // are removed from the hyperlink map
 void TextBufferTests::HyperlinkTrim()
@@ -2815,3 +3100,387 @@ void TextBufferTests::NoHyperlinkTrim()
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
     VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
 }
+
+// This tests that hyperlinks get removed from the map once they're overwritten,
+// even if the row they were in is not the one that gets scrolled out of view.
+void TextBufferTests::HyperlinkRefCounting()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    static constexpr std::wstring_view url{ L"test.url" };
+    static constexpr std::wstring_view otherUrl{ L"other.url" };
+
+    const auto id = _buffer->GetHyperlinkId(url, {});
+    TextAttribute linkAttr{ 0x7f };
+    linkAttr.SetHyperlinkId(id);
+    _buffer->AddHyperlinkToMap(url, id);
+
+    // Reference the hyperlink from two rows and overwrite it in both of them.
+    _buffer->GetRowByOffset(3).SetAttrToEnd(70, linkAttr);
+    _buffer->GetRowByOffset(5).ReplaceAttributes(10, 20, linkAttr);
+    VERIFY_ARE_EQUAL(2u, _buffer->_hyperlinkRefs->Count(id));
+
+    _buffer->GetRowByOffset(3).Reset(attr);
+    VERIFY_ARE_EQUAL(1u, _buffer->_hyperlinkRefs->Count(id));
+    _buffer->GetRowByOffset(5).SetAttrToEnd(0, attr);
+    VERIFY_ARE_EQUAL(0u, _buffer->_hyperlinkRefs->Count(id));
+
+    // The other hyperlink is still being used by the current attributes and must survive.
+    const auto otherId = _buffer->GetHyperlinkId(otherUrl, {});
+    TextAttribute otherLinkAttr{ 0x7f };
+    otherLinkAttr.SetHyperlinkId(otherId);
+    _buffer->AddHyperlinkToMap(otherUrl, otherId);
+    _buffer->SetCurrentAttributes(otherLinkAttr);
+    _buffer->GetRowByOffset(7).SetAttrToEnd(0, otherLinkAttr);
+    _buffer->GetRowByOffset(7).SetAttrToEnd(0, attr);
+
+    // Row 0 holds no hyperlinks, but scrolling should still clean up the map.
+    _buffer->IncrementCircularBuffer();
+
+    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap.find(id), _buffer->_hyperlinkMap.end());
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(otherId), otherUrl);
+}
+
+// This tests that the hyperlinks which a reflow copies over, but which none of the new rows reference, get removed from the map.
+void TextBufferTests::HyperlinkReflowPruning()
+{
+    const til::size bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer oldBuffer{ bufferSize, attr, cursorSize, false, _renderer };
+    TextBuffer newBuffer{ { 40, 10 }, attr, cursorSize, false, _renderer };
+
+    static constexpr std::wstring_view url{ L"test.url" };
+    static constexpr std::wstring_view otherUrl{ L"other.url" };
+
+    // The first hyperlink is written and overwritten again, before the old buffer got a chance to prune it.
+    const auto id = oldBuffer.GetHyperlinkId(url, {});
+    TextAttribute linkAttr{ 0x7f };
+    linkAttr.SetHyperlinkId(id);
+    oldBuffer.AddHyperlinkToMap(url, id);
+    oldBuffer.GetRowByOffset(0).SetAttrToEnd(0, linkAttr);
+    oldBuffer.GetRowByOffset(0).SetAttrToEnd(0, attr);
+
+    // The second one is still in use and must survive the reflow.
+    const auto otherId = oldBuffer.GetHyperlinkId(otherUrl, {});
+    TextAttribute otherLinkAttr{ 0x7f };
+    otherLinkAttr.SetHyperlinkId(otherId);
+    oldBuffer.AddHyperlinkToMap(otherUrl, otherId);
+    RowWriteState state{ .text = L"link" };
+    oldBuffer.Write(1, otherLinkAttr, state);
+
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt));
+    VERIFY_ARE_EQUAL(0u, newBuffer._hyperlinkRefs->Count(id));
+    VERIFY_ARE_EQUAL(1u, newBuffer._hyperlinkRefs->Count(otherId));
+
+    newBuffer.IncrementCircularBuffer();
+
+    VERIFY_ARE_EQUAL(newBuffer._hyperlinkMap.find(id), newBuffer._hyperlinkMap.end());
+    VERIFY_ARE_EQUAL(newBuffer.GetHyperlinkUriFromId(otherId), otherUrl);
+}
+
+void TextBufferTests::GetPatterns()
+{
+    const til::size bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto write = [&](til::CoordType y, std::wstring_view text, til::CoordType column = 0) {
+        RowWriteState state{ .text = text, .columnBegin = column };
+        _buffer->Write(y, attr, state);
+    };
+    const auto find = [&]() {
+        const auto patterns = _buffer->GetPatterns(0, bufferSize.height - 1);
+        auto results = patterns.findContained({ 0, 0 }, { 0, bufferSize.height });
+        std::sort(results.begin(), results.end(), [](const auto& a, const auto& b) { return a.start < b.start; });
+        return results;
+    };
+
+    const auto id = _buffer->AddPatternRecognizer(L"ab+c");
+
+    // - - - Text Buffer Contents - - -
+    // |\u304Babbc    | <-- the wide glyph shifts the match by 2 columns
+    // |      abbb     | <-- wrapped
+    // |c              | <-- ...and the match continues here
+    // |abc            |
+    // - - - - - - - - - - - - - - - -
+    write(0, L"\u304Babbc");
+    write(1, L"abbb", 6);
+    _buffer->GetRowByOffset(1).SetWrapForced(true);
+    write(2, L"c");
+    write(3, L"abc");
+
+    {
+        const auto results = find();
+        VERIFY_ARE_EQUAL(3u, results.size());
+        VERIFY_ARE_EQUAL(id, results[0].value);
+        VERIFY_ARE_EQUAL((til::point{ 2, 0 }), results[0].start);
+        VERIFY_ARE_EQUAL((til::point{ 6, 0 }), results[0].stop);
+        VERIFY_ARE_EQUAL((til::point{ 6, 1 }), results[1].start);
+        VERIFY_ARE_EQUAL((til::point{ 1, 2 }), results[1].stop);
+        VERIFY_ARE_EQUAL((til::point{ 0, 3 }), results[2].start);
+        VERIFY_ARE_EQUAL((til::point{ 3, 3 }), results[2].stop);
+    }
+
+    Log::Comment(L"Modifying a row must invalidate the cached matches for it.");
+    write(3, L"xyz");
+    {
+        const auto results = find();
+        VERIFY_ARE_EQUAL(2u, results.size());
+    }
+
+    Log::Comment(L"Rows that aren't joined by a forced wrap don't form a single match.");
+    _buffer->GetRowByOffset(1).SetWrapForced(false);
+    {
+        const auto results = find();
+        VERIFY_ARE_EQUAL(1u, results.size());
+    }
+
+    Log::Comment(L"Cached matches move up along with their rows when the buffer circles.");
+    write(4, L"abbc");
+    VERIFY_ARE_EQUAL(2u, find().size());
+    _buffer->IncrementCircularBuffer();
+    {
+        const auto results = find();
+        VERIFY_ARE_EQUAL(1u, results.size());
+        VERIFY_ARE_EQUAL((til::point{ 0, 3 }), results[0].start);
+        VERIFY_ARE_EQUAL((til::point{ 4, 3 }), results[0].stop);
+    }
+}
+
+void TextBufferTests::WriteGraphemeClusters()
+{
+    const til::size bufferSize{ 10, 2 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // "e" + combining acute accent, a family emoji (ZWJ sequence), a flag (pair of regional indicators) and a "x".
+    static constexpr std::wstring_view accent{ L"e\x0301" };
+    static constexpr std::wstring_view family{ L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67" };
+    static constexpr std::wstring_view flag{ L"\xD83C\xDDE9\xD83C\xDDEA" };
+    const auto text = fmt::format(L"{}{}{}x", accent, family, flag);
+
+    Log::Comment(L"By default each codepoint is stored in a cell of its own.");
+    RowWriteState codepointState{ .text = accent };
+    _buffer->Write(0, attr, codepointState);
+    VERIFY_ARE_EQUAL(2, codepointState.columnEnd);
+    VERIFY_ARE_EQUAL(L"e", _buffer->GetRowByOffset(0).GlyphAt(0));
+    VERIFY_ARE_EQUAL(L"\x0301", _buffer->GetRowByOffset(0).GlyphAt(1));
+    VERIFY_ARE_EQUAL(2, ROW::MeasureText(accent, 10, false));
+
+    Log::Comment(L"In grapheme cluster mode each cluster is stored in a single cell and the emoji take up 2 columns each.");
+    RowWriteState state{ .text = text, .graphemeClusters = true };
+    _buffer->Write(0, attr, state);
+
+    const auto& row = _buffer->GetRowByOffset(0);
+    VERIFY_IS_TRUE(state.text.empty());
+    VERIFY_ARE_EQUAL(6, state.columnEnd);
+    VERIFY_ARE_EQUAL(accent, row.GlyphAt(0));
+    VERIFY_ARE_EQUAL(family, row.GlyphAt(1));
+    VERIFY_ARE_EQUAL(family, row.GlyphAt(2));
+    VERIFY_ARE_EQUAL(flag, row.GlyphAt(3));
+    VERIFY_ARE_EQUAL(L"x", row.GlyphAt(5));
+
+    // A combining mark following the last column's ASCII character gets stored together with it.
+    RowWriteState wrapState{ .text = L"abcdefghij\x0301k", .columnLimit = 10, .graphemeClusters = true };
+    _buffer->Write(1, attr, wrapState);
+    VERIFY_ARE_EQUAL(L"k", wrapState.text);
+    VERIFY_ARE_EQUAL(L"j\x0301", _buffer->GetRowByOffset(1).GlyphAt(9));
+
+    Log::Comment(L"A narrow codepoint followed by VS16 is an emoji and takes up 2 columns, unless it's stored codepoint by codepoint.");
+    static constexpr std::wstring_view heart{ L"\x2764\xFE0F" };
+    static constexpr std::wstring_view smiley{ L"\x263A\xFE0F" };
+    const auto emoji = fmt::format(L"{}{}x", heart, smiley);
+    RowWriteState emojiState{ .text = emoji, .graphemeClusters = true };
+    _buffer->Write(1, attr, emojiState);
+    VERIFY_IS_TRUE(emojiState.text.empty());
+    VERIFY_ARE_EQUAL(5, emojiState.columnEnd);
+    VERIFY_ARE_EQUAL(heart, _buffer->GetRowByOffset(1).GlyphAt(0));
+    VERIFY_ARE_EQUAL(heart, _buffer->GetRowByOffset(1).GlyphAt(1));
+    VERIFY_ARE_EQUAL(smiley, _buffer->GetRowByOffset(1).GlyphAt(2));
+    VERIFY_ARE_EQUAL(L"x", _buffer->GetRowByOffset(1).GlyphAt(4));
+    VERIFY_ARE_EQUAL(5, ROW::MeasureText(emoji, 10, true));
+    VERIFY_ARE_EQUAL(2, ROW::MeasureText(emoji, 3, true));
+    VERIFY_ARE_EQUAL(3, ROW::MeasureText(emoji, 3, false));
+}
+
+void TextBufferTests::WriteCharInfos()
+{
+    const til::size bufferSize{ 10, 2 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, false, _renderer };
+
+    static constexpr auto single = [](wchar_t ch, WORD attributes = 0x07) { return CHAR_INFO{ { ch }, attributes }; };
+    static constexpr auto leading = [](wchar_t ch, WORD attributes = 0x07) { return CHAR_INFO{ { ch }, gsl::narrow_cast<WORD>(attributes | COMMON_LVB_LEADING_BYTE) }; };
+    static constexpr auto trailing = [](wchar_t ch, WORD attributes = 0x07) { return CHAR_INFO{ { ch }, gsl::narrow_cast<WORD>(attributes | COMMON_LVB_TRAILING_BYTE) }; };
+
+    struct TestCase
+    {
+        std::wstring_view name;
+        til::CoordType column;
+        std::vector<CHAR_INFO> cells;
+    };
+    const TestCase testCases[]{
+        { L"narrow cells splitting a wide glyph", 2, { single(L'x', 0x1f), single(L'y', 0x1f), single(L'z', 0x2e) } },
+        { L"leading/trailing pair", 3, { leading(L'\x3042', 0x4f), trailing(L'\x3042', 0x4f), single(L'x') } },
+        { L"leading half in the last column", 8, { single(L'x'), leading(L'\x3042', 0x5f), trailing(L'\x3042', 0x5f) } },
+        { L"trailing half as the first cell", 4, { trailing(L'\x3042', 0x6f), single(L'x'), single(L'y') } },
+        { L"trailing half in the first column", 0, { trailing(L'\x3042'), single(L'x') } },
+        { L"trailing half without a leading half", 1, { single(L'x'), trailing(L'\x3042', 0x3f), single(L'y') } },
+        { L"leading half without a trailing half", 0, { leading(L'\x3042'), single(L'x'), single(L'y') } },
+        { L"leading half as the last cell", 4, { single(L'x'), leading(L'\x3042', 0x2f) } },
+        { L"full row", 0, { single(L'a'), leading(L'\x3042'), trailing(L'\x3042'), single(L'b'), single(L'c'), single(L'd'), leading(L'\x304B'), trailing(L'\x304B'), single(L'e'), single(L'f') } },
+    };
+
+    for (const auto& test : testCases)
+    {
+        Log::Comment(NoThrowString().Format(L"%.*s", gsl::narrow_cast<int>(test.name.size()), test.name.data()));
+
+        // Both rows start out with the same narrow and wide glyphs and are then written via WriteCells() and WriteCharInfos() respectively.
+        for (til::CoordType y = 0; y < 2; ++y)
+        {
+            auto& row = buffer.GetRowByOffset(y);
+            row.Reset(attr);
+            RowWriteState state{ .text = L"a\x304Bbcd\x304Bef" };
+            row.ReplaceText(state);
+        }
+
+        auto& expected = buffer.GetRowByOffset(0);
+        auto& actual = buffer.GetRowByOffset(1);
+
+        const auto it = expected.WriteCells(OutputCellIterator{ std::span<const CHAR_INFO>{ test.cells } }, test.column, true);
+        const auto consumed = actual.WriteCharInfos(test.column, test.cells, true);
+
+        VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(it.Position()), consumed);
+        VERIFY_ARE_EQUAL(expected.GetText(), actual.GetText());
+        VERIFY_IS_TRUE(expected.Attributes() == actual.Attributes());
+        VERIFY_ARE_EQUAL(expected.WasDoubleBytePadded(), actual.WasDoubleBytePadded());
+        VERIFY_ARE_EQUAL(expected.WasWrapForced(), actual.WasWrapForced());
+        for (til::CoordType x = 0; x < bufferSize.width; ++x)
+        {
+            VERIFY_ARE_EQUAL(expected.DbcsAttrAt(x), actual.DbcsAttrAt(x));
+        }
+    }
+}
+
+void TextBufferTests::ReadCharInfos()
+{
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const til::size bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    TextBuffer buffer{ bufferSize, TextAttribute{ 0x07 }, cursorSize, false, _renderer };
+
+    // Narrow and wide glyphs, a surrogate pair and a combining mark in several colors.
+    const auto write = [&](til::CoordType y, std::wstring_view text, WORD attributes) {
+        RowWriteState state{ .text = text };
+        buffer.Write(y, TextAttribute{ attributes }, state);
+    };
+    write(0, L"a\x304Bb\U0001F600c", 0x1e);
+    write(1, L"éかかかかか", 0x2d);
+    write(2, L"xyz", 0x3c);
+    buffer.GetRowByOffset(2).ReplaceAttributes(1, 2, TextAttribute{ 0x4b });
+
+    // The area is offset by a column and the stride is larger than the area,
+    // so that both, cutting wide glyphs in half and skipping cells is tested.
+    static constexpr til::rect area{ 1, 0, 9, 3 };
+    static constexpr size_t stride = 12;
+    const CHAR_INFO sentinel{ { L'#' }, 0x1234 };
+    std::vector<CHAR_INFO> actual(stride * 3, sentinel);
+    buffer.ReadCharInfos(area, actual, stride);
+
+    for (auto y = area.top; y < area.bottom; ++y)
+    {
+        for (auto x = 0; x < gsl::narrow_cast<til::CoordType>(stride); ++x)
+        {
+            const auto& ci = actual.at(y * stride + x);
+            if (x < area.width())
+            {
+                VERIFY_ARE_EQUAL(gci.AsCharInfo(*buffer.GetCellDataAt({ area.left + x, y })), ci);
+            }
+            else
+            {
+                VERIFY_ARE_EQUAL(sentinel, ci);
+            }
+        }
+    }
+
+    // A target that's too small only receives the cells that fit.
+    std::vector<CHAR_INFO> small(area.width() + 2, sentinel);
+    buffer.ReadCharInfos(area, small, area.width());
+    VERIFY_ARE_EQUAL(gci.AsCharInfo(*buffer.GetCellDataAt({ area.left, 1 })), small.at(area.width()));
+    VERIFY_ARE_EQUAL(gci.AsCharInfo(*buffer.GetCellDataAt({ area.left + 1, 1 })), small.at(area.width() + 1));
+}
+
+void TextBufferTests::SearchText()
+{
+    const til::size bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto write = [&](til::CoordType y, std::wstring_view text, til::CoordType column = 0) {
+        RowWriteState state{ .text = text, .columnBegin = column };
+        _buffer->Write(y, attr, state);
+    };
+    const auto verifySpan = [](const til::point_span& span, til::point start, til::point end) {
+        VERIFY_ARE_EQUAL(start, span.start);
+        VERIFY_ARE_EQUAL(end, span.end);
+    };
+
+    // - - - Text Buffer Contents - - -
+    // |\u304BAbab  |
+    // |        xa| <-- wrapped
+    // |b         |
+    // |aaa       |
+    // - - - - - - - - - - - - - - - -
+    write(0, L"\u304BAbab");
+    write(1, L"xa", 8);
+    _buffer->GetRowByOffset(1).SetWrapForced(true);
+    write(2, L"b");
+    write(3, L"aaa");
+
+    Log::Comment(L"Case insensitive matches are sorted and may span wrapped rows.");
+    {
+        const auto results = _buffer->SearchText(L"AB", true);
+        VERIFY_ARE_EQUAL(3u, results.size());
+        verifySpan(results[0], { 2, 0 }, { 3, 0 });
+        verifySpan(results[1], { 4, 0 }, { 5, 0 });
+        verifySpan(results[2], { 9, 1 }, { 0, 2 });
+    }
+
+    Log::Comment(L"Case sensitive search.");
+    {
+        const auto results = _buffer->SearchText(L"ab", false);
+        VERIFY_ARE_EQUAL(2u, results.size());
+        verifySpan(results[0], { 4, 0 }, { 5, 0 });
+        verifySpan(results[1], { 9, 1 }, { 0, 2 });
+    }
+
+    Log::Comment(L"Wide glyphs cover both of their columns.");
+    {
+        const auto results = _buffer->SearchText(L"\u304B", false);
+        VERIFY_ARE_EQUAL(1u, results.size());
+        verifySpan(results[0], { 0, 0 }, { 1, 0 });
+    }
+
+    Log::Comment(L"Overlapping matches are all reported.");
+    {
+        const auto results = _buffer->SearchText(L"aa", false);
+        VERIFY_ARE_EQUAL(2u, results.size());
+        verifySpan(results[0], { 0, 3 }, { 1, 3 });
+        verifySpan(results[1], { 1, 3 }, { 2, 3 });
+    }
+
+    Log::Comment(L"Searching a row range only returns matches within it.");
+    {
+        const auto results = _buffer->SearchText(L"a", false, 3, 4);
+        VERIFY_ARE_EQUAL(3u, results.size());
+        verifySpan(results[0], { 0, 3 }, { 0, 3 });
+    }
+}
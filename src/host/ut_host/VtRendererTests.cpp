@@ -69,6 +69,7 @@ class Microsoft::Console::Render::VtRendererTest
     TEST_METHOD(Xterm256TestCursor);
     TEST_METHOD(Xterm256TestExtendedAttributes);
     TEST_METHOD(Xterm256TestAttributesAcrossReset);
+    TEST_METHOD(Xterm256TestCombinedRendition);
 
     TEST_METHOD(XtermTestInvalidate);
     TEST_METHOD(XtermTestColors);
@@ -83,6 +84,13 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(PipeWriterMergesFramesForSlowReader);
+    TEST_METHOD(PipeWriterReportsBrokenPipe);
+    TEST_METHOD(PipeWriterCancelsBlockedWriteOnDestruction);
+
+    TEST_METHOD(ShadowFrameWritesOnlyChangedCells);
+    TEST_METHOD(ShadowFrameByteCount);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -417,8 +425,7 @@ void VtRendererTest::Xterm256TestColors()
     Log::Comment(NoThrowString().Format(
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
         L"These values were picked for ease of formatting raw COLORREF values."));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({ 0x00030201, 0x00070605 },
                                                   renderSettings,
                                                   &renderData,
@@ -705,57 +712,72 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     VERIFY_SUCCEEDED(TestData::TryGetValue(L"crossedOut", crossedOut));
 
     TextAttribute desiredAttrs;
-    std::vector<std::string> onSequences, offSequences;
+    std::vector<std::string_view> onParameters, offParameters;
 
-    // Collect up a VT sequence to set the state given the method properties
+    // Collect up the SGR parameters to set the state given the method properties
     if (faint)
     {
         desiredAttrs.SetFaint(true);
-        onSequences.push_back("\x1b[2m");
-        offSequences.push_back("\x1b[22m");
+        onParameters.push_back("2");
+        offParameters.push_back("22");
     }
     if (underlined)
     {
         desiredAttrs.SetUnderlined(true);
-        onSequences.push_back("\x1b[4m");
-        offSequences.push_back("\x1b[24m");
+        onParameters.push_back("4");
+        offParameters.push_back("24");
     }
     if (doublyUnderlined)
     {
         desiredAttrs.SetDoublyUnderlined(true);
-        onSequences.push_back("\x1b[21m");
-        // The two underlines share the same off sequence, so we
+        onParameters.push_back("21");
+        // The two underlines share the same off parameter, so we
         // only add it here if that hasn't already been done.
         if (!underlined)
         {
-            offSequences.push_back("\x1b[24m");
+            offParameters.push_back("24");
         }
     }
     if (italics)
     {
         desiredAttrs.SetItalic(true);
-        onSequences.push_back("\x1b[3m");
-        offSequences.push_back("\x1b[23m");
+        onParameters.push_back("3");
+        offParameters.push_back("23");
     }
     if (blink)
     {
         desiredAttrs.SetBlinking(true);
-        onSequences.push_back("\x1b[5m");
-        offSequences.push_back("\x1b[25m");
+        onParameters.push_back("5");
+        offParameters.push_back("25");
     }
     if (invisible)
     {
         desiredAttrs.SetInvisible(true);
-        onSequences.push_back("\x1b[8m");
-        offSequences.push_back("\x1b[28m");
+        onParameters.push_back("8");
+        offParameters.push_back("28");
     }
     if (crossedOut)
     {
         desiredAttrs.SetCrossedOut(true);
-        onSequences.push_back("\x1b[9m");
-        offSequences.push_back("\x1b[29m");
+        onParameters.push_back("9");
+        offParameters.push_back("29");
     }
 
+    // All the parameters are combined into a single SGR sequence.
+    const auto expectSequence = [&](const std::vector<std::string_view>& parameters) {
+        if (!parameters.empty())
+        {
+            std::string sequence{ "\x1b[" };
+            for (const auto parameter : parameters)
+            {
+                sequence.append(parameter);
+                sequence.push_back(';');
+            }
+            sequence.back() = 'm';
+            qExpectedInput.push_back(std::move(sequence));
+        }
+    };
+
     auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
     auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
     auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
@@ -768,26 +790,32 @@ void VtRendererTest::Xterm256TestExtendedAttributes()
     Log::Comment(NoThrowString().Format(
         L"Test changing the text attributes"));
 
+    Log::Comment(NoThrowString().Format(
+        L"----Start with all attributes reset----"));
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[m");
+        VERIFY_SUCCEEDED(engine->_UpdateGraphicsRendition({}));
+    });
+
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes on----"));
     TestPaint(*engine, [&]() {
-        // Merge the "on" sequences into expected input.
-        std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        expectSequence(onParameters);
+        VERIFY_SUCCEEDED(engine->_UpdateGraphicsRendition(desiredAttrs));
     });
 
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes off----"));
     TestPaint(*engine, [&]() {
-        std::copy(offSequences.cbegin(), offSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs({}));
+        expectSequence(offParameters);
+        VERIFY_SUCCEEDED(engine->_UpdateGraphicsRendition({}));
     });
 
     Log::Comment(NoThrowString().Format(
         L"----Turn the extended attributes back on----"));
     TestPaint(*engine, [&]() {
-        std::copy(onSequences.cbegin(), onSequences.cend(), std::back_inserter(qExpectedInput));
-        VERIFY_SUCCEEDED(engine->_UpdateExtendedAttrs(desiredAttrs));
+        expectSequence(onParameters);
+        VERIFY_SUCCEEDED(engine->_UpdateGraphicsRendition(desiredAttrs));
     });
 
     VerifyExpectedInputsDrained();
@@ -804,6 +832,9 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     std::stringstream renditionSequence;
     renditionSequence << "\x1b[" << renditionAttribute << "m";
+    // The reset and the rendition are combined into a single sequence.
+    std::stringstream resetAndRenditionSequence;
+    resetAndRenditionSequence << "\x1b[0;" << renditionAttribute << "m";
 
     auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
     auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
@@ -872,8 +903,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Foreground and Retain Rendition----");
     textAttributes.SetDefaultForeground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetAndRenditionSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, renderSettings, &renderData, false, false));
 
     Log::Comment(L"----Set Green Background----");
@@ -883,13 +913,68 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Background and Retain Rendition----");
     textAttributes.SetDefaultBackground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetAndRenditionSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, renderSettings, &renderData, false, false));
 
     VerifyExpectedInputsDrained();
 }
 
+void VtRendererTest::Xterm256TestCombinedRendition()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    Log::Comment(L"Make sure a change of colors and renditions is written as a single SGR");
+
+    Log::Comment(L"----Start With All Attributes Reset----");
+    qExpectedInput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, false));
+
+    TextAttribute first{ 0x00030201, 0 };
+    first.SetIndexedBackground256(123);
+    first.SetIntense(true);
+    first.SetUnderlined(true);
+
+    auto second = first;
+    second.SetIndexedBackground(TextColor::BRIGHT_BLUE);
+    second.SetIntense(false);
+    second.SetItalic(true);
+
+    Log::Comment(L"----Set Both Colors And Renditions----");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;5;123;1;4m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(first, renderSettings, &renderData, false, false));
+
+    // Switch back and forth twice, so that the second time around
+    // the sequences are taken from the encoder's transition cache.
+    for (auto i = 0; i < 2; ++i)
+    {
+        Log::Comment(L"----Change The Background And Renditions----");
+        qExpectedInput.push_back("\x1b[104;22;3m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(second, renderSettings, &renderData, false, false));
+
+        Log::Comment(L"----Change Them Back----");
+        qExpectedInput.push_back("\x1b[48;5;123;1;23m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(first, renderSettings, &renderData, false, false));
+    }
+
+    Log::Comment(L"----Attributes Without An SGR Representation Don't Write Anything----");
+    auto gridlines = first;
+    gridlines.SetLeftVerticalDisplayed(true);
+    qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(gridlines, renderSettings, &renderData, false, false));
+    WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
+
+    Log::Comment(L"----Reset Everything----");
+    qExpectedInput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, false));
+
+    VerifyExpectedInputsDrained();
+}
+
 void VtRendererTest::XtermTestInvalidate()
 {
     auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -1594,3 +1679,234 @@ void VtRendererTest::FormattedString()
     qExpectedInput.push_back("\x1b[28;3;500;500;500m");
     VERIFY_SUCCEEDED(engine->_WriteFormatted(bigFormat, bigValue, bigValue, bigValue));
 }
+
+void VtRendererTest::PipeWriterMergesFramesForSlowReader()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 4096));
+
+    // Every frame is 1 KiB of a single repeated letter, so that we can check the order they arrive in.
+    static constexpr size_t frameCount = 256;
+    static constexpr size_t frameSize = 1024;
+
+    std::string received;
+    std::thread reader{ [&]() {
+        char buffer[4096];
+        DWORD read = 0;
+        while (ReadFile(readPipe.get(), &buffer[0], sizeof(buffer), &read, nullptr) && read)
+        {
+            received.append(&buffer[0], read);
+            // Deliberately fall behind the writer.
+            Sleep(2);
+        }
+    } };
+
+    VtPipeWriter::Stats stats;
+    {
+        VtPipeWriter writer{ std::move(writePipe), 64 * 1024 };
+        std::string frame;
+
+        for (size_t i = 0; i < frameCount; ++i)
+        {
+            frame.assign(frameSize, static_cast<char>('a' + i % 26));
+            VERIFY_SUCCEEDED(writer.Submit(frame));
+            VERIFY_IS_TRUE(frame.empty());
+        }
+
+        VERIFY_SUCCEEDED(writer.WaitForIdle());
+        stats = writer.GetStats();
+        // Destroying the writer closes the pipe, which ends the reader.
+    }
+    reader.join();
+
+    Log::Comment(NoThrowString().Format(L"writes: %llu, merged: %llu, max latency: %lld us", stats.writes, stats.framesMerged, std::chrono::duration_cast<std::chrono::microseconds>(stats.flushLatencyMax).count()));
+
+    VERIFY_ARE_EQUAL(uint64_t{ frameCount }, stats.frames);
+    VERIFY_ARE_EQUAL(uint64_t{ frameCount * frameSize }, stats.bytes);
+    VERIFY_ARE_EQUAL(stats.frames, stats.writes + stats.framesMerged);
+    VERIFY_IS_GREATER_THAN(stats.framesMerged, 0ull);
+
+    VERIFY_ARE_EQUAL(frameCount * frameSize, received.size());
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        VERIFY_ARE_EQUAL(static_cast<char>('a' + i % 26), received[i * frameSize]);
+        VERIFY_ARE_EQUAL(static_cast<char>('a' + i % 26), received[i * frameSize + frameSize - 1]);
+    }
+}
+
+void VtRendererTest::PipeWriterReportsBrokenPipe()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+    readPipe.reset();
+
+    VtPipeWriter writer{ std::move(writePipe) };
+    std::string frame{ "\x1b[H" };
+    VERIFY_SUCCEEDED(writer.Submit(frame));
+    VERIFY_FAILED(writer.WaitForIdle());
+
+    Log::Comment(L"Once a write failed, further frames are rejected.");
+    frame = "\x1b[H";
+    VERIFY_FAILED(writer.Submit(frame));
+    VERIFY_IS_TRUE(frame.empty());
+}
+
+void VtRendererTest::PipeWriterCancelsBlockedWriteOnDestruction()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 4096));
+
+    {
+        // Nobody reads from the pipe, so the writer thread blocks in WriteFile.
+        VtPipeWriter writer{ std::move(writePipe) };
+        std::string frame(64 * 1024, 'a');
+        VERIFY_SUCCEEDED(writer.Submit(frame));
+        VERIFY_ARE_EQUAL(HRESULT_FROM_WIN32(ERROR_TIMEOUT), writer.WaitForIdle(std::chrono::milliseconds{ 50 }));
+
+        Log::Comment(L"Destroying the writer must not hang, even though the write never completes.");
+    }
+}
+
+static std::vector<Cluster> MakeClusters(const std::wstring_view text)
+{
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        clusters.emplace_back(text.substr(i, 1), 1);
+    }
+    return clusters;
+}
+
+void VtRendererTest::ShadowFrameWritesOnlyChangedCells()
+{
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    VERIFY_SUCCEEDED(engine->SetShadowFrame(true));
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    VerifyFirstPaint(*engine);
+
+    const auto paintLine = [&](const std::wstring_view text) {
+        const auto clusters = MakeClusters(text);
+        const til::rect invalid{ 0, 0, gsl::narrow_cast<til::CoordType>(text.size()), 1 };
+        VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+        TestPaint(*engine, [&]() {
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, true));
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, false));
+            VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+        });
+    };
+
+    Log::Comment(L"The first frame is written in full.");
+    engine->SetTestCallback([](auto&&...) { return true; });
+    paintLine(L"hello world");
+    engine->SetTestCallback(pfn);
+
+    Log::Comment(L"Repainting the same line writes nothing at all.");
+    qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+    paintLine(L"hello world");
+    WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+
+    Log::Comment(L"A single changed cell is written after a cursor jump.");
+    qExpectedInput.push_back("\x1b[1;7H");
+    qExpectedInput.push_back("W");
+    paintLine(L"hello World");
+
+    Log::Comment(L"Changes a few cells apart are merged, others are jumped to.");
+    qExpectedInput.push_back("\x1b[H");
+    qExpectedInput.push_back("HeL");
+    qExpectedInput.push_back("\x1b[7C");
+    qExpectedInput.push_back("D");
+    paintLine(L"HeLlo WorlD");
+
+    Log::Comment(L"Changing the attributes of a run writes it again.");
+    const auto clusters = MakeClusters(L"HeLlo WorlD");
+    const til::rect invalid{ 0, 0, 11, 1 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    qExpectedInput.push_back("\x1b[7m");
+    qExpectedInput.push_back("\x1b[H");
+    qExpectedInput.push_back("HeLlo WorlD");
+    TestPaint(*engine, [&]() {
+        TextAttribute reversed{};
+        reversed.SetReverseVideo(true);
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(reversed, renderSettings, &renderData, false, false));
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+// Counts the bytes written for a top-like process list, where the client
+// rewrites the whole screen on every tick, but only a few numbers change.
+void VtRendererTest::ShadowFrameByteCount()
+{
+    RenderSettings renderSettings;
+    RenderData renderData;
+    const auto view = SetUpViewport();
+    const auto width = view.Width();
+    const auto height = view.Height();
+
+    // Each row is a colored PID column, followed by the rest of the process info.
+    TextAttribute pidAttributes{};
+    pidAttributes.SetIndexedForeground(TextColor::DARK_CYAN);
+    const auto makeRows = [&](const int tick) {
+        std::vector<std::wstring> rows;
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            const auto cpu = (y % 8 == tick % 8) ? (y * 7 + tick * 13) % 1000 : y * 3;
+            auto row = fmt::format(FMT_COMPILE(L"{:>6} user      20   0 {:>8} {:>7} S {:>3}.{} {:>4}.{} process-{}"), 1000 + y, 12345 + y * 91, 2048 + y * 17, cpu / 10, cpu % 10, y % 10, y % 7, y);
+            row.resize(gsl::narrow_cast<size_t>(width), L' ');
+            rows.emplace_back(std::move(row));
+        }
+        return rows;
+    };
+
+    const auto measure = [&](const bool shadowFrame) {
+        auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+        auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), view);
+        size_t bytes = 0;
+        engine->SetTestCallback([&](const char* const, const size_t cch) {
+            bytes += cch;
+            return true;
+        });
+        VERIFY_SUCCEEDED(engine->SetShadowFrame(shadowFrame));
+
+        for (auto tick = 0; tick < 16; ++tick)
+        {
+            const auto rows = makeRows(tick);
+            const auto invalid = view.ToExclusive();
+            VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+            TestPaint(*engine, [&]() {
+                VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, true));
+                for (til::CoordType y = 0; y < height; ++y)
+                {
+                    const auto clusters = MakeClusters(til::at(rows, y));
+                    const std::span<const Cluster> line{ clusters.data(), clusters.size() };
+                    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(pidAttributes, renderSettings, &renderData, false, false));
+                    VERIFY_SUCCEEDED(engine->PaintBufferLine(line.first(6), { 0, y }, false, false));
+                    VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, false));
+                    VERIFY_SUCCEEDED(engine->PaintBufferLine(line.subspan(6), { 6, y }, false, false));
+                }
+            });
+
+            // The first frame is the same for both, we only care about the updates.
+            if (tick == 0)
+            {
+                bytes = 0;
+            }
+        }
+        return bytes;
+    };
+
+    const auto fullBytes = measure(false);
+    const auto shadowBytes = measure(true);
+    Log::Comment(NoThrowString().Format(L"Bytes written for 15 updates: %zu without shadow frame, %zu with shadow frame", fullBytes, shadowBytes));
+    VERIFY_IS_GREATER_THAN(shadowBytes, size_t{ 0 });
+    VERIFY_IS_LESS_THAN(shadowBytes * 10, fullBytes);
+}
@@ -12,8 +12,11 @@ Abstract:
 Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
-Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+Back then the scalar algorithms lost against MultiByteToWideChar and
+WideCharToMultiByte. The transcoders below convert ASCII runs with SSE2
+and only fall back to scalar code for non-ASCII, which beats the platform
+functions while also allowing to convert into caller-provided buffers.
+Run "ConBench utf8" to compare them against each other.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -47,6 +50,369 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         }
     };
 
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26429 26481 26490) // use not_null, pointer arithmetic, reinterpret_cast
+        // Routine Description:
+        // - Converts the UTF-8 string [it, end) to UTF-16. Invalid sequences are replaced with U+FFFD,
+        //   one for each maximal subpart of an ill-formed sequence, just like MultiByteToWideChar does.
+        // - ASCII is converted 16 bytes at a time using SSE2. The vectorized loop always stores a full
+        //   block and this is the reason `out` must hold at least `end - it` code units (the worst case anyways).
+        // Arguments:
+        // - it, end - the UTF-8 string to be converted
+        // - out - the destination buffer, which must hold at least `end - it` code units
+        // Return Value:
+        // - the number of UTF-16 code units written to `out`
+        inline size_t u8u16(const char* it, const char* const end, wchar_t* const out) noexcept
+        {
+            auto dst = out;
+
+            while (it != end)
+            {
+#if defined(TIL_SSE_INTRINSICS)
+                while (end - it >= 16)
+                {
+                    const auto vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    const auto zero = _mm_setzero_si128();
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(vec, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 8), _mm_unpackhi_epi8(vec, zero));
+
+                    // Bytes >= 0x80 have their high bit set, which is what _mm_movemask_epi8 extracts.
+                    const auto mask = static_cast<unsigned long>(_mm_movemask_epi8(vec));
+                    if (mask)
+                    {
+                        unsigned long offset;
+                        _BitScanForward(&offset, mask);
+                        it += offset;
+                        dst += offset;
+                        break;
+                    }
+
+                    it += 16;
+                    dst += 16;
+                }
+
+                if (it == end)
+                {
+                    break;
+                }
+#endif
+
+                const auto lead = static_cast<uint8_t>(*it++);
+                if (lead < 0x80)
+                {
+                    *dst++ = lead;
+                    continue;
+                }
+
+                // The valid range of the first continuation byte depends on the lead byte, which is how
+                // overlong encodings, surrogates and code points past U+10FFFF are rejected. See the
+                // "Well-Formed UTF-8 Byte Sequences" table in chapter 3.9 of the Unicode standard.
+                char32_t cp;
+                int trail;
+                uint8_t lo = 0x80;
+                uint8_t hi = 0xBF;
+                if (lead >= 0xC2 && lead <= 0xDF)
+                {
+                    cp = lead & 0x1f;
+                    trail = 1;
+                }
+                else if (lead >= 0xE0 && lead <= 0xEF)
+                {
+                    cp = lead & 0x0f;
+                    trail = 2;
+                    lo = lead == 0xE0 ? 0xA0 : 0x80;
+                    hi = lead == 0xED ? 0x9F : 0xBF;
+                }
+                else if (lead >= 0xF0 && lead <= 0xF4)
+                {
+                    cp = lead & 0x07;
+                    trail = 3;
+                    lo = lead == 0xF0 ? 0x90 : 0x80;
+                    hi = lead == 0xF4 ? 0x8F : 0xBF;
+                }
+                else
+                {
+                    *dst++ = 0xFFFD;
+                    continue;
+                }
+
+                for (; trail && it != end; --trail, ++it, lo = 0x80, hi = 0xBF)
+                {
+                    const auto b = static_cast<uint8_t>(*it);
+                    if (b < lo || b > hi)
+                    {
+                        break;
+                    }
+                    cp = (cp << 6) | (b & 0x3f);
+                }
+
+                if (trail)
+                {
+                    // The bytes we consumed so far are the maximal subpart and get replaced as a whole.
+                    *dst++ = 0xFFFD;
+                }
+                else if (cp < 0x10000)
+                {
+                    *dst++ = static_cast<wchar_t>(cp);
+                }
+                else
+                {
+                    cp -= 0x10000;
+                    *dst++ = static_cast<wchar_t>(0xD800 | (cp >> 10));
+                    *dst++ = static_cast<wchar_t>(0xDC00 | (cp & 0x3ff));
+                }
+            }
+
+            return static_cast<size_t>(dst - out);
+        }
+
+        // Routine Description:
+        // - Converts the UTF-16 string [it, end) to UTF-8. Unpaired surrogates are replaced with U+FFFD,
+        //   just like WideCharToMultiByte does.
+        // - ASCII is converted 8 code units at a time using SSE2.
+        // Arguments:
+        // - it, end - the UTF-16 string to be converted
+        // - out - the destination buffer, which must hold at least `(end - it) * 3` code units
+        // Return Value:
+        // - the number of UTF-8 code units written to `out`
+        inline size_t u16u8(const wchar_t* it, const wchar_t* const end, char* const out) noexcept
+        {
+            auto dst = out;
+
+            while (it != end)
+            {
+#if defined(TIL_SSE_INTRINSICS)
+                while (end - it >= 8)
+                {
+                    const auto vec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                    // _mm_packus_epi16 saturates to 0..255, which is fine since we only keep the ASCII prefix anyways.
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(vec, vec));
+
+                    // A code unit is ASCII if none of the bits 7 to 15 are set. _mm_movemask_epi8 returns 2 bits per code unit.
+                    const auto ascii = _mm_cmpeq_epi16(_mm_and_si128(vec, _mm_set1_epi16(static_cast<short>(0xff80))), _mm_setzero_si128());
+                    const auto mask = static_cast<unsigned long>(~_mm_movemask_epi8(ascii) & 0xffff);
+                    if (mask)
+                    {
+                        unsigned long offset;
+                        _BitScanForward(&offset, mask);
+                        offset /= 2;
+                        it += offset;
+                        dst += offset;
+                        break;
+                    }
+
+                    it += 8;
+                    dst += 8;
+                }
+
+                if (it == end)
+                {
+                    break;
+                }
+#endif
+
+                char32_t cp = *it++;
+                if (cp < 0x80)
+                {
+                    *dst++ = static_cast<char>(cp);
+                    continue;
+                }
+                if (cp < 0x800)
+                {
+                    *dst++ = static_cast<char>(0xC0 | (cp >> 6));
+                    *dst++ = static_cast<char>(0x80 | (cp & 0x3f));
+                    continue;
+                }
+                if (cp >= 0xD800 && cp <= 0xDFFF)
+                {
+                    if (cp <= 0xDBFF && it != end && *it >= 0xDC00 && *it <= 0xDFFF)
+                    {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (*it++ - 0xDC00);
+                        *dst++ = static_cast<char>(0xF0 | (cp >> 18));
+                        *dst++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+                        *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                        *dst++ = static_cast<char>(0x80 | (cp & 0x3f));
+                        continue;
+                    }
+                    cp = 0xFFFD;
+                }
+                *dst++ = static_cast<char>(0xE0 | (cp >> 12));
+                *dst++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                *dst++ = static_cast<char>(0x80 | (cp & 0x3f));
+            }
+
+            return static_cast<size_t>(dst - out);
+        }
+#pragma warning(pop)
+    }
+
+    // Routine Description:
+    // - Takes a UTF-8 string and performs the conversion to UTF-16 into a caller-provided buffer. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
+    // Arguments:
+    // - in - UTF-8 string to be converted
+    // - out - buffer receiving the UTF-16 string. It must hold at least in.size() code units.
+    // - written - receives the number of code units written to out
+    // Return Value:
+    // - S_OK                    - the conversion succeeded
+    // - E_NOT_SUFFICIENT_BUFFER - out is too small
+    [[nodiscard]] inline HRESULT u8u16(const std::string_view& in, const std::span<wchar_t>& out, size_t& written) noexcept
+    {
+        written = 0;
+        // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
+        RETURN_HR_IF(E_NOT_SUFFICIENT_BUFFER, out.size() < in.size());
+        written = details::u8u16(in.data(), in.data() + in.size(), out.data());
+        return S_OK;
+    }
+
+#pragma warning(push)
+#pragma warning(disable : 26429 26446 26481 26482) // use not_null, subscript operator, pointer arithmetic, dynamic array indexing
+    // Routine Description:
+    // - Takes a UTF-8 string, complements and/or caches partials, and performs the conversion to UTF-16 into a caller-provided buffer.
+    // Arguments:
+    // - in - UTF-8 string to be converted
+    // - out - buffer receiving the UTF-16 string. It must hold at least in.size() + state.have code units.
+    // - written - receives the number of code units written to out
+    // - state - reference to a til::u8state holding the status of the current partials handling
+    // Return Value:
+    // - S_OK                    - the conversion succeeded
+    // - E_NOT_SUFFICIENT_BUFFER - out is too small
+    [[nodiscard]] inline HRESULT u8u16(const std::string_view& in, const std::span<wchar_t>& out, size_t& written, u8state& state) noexcept
+    {
+        written = 0;
+        RETURN_HR_IF(S_OK, in.empty());
+        // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
+        RETURN_HR_IF(E_NOT_SUFFICIENT_BUFFER, out.size() < in.size() + state.have);
+
+        auto len8{ in.size() };
+        auto cursor8{ in.data() };
+        auto cursor16{ out.data() };
+        if (state.have)
+        {
+            const auto copyable{ std::min<size_t>(state.want, len8) };
+            std::copy_n(cursor8, copyable, &state.partials[state.have]);
+            state.have += gsl::narrow_cast<uint8_t>(copyable);
+            state.want -= gsl::narrow_cast<uint8_t>(copyable);
+            if (state.want) // we still didn't get enough data to complete the code point, however this is not an error
+            {
+                return S_OK;
+            }
+
+            cursor16 += details::u8u16(&state.partials[0], &state.partials[state.have], cursor16);
+            len8 -= copyable;
+            cursor8 += copyable;
+            // state.want is already zero at this point
+            state.have = 0;
+        }
+
+        if (len8)
+        {
+            auto backIter{ cursor8 + len8 - 1 };
+            size_t sequenceLen{ 1 };
+
+            // skip UTF8 continuation bytes
+            while (backIter != cursor8 && (*backIter & 0b11'000000) == 0b10'000000)
+            {
+                --backIter;
+                ++sequenceLen;
+            }
+
+            // credits go to Christopher Wellons for this algorithm to determine the length of a UTF-8 code point
+            // it is released into the Public Domain. https://github.com/skeeto/branchless-utf8
+            static constexpr uint8_t lengths[]{ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 3, 3, 4, 0 };
+            const size_t codePointLen{ lengths[gsl::narrow_cast<uint8_t>(*backIter) >> 3] };
+
+            if (codePointLen > sequenceLen)
+            {
+                std::copy_n(backIter, sequenceLen, &state.partials[0]);
+                len8 -= sequenceLen;
+                state.have = gsl::narrow_cast<uint8_t>(sequenceLen);
+                state.want = gsl::narrow_cast<uint8_t>(codePointLen - sequenceLen);
+            }
+        }
+
+        if (len8)
+        {
+            cursor16 += details::u8u16(cursor8, cursor8 + len8, cursor16);
+        }
+
+        written = gsl::narrow_cast<size_t>(cursor16 - out.data());
+        return S_OK;
+    }
+#pragma warning(pop)
+
+    // Routine Description:
+    // - Takes a UTF-16 string and performs the conversion to UTF-8 into a caller-provided buffer. NOTE: The function relies on getting complete UTF-16 characters at the string boundaries.
+    // Arguments:
+    // - in - UTF-16 string to be converted
+    // - out - buffer receiving the UTF-8 string. It must hold at least in.size() * 3 code units.
+    // - written - receives the number of code units written to out
+    // Return Value:
+    // - S_OK                    - the conversion succeeded
+    // - E_NOT_SUFFICIENT_BUFFER - out is too small
+    [[nodiscard]] inline HRESULT u16u8(const std::wstring_view& in, const std::span<char>& out, size_t& written) noexcept
+    {
+        written = 0;
+        // Code Point U+0000..U+FFFF: 1 UTF-16 code unit --> 1..3 UTF-8 code units.
+        // Code Points >U+FFFF: 2 UTF-16 code units --> 4 UTF-8 code units.
+        // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
+        RETURN_HR_IF(E_NOT_SUFFICIENT_BUFFER, out.size() / 3 < in.size());
+        written = details::u16u8(in.data(), in.data() + in.size(), out.data());
+        return S_OK;
+    }
+
+#pragma warning(push)
+#pragma warning(disable : 26429 26446 26481) // use not_null, subscript operator, pointer arithmetic
+    // Routine Description:
+    // - Takes a UTF-16 string, complements and/or caches partials, and performs the conversion to UTF-8 into a caller-provided buffer.
+    // Arguments:
+    // - in - UTF-16 string to be converted
+    // - out - buffer receiving the UTF-8 string. It must hold at least (in.size() + 1) * 3 code units.
+    // - written - receives the number of code units written to out
+    // - state - reference to a til::u16state holding the status of the current partials handling
+    // Return Value:
+    // - S_OK                    - the conversion succeeded
+    // - E_NOT_SUFFICIENT_BUFFER - out is too small
+    [[nodiscard]] inline HRESULT u16u8(const std::wstring_view& in, const std::span<char>& out, size_t& written, u16state& state) noexcept
+    {
+        written = 0;
+        RETURN_HR_IF(S_OK, in.empty());
+        // The worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
+        RETURN_HR_IF(E_NOT_SUFFICIENT_BUFFER, out.size() / 3 < in.size() + (state.partials[0] != 0));
+
+        auto len16{ in.size() };
+        auto cursor16{ in.data() };
+        auto cursor8{ out.data() };
+        if (state.partials[0])
+        {
+            state.partials[1] = *cursor16;
+            cursor8 += details::u16u8(&state.partials[0], &state.partials[2], cursor8);
+            state.reset();
+            --len16;
+            ++cursor16;
+        }
+
+        if (len16)
+        {
+            const auto back = *(cursor16 + len16 - 1);
+            if (back >= 0xD800 && back <= 0xDBFF) // cache the last value in the string if it is in the range of high surrogates
+            {
+                state.partials[0] = back;
+                --len16;
+            }
+        }
+
+        if (len16)
+        {
+            cursor8 += details::u16u8(cursor16, cursor16 + len16, cursor8);
+        }
+
+        written = gsl::narrow_cast<size_t>(cursor8 - out.data());
+        return S_OK;
+    }
+#pragma warning(pop)
+
     // Routine Description:
     // - Takes a UTF-8 string and performs the conversion to UTF-16. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
     // Arguments:
@@ -55,8 +421,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u8u16(const std::string_view& in, outT& out) noexcept
@@ -66,20 +430,14 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             out.clear();
             RETURN_HR_IF(S_OK, in.empty());
 
-            int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
-            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
-            out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
-
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            out.resize(in.length());
+            out.resize(details::u8u16(in.data(), in.data() + in.size(), out.data()));
+            return S_OK;
         }
         CATCH_RETURN();
     }
 
-#pragma warning(push)
-#pragma warning(disable : 26429 26446 26459 26481 26482) // use not_null, subscript operator, use span, pointer arithmetic, dynamic array indexing
     // Routine Description:
     // - Takes a UTF-8 string, complements and/or caches partials, and performs the conversion to UTF-16.
     // Arguments:
@@ -89,8 +447,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u8u16(const std::string_view& in, outT& out, u8state& state) noexcept
@@ -100,76 +456,14 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             out.clear();
             RETURN_HR_IF(S_OK, in.empty());
 
-            int capa16{};
-            // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
-            RETURN_HR_IF(E_ABORT, !base::CheckAdd(in.length(), state.have).AssignIfValid(&capa16));
-
-            out.resize(gsl::narrow_cast<size_t>(capa16));
-            auto len8{ gsl::narrow_cast<int>(in.length()) };
-            int len16{};
-            auto cursor8{ in.data() };
-            if (state.have)
-            {
-                const auto copyable{ std::min<int>(state.want, len8) };
-                std::move(cursor8, cursor8 + copyable, &state.partials[state.have]);
-                state.have += gsl::narrow_cast<uint8_t>(copyable);
-                state.want -= gsl::narrow_cast<uint8_t>(copyable);
-                if (state.want) // we still didn't get enough data to complete the code point, however this is not an error
-                {
-                    out.clear();
-                    return S_OK;
-                }
-
-                len16 = MultiByteToWideChar(CP_UTF8, 0UL, &state.partials[0], gsl::narrow_cast<int>(state.have), out.data(), capa16);
-                RETURN_HR_IF(E_UNEXPECTED, !len16);
-
-                capa16 -= len16;
-                len8 -= copyable;
-                cursor8 += copyable;
-                // state.want is already zero at this point
-                state.have = 0;
-            }
-
-            if (len8)
-            {
-                auto backIter{ cursor8 + len8 - 1 };
-                int sequenceLen{ 1 };
-
-                // skip UTF8 continuation bytes
-                while (backIter != cursor8 && (*backIter & 0b11'000000) == 0b10'000000)
-                {
-                    --backIter;
-                    ++sequenceLen;
-                }
-
-                // credits go to Christopher Wellons for this algorithm to determine the length of a UTF-8 code point
-                // it is released into the Public Domain. https://github.com/skeeto/branchless-utf8
-                static constexpr uint8_t lengths[]{ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 3, 3, 4, 0 };
-                const auto codePointLen{ lengths[gsl::narrow_cast<uint8_t>(*backIter) >> 3] };
-
-                if (codePointLen > sequenceLen)
-                {
-                    std::move(backIter, backIter + sequenceLen, &state.partials[0]);
-                    len8 -= sequenceLen;
-                    state.have = gsl::narrow_cast<uint8_t>(sequenceLen);
-                    state.want = gsl::narrow_cast<uint8_t>(codePointLen - sequenceLen);
-                }
-            }
-
-            if (len8)
-            {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
-                RETURN_HR_IF(E_UNEXPECTED, !convLen);
-
-                len16 += convLen;
-            }
-
-            out.resize(gsl::narrow_cast<size_t>(len16));
+            out.resize(in.length() + state.have);
+            size_t written{};
+            RETURN_IF_FAILED(u8u16(in, std::span{ out.data(), out.size() }, written, state));
+            out.resize(written);
             return S_OK;
         }
         CATCH_RETURN();
     }
-#pragma warning(pop)
 
     // Routine Description:
     // - Takes a UTF-16 string and performs the conversion to UTF-8. NOTE: The function relies on getting complete UTF-16 characters at the string boundaries.
@@ -179,8 +473,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u16u8(const std::wstring_view& in, outT& out) noexcept
@@ -190,23 +482,14 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             out.clear();
             RETURN_HR_IF(S_OK, in.empty());
 
-            int lengthIn{};
-            int lengthRequired{};
-            // Code Point U+0000..U+FFFF: 1 UTF-16 code unit --> 1..3 UTF-8 code units.
-            // Code Points >U+FFFF: 2 UTF-16 code units --> 4 UTF-8 code units.
-            // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
-            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
-            out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
-
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            // The worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
+            out.resize(in.length() * 3);
+            out.resize(details::u16u8(in.data(), in.data() + in.size(), out.data()));
+            return S_OK;
         }
         CATCH_RETURN();
     }
 
-#pragma warning(push)
-#pragma warning(disable : 26429 26446 26459 26481) // use not_null, subscript operator, use span, pointer arithmetic
     // Routine Description:
     // - Takes a UTF-16 string, complements and/or caches partials, and performs the conversion to UTF-8.
     // Arguments:
@@ -216,8 +499,6 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeeded without any change of the represented code points
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
-    // - E_UNEXPECTED  - the underlying conversion function failed
     // - HRESULT value converted from a caught exception
     template<class outT>
     [[nodiscard]] HRESULT u16u8(const std::wstring_view& in, outT& out, u16state& state) noexcept
@@ -227,50 +508,14 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             out.clear();
             RETURN_HR_IF(S_OK, in.empty());
 
-            int len16{};
-            int capa8{};
-            // The worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
-            RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&len16) || !base::CheckAdd(len16, gsl::narrow_cast<int>(state.partials[0]) != 0).AssignIfValid(&capa8) || !base::CheckMul(capa8, 3).AssignIfValid(&capa8));
-
-            out.resize(gsl::narrow_cast<size_t>(capa8));
-            int len8{};
-            auto cursor16{ in.data() };
-            if (state.partials[0])
-            {
-                state.partials[1] = *cursor16;
-                len8 = WideCharToMultiByte(CP_UTF8, 0UL, &state.partials[0], 2, out.data(), capa8, nullptr, nullptr);
-                RETURN_HR_IF(E_UNEXPECTED, !len8);
-
-                state.reset();
-                capa8 -= len8;
-                --len16;
-                ++cursor16;
-            }
-
-            if (len16)
-            {
-                const auto back = *(cursor16 + len16 - 1);
-                if (back >= 0xD800 && back <= 0xDBFF) // cache the last value in the string if it is in the range of high surrogates
-                {
-                    state.partials[0] = back;
-                    --len16;
-                }
-            }
-
-            if (len16)
-            {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
-                RETURN_HR_IF(E_UNEXPECTED, !convLen);
-
-                len8 += convLen;
-            }
-
-            out.resize(gsl::narrow_cast<size_t>(len8));
+            out.resize((in.length() + (state.partials[0] != 0)) * 3);
+            size_t written{};
+            RETURN_IF_FAILED(u16u8(in, std::span{ out.data(), out.size() }, written, state));
+            out.resize(written);
             return S_OK;
         }
         CATCH_RETURN();
     }
-#pragma warning(pop)
 
     // Routine Description:
     // - Takes a UTF-8 string and performs the conversion to UTF-16. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
@@ -230,12 +230,23 @@ void Clipboard::StoreSelectionToClipboard(const bool copyFormatting)
     const auto selectionRects = selection.GetSelectionRects();
 
     const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    const auto& buffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+    const auto& screenInfo = gci.GetActiveOutputBuffer();
+    const auto& buffer = screenInfo.GetTextBuffer();
     const auto& renderSettings = gci.GetRenderSettings();
 
-    const auto GetAttributeColors = [&](const auto& attr) {
-        return renderSettings.GetAttributeColors(attr);
-    };
+    TextBuffer::ClipboardFormatting formatting;
+    if (copyFormatting)
+    {
+        formatting.GetAttributeColors = [&](const auto& attr) {
+            return renderSettings.GetAttributeColors(attr);
+        };
+        const auto& fontData = screenInfo.GetCurrentFont();
+        formatting.fontHeightPoints = fontData.GetUnscaledSize().height * 72 / ServiceLocator::LocateGlobals().dpi;
+        formatting.fontFaceName = fontData.GetFaceName();
+        formatting.backgroundColor = renderSettings.GetAttributeColors({}).second;
+        formatting.html = true;
+        formatting.rtf = true;
+    }
 
     bool includeCRLF, trimTrailingWhitespace;
     if (WI_IsFlagSet(OneCoreSafeGetKeyState(VK_SHIFT), KEY_PRESSED))
@@ -248,29 +259,23 @@ void Clipboard::StoreSelectionToClipboard(const bool copyFormatting)
         includeCRLF = trimTrailingWhitespace = true;
     }
 
-    const auto text = buffer.GetText(includeCRLF,
-                                     trimTrailingWhitespace,
-                                     selectionRects,
-                                     GetAttributeColors,
-                                     selection.IsKeyboardMarkSelection());
+    auto data = buffer.SerializeSelection(includeCRLF,
+                                          trimTrailingWhitespace,
+                                          selectionRects,
+                                          formatting,
+                                          selection.IsKeyboardMarkSelection());
 
-    CopyTextToSystemClipboard(text, copyFormatting);
+    CopyTextToSystemClipboard(data, copyFormatting);
 }
 
 // Routine Description:
 // - Copies the text given onto the global system clipboard.
 // Arguments:
-// - rows - Rows of text data to copy
+// - data - The text and, if fAlsoCopyFormatting is set, the HTML and RTF to copy
 // - fAlsoCopyFormatting - true if the color and formatting should also be copied, false otherwise
-void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, const bool fAlsoCopyFormatting)
+void Clipboard::CopyTextToSystemClipboard(TextBuffer::ClipboardData& data, const bool fAlsoCopyFormatting)
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
-    for (const auto& str : rows.text)
-    {
-        finalString += str;
-    }
+    const auto& finalString = data.text;
 
     // allocate the final clipboard data
     const auto cchNeeded = finalString.size() + 1;
@@ -300,16 +305,8 @@ void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows,
 
         if (fAlsoCopyFormatting)
         {
-            const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-            const auto& fontData = gci.GetActiveOutputBuffer().GetCurrentFont();
-            const auto iFontHeightPoints = fontData.GetUnscaledSize().height * 72 / ServiceLocator::LocateGlobals().dpi;
-            const auto bgColor = gci.GetRenderSettings().GetAttributeColors({}).second;
-
-            auto HTMLToPlaceOnClip = TextBuffer::GenHTML(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor);
-            CopyToSystemClipboard(HTMLToPlaceOnClip, L"HTML Format");
-
-            auto RTFToPlaceOnClip = TextBuffer::GenRTF(rows, iFontHeightPoints, fontData.GetFaceName(), bgColor);
-            CopyToSystemClipboard(RTFToPlaceOnClip, L"Rich Text Format");
+            CopyToSystemClipboard(std::move(data.html), L"HTML Format");
+            CopyToSystemClipboard(std::move(data.rtf), L"Rich Text Format");
         }
     }
 
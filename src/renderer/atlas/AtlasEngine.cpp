@@ -49,6 +49,8 @@ AtlasEngine::AtlasEngine()
 
 // StartPaint() is called while the console buffer lock is being held.
 // --> Put as little in here as possible.
+// The lock is released before the frame is painted (see RequiresLockForPainting()), which means that
+// Invalidate*() calls may arrive during the paint. We must consume all invalidations here as a result.
 [[nodiscard]] HRESULT AtlasEngine::StartPaint() noexcept
 try
 {
@@ -126,6 +128,19 @@ try
     _p.cursorRect = {};
     _p.scrollOffset = _api.scrollOffset;
 
+    // Clear the previous cursor
+    if (const auto r = _api.invalidatedCursorArea; r.non_empty())
+    {
+        _p.dirtyRectInPx.left = std::min(_p.dirtyRectInPx.left, r.left * _p.s->font->cellSize.x);
+        _p.dirtyRectInPx.top = std::min(_p.dirtyRectInPx.top, r.top * _p.s->font->cellSize.y);
+        _p.dirtyRectInPx.right = std::max(_p.dirtyRectInPx.right, r.right * _p.s->font->cellSize.x);
+        _p.dirtyRectInPx.bottom = std::max(_p.dirtyRectInPx.bottom, r.bottom * _p.s->font->cellSize.y);
+    }
+
+    _api.invalidatedCursorArea = invalidatedAreaNone;
+    _api.invalidatedRows = invalidatedRowsNone;
+    _api.scrollOffset = 0;
+
     // This if condition serves 2 purposes:
     // * By setting top/bottom to the full height we ensure that we call Present() without
     //   any dirty rects and not Present1() on the first frame after the settings change.
@@ -250,14 +265,18 @@ CATCH_RETURN()
 try
 {
     _flushBufferLine();
-
-    _api.invalidatedCursorArea = invalidatedAreaNone;
-    _api.invalidatedRows = invalidatedRowsNone;
-    _api.scrollOffset = 0;
     return S_OK;
 }
 CATCH_RETURN()
 
+[[nodiscard]] bool AtlasEngine::RequiresLockForPainting() noexcept
+{
+    // Everything between StartPaint() and EndPaint() only reads from the Renderer's frame snapshot
+    // and writes into _p. The only exceptions are the settings written by UpdateDrawingBrushes()
+    // (for the default brushes) and PrepareRenderInfo(), both of which are called under the lock.
+    return false;
+}
+
 [[nodiscard]] HRESULT AtlasEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
@@ -272,6 +291,22 @@ CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::PrepareRenderInfo(const RenderFrameInfo& info) noexcept
 {
+    // This is called while the console lock is being held, unlike PaintCursor().
+    // It's the last chance to safely update _api.s for this frame.
+    if (const auto& options = info.cursorInfo)
+    {
+        const CursorSettings cachedOptions{
+            .cursorColor = gsl::narrow_cast<u32>(options->fUseColor ? options->cursorColor | 0xff000000 : INVALID_COLOR),
+            .cursorType = gsl::narrow_cast<u16>(options->cursorType),
+            .heightPercentage = gsl::narrow_cast<u16>(options->ulCursorHeightPercent),
+        };
+        if (*_api.s->cursor != cachedOptions)
+        {
+            *_api.s.write()->cursor.write() = cachedOptions;
+            *_p.s.write()->cursor.write() = cachedOptions;
+        }
+    }
+
     return S_OK;
 }
 
@@ -409,28 +444,6 @@ try
     // As such we got to call _flushBufferLine() here just to be sure.
     _flushBufferLine();
 
-    {
-        const CursorSettings cachedOptions{
-            .cursorColor = gsl::narrow_cast<u32>(options.fUseColor ? options.cursorColor | 0xff000000 : INVALID_COLOR),
-            .cursorType = gsl::narrow_cast<u16>(options.cursorType),
-            .heightPercentage = gsl::narrow_cast<u16>(options.ulCursorHeightPercent),
-        };
-        if (*_api.s->cursor != cachedOptions)
-        {
-            *_api.s.write()->cursor.write() = cachedOptions;
-            *_p.s.write()->cursor.write() = cachedOptions;
-        }
-    }
-
-    // Clear the previous cursor
-    if (const auto r = _api.invalidatedCursorArea; r.non_empty())
-    {
-        _p.dirtyRectInPx.left = std::min(_p.dirtyRectInPx.left, r.left * _p.s->font->cellSize.x);
-        _p.dirtyRectInPx.top = std::min(_p.dirtyRectInPx.top, r.top * _p.s->font->cellSize.y);
-        _p.dirtyRectInPx.right = std::max(_p.dirtyRectInPx.right, r.right * _p.s->font->cellSize.x);
-        _p.dirtyRectInPx.bottom = std::max(_p.dirtyRectInPx.bottom, r.bottom * _p.s->font->cellSize.y);
-    }
-
     if (options.isOn)
     {
         const auto point = options.coordCursor;
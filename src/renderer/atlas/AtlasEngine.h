@@ -25,6 +25,7 @@ namespace Microsoft::Console::Render::Atlas
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
+        [[nodiscard]] bool RequiresLockForPainting() noexcept override;
         void WaitUntilCanRender() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override;
@@ -160,7 +161,8 @@ namespace Microsoft::Console::Render::Atlas
 
             // dirtyRect is a computed value based on invalidatedRows.
             til::rect dirtyRect;
-            // These "invalidation" fields are reset in EndPaint()
+            // These "invalidation" fields are reset at the end of StartPaint(),
+            // because the remainder of the frame is painted without the console lock.
             u16r invalidatedCursorArea = invalidatedAreaNone;
             range<u16> invalidatedRows = invalidatedRowsNone; // x is treated as "top" and y as "bottom"
             i16 scrollOffset = 0;
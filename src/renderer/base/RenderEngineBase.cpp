@@ -69,6 +69,18 @@ HRESULT RenderEngineBase::PrepareLineTransform(const LineRendition /*lineRenditi
     return false;
 }
 
+// Method Description:
+// - The Renderer captures everything it needs for a frame into a snapshot while it holds
+//   the console lock. Engines that return false here are painted from that snapshot
+//   after the lock was released, which lets the output thread continue in the meantime.
+// - By default engines keep the lock until EndPaint(), because many of them accept
+//   invalidations (which are made under the lock) into the same state they paint with,
+//   or read from the IRenderData given to UpdateDrawingBrushes().
+[[nodiscard]] bool RenderEngineBase::RequiresLockForPainting() noexcept
+{
+    return true;
+}
+
 // Method Description:
 // - Blocks until the engine is able to render without blocking.
 void RenderEngineBase::WaitUntilCanRender() noexcept
@@ -115,6 +115,9 @@ try
         _pData->UnlockConsole();
     });
 
+    // Forward the regions that TriggerRedraw() accumulated since the last frame to all engines at once.
+    _FlushInvalidations();
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
@@ -151,6 +154,16 @@ try
     // C. Prepare the engine with additional information before we start drawing.
     RETURN_IF_FAILED(_PrepareRenderInfo(pEngine));
 
+    // D. Capture everything that's about to be painted. Nothing below this point reads from _pData.
+    _CaptureFrame(pEngine);
+
+    // Engines that can paint without the lock do so from the snapshot, while other
+    // threads (like the one processing the application's output) continue to run.
+    if (!pEngine->RequiresLockForPainting())
+    {
+        unlock.reset();
+    }
+
     // 1. Paint Background
     RETURN_IF_FAILED(_PaintBackground(pEngine));
 
@@ -173,6 +186,7 @@ try
     endPaint.reset();
 
     // Force scope exit unlock to let go of global lock so other threads can run
+    // (unless we already did so above).
     unlock.reset();
 
     // Trigger out-of-lock presentation for renderers that can support it
@@ -211,8 +225,10 @@ void Renderer::TriggerSystemRedraw(const til::rect* const prcDirtyClient)
 
 // Routine Description:
 // - Called when a particular region within the console buffer has changed.
+// - The region isn't forwarded to the engines immediately. It's marked in the _pendingInvalidations
+//   bitmap instead, which _FlushInvalidations() forwards once at the start of the next frame.
 // Arguments:
-// - <none>
+// - region - The buffer-space region that has changed.
 // Return Value:
 // - <none>
 void Renderer::TriggerRedraw(const Viewport& region)
@@ -235,10 +251,12 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        }
+        _invalidationStats.received++;
+
+        // The bitmap is empty whenever the viewport changes (see _CheckViewportAndScroll),
+        // so this only ever allocates once for every viewport size.
+        _pendingInvalidations.resize(view.Dimensions());
+        _pendingInvalidations.set(srUpdateRegion);
 
         NotifyPaintFrame();
     }
@@ -306,6 +324,8 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll(const bool backgroundChanged, const bool frameChanged)
 {
+    _FlushInvalidations();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateAll());
@@ -401,6 +421,10 @@ bool Renderer::_CheckViewportAndScroll()
         return false;
     }
 
+    // The pending invalidations are relative to the old viewport
+    // and need to reach the engines before they scroll their contents.
+    _FlushInvalidations();
+
     _viewport = Viewport::FromInclusive(srNewViewport);
     _forceUpdateViewport = false;
 
@@ -418,6 +442,36 @@ bool Renderer::_CheckViewportAndScroll()
     return true;
 }
 
+// Routine Description:
+// - Forwards the regions accumulated by TriggerRedraw() to all engines.
+// - Needs to be called before anything else that depends on the order of invalidations
+//   is forwarded to the engines, like scrolling or painting a frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_FlushInvalidations()
+{
+    if (_pendingInvalidations.none())
+    {
+        return;
+    }
+
+    // The runs are the spans of dirty cells in each row. Unlike the regions given to TriggerRedraw(),
+    // there are never more of them than there are cells, however many writes happened in this frame.
+    const auto runs = _pendingInvalidations.runs();
+    for (const auto& rect : runs)
+    {
+        FOREACH_ENGINE(pEngine)
+        {
+            LOG_IF_FAILED(pEngine->Invalidate(&rect));
+        }
+    }
+
+    _invalidationStats.forwarded += runs.size();
+    _pendingInvalidations.reset_all();
+}
+
 // Routine Description:
 // - Called when a scroll operation has occurred by manipulating the viewport.
 // - This is a special case as calling out scrolls explicitly drastically improves performance.
@@ -444,6 +498,8 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
+    _FlushInvalidations();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
@@ -465,6 +521,8 @@ void Renderer::TriggerFlush(const bool circling)
 {
     const auto rects = _GetSelectionRects();
 
+    _FlushInvalidations();
+
     FOREACH_ENGINE(pEngine)
     {
         auto fEngineRequestsRepaint = false;
@@ -513,8 +571,7 @@ void Renderer::TriggerNewTextNotification(const std::wstring_view newText)
 // - the HRESULT of the underlying engine's UpdateTitle call.
 HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 {
-    const auto newTitle = _pData->GetConsoleTitle();
-    return pEngine->UpdateTitle(newTitle);
+    return pEngine->UpdateTitle(_snapshot.title);
 }
 
 // Routine Description:
@@ -672,31 +729,76 @@ void Renderer::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
 }
 
 // Routine Description:
-// - Paint helper to copy the primary console buffer text onto the screen.
+// - Clears the snapshot for the next frame, without releasing its memory.
+void Renderer::FrameSnapshot::Clear() noexcept
+{
+    dirtyAreas.clear();
+    text.clear();
+    clusterText.clear();
+    clusters.clear();
+    runs.clear();
+    gridLines.clear();
+    lines.clear();
+    overlayLinesBegin = 0;
+    selection.clear();
+    cursor.reset();
+    title.clear();
+}
+
+// Routine Description:
+// - Copies everything that's needed to paint the current frame into _snapshot: The text and attributes
+//   of the dirty rows, the overlays, selection, cursor and title. This is the only part of painting
+//   that needs to access the console data and as such it must be called while holding the lock.
+// Arguments:
+// - pEngine - The engine whose dirty area should be captured.
+// Return Value:
+// - <none>
+void Renderer::_CaptureFrame(_In_ IRenderEngine* const pEngine)
+{
+    _snapshot.Clear();
+    _snapshot.settings = _renderSettings;
+
+    std::span<const til::rect> dirtyAreas;
+    LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
+    _snapshot.dirtyAreas.assign(dirtyAreas.begin(), dirtyAreas.end());
+
+    _CaptureBufferOutput();
+    _snapshot.overlayLinesBegin = _snapshot.lines.size();
+    _CaptureOverlays();
+    _CaptureSelection();
+    _snapshot.cursor = _GetCursorInfo();
+    _snapshot.title.assign(_pData->GetConsoleTitle());
+
+    // The text won't grow anymore, so the clusters can now point into it.
+    const std::wstring_view text{ _snapshot.text };
+    _snapshot.clusters.reserve(_snapshot.clusterText.size());
+    for (const auto& c : _snapshot.clusterText)
+    {
+        _snapshot.clusters.emplace_back(text.substr(c.offset, c.length), c.columns);
+    }
+}
+
+// Routine Description:
+// - Capture helper for the primary console buffer text.
 // - This portion primarily handles figuring the current viewport, comparing it/trimming it versus the invalid portion of the frame, and queuing up, row by row, which pieces of text need to be further processed.
 // - See also: Helper functions that separate out each complexity of text rendering.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureBufferOutput()
 {
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
     // relative to the entire buffer.
     const auto view = _pData->GetViewport();
 
+    // Retrieve the text buffer so we can read information out of it.
+    const auto& buffer = _pData->GetTextBuffer();
+
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
-    std::span<const til::rect> dirtyAreas;
-    LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
-
-    // This is to make sure any transforms are reset when this paint is finished.
-    auto resetLineTransform = wil::scope_exit([&]() {
-        LOG_IF_FAILED(pEngine->ResetLineTransform());
-    });
-
-    for (const auto& dirtyRect : dirtyAreas)
+    for (const auto& dirtyRect : _snapshot.dirtyAreas)
     {
         if (!dirtyRect)
         {
@@ -714,9 +816,6 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
         // we need to walk through line-by-line and repaint onto the screen.
         const auto redraw = Viewport::Intersect(dirty, view);
 
-        // Retrieve the text buffer so we can read information out of it.
-        const auto& buffer = _pData->GetTextBuffer();
-
         // Now walk through each row of text that we need to redraw.
         for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
         {
@@ -742,15 +841,22 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // Calculate if two things are true:
             // 1. this row wrapped
             // 2. We're painting the last col of the row.
-            // In that case, set lineWrapped=true for the _PaintBufferOutputHelper call.
+            // In that case, set lineWrapped=true for the PaintBufferLine calls.
             const auto lineWrapped = (buffer.GetRowByOffset(bufferLine.Origin().y).WasWrapForced()) &&
                                      (bufferLine.RightExclusive() == buffer.GetSize().Width());
 
-            // Prepare the appropriate line transform for the current row and viewport offset.
-            LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.y, view.Left()));
+            auto& line = _snapshot.lines.emplace_back();
+            line.runsBegin = _snapshot.runs.size();
+            line.lineRendition = lineRendition;
+            line.targetRow = screenPosition.y;
+            line.viewportLeft = view.Left();
+            line.lineWrapped = lineWrapped;
+            line.lineTransform = true;
+
+            // Ask the helper to capture this specific line.
+            _CaptureBufferOutputHelper(it, screenPosition);
 
-            // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+            _snapshot.lines.back().runsEnd = _snapshot.runs.size();
         }
     }
 }
@@ -761,20 +867,13 @@ static bool _IsAllSpaces(const std::wstring_view v)
     return v.find_first_not_of(L' ') == decltype(v)::npos;
 }
 
-void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
-                                        const til::point target,
-                                        const bool lineWrapped)
+void Renderer::_CaptureBufferOutputHelper(TextBufferCellIterator it, const til::point target)
 {
     auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
 
     // If we have valid data, let's figure out how to draw it.
     if (it)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
         til::CoordType cols = 0;
 
         // Retrieve the first color.
@@ -796,11 +895,12 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // when we go to draw gridlines for the length of the run.
             const auto currentRunColor = color;
 
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
-            // Update the drawing brushes with our color and font usage.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
+            // The engines resolve colors with the snapshot's copy of the render settings.
+            // The original needs to learn about any blinking text that's visible on its own.
+            if (currentRunColor.IsBlinking())
+            {
+                std::ignore = _renderSettings.GetAttributeColors(currentRunColor);
+            }
 
             // Advance the point by however many columns we've just outputted and reset the accumulator.
             screenPoint.x += cols;
@@ -810,9 +910,10 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // in case we need to do some special work to paint the line drawing characters.
             const auto currentRunItStart = it;
             const auto currentRunTargetStart = screenPoint;
+            const auto currentRunUsingSoftFont = usingSoftFont;
 
-            // Ensure that our cluster vector is clear.
-            _clusterBuffer.clear();
+            // Remember where the clusters of this run begin.
+            const auto clustersBegin = _snapshot.clusterText.size();
 
             // Reset our flag to know when we're in the special circumstance
             // of attempting to draw only the right-half of a two-column character
@@ -851,7 +952,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr() == DbcsAttribute::Trailing)
+                if (_snapshot.clusterText.size() == clustersBegin && it->DbcsAttr() == DbcsAttribute::Trailing)
                 {
                     // Move left to the one so the whole character can be struck correctly.
                     --screenPoint.x;
@@ -867,14 +968,22 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 }
 
                 // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
+                const auto chars = it->Chars();
+                _snapshot.clusterText.emplace_back(FrameSnapshot::ClusterText{ _snapshot.text.size(), chars.size(), columnCount });
+                _snapshot.text.append(chars);
                 it += std::max(it->Columns(), 1); // prevent infinite loop for no visible columns
                 cols += columnCount;
 
             } while (it);
 
-            // Do the painting.
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
+            auto& run = _snapshot.runs.emplace_back();
+            run.attr = currentRunColor;
+            run.target = screenPoint;
+            run.clustersBegin = clustersBegin;
+            run.clustersEnd = _snapshot.clusterText.size();
+            run.gridLinesBegin = _snapshot.gridLines.size();
+            run.usingSoftFont = currentRunUsingSoftFont;
+            run.trimLeft = trimLeft;
 
             // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
             // We're only allowed to draw the grid lines under certain circumstances.
@@ -900,15 +1009,73 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                     for (til::CoordType colsPainted = 0; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.x)
                     {
                         auto lines = lineIt->TextAttr();
-                        _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
+                        _CaptureBufferOutputGridLineHelper(lines, 1, lineTarget);
                     }
                 }
                 else
                 {
                     // If nothing exciting is going on, draw the lines in bulk.
-                    _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
+                    _CaptureBufferOutputGridLineHelper(currentRunColor, cols, screenPoint);
                 }
             }
+
+            run.gridLinesEnd = _snapshot.gridLines.size();
+        }
+    }
+}
+
+// Routine Description:
+// - Paint helper to copy the primary console buffer text onto the screen.
+// - The text was captured by _CaptureBufferOutput() beforehand.
+// Arguments:
+// - pEngine - The render engine that we're targeting.
+// Return Value:
+// - <none>
+void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
+{
+    // This is to make sure any transforms are reset when this paint is finished.
+    auto resetLineTransform = wil::scope_exit([&]() {
+        LOG_IF_FAILED(pEngine->ResetLineTransform());
+    });
+
+    _PaintLines(pEngine, 0, _snapshot.overlayLinesBegin);
+}
+
+// Routine Description:
+// - Paints a range of the lines in _snapshot, run by run.
+// Arguments:
+// - pEngine - The render engine that we're targeting.
+// - linesBegin, linesEnd - The range of _snapshot.lines to paint.
+// Return Value:
+// - <none>
+void Renderer::_PaintLines(_In_ IRenderEngine* const pEngine, const size_t linesBegin, const size_t linesEnd)
+{
+    for (auto i = linesBegin; i < linesEnd; ++i)
+    {
+        const auto& line = til::at(_snapshot.lines, i);
+
+        if (line.lineTransform)
+        {
+            // Prepare the appropriate line transform for the current row and viewport offset.
+            LOG_IF_FAILED(pEngine->PrepareLineTransform(line.lineRendition, line.targetRow, line.viewportLeft));
+        }
+
+        for (auto j = line.runsBegin; j < line.runsEnd; ++j)
+        {
+            const auto& run = til::at(_snapshot.runs, j);
+            const std::span<const Cluster> clusters{ _snapshot.clusters.data() + run.clustersBegin, run.clustersEnd - run.clustersBegin };
+
+            // Update the drawing brushes with our color and font usage.
+            THROW_IF_FAILED(pEngine->UpdateDrawingBrushes(run.attr, _snapshot.settings, _pData, run.usingSoftFont, false));
+
+            // Do the painting.
+            THROW_IF_FAILED(pEngine->PaintBufferLine(clusters, run.target, run.trimLeft, line.lineWrapped));
+
+            for (auto k = run.gridLinesBegin; k < run.gridLinesEnd; ++k)
+            {
+                const auto& gridLine = til::at(_snapshot.gridLines, k);
+                LOG_IF_FAILED(pEngine->PaintBufferGridLines(gridLine.lines, gridLine.color, gridLine.cchLine, gridLine.target));
+            }
         }
     }
 }
@@ -968,7 +1135,7 @@ GridLineSet Renderer::s_GetGridlines(const TextAttribute& textAttribute) noexcep
 }
 
 // Routine Description:
-// - Paint helper for primary buffer output function.
+// - Capture helper for primary buffer output function.
 // - This particular helper sets up the various box drawing lines that can be inscribed around any character in the buffer (left, right, top, underline).
 // - See also: All related helpers and buffer output functions.
 // Arguments:
@@ -977,10 +1144,9 @@ GridLineSet Renderer::s_GetGridlines(const TextAttribute& textAttribute) noexcep
 // - coordTarget - The X/Y coordinate position in the buffer which we're attempting to start rendering from.
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
-                                                const TextAttribute textAttribute,
-                                                const size_t cchLine,
-                                                const til::point coordTarget)
+void Renderer::_CaptureBufferOutputGridLineHelper(const TextAttribute textAttribute,
+                                                  const size_t cchLine,
+                                                  const til::point coordTarget)
 {
     // Convert console grid line representations into rendering engine enum representations.
     auto lines = Renderer::s_GetGridlines(textAttribute);
@@ -997,8 +1163,8 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
     {
         // Get the current foreground color to render the lines.
         const auto rgb = _renderSettings.GetAttributeColors(textAttribute).first;
-        // Draw the lines
-        LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
+        // Queue the lines up for drawing
+        _snapshot.gridLines.emplace_back(FrameSnapshot::GridLine{ lines, rgb, cchLine, coordTarget });
     }
 }
 
@@ -1086,10 +1252,9 @@ bool Renderer::_isInHoveredInterval(const til::point coordTarget) const noexcept
 // - <none>
 void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 {
-    const auto cursorInfo = _GetCursorInfo();
-    if (cursorInfo.has_value())
+    if (_snapshot.cursor.has_value())
     {
-        LOG_IF_FAILED(pEngine->PaintCursor(cursorInfo.value()));
+        LOG_IF_FAILED(pEngine->PaintCursor(_snapshot.cursor.value()));
     }
 }
 
@@ -1112,15 +1277,13 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 }
 
 // Routine Description:
-// - Paint helper to draw text that overlays the main buffer to provide user interactivity regions
+// - Capture helper for text that overlays the main buffer to provide user interactivity regions
 // - This supports IME composition.
 // Arguments:
-// - engine - The render engine that we're targeting.
-// - overlay - The overlay to draw.
+// - overlay - The overlay to capture.
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlay(IRenderEngine& engine,
-                             const RenderOverlay& overlay)
+void Renderer::_CaptureOverlay(const RenderOverlay& overlay)
 {
     try
     {
@@ -1131,10 +1294,7 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
         srCaView.left += overlay.origin.x;
         srCaView.right += overlay.origin.x;
 
-        std::span<const til::rect> dirtyAreas;
-        LOG_IF_FAILED(engine.GetDirtyArea(dirtyAreas));
-
-        for (const auto& rect : dirtyAreas)
+        for (const auto& rect : _snapshot.dirtyAreas)
         {
             if (const auto viewDirty = rect & srCaView)
             {
@@ -1145,7 +1305,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 
                     auto it = overlay.buffer.GetCellLineDataAt(source);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    _snapshot.lines.emplace_back().runsBegin = _snapshot.runs.size();
+                    _CaptureBufferOutputHelper(it, target);
+                    _snapshot.lines.back().runsEnd = _snapshot.runs.size();
                 }
             }
         }
@@ -1154,14 +1316,14 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 }
 
 // Routine Description:
-// - Paint helper to draw the composition string portion of the IME.
+// - Capture helper for the composition string portion of the IME.
 // - This specifically is the string that appears at the cursor on the input line showing what the user is currently typing.
 // - See also: Generic Paint IME helper method.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureOverlays()
 {
     try
     {
@@ -1169,34 +1331,46 @@ void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 
         for (const auto& overlay : overlays)
         {
-            _PaintOverlay(*pEngine, overlay);
+            _CaptureOverlay(overlay);
         }
     }
     CATCH_LOG();
 }
 
 // Routine Description:
-// - Paint helper to draw the selected area of the window.
+// - Paint helper to draw the overlays captured by _CaptureOverlays().
 // Arguments:
-// - <none>
+// - engine - The render engine that we're targeting.
 // Return Value:
 // - <none>
-void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 {
     try
     {
-        std::span<const til::rect> dirtyAreas;
-        LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
+        _PaintLines(pEngine, _snapshot.overlayLinesBegin, _snapshot.lines.size());
+    }
+    CATCH_LOG();
+}
 
+// Routine Description:
+// - Capture helper for the selected area of the window.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_CaptureSelection()
+{
+    try
+    {
         // Get selection rectangles
         const auto rectangles = _GetSelectionRects();
         for (const auto& rect : rectangles)
         {
-            for (auto& dirtyRect : dirtyAreas)
+            for (auto& dirtyRect : _snapshot.dirtyAreas)
             {
                 if (const auto rectCopy = rect & dirtyRect)
                 {
-                    LOG_IF_FAILED(pEngine->PaintSelection(rectCopy));
+                    _snapshot.selection.emplace_back(rectCopy);
                 }
             }
         }
@@ -1204,6 +1378,20 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
     CATCH_LOG();
 }
 
+// Routine Description:
+// - Paint helper to draw the selected area of the window.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
+{
+    for (const auto& rect : _snapshot.selection)
+    {
+        LOG_IF_FAILED(pEngine->PaintSelection(rect));
+    }
+}
+
 // Routine Description:
 // - Helper to convert the text attributes to actual RGB colors and update the rendering pen/brush within the rendering engine before the next draw operation.
 // Arguments:
@@ -1380,6 +1568,18 @@ void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval
     _hoveredInterval = newInterval;
 }
 
+// Routine Description:
+// - Returns how many regions TriggerRedraw() received and how many of them were forwarded
+//   to the engines after coalescing them. Must be called while holding the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - The invalidation counters since the renderer was created.
+Renderer::InvalidationStats Renderer::GetInvalidationStats() const noexcept
+{
+    return _invalidationStats;
+}
+
 // Method Description:
 // - Blocks until the engines are able to render without blocking.
 void Renderer::WaitUntilCanRender()
@@ -36,6 +36,14 @@ namespace Microsoft::Console::Render
     class Renderer
     {
     public:
+        struct InvalidationStats
+        {
+            // The number of regions given to TriggerRedraw() that intersected the viewport.
+            uint64_t received = 0;
+            // The number of runs of dirty cells those were coalesced into and that were forwarded to each engine.
+            uint64_t forwarded = 0;
+        };
+
         Renderer(const RenderSettings& renderSettings,
                  IRenderData* pData,
                  _In_reads_(cEngines) IRenderEngine** const pEngine,
@@ -92,21 +100,90 @@ namespace Microsoft::Console::Render
         void UpdateHyperlinkHoveredId(uint16_t id) noexcept;
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
 
+        InvalidationStats GetInvalidationStats() const noexcept;
+
     private:
+        // Everything that's needed to paint a frame, captured while the console lock is being held.
+        // Engines that don't require the lock to paint are painted from this after it has been released.
+        // The members retain their capacity between frames so that capturing a frame doesn't allocate.
+        struct FrameSnapshot
+        {
+            struct Run
+            {
+                TextAttribute attr;
+                til::point target;
+                size_t clustersBegin = 0;
+                size_t clustersEnd = 0;
+                size_t gridLinesBegin = 0;
+                size_t gridLinesEnd = 0;
+                bool usingSoftFont = false;
+                bool trimLeft = false;
+            };
+
+            struct GridLine
+            {
+                GridLineSet lines;
+                COLORREF color = 0;
+                size_t cchLine = 0;
+                til::point target;
+            };
+
+            struct Line
+            {
+                size_t runsBegin = 0;
+                size_t runsEnd = 0;
+                LineRendition lineRendition = LineRendition::SingleWidth;
+                til::CoordType targetRow = 0;
+                til::CoordType viewportLeft = 0;
+                bool lineWrapped = false;
+                // Lines of the text buffer get a line transform, overlays don't.
+                bool lineTransform = false;
+            };
+
+            // Clusters can only point into `text` once it stopped growing. Until then they're stored as offsets.
+            struct ClusterText
+            {
+                size_t offset = 0;
+                size_t length = 0;
+                til::CoordType columns = 0;
+            };
+
+            void Clear() noexcept;
+
+            RenderSettings settings;
+            std::vector<til::rect> dirtyAreas;
+            std::wstring text;
+            std::vector<ClusterText> clusterText;
+            std::vector<Cluster> clusters;
+            std::vector<Run> runs;
+            std::vector<GridLine> gridLines;
+            std::vector<Line> lines;
+            size_t overlayLinesBegin = 0;
+            std::vector<til::rect> selection;
+            std::optional<CursorOptions> cursor;
+            std::wstring title;
+        };
+
         static GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
         bool _CheckViewportAndScroll();
+        void _FlushInvalidations();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
+        void _CaptureFrame(_In_ IRenderEngine* const pEngine);
+        void _CaptureBufferOutput();
+        void _CaptureBufferOutputHelper(TextBufferCellIterator it, const til::point target);
+        void _CaptureBufferOutputGridLineHelper(const TextAttribute textAttribute, const size_t cchLine, const til::point coordTarget);
+        void _CaptureSelection();
+        void _CaptureOverlays();
+        void _CaptureOverlay(const RenderOverlay& overlay);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const til::point target, const bool lineWrapped);
-        void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine, const TextAttribute textAttribute, const size_t cchLine, const til::point coordTarget);
+        void _PaintLines(_In_ IRenderEngine* const pEngine, const size_t linesBegin, const size_t linesEnd);
         bool _isHoveredHyperlink(const TextAttribute& textAttribute) const noexcept;
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
         void _PaintCursor(_In_ IRenderEngine* const pEngine);
         void _PaintOverlays(_In_ IRenderEngine* const pEngine);
-        void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
         [[nodiscard]] HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool usingSoftFont, const bool isSettingDefaultBrushes);
         [[nodiscard]] HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
         std::vector<til::rect> _GetSelectionRects() const;
@@ -125,7 +202,11 @@ namespace Microsoft::Console::Render
         uint16_t _hyperlinkHoveredId = 0;
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
         Microsoft::Console::Types::Viewport _viewport;
-        std::vector<Cluster> _clusterBuffer;
+        FrameSnapshot _snapshot;
+        // The cells invalidated by TriggerRedraw() since they were last forwarded to the engines, relative to _viewport.
+        // Its size is bounded by the viewport, so a stream of small writes turns into a few runs of dirty cells per row and frame.
+        til::bitmap _pendingInvalidations;
+        InvalidationStats _invalidationStats;
         std::vector<til::rect> _previousSelection;
         std::function<void()> _pfnBackgroundColorChanged;
         std::function<void()> _pfnFrameColorChanged;
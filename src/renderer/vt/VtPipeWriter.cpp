@@ -0,0 +1,203 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "VtPipeWriter.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates the writer and starts its thread.
+// - NOTE: Will throw if initialization failure. Caller must catch.
+// Arguments:
+// - pipe - The pipe to write to.
+// - maxPendingSize - The number of bytes the pending buffer may grow to, before Submit() blocks.
+VtPipeWriter::VtPipeWriter(wil::unique_hfile pipe, size_t maxPendingSize) :
+    _pipe{ std::move(pipe) },
+    _maxPendingSize{ maxPendingSize }
+{
+    THROW_HR_IF(E_HANDLE, !_pipe);
+
+    _thread = std::thread{ &VtPipeWriter::_writerThread, this };
+    LOG_IF_FAILED(SetThreadDescription(_thread.native_handle(), L"ConPTY Output Writer Thread"));
+}
+
+// Routine Description:
+// - Writes any pending output to the pipe and stops the writer thread.
+// - If the output can't be written within ShutdownTimeout, because the terminal stopped
+//   reading from the pipe, the remaining output is dropped and the blocked write cancelled.
+//   Otherwise joining the writer thread would hang forever.
+VtPipeWriter::~VtPipeWriter()
+{
+    const auto idle = WaitForIdle(ShutdownTimeout);
+    LOG_HR_IF(idle, idle == HRESULT_FROM_WIN32(ERROR_TIMEOUT));
+
+    {
+        std::unique_lock guard{ _lock };
+        _exit = true;
+        _pending.clear();
+
+        // CancelSynchronousIo() fails if the thread hasn't entered WriteFile() yet,
+        // which is why we retry until the writer thread reports back.
+        while (_writing)
+        {
+            CancelSynchronousIo(_thread.native_handle());
+            _writingChanged.wait_for(guard, std::chrono::milliseconds{ 10 });
+        }
+    }
+
+    _pendingChanged.notify_all();
+    _thread.join();
+}
+
+// Routine Description:
+// - Hands the contents of `buffer` over to the writer thread. If the previous frame hasn't
+//   been written yet, it's appended to it. If that would exceed the maximum pending size,
+//   this blocks until the writer thread started writing the previous frame.
+// - On return `buffer` is empty, but may have gained the capacity of an earlier buffer,
+//   so that the caller can serialize the next frame without allocating.
+// Arguments:
+// - buffer - The frame to write.
+// Return Value:
+// - S_OK, or the error of a failed write. Once a write failed, nothing will be written anymore.
+[[nodiscard]] HRESULT VtPipeWriter::Submit(std::string& buffer) noexcept
+try
+{
+    if (buffer.empty())
+    {
+        return S_OK;
+    }
+
+    std::unique_lock guard{ _lock };
+
+    if (SUCCEEDED(_result) && !_pending.empty() && _pending.size() + buffer.size() > _maxPendingSize)
+    {
+        const auto beg = clock::now();
+        _writingChanged.wait(guard, [&]() { return _pending.empty() || FAILED(_result); });
+        _stats.blockedTotal += clock::now() - beg;
+    }
+
+    if (FAILED(_result))
+    {
+        buffer.clear();
+        return _result;
+    }
+
+    _stats.frames++;
+
+    if (_pending.empty())
+    {
+        _pending.swap(buffer);
+        _pendingSince = clock::now();
+    }
+    else
+    {
+        _pending.append(buffer);
+        _stats.framesMerged++;
+    }
+
+    buffer.clear();
+    guard.unlock();
+    _pendingChanged.notify_one();
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Blocks until all submitted frames have been written to the pipe.
+// Return Value:
+// - S_OK, or the error of a failed write.
+[[nodiscard]] HRESULT VtPipeWriter::WaitForIdle() noexcept
+try
+{
+    std::unique_lock guard{ _lock };
+    _writingChanged.wait(guard, [&]() { return _isIdle(); });
+    return _result;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Blocks until all submitted frames have been written to the pipe, or until the timeout elapsed.
+// Arguments:
+// - timeout - The maximum time to wait for.
+// Return Value:
+// - S_OK, the error of a failed write, or HRESULT_FROM_WIN32(ERROR_TIMEOUT).
+[[nodiscard]] HRESULT VtPipeWriter::WaitForIdle(const std::chrono::milliseconds timeout) noexcept
+try
+{
+    std::unique_lock guard{ _lock };
+    if (!_writingChanged.wait_for(guard, timeout, [&]() { return _isIdle(); }))
+    {
+        return HRESULT_FROM_WIN32(ERROR_TIMEOUT);
+    }
+    return _result;
+}
+CATCH_RETURN()
+
+VtPipeWriter::Stats VtPipeWriter::GetStats() const noexcept
+{
+    std::lock_guard guard{ _lock };
+    return _stats;
+}
+
+// Must be called with _lock held.
+bool VtPipeWriter::_isIdle() const noexcept
+{
+    return (_pending.empty() && !_writing) || FAILED(_result);
+}
+
+void VtPipeWriter::_writerThread() noexcept
+{
+    for (;;)
+    {
+        clock::time_point pendingSince;
+
+        {
+            std::unique_lock guard{ _lock };
+            _pendingChanged.wait(guard, [&]() { return !_pending.empty() || _exit; });
+
+            // We only exit once everything has been written.
+            if (_pending.empty())
+            {
+                return;
+            }
+
+            _written.swap(_pending);
+            pendingSince = _pendingSince;
+            _writing = true;
+        }
+
+        // A blocked Submit() may now append to the (empty) pending buffer.
+        _writingChanged.notify_all();
+
+        DWORD bytesWritten = 0;
+        const auto success = !!WriteFile(_pipe.get(), _written.data(), gsl::narrow_cast<DWORD>(_written.size()), &bytesWritten, nullptr);
+        const auto hr = success ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+        const auto latency = clock::now() - pendingSince;
+
+        {
+            std::lock_guard guard{ _lock };
+            _writing = false;
+            _stats.writes++;
+            _stats.bytes += bytesWritten;
+            _stats.flushLatencyTotal += latency;
+            _stats.flushLatencyMax = std::max<std::chrono::nanoseconds>(_stats.flushLatencyMax, latency);
+
+            if (FAILED(hr))
+            {
+                _result = hr;
+                _pending.clear();
+            }
+        }
+
+        _written.clear();
+        _writingChanged.notify_all();
+
+        if (FAILED(hr))
+        {
+            return;
+        }
+    }
+}
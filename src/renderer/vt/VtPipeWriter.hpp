@@ -0,0 +1,88 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtPipeWriter.hpp
+
+Abstract:
+- Writes the output of the VtEngine to the ConPTY output pipe on a dedicated thread.
+    The render thread serializes a frame into one buffer, while the writer thread
+    drains the other one, so that painting (which happens under the console lock)
+    doesn't stall whenever the terminal is slow to read from the pipe.
+- If the terminal falls behind, frames submitted in the meantime are appended to
+    the pending buffer and written with a single WriteFile ("merged"). Once the
+    pending buffer exceeds its limit, Submit() blocks until the writer caught up,
+    which pushes back on the client application just like a blocking write would.
+- On destruction, the writer gets ShutdownTimeout to write out what's still pending.
+    After that a write that's stuck, because the terminal stopped reading, is cancelled.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace Microsoft::Console::Render
+{
+    class VtPipeWriter
+    {
+    public:
+        struct Stats
+        {
+            // The number of frames given to Submit().
+            uint64_t frames = 0;
+            // The number of frames that were appended to a still pending frame.
+            uint64_t framesMerged = 0;
+            // The number of WriteFile calls made by the writer thread.
+            uint64_t writes = 0;
+            // The number of bytes written to the pipe.
+            uint64_t bytes = 0;
+            // The time from a Submit() until the writer finished writing it to the pipe.
+            std::chrono::nanoseconds flushLatencyTotal{};
+            std::chrono::nanoseconds flushLatencyMax{};
+            // The time Submit() spent waiting on the writer, because the pending buffer was full.
+            std::chrono::nanoseconds blockedTotal{};
+        };
+
+        static constexpr size_t DefaultMaxPendingSize = 4 * 1024 * 1024;
+        static constexpr std::chrono::milliseconds ShutdownTimeout{ 1000 };
+
+        VtPipeWriter(wil::unique_hfile pipe, size_t maxPendingSize = DefaultMaxPendingSize);
+        ~VtPipeWriter();
+
+        VtPipeWriter(const VtPipeWriter&) = delete;
+        VtPipeWriter& operator=(const VtPipeWriter&) = delete;
+        VtPipeWriter(VtPipeWriter&&) = delete;
+        VtPipeWriter& operator=(VtPipeWriter&&) = delete;
+
+        [[nodiscard]] HRESULT Submit(std::string& buffer) noexcept;
+        [[nodiscard]] HRESULT WaitForIdle() noexcept;
+        [[nodiscard]] HRESULT WaitForIdle(std::chrono::milliseconds timeout) noexcept;
+        Stats GetStats() const noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        bool _isIdle() const noexcept;
+        void _writerThread() noexcept;
+
+        wil::unique_hfile _pipe;
+        size_t _maxPendingSize;
+
+        // _lock guards all members below.
+        mutable std::mutex _lock;
+        std::condition_variable _pendingChanged;
+        std::condition_variable _writingChanged;
+        std::string _pending;
+        clock::time_point _pendingSince;
+        bool _writing = false;
+        bool _exit = false;
+        HRESULT _result = S_OK;
+        Stats _stats;
+
+        // Only accessed by the writer thread.
+        std::string _written;
+
+        std::thread _thread;
+    };
+}
@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "VtSgrEncoder.hpp"
+
+#include "../../inc/conattrs.hpp"
+
+#include <til/hash.h>
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// The rendition attributes that have an SGR representation. Everything else
+// (the hyperlink ID, the other gridlines, etc.) isn't part of the SGR state.
+static constexpr auto sgrAttributes = CharacterAttributes::Intense |
+                                      CharacterAttributes::Faint |
+                                      CharacterAttributes::Italics |
+                                      CharacterAttributes::Blinking |
+                                      CharacterAttributes::Invisible |
+                                      CharacterAttributes::CrossedOut |
+                                      CharacterAttributes::Underlined |
+                                      CharacterAttributes::DoublyUnderlined |
+                                      CharacterAttributes::TopGridline | // overline
+                                      CharacterAttributes::ReverseVideo;
+
+static void appendColor(std::string& out, const TextColor& color, const bool isForeground)
+{
+    if (color.IsDefault())
+    {
+        out.append(isForeground ? "39;" : "49;");
+    }
+    else if (color.IsIndex16())
+    {
+        // See VtEngine::_SetGraphicsRendition16Color.
+        const auto index = color.GetIndex();
+        const auto prefix = WI_IsFlagSet(index, FOREGROUND_INTENSITY) ? (isForeground ? 90 : 100) : (isForeground ? 30 : 40);
+        fmt::format_to(std::back_inserter(out), FMT_COMPILE("{};"), prefix + (index & 7));
+    }
+    else if (color.IsIndex256())
+    {
+        fmt::format_to(std::back_inserter(out), FMT_COMPILE("{}8;5;{};"), isForeground ? '3' : '4', color.GetIndex());
+    }
+    else if (color.IsRgb())
+    {
+        const auto rgb = color.GetRGB();
+        fmt::format_to(std::back_inserter(out), FMT_COMPILE("{}8;2;{};{};{};"), isForeground ? '3' : '4', GetRValue(rgb), GetGValue(rgb), GetBValue(rgb));
+    }
+}
+
+// Routine Description:
+// - Returns the part of the attributes that's represented by SGR sequences:
+//      the colors and the rendition attributes, but not the hyperlink.
+TextAttribute VtSgrEncoder::GetState(const TextAttribute& attributes) noexcept
+{
+    auto state = attributes;
+    state.SetCharacterAttributes(attributes.GetCharacterAttributes() & sgrAttributes);
+    state.SetHyperlinkId(0);
+    return state;
+}
+
+// Routine Description:
+// - Appends the SGR sequence that turns `from` into `to` to `out`.
+//      Appends nothing if they're the same.
+// - If both colors become the defaults, the sequence starts with a reset,
+//      after which any rendition attributes that `to` keeps are turned back on.
+// Arguments:
+// - from - the attributes the terminal currently uses.
+// - to - the attributes to switch to.
+// - out - the buffer to append to.
+void VtSgrEncoder::EncodeUncached(const TextAttribute& from, const TextAttribute& to, std::string& out)
+{
+    const auto beg = out.size();
+    out.append("\x1b[");
+
+    auto last = GetState(from);
+    const auto next = GetState(to);
+
+    if (next.GetForeground().IsDefault() && next.GetBackground().IsDefault() &&
+        !(last.GetForeground().IsDefault() && last.GetBackground().IsDefault()))
+    {
+        out.append("0;");
+        last = {};
+    }
+
+    if (next.GetForeground() != last.GetForeground())
+    {
+        appendColor(out, next.GetForeground(), true);
+    }
+    if (next.GetBackground() != last.GetBackground())
+    {
+        appendColor(out, next.GetBackground(), false);
+    }
+
+    // Intense and faint, as well as the two underline styles,
+    // are turned off by the same parameter.
+    if ((!next.IsIntense() && last.IsIntense()) || (!next.IsFaint() && last.IsFaint()))
+    {
+        out.append("22;");
+        last.SetIntense(false);
+        last.SetFaint(false);
+    }
+    if (next.IsIntense() && !last.IsIntense())
+    {
+        out.append("1;");
+    }
+    if (next.IsFaint() && !last.IsFaint())
+    {
+        out.append("2;");
+    }
+
+    if ((!next.IsUnderlined() && last.IsUnderlined()) || (!next.IsDoublyUnderlined() && last.IsDoublyUnderlined()))
+    {
+        out.append("24;");
+        last.SetUnderlined(false);
+        last.SetDoublyUnderlined(false);
+    }
+    if (next.IsUnderlined() && !last.IsUnderlined())
+    {
+        out.append("4;");
+    }
+    if (next.IsDoublyUnderlined() && !last.IsDoublyUnderlined())
+    {
+        out.append("21;");
+    }
+
+    if (next.IsOverlined() != last.IsOverlined())
+    {
+        out.append(next.IsOverlined() ? "53;" : "55;");
+    }
+    if (next.IsItalic() != last.IsItalic())
+    {
+        out.append(next.IsItalic() ? "3;" : "23;");
+    }
+    if (next.IsBlinking() != last.IsBlinking())
+    {
+        out.append(next.IsBlinking() ? "5;" : "25;");
+    }
+    if (next.IsInvisible() != last.IsInvisible())
+    {
+        out.append(next.IsInvisible() ? "8;" : "28;");
+    }
+    if (next.IsCrossedOut() != last.IsCrossedOut())
+    {
+        out.append(next.IsCrossedOut() ? "9;" : "29;");
+    }
+    if (next.IsReverseVideo() != last.IsReverseVideo())
+    {
+        out.append(next.IsReverseVideo() ? "7;" : "27;");
+    }
+
+    const std::string_view params{ out.data() + beg + 2, out.size() - beg - 2 };
+    if (params.empty())
+    {
+        out.resize(beg);
+    }
+    else if (params == "0;")
+    {
+        out.resize(out.size() - 2);
+        out.push_back('m');
+    }
+    else
+    {
+        out.back() = 'm';
+    }
+}
+
+// Routine Description:
+// - Like EncodeUncached, but copies the sequence from the cache if the same
+//      transition was encoded recently.
+void VtSgrEncoder::Encode(const TextAttribute& from, const TextAttribute& to, std::string& out)
+{
+    const auto last = GetState(from);
+    const auto next = GetState(to);
+
+    til::hasher hasher;
+    hasher.write(&last, sizeof(last));
+    hasher.write(&next, sizeof(next));
+    auto& transition = til::at(_cache, hasher.finalize() % _cache.size());
+
+    if (!transition.valid || transition.from != last || transition.to != next)
+    {
+        transition.from = last;
+        transition.to = next;
+        transition.sequence.clear();
+        EncodeUncached(last, next, transition.sequence);
+        transition.valid = true;
+    }
+
+    out.append(transition.sequence);
+}
@@ -0,0 +1,42 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtSgrEncoder.hpp
+
+Abstract:
+- Serializes the difference between two TextAttributes into a single SGR
+    sequence, like "ESC[1;38;2;r;g;bm", instead of one sequence per color and
+    rendition attribute.
+- Colorful output usually alternates between a handful of attributes, so the
+    sequences of recently seen (from, to) transitions are kept in a small
+    direct-mapped cache and are simply copied into the output buffer.
+--*/
+
+#pragma once
+
+#include "../../buffer/out/TextAttribute.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class VtSgrEncoder
+    {
+    public:
+        static TextAttribute GetState(const TextAttribute& attributes) noexcept;
+        static void EncodeUncached(const TextAttribute& from, const TextAttribute& to, std::string& out);
+
+        void Encode(const TextAttribute& from, const TextAttribute& to, std::string& out);
+
+    private:
+        struct Transition
+        {
+            TextAttribute from;
+            TextAttribute to;
+            std::string sequence;
+            bool valid = false;
+        };
+
+        std::array<Transition, 64> _cache;
+    };
+}
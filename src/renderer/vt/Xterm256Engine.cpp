@@ -16,7 +16,7 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. Writes true RGB
-//      color sequences.
+//      color sequences, combined with the character rendition into one SGR.
 // Arguments:
 // - textAttributes - Text attributes to use for the colors and character rendition
 // - renderSettings - The color table and modes required for rendering
@@ -27,14 +27,20 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT Xterm256Engine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                           const RenderSettings& /*renderSettings*/,
+                                                           const RenderSettings& renderSettings,
                                                            const gsl::not_null<IRenderData*> pData,
                                                            const bool usingSoftFont,
                                                            const bool isSettingDefaultBrushes) noexcept
 {
     RETURN_HR_IF(S_FALSE, _passthrough && isSettingDefaultBrushes);
 
-    RETURN_IF_FAILED(VtEngine::_RgbUpdateDrawingBrushes(textAttributes));
+    if (_DeferDrawingBrushes(textAttributes, renderSettings, pData, usingSoftFont, isSettingDefaultBrushes))
+    {
+        return S_OK;
+    }
+
+    // Only do extended attributes in xterm-256color, as to not break telnet.exe.
+    RETURN_IF_FAILED(_UpdateGraphicsRendition(textAttributes));
 
     RETURN_IF_FAILED(_UpdateHyperlinkAttr(textAttributes, pData));
 
@@ -49,104 +55,35 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
         _usingSoftFont = usingSoftFont;
     }
 
-    // Only do extended attributes in xterm-256color, as to not break telnet.exe.
-    return _UpdateExtendedAttrs(textAttributes);
+    return S_OK;
 }
 
 // Routine Description:
-// - Write a VT sequence to update the character rendition attributes.
+// - Write a single SGR sequence that changes the current colors and character
+//      rendition attributes to the given ones. Only the parameters that differ
+//      from the last attributes are included. The hyperlink ID is left alone.
 // Arguments:
-// - textAttributes - text attributes (intense, italic, underline, etc.) to use.
+// - textAttributes - text attributes (colors, intense, italic, underline, etc.) to use.
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT Xterm256Engine::_UpdateExtendedAttrs(const TextAttribute& textAttributes) noexcept
+[[nodiscard]] HRESULT Xterm256Engine::_UpdateGraphicsRendition(const TextAttribute& textAttributes) noexcept
+try
 {
-    // Turning off Intense and Faint must be handled at the same time,
-    // since there is only one sequence that resets both of them.
-    const auto intenseTurnedOff = !textAttributes.IsIntense() && _lastTextAttributes.IsIntense();
-    const auto faintTurnedOff = !textAttributes.IsFaint() && _lastTextAttributes.IsFaint();
-    if (intenseTurnedOff || faintTurnedOff)
-    {
-        RETURN_IF_FAILED(_SetIntense(false));
-        _lastTextAttributes.SetIntense(false);
-        _lastTextAttributes.SetFaint(false);
-    }
-
-    // Once we've handled the cases where they need to be turned off,
-    // we can then check if either should be turned back on again.
-    if (textAttributes.IsIntense() && !_lastTextAttributes.IsIntense())
-    {
-        RETURN_IF_FAILED(_SetIntense(true));
-        _lastTextAttributes.SetIntense(true);
-    }
-    if (textAttributes.IsFaint() && !_lastTextAttributes.IsFaint())
-    {
-        RETURN_IF_FAILED(_SetFaint(true));
-        _lastTextAttributes.SetFaint(true);
-    }
-
-    // Turning off the underline styles must be handled at the same time,
-    // since there is only one sequence that resets both of them.
-    const auto singleTurnedOff = !textAttributes.IsUnderlined() && _lastTextAttributes.IsUnderlined();
-    const auto doubleTurnedOff = !textAttributes.IsDoublyUnderlined() && _lastTextAttributes.IsDoublyUnderlined();
-    if (singleTurnedOff || doubleTurnedOff)
-    {
-        RETURN_IF_FAILED(_SetUnderlined(false));
-        _lastTextAttributes.SetUnderlined(false);
-        _lastTextAttributes.SetDoublyUnderlined(false);
-    }
-
-    // Once we've handled the cases where they need to be turned off,
-    // we can then check if either should be turned back on again.
-    if (textAttributes.IsUnderlined() && !_lastTextAttributes.IsUnderlined())
-    {
-        RETURN_IF_FAILED(_SetUnderlined(true));
-        _lastTextAttributes.SetUnderlined(true);
-    }
-    if (textAttributes.IsDoublyUnderlined() && !_lastTextAttributes.IsDoublyUnderlined())
-    {
-        RETURN_IF_FAILED(_SetDoublyUnderlined(true));
-        _lastTextAttributes.SetDoublyUnderlined(true);
-    }
-
-    if (textAttributes.IsOverlined() != _lastTextAttributes.IsOverlined())
-    {
-        RETURN_IF_FAILED(_SetOverlined(textAttributes.IsOverlined()));
-        _lastTextAttributes.SetOverlined(textAttributes.IsOverlined());
-    }
-
-    if (textAttributes.IsItalic() != _lastTextAttributes.IsItalic())
-    {
-        RETURN_IF_FAILED(_SetItalic(textAttributes.IsItalic()));
-        _lastTextAttributes.SetItalic(textAttributes.IsItalic());
-    }
-
-    if (textAttributes.IsBlinking() != _lastTextAttributes.IsBlinking())
+    auto next = VtSgrEncoder::GetState(textAttributes);
+    if (next == VtSgrEncoder::GetState(_lastTextAttributes))
     {
-        RETURN_IF_FAILED(_SetBlinking(textAttributes.IsBlinking()));
-        _lastTextAttributes.SetBlinking(textAttributes.IsBlinking());
+        return S_OK;
     }
 
-    if (textAttributes.IsInvisible() != _lastTextAttributes.IsInvisible())
-    {
-        RETURN_IF_FAILED(_SetInvisible(textAttributes.IsInvisible()));
-        _lastTextAttributes.SetInvisible(textAttributes.IsInvisible());
-    }
-
-    if (textAttributes.IsCrossedOut() != _lastTextAttributes.IsCrossedOut())
-    {
-        RETURN_IF_FAILED(_SetCrossedOut(textAttributes.IsCrossedOut()));
-        _lastTextAttributes.SetCrossedOut(textAttributes.IsCrossedOut());
-    }
-
-    if (textAttributes.IsReverseVideo() != _lastTextAttributes.IsReverseVideo())
-    {
-        RETURN_IF_FAILED(_SetReverseVideo(textAttributes.IsReverseVideo()));
-        _lastTextAttributes.SetReverseVideo(textAttributes.IsReverseVideo());
-    }
+    _sgrBuffer.clear();
+    _sgrEncoder.Encode(_lastTextAttributes, next, _sgrBuffer);
+    RETURN_IF_FAILED(_Write(_sgrBuffer));
 
+    next.SetHyperlinkId(_lastTextAttributes.GetHyperlinkId());
+    _lastTextAttributes = next;
     return S_OK;
 }
+CATCH_RETURN()
 
 // Routine Description:
 // - Write a VT sequence to start/stop a hyperlink
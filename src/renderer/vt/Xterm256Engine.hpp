@@ -17,6 +17,7 @@ Author(s):
 #pragma once
 
 #include "XtermEngine.hpp"
+#include "VtSgrEncoder.hpp"
 
 class VtApiRoutines;
 
@@ -41,10 +42,13 @@ namespace Microsoft::Console::Render
         friend class ::VtApiRoutines;
 
     private:
-        [[nodiscard]] HRESULT _UpdateExtendedAttrs(const TextAttribute& textAttributes) noexcept;
+        [[nodiscard]] HRESULT _UpdateGraphicsRendition(const TextAttribute& textAttributes) noexcept;
         [[nodiscard]] HRESULT _UpdateHyperlinkAttr(const TextAttribute& textAttributes,
                                                    const gsl::not_null<IRenderData*> pData) noexcept;
 
+        VtSgrEncoder _sgrEncoder;
+        std::string _sgrBuffer;
+
 #ifdef UNIT_TESTING
         friend class VtRendererTest;
         friend class ConptyOutputTests;
@@ -64,6 +64,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      the screen on the first paint, just to make sure that the
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
+        _InvalidateShadowFrame();
         _clearedAllThisFrame = true;
         _firstPaint = false;
     }
@@ -145,11 +146,16 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT XtermEngine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                        const RenderSettings& /*renderSettings*/,
-                                                        const gsl::not_null<IRenderData*> /*pData*/,
-                                                        const bool /*usingSoftFont*/,
-                                                        const bool /*isSettingDefaultBrushes*/) noexcept
+                                                        const RenderSettings& renderSettings,
+                                                        const gsl::not_null<IRenderData*> pData,
+                                                        const bool usingSoftFont,
+                                                        const bool isSettingDefaultBrushes) noexcept
 {
+    if (_DeferDrawingBrushes(textAttributes, renderSettings, pData, usingSoftFont, isSettingDefaultBrushes))
+    {
+        return S_OK;
+    }
+
     // The base xterm mode only knows about 16 colors
     RETURN_IF_FAILED(VtEngine::_16ColorUpdateDrawingBrushes(textAttributes));
 
@@ -365,6 +371,9 @@ try
     const auto dy = _scrollDelta.y;
     const auto absDy = abs(dy);
 
+    // The rows we're about to insert are filled with the current background color.
+    RETURN_IF_FAILED(_ApplyDrawingBrushes());
+
     // Save the old wrap state here. We're going to clear it so that
     // _MoveCursor will definitely move us to the right position. We'll
     // restore the state afterwards.
@@ -402,6 +411,8 @@ try
     _wrappedRow = oldWrappedRow;
     _delayedEolWrap = oldDelayedEolWrap;
 
+    _ScrollShadowFrame(dy);
+
     // Shift our internal tracker of the last text position according to how
     // much we've scrolled. If we manually scroll the buffer right now, by
     // moving the cursor to the bottom row of the viewport and emitting a
@@ -509,8 +520,12 @@ CATCH_RETURN();
                                                    const bool /*trimLeft*/,
                                                    const bool lineWrapped) noexcept
 {
-    return _fUseAsciiOnly ?
-               VtEngine::_PaintAsciiBufferLine(clusters, coord) :
+    if (_fUseAsciiOnly)
+    {
+        return VtEngine::_PaintAsciiBufferLine(clusters, coord);
+    }
+    return _shadowFrameEnabled ?
+               VtEngine::_PaintChangedClusters(clusters, coord, lineWrapped) :
                VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped);
 }
 
@@ -523,6 +538,8 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // We don't know what the sequence does to the terminal's contents.
+    _InvalidateShadowFrame();
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
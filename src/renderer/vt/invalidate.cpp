@@ -92,6 +92,9 @@ try
 {
     _trace.TraceInvalidateAll(_lastViewport.ToOrigin().ToExclusive());
     _invalidMap.set_all();
+    // Something changed that affects the entire frame (like the color table),
+    // so the shadow frame can't be trusted to match what the terminal shows.
+    _InvalidateShadowFrame();
     return S_OK;
 }
 CATCH_RETURN();
@@ -133,12 +136,15 @@ CATCH_RETURN();
 // - Notifies us that we're about to be torn down. This gives us a last chance
 //      to force a repaint before the buffer contents are lost. The VT renderer
 //      needs to be able to render all text before it's lost, so we return true.
+// - Since the process exits right after the final paint, from now on every
+//      flush waits for the pipe writer to actually write the output.
 // Arguments:
 // - Receives a bool indicating if we should force the repaint.
 // Return Value:
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
+    _tearingDown = true;
     *pForcePaint = true;
     return S_OK;
 }
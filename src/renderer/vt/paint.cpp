@@ -20,7 +20,7 @@ using namespace Microsoft::Console::Types;
 //      HRESULT error code if painting didn't start successfully.
 [[nodiscard]] HRESULT VtEngine::StartPaint() noexcept
 {
-    if (!_hFile)
+    if (!_pipeWriter)
     {
         return S_FALSE;
     }
@@ -43,6 +43,13 @@ using namespace Microsoft::Console::Types;
                            _cursorMoved,
                            _wrappedRow);
 
+    // The final frame before teardown may have nothing new to paint,
+    // but the previous ones might still be waiting to be written.
+    if (_quickReturn && _tearingDown)
+    {
+        RETURN_IF_FAILED(_Flush());
+    }
+
     return _quickReturn ? S_FALSE : S_OK;
 }
 
@@ -79,6 +86,9 @@ using namespace Microsoft::Console::Types;
     }
     _circled = false;
 
+    // The render data these point to is only valid during the frame.
+    _pendingBrushes.reset();
+
     // If _stopUsingLineRenditions is still true at the end of the frame, that
     // means we've refreshed the entire viewport with every line being single
     // width, so we can safely stop using them from now on.
@@ -246,80 +256,6 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
-// Routine Description:
-// - Write a VT sequence to change the current colors of text. Writes true RGB
-//      color sequences.
-// Arguments:
-// - textAttributes: Text attributes to use for the colors.
-// Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT VtEngine::_RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept
-{
-    const auto fg = textAttributes.GetForeground();
-    const auto bg = textAttributes.GetBackground();
-    auto lastFg = _lastTextAttributes.GetForeground();
-    auto lastBg = _lastTextAttributes.GetBackground();
-
-    // If both the FG and BG should be the defaults, emit a SGR reset.
-    if (fg.IsDefault() && bg.IsDefault() && !(lastFg.IsDefault() && lastBg.IsDefault()))
-    {
-        // SGR Reset will clear all attributes (except hyperlink ID) - which means
-        // we cannot reset _lastTextAttributes by simply doing
-        // _lastTextAttributes = {};
-        // because we want to retain the last hyperlink ID
-        RETURN_IF_FAILED(_SetGraphicsDefault());
-        _lastTextAttributes.SetDefaultBackground();
-        _lastTextAttributes.SetDefaultForeground();
-        _lastTextAttributes.SetDefaultRenditionAttributes();
-        lastFg = {};
-        lastBg = {};
-    }
-
-    if (fg != lastFg)
-    {
-        if (fg.IsDefault())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(true));
-        }
-        else if (fg.IsIndex16())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition16Color(fg.GetIndex(), true));
-        }
-        else if (fg.IsIndex256())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition256Color(fg.GetIndex(), true));
-        }
-        else if (fg.IsRgb())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(fg.GetRGB(), true));
-        }
-        _lastTextAttributes.SetForeground(fg);
-    }
-
-    if (bg != lastBg)
-    {
-        if (bg.IsDefault())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(false));
-        }
-        else if (bg.IsIndex16())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition16Color(bg.GetIndex(), false));
-        }
-        else if (bg.IsIndex256())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRendition256Color(bg.GetIndex(), false));
-        }
-        else if (bg.IsRgb())
-        {
-            RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(bg.GetRGB(), false));
-        }
-        _lastTextAttributes.SetBackground(bg);
-    }
-
-    return S_OK;
-}
-
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. It will try to
 //      find ANSI colors that are nearest to the input colors, and write those
@@ -408,6 +344,7 @@ using namespace Microsoft::Console::Types;
 {
     try
     {
+        RETURN_IF_FAILED(_ApplyDrawingBrushes());
         RETURN_IF_FAILED(_MoveCursor(coord));
 
         _bufferLine.clear();
@@ -447,6 +384,8 @@ using namespace Microsoft::Console::Types;
         return S_OK;
     }
 
+    RETURN_IF_FAILED(_ApplyDrawingBrushes());
+
     _bufferLine.clear();
     _bufferLine.reserve(clusters.size());
     til::CoordType totalWidth = 0;
@@ -656,6 +595,255 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Draws one line of the buffer to the screen like _PaintUtf8BufferLine, but
+//      compares it against the shadow frame first and only writes the clusters
+//      the terminal doesn't already show. Changes that are at most
+//      SHADOW_FRAME_MERGE_GAP columns apart are written as a single piece of
+//      text, since rewriting a few cells is cheaper than a CUF or CUP sequence.
+//      Blank tails still get turned into ECH/EL by _PaintUtf8BufferLine.
+// - Runs that wrap are always painted in full, because the last cell has to be
+//      written for the terminal to wrap the line. Runs with a soft font or line
+//      renditions are painted in full too, and aren't recorded in the shadow frame.
+// Arguments:
+// - clusters - text and column widths to be written
+// - coord - character coordinate target to render within viewport
+// - lineWrapped: true if this run is the end of a line that wrapped.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintChangedClusters(const std::span<const Cluster> clusters,
+                                                      const til::point coord,
+                                                      const bool lineWrapped) noexcept
+{
+    const auto inShadowFrame = coord.y >= _virtualTop &&
+                               coord.y >= 0 && coord.y < _shadowSize.height &&
+                               coord.x >= 0 && coord.x < _shadowSize.width;
+    const auto recordable = inShadowFrame && !_usingLineRenditions && !_brushUsingSoftFont;
+
+    if (!recordable || lineWrapped)
+    {
+        RETURN_IF_FAILED(_PaintUtf8BufferLine(clusters, coord, lineWrapped));
+        _UpdateShadowFrame(clusters, coord, recordable);
+        return S_OK;
+    }
+
+    // If the previous row wrapped, the terminal only marks it as wrapped once we
+    // write the first cell of this row. Jumping past it would break the line.
+    const auto continuesWrappedRow = _wrappedRow.has_value() && coord.x == 0 && coord.y == _wrappedRow.value() + 1;
+
+    const auto row = _shadowFrame.data() + coord.y * _shadowSize.width;
+    auto x = coord.x;
+    // The first and one past the last changed cluster of the current piece of text,
+    // and the columns it starts and ends at.
+    size_t changedBeg = 0;
+    size_t changedEnd = 0;
+    til::CoordType changedBegX = 0;
+    til::CoordType changedEndX = 0;
+
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const auto& cluster = til::at(clusters, i);
+        const auto columns = cluster.GetColumns();
+
+        if ((i == 0 && continuesWrappedRow) || columns <= 0 || x + columns > _shadowSize.width || !_ShadowCellMatches(row[x], cluster))
+        {
+            if (changedBeg != changedEnd && x - changedEndX > SHADOW_FRAME_MERGE_GAP)
+            {
+                RETURN_IF_FAILED(_PaintUtf8BufferLine(clusters.subspan(changedBeg, changedEnd - changedBeg), { changedBegX, coord.y }, false));
+                changedBeg = changedEnd;
+            }
+            if (changedBeg == changedEnd)
+            {
+                changedBeg = i;
+                changedBegX = x;
+            }
+            changedEnd = i + 1;
+            changedEndX = x + columns;
+        }
+
+        x += columns;
+    }
+
+    if (changedBeg != changedEnd)
+    {
+        RETURN_IF_FAILED(_PaintUtf8BufferLine(clusters.subspan(changedBeg, changedEnd - changedBeg), { changedBegX, coord.y }, false));
+    }
+
+    _UpdateShadowFrame(clusters, coord, true);
+    return S_OK;
+}
+
+// Routine Description:
+// - Returns true if the terminal already shows the given cluster in the given
+//      cell, drawn with the attributes of the current run.
+bool VtEngine::_ShadowCellMatches(const ShadowCell& cell, const Cluster& cluster) const noexcept
+{
+    const auto text = cluster.GetText();
+    return cell.columns != 0 &&
+           cell.columns == cluster.GetColumns() &&
+           cell.length == text.size() &&
+           std::equal(text.begin(), text.end(), cell.text.begin()) &&
+           cell.attributes == _brushAttributes;
+}
+
+// Routine Description:
+// - Records the given run in the shadow frame, after it has been painted.
+// Arguments:
+// - clusters - the clusters of the run.
+// - coord - where the run starts.
+// - known - false if the cells of the run should be marked as unknown instead.
+void VtEngine::_UpdateShadowFrame(const std::span<const Cluster> clusters, const til::point coord, const bool known) noexcept
+{
+    if (_shadowFrame.empty() || coord.y < 0 || coord.y >= _shadowSize.height || coord.x < 0 || coord.x >= _shadowSize.width)
+    {
+        return;
+    }
+
+    const auto row = _shadowFrame.data() + coord.y * _shadowSize.width;
+    auto x = coord.x;
+
+    // If we wrote over the right half of a wide glyph, the terminal erased its left half.
+    if (x > 0 && row[x - 1].columns > 1)
+    {
+        row[x - 1] = {};
+    }
+
+    for (const auto& cluster : clusters)
+    {
+        // We don't know where the terminal puts zero-width clusters.
+        if (cluster.GetColumns() <= 0)
+        {
+            std::fill(row + x, row + _shadowSize.width, ShadowCell{});
+            break;
+        }
+
+        const auto text = cluster.GetText();
+        const auto columns = std::min(cluster.GetColumns(), _shadowSize.width - x);
+        if (columns <= 0)
+        {
+            break;
+        }
+
+        auto& cell = row[x];
+        cell = {};
+        if (known && text.size() <= cell.text.size() && columns == cluster.GetColumns())
+        {
+            cell.attributes = _brushAttributes;
+            std::copy(text.begin(), text.end(), cell.text.begin());
+            cell.length = gsl::narrow_cast<uint8_t>(text.size());
+            cell.columns = gsl::narrow_cast<uint8_t>(columns);
+        }
+
+        // The right half of wide glyphs is never compared.
+        std::fill_n(row + x + 1, columns - 1, ShadowCell{});
+        x += columns;
+    }
+}
+
+// Routine Description:
+// - Moves the rows of the shadow frame by the given amount, like ScrollFrame
+//      does to the terminal's contents. Revealed rows are unknown.
+// Arguments:
+// - dy - the number of rows to move the frame down by (up, if negative).
+void VtEngine::_ScrollShadowFrame(const til::CoordType dy) noexcept
+{
+    if (_shadowFrame.empty() || dy == 0)
+    {
+        return;
+    }
+
+    const auto rows = std::min(std::abs(dy), _shadowSize.height);
+    const auto cells = gsl::narrow_cast<ptrdiff_t>(rows) * _shadowSize.width;
+    const auto beg = _shadowFrame.begin();
+    const auto end = _shadowFrame.end();
+
+    if (dy < 0)
+    {
+        std::move(beg + cells, end, beg);
+        std::fill(end - cells, end, ShadowCell{});
+    }
+    else
+    {
+        std::move_backward(beg, end - cells, end);
+        std::fill(beg, beg + cells, ShadowCell{});
+    }
+}
+
+// Routine Description:
+// - Forgets the contents of the shadow frame, because we wrote something to
+//      the terminal that might have changed what it shows.
+void VtEngine::_InvalidateShadowFrame() noexcept
+{
+    std::fill(_shadowFrame.begin(), _shadowFrame.end(), ShadowCell{});
+}
+
+// Routine Description:
+// - Sizes the shadow frame to the viewport and forgets its contents.
+// Return Value:
+// - S_OK, or E_OUTOFMEMORY.
+[[nodiscard]] HRESULT VtEngine::_ResetShadowFrame() noexcept
+try
+{
+    if (!_shadowFrameEnabled)
+    {
+        _shadowFrame = {};
+        _shadowSize = {};
+        return S_OK;
+    }
+
+    _shadowSize = _lastViewport.Dimensions();
+    _shadowFrame.assign(_shadowSize.area<size_t>(), ShadowCell{});
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Called by UpdateDrawingBrushes. While the shadow frame is enabled, the
+//      brushes are only remembered and applied by _ApplyDrawingBrushes before
+//      we write text, so that we don't emit SGR sequences for runs that turn
+//      out to be unchanged.
+// Return Value:
+// - true if the brushes were deferred and UpdateDrawingBrushes should return.
+bool VtEngine::_DeferDrawingBrushes(const TextAttribute& textAttributes,
+                                    const RenderSettings& renderSettings,
+                                    IRenderData* const pData,
+                                    const bool usingSoftFont,
+                                    const bool isSettingDefaultBrushes) noexcept
+{
+    if (!_shadowFrameEnabled || _applyingBrushes)
+    {
+        return false;
+    }
+
+    _brushAttributes = textAttributes;
+    if (!isSettingDefaultBrushes)
+    {
+        _brushUsingSoftFont = usingSoftFont;
+    }
+    _pendingBrushes = PendingBrushes{ textAttributes, &renderSettings, pData, usingSoftFont, isSettingDefaultBrushes };
+    return true;
+}
+
+// Routine Description:
+// - Applies the brushes deferred by _DeferDrawingBrushes, if any.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_ApplyDrawingBrushes() noexcept
+{
+    if (!_pendingBrushes)
+    {
+        return S_OK;
+    }
+
+    const auto brushes = *_pendingBrushes;
+    _pendingBrushes.reset();
+
+    _applyingBrushes = true;
+    const auto hr = UpdateDrawingBrushes(brushes.attributes, *brushes.renderSettings, brushes.renderData, brushes.usingSoftFont, brushes.isSettingDefaultBrushes);
+    _applyingBrushes = false;
+    return hr;
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
@@ -28,7 +28,7 @@ constexpr til::point VtEngine::INVALID_COORDS = { -1, -1 };
 VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
                    const Viewport initialViewport) :
     RenderEngineBase(),
-    _hFile(std::move(pipe)),
+    _pipeWriter(pipe ? std::make_unique<VtPipeWriter>(std::move(pipe)) : nullptr),
     _usingLineRenditions(false),
     _stopUsingLineRenditions(false),
     _usingSoftFont(false),
@@ -60,7 +60,7 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 {
 #ifndef UNIT_TESTING
     // When unit testing, we can instantiate a VtEngine without a pipe.
-    THROW_HR_IF(E_HANDLE, !_hFile);
+    THROW_HR_IF(E_HANDLE, !_pipeWriter);
 #else
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
@@ -136,16 +136,34 @@ CATCH_RETURN();
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Hands the contents of _buffer over to the pipe writer thread, which writes
+//      them to the pipe while we continue painting into the emptied _buffer.
+//      This way a terminal that's slow to read doesn't stall the render thread.
+// - During teardown this waits (up to VtPipeWriter::ShutdownTimeout) for the
+//      output to be written, as the process may exit right after we return.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
 {
-    if (_hFile)
+    if (_pipeWriter)
     {
-        auto fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
-        if (!fSuccess)
+        auto hr = _pipeWriter->Submit(_buffer);
+        if (SUCCEEDED(hr) && _tearingDown)
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _hFile.reset();
+            hr = _pipeWriter->WaitForIdle(VtPipeWriter::ShutdownTimeout);
+            if (hr == HRESULT_FROM_WIN32(ERROR_TIMEOUT))
+            {
+                LOG_HR(hr);
+                return S_OK;
+            }
+        }
+        if (FAILED(hr))
+        {
+            _exitResult = hr;
+            _pipeWriter.reset();
             if (_terminalOwner)
             {
                 _terminalOwner->CloseOutput();
@@ -157,10 +175,38 @@ CATCH_RETURN();
     return S_OK;
 }
 
+// Method Description:
+// - Returns statistics about the output written to the pipe so far, like the
+//      number of frames that had to be merged because the terminal fell behind.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics of the pipe writer, or all zeros if there's no pipe.
+VtPipeWriter::Stats VtEngine::GetPipeWriterStats() const noexcept
+{
+    return _pipeWriter ? _pipeWriter->GetStats() : VtPipeWriter::Stats{};
+}
+
+// Method Description:
+// - Enables or disables the shadow frame. While enabled, we keep a copy of
+//      what the terminal shows and only write the cells of invalidated runs
+//      that actually changed. See _PaintChangedClusters.
+// Arguments:
+// - enabled - True to turn on the shadow frame. False otherwise.
+// Return Value:
+// - S_OK, or E_OUTOFMEMORY.
+[[nodiscard]] HRESULT VtEngine::SetShadowFrame(const bool enabled) noexcept
+{
+    _shadowFrameEnabled = enabled;
+    _pendingBrushes.reset();
+    return _ResetShadowFrame();
+}
+
 // Method Description:
 // - Wrapper for _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    _InvalidateShadowFrame();
     return _Write(str);
 }
 
@@ -311,6 +357,11 @@ CATCH_RETURN();
     _suppressResizeRepaint = false;
     _lastViewport = newView;
 
+    if (SUCCEEDED(hr) && oldSize != newSize)
+    {
+        hr = _ResetShadowFrame();
+    }
+
     return hr;
 }
 
@@ -552,6 +603,7 @@ HRESULT VtEngine::RequestWin32Input() noexcept
 
 HRESULT VtEngine::SwitchScreenBuffer(const bool useAltBuffer) noexcept
 {
+    _InvalidateShadowFrame();
     RETURN_IF_FAILED(_SwitchScreenBuffer(useAltBuffer));
     RETURN_IF_FAILED(_Flush());
     return S_OK;
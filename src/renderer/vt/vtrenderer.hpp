@@ -18,6 +18,8 @@ Author(s):
 #include "../inc/RenderEngineBase.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "VtPipeWriter.hpp"
+#include <array>
 #include <string>
 #include <functional>
 
@@ -42,6 +44,8 @@ namespace Microsoft::Console::Render
     public:
         // See _PaintUtf8BufferLine for explanation of this value.
         static const size_t ERASE_CHARACTER_STRING_LENGTH = 8;
+        // See _PaintChangedClusters for explanation of this value.
+        static const til::CoordType SHADOW_FRAME_MERGE_GAP = 4;
         static const til::point INVALID_COORDS;
 
         VtEngine(_In_ wil::unique_hfile hPipe,
@@ -90,9 +94,11 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT RequestWin32Input() noexcept;
         [[nodiscard]] virtual HRESULT SetWindowVisibility(const bool showOrHide) noexcept = 0;
         [[nodiscard]] HRESULT SwitchScreenBuffer(const bool useAltBuffer) noexcept;
+        VtPipeWriter::Stats GetPipeWriterStats() const noexcept;
+        [[nodiscard]] HRESULT SetShadowFrame(const bool enabled) noexcept;
 
     protected:
-        wil::unique_hfile _hFile;
+        std::unique_ptr<VtPipeWriter> _pipeWriter;
         std::string _buffer;
 
         std::string _formatBuffer;
@@ -140,8 +146,39 @@ namespace Microsoft::Console::Render
         bool _resizeQuirk{ false };
         bool _passthrough{ false };
         bool _noFlushOnEnd{ false };
+        bool _tearingDown{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
+        // The contents of the cell as we last sent it to the terminal.
+        // Clusters longer than 2 code units aren't stored and never match.
+        struct ShadowCell
+        {
+            TextAttribute attributes;
+            std::array<wchar_t, 2> text{};
+            uint8_t length = 0;
+            // 0 if we don't know what the terminal shows in this cell.
+            uint8_t columns = 0;
+        };
+
+        // The arguments of the last UpdateDrawingBrushes call, which we only
+        // apply once we know that we're actually going to write some text.
+        struct PendingBrushes
+        {
+            TextAttribute attributes;
+            const RenderSettings* renderSettings;
+            IRenderData* renderData;
+            bool usingSoftFont;
+            bool isSettingDefaultBrushes;
+        };
+
+        bool _shadowFrameEnabled{ false };
+        std::vector<ShadowCell> _shadowFrame;
+        til::size _shadowSize;
+        std::optional<PendingBrushes> _pendingBrushes;
+        bool _applyingBrushes{ false };
+        TextAttribute _brushAttributes;
+        bool _brushUsingSoftFont{ false };
+
         [[nodiscard]] HRESULT _WriteFill(const size_t n, const char c) noexcept;
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
@@ -209,7 +246,6 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _RequestFocusEventMode() noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const til::point coord) noexcept = 0;
-        [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
         [[nodiscard]] HRESULT _16ColorUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
 
         bool _WillWriteSingleChar() const;
@@ -224,6 +260,22 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(const std::span<const Cluster> clusters,
                                                     const til::point coord) noexcept;
 
+        [[nodiscard]] HRESULT _PaintChangedClusters(const std::span<const Cluster> clusters,
+                                                    const til::point coord,
+                                                    const bool lineWrapped) noexcept;
+        bool _ShadowCellMatches(const ShadowCell& cell, const Cluster& cluster) const noexcept;
+        void _UpdateShadowFrame(const std::span<const Cluster> clusters, const til::point coord, const bool known) noexcept;
+        void _ScrollShadowFrame(const til::CoordType dy) noexcept;
+        void _InvalidateShadowFrame() noexcept;
+        [[nodiscard]] HRESULT _ResetShadowFrame() noexcept;
+
+        bool _DeferDrawingBrushes(const TextAttribute& textAttributes,
+                                  const RenderSettings& renderSettings,
+                                  IRenderData* const pData,
+                                  const bool usingSoftFont,
+                                  const bool isSettingDefaultBrushes) noexcept;
+        [[nodiscard]] HRESULT _ApplyDrawingBrushes() noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalDrcs(const std::wstring_view str) noexcept;
@@ -142,8 +142,7 @@
     ULONG cbBufferSize;
     RETURN_IF_FAILED(m->GetOutputBuffer(&pvBuffer, &cbBufferSize));
 
-    const auto rgRecords = reinterpret_cast<INPUT_RECORD*>(pvBuffer);
-    const auto cRecords = cbBufferSize / sizeof(INPUT_RECORD);
+    const std::span records{ static_cast<INPUT_RECORD*>(pvBuffer), cbBufferSize / sizeof(INPUT_RECORD) };
 
     const auto fIsPeek = WI_IsFlagSet(a->Flags, CONSOLE_READ_NOREMOVE);
     const auto fIsWaitAllowed = WI_IsFlagClear(a->Flags, CONSOLE_READ_NOWAIT);
@@ -151,11 +150,11 @@
     const auto pInputReadHandleData = pHandleData->GetClientInput();
 
     std::unique_ptr<IWaitRoutine> waiter;
-    InputEventQueue outEvents;
+    size_t recordsRead = 0;
     auto hr = m->_pApiRoutines->GetConsoleInputImpl(
         *pInputBuffer,
-        outEvents,
-        cRecords,
+        records,
+        recordsRead,
         *pInputReadHandleData,
         a->Unicode,
         fIsPeek,
@@ -163,10 +162,10 @@
 
     // We must return the number of records in the message payload (to alert the client)
     // as well as in the message headers (below in SetReplyInformation) to alert the driver.
-    LOG_IF_FAILED(SizeTToULong(outEvents.size(), &a->NumRecords));
+    LOG_IF_FAILED(SizeTToULong(recordsRead, &a->NumRecords));
 
     size_t cbWritten;
-    LOG_IF_FAILED(SizeTMult(outEvents.size(), sizeof(INPUT_RECORD), &cbWritten));
+    LOG_IF_FAILED(SizeTMult(recordsRead, sizeof(INPUT_RECORD), &cbWritten));
 
     if (nullptr != waiter.get())
     {
@@ -194,22 +193,6 @@
             hr = S_OK;
         }
     }
-    else
-    {
-        try
-        {
-            for (size_t i = 0; i < cRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                rgRecords[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
-        }
-        CATCH_RETURN();
-    }
 
     if (SUCCEEDED(hr))
     {
@@ -30,21 +30,40 @@ InteractDispatch::InteractDispatch() :
 
 // Method Description:
 // - Writes a collection of input to the host. The new input is appended to the
-//      end of the input buffer.
+//      end of the input buffer once FlushInput() is called, so that all the
+//      input of a single read from the VT input pipe is written (and wakes up
+//      waiting readers) just once.
 //  If Ctrl+C is written with this function, it will not trigger a Ctrl-C
 //      interrupt in the client, but instead write a Ctrl+C to the input buffer
 //      to be read by the client.
 // Arguments:
-// - inputEvents: a collection of IInputEvents
+// - inputEvents: a collection of IInputEvents. It'll be empty afterwards.
 // Return Value:
 // - True.
 bool InteractDispatch::WriteInput(std::deque<std::unique_ptr<IInputEvent>>& inputEvents)
 {
-    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.GetActiveInputBuffer()->Write(inputEvents);
+    std::move(inputEvents.begin(), inputEvents.end(), std::back_inserter(_pendingInput));
+    inputEvents.clear();
     return true;
 }
 
+// Method Description:
+// - Writes the input collected by WriteInput() and WriteString() to the host.
+//   The console lock must be held when calling this routine.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InteractDispatch::FlushInput()
+{
+    if (!_pendingInput.empty())
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.GetActiveInputBuffer()->Write(_pendingInput);
+        _pendingInput.clear();
+    }
+}
+
 // Method Description:
 // - Writes a key event to the host in a fashion that will enable the host to
 //   process special keys such as Ctrl-C or Ctrl+Break. The host will then
@@ -56,6 +75,8 @@ bool InteractDispatch::WriteInput(std::deque<std::unique_ptr<IInputEvent>>& inpu
 // - True.
 bool InteractDispatch::WriteCtrlKey(const KeyEvent& event)
 {
+    // The host may write the key into the input buffer, so it has to come after any earlier input.
+    FlushInput();
     HandleGenericKeyEvent(event, false);
     return true;
 }
@@ -178,7 +199,7 @@ bool InteractDispatch::IsVtInputEnabled() const
 // - focused: if the terminal is now focused
 // Return Value:
 // - true always.
-bool InteractDispatch::FocusChanged(const bool focused) const
+bool InteractDispatch::FocusChanged(const bool focused)
 {
     auto& g = ServiceLocator::LocateGlobals();
     auto& gci = g.getConsoleInformation();
@@ -240,6 +261,7 @@ bool InteractDispatch::FocusChanged(const bool focused) const
 
         WI_UpdateFlag(gci.Flags, CONSOLE_HAS_FOCUS, shouldActuallyFocus);
         gci.ProcessHandleList.ModifyConsoleProcessFocus(shouldActuallyFocus);
+        FlushInput();
         gci.pInputBuffer->WriteFocusEvent(focused);
     }
     // Does nothing outside of ConPTY. If there's a real HWND, then the HWND is solely in charge.
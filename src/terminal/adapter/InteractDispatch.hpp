@@ -35,9 +35,12 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool IsVtInputEnabled() const override;
 
-        bool FocusChanged(const bool focused) const override;
+        bool FocusChanged(const bool focused) override;
+
+        void FlushInput();
 
     private:
         ConhostInternalGetSet _api;
+        std::deque<std::unique_ptr<IInputEvent>> _pendingInput;
     };
 }
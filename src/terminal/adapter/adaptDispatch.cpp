@@ -17,6 +17,23 @@ using namespace Microsoft::Console::VirtualTerminal;
 
 static constexpr std::wstring_view whitespace{ L" " };
 
+// Adapts a parser that processes a data string one character at a time to the StringHandler interface,
+// which receives the data in runs. Once the parser returns false, the remainder of the string is ignored.
+template<typename T>
+static ITermDispatch::StringHandler parseCharacterwise(T&& parser)
+{
+    return [parser = std::forward<T>(parser)](const std::wstring_view string) mutable {
+        for (const auto ch : string)
+        {
+            if (!parser(ch))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+}
+
 AdaptDispatch::AdaptDispatch(ITerminalApi& api, Renderer& renderer, RenderSettings& renderSettings, TerminalInput& terminalInput) :
     _api{ api },
     _renderer{ renderer },
@@ -57,13 +74,7 @@ void AdaptDispatch::PrintString(const std::wstring_view string)
 {
     if (_termOutput.NeedToTranslate())
     {
-        std::wstring buffer;
-        buffer.reserve(string.size());
-        for (auto& wch : string)
-        {
-            buffer.push_back(_termOutput.TranslateKey(wch));
-        }
-        _WriteToBuffer(buffer);
+        _WriteToBuffer(_termOutput.TranslateString(string, _translationBuffer));
     }
     else
     {
@@ -95,6 +106,7 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
     RowWriteState state{
         .text = string,
         .columnLimit = lineWidth,
+        .graphemeClusters = _modes.test(Mode::GraphemeCluster),
     };
 
     while (!state.text.empty())
@@ -123,15 +135,10 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
         {
             // If insert-replace mode is enabled, we first measure how many cells
             // the string will occupy, and scroll the target area right by that
-            // amount to make space for the incoming text.
-            const OutputCellIterator it(state.text, attributes);
-            auto measureIt = it;
-            while (measureIt && measureIt.GetCellDistance(it) < state.columnLimit)
-            {
-                ++measureIt;
-            }
+            // amount to make space for the incoming text. The measurement is
+            // the same that ROW::ReplaceText() uses, so the two always agree.
             const auto row = cursorPosition.y;
-            const auto cellCount = measureIt.GetCellDistance(it);
+            const auto cellCount = ROW::MeasureText(state.text, state.columnLimit - cursorPosition.x, state.graphemeClusters);
             _ScrollRectHorizontally(textBuffer, { cursorPosition.x, row, state.columnLimit, row + 1 }, cellCount);
         }
 
@@ -176,7 +183,7 @@ void AdaptDispatch::_WriteToBuffer(const std::wstring_view string)
             //   we tried writing a wide glyph into the last column which can't work.
             if (textPositionBefore == textPositionAfter && (state.columnBegin == 0 || !wrapAtEOL))
             {
-                textBuffer.ConsumeGrapheme(state.text);
+                textBuffer.ConsumeGrapheme(state.text, state.graphemeClusters);
             }
 
             if (wrapAtEOL)
@@ -614,7 +621,8 @@ void AdaptDispatch::_ScrollRectVertically(TextBuffer& textBuffer, const til::rec
         if (width == textBuffer.GetSize().Width())
         {
             // If the scrollRect is the full width of the buffer, we can scroll
-            // more efficiently by rotating the row storage.
+            // more efficiently by rotating the row storage. This moves the rows
+            // that are scrolled over into the vacated rows, which we erase below.
             textBuffer.ScrollRows(top, height, actualDelta);
             textBuffer.TriggerRedraw(Viewport::FromExclusive(scrollRect));
         }
@@ -1902,6 +1910,11 @@ bool AdaptDispatch::_ModeParamsHelper(const DispatchTypes::ModeParams param, con
     case DispatchTypes::ModeParams::XTERM_BracketedPasteMode:
         _api.SetSystemMode(ITerminalApi::Mode::BracketedPaste, enable);
         return !_api.IsConsolePty();
+    case DispatchTypes::ModeParams::GCM_GraphemeClusterMode:
+        // Both ConPTY and the terminal it's connected to need to agree on how wide the text is.
+        // That's why the mode is passed through, in addition to applying it to our own buffer.
+        _modes.set(Mode::GraphemeCluster, enable);
+        return !_api.IsConsolePty();
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         _terminalInput.SetInputMode(TerminalInput::Mode::Win32, enable);
         return !_PassThroughInputModes();
@@ -2034,6 +2047,9 @@ bool AdaptDispatch::RequestMode(const DispatchTypes::ModeParams param)
     case DispatchTypes::ModeParams::XTERM_BracketedPasteMode:
         enabled = _api.GetSystemMode(ITerminalApi::Mode::BracketedPaste);
         break;
+    case DispatchTypes::ModeParams::GCM_GraphemeClusterMode:
+        enabled = _modes.test(Mode::GraphemeCluster);
+        break;
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         enabled = _terminalInput.GetInputMode(TerminalInput::Mode::Win32);
         break;
@@ -3780,18 +3796,21 @@ ITermDispatch::StringHandler AdaptDispatch::DownloadDRCS(const VTInt fontNumber,
     // set translation is correctly handled on the host side.
     const auto conptyPassthrough = _api.IsConsolePty() ? _CreateDrcsPassthroughHandler(charsetSize) : nullptr;
 
-    return [=](const auto ch) {
+    return [=](const std::wstring_view string) {
         if (conptyPassthrough)
         {
-            conptyPassthrough(ch);
+            conptyPassthrough(string);
         }
         // We pass the data string straight through to the font buffer class
         // until we receive an ESC, indicating the end of the string. At that
         // point we can finalize the buffer, and if valid, update the renderer
         // with the constructed bit pattern.
-        if (ch != AsciiChars::ESC)
+        if (string.front() != AsciiChars::ESC)
         {
-            _fontBuffer->AddSixelData(ch);
+            for (const auto ch : string)
+            {
+                _fontBuffer->AddSixelData(ch);
+            }
         }
         else if (_fontBuffer->FinalizeSixelData())
         {
@@ -3829,20 +3848,25 @@ ITermDispatch::StringHandler AdaptDispatch::_CreateDrcsPassthroughHandler(const
     if (defaultPassthrough)
     {
         auto& engine = _api.GetStateMachine().Engine();
-        return [=, &engine, gotId = false](const auto ch) mutable {
+        return [=, &engine, gotId = false](std::wstring_view string) mutable {
             // The character set ID is contained in the first characters of the
             // sequence, so we just ignore that initial content until we receive
             // a "final" character (i.e. in range 30 to 7E). At that point we
             // pass through a hard-coded ID of "@".
             if (!gotId)
             {
-                if (ch >= 0x30 && ch <= 0x7E)
+                const auto idEnd = std::find_if(string.begin(), string.end(), [](const auto ch) {
+                    return ch >= 0x30 && ch <= 0x7E;
+                });
+                if (idEnd == string.end())
                 {
-                    gotId = true;
-                    defaultPassthrough('@');
+                    return true;
                 }
+                gotId = true;
+                defaultPassthrough(L"@");
+                string = { idEnd + 1, string.end() };
             }
-            else if (!defaultPassthrough(ch))
+            if (!string.empty() && !defaultPassthrough(string))
             {
                 // Once the DECDLD sequence is finished, we also output an SCS
                 // sequence to map the character set into the G1 table.
@@ -3875,9 +3899,9 @@ ITermDispatch::StringHandler AdaptDispatch::DefineMacro(const VTInt macroId,
 
     if (_macroBuffer->InitParser(macroId, deleteControl, encoding))
     {
-        return [&](const auto ch) {
+        return parseCharacterwise([&](const auto ch) {
             return _macroBuffer->ParseDefinition(ch);
-        };
+        });
     }
 
     return nullptr;
@@ -3947,7 +3971,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreColorTable()
         return _CreatePassthroughHandler();
     }
 
-    return [this, parameter = VTInt{}, parameters = std::vector<VTParameter>{}](const auto ch) mutable {
+    return parseCharacterwise([this, parameter = VTInt{}, parameters = std::vector<VTParameter>{}](const auto ch) mutable {
         if (ch >= L'0' && ch <= L'9')
         {
             parameter *= 10;
@@ -3986,7 +4010,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreColorTable()
             parameter = 0;
         }
         return (ch != AsciiChars::ESC);
-    };
+    });
 }
 
 // Method Description:
@@ -4005,7 +4029,7 @@ ITermDispatch::StringHandler AdaptDispatch::RequestSetting()
     // this is the opposite of what is documented in most DEC manuals, which
     // say that 0 is for a valid response, and 1 is for an error. The correct
     // interpretation is documented in the DEC STD 070 reference.
-    return [this, parameter = VTInt{}, idBuilder = VTIDBuilder{}](const auto ch) mutable {
+    return parseCharacterwise([this, parameter = VTInt{}, idBuilder = VTIDBuilder{}](const auto ch) mutable {
         const auto isFinal = ch >= L'\x40' && ch <= L'\x7e';
         if (isFinal)
         {
@@ -4057,7 +4081,7 @@ ITermDispatch::StringHandler AdaptDispatch::RequestSetting()
             }
             return true;
         }
-    };
+    });
 }
 
 // Method Description:
@@ -4405,7 +4429,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreCursorInformation()
         VTParameter column{};
     };
     auto& textBuffer = _api.GetTextBuffer();
-    return [&, state = State{}](const auto ch) mutable {
+    return parseCharacterwise([&, state = State{}](const auto ch) mutable {
         if (numeric.test(state.field))
         {
             if (ch >= '0' && ch <= '9')
@@ -4522,7 +4546,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreCursorInformation()
             }
         }
         return (ch != AsciiChars::ESC);
-    };
+    });
 }
 
 // Method Description:
@@ -4576,7 +4600,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreTabStops()
     _ClearAllTabStops();
     _InitTabStopsForWidth(width);
 
-    return [this, width, column = size_t{}](const auto ch) mutable {
+    return parseCharacterwise([this, width, column = size_t{}](const auto ch) mutable {
         if (ch >= L'0' && ch <= L'9')
         {
             column *= 10;
@@ -4600,7 +4624,7 @@ ITermDispatch::StringHandler AdaptDispatch::_RestoreTabStops()
             return false;
         }
         return (ch != AsciiChars::ESC);
-    };
+    });
 }
 
 // Routine Description:
@@ -4659,13 +4683,13 @@ ITermDispatch::StringHandler AdaptDispatch::_CreatePassthroughHandler()
         // And finally we create a StringHandler to receive the rest of the
         // sequence data, and pass it through to the connected terminal.
         auto& engine = stateMachine.Engine();
-        return [&, buffer = std::wstring{}](const auto ch) mutable {
+        return [&, buffer = std::wstring{}](const std::wstring_view string) mutable {
             // To make things more efficient, we buffer the string data before
             // passing it through, only flushing if the buffer gets too large,
             // or we're dealing with the last character in the current output
             // fragment, or we've reached the end of the string.
-            const auto endOfString = ch == AsciiChars::ESC;
-            buffer += ch;
+            const auto endOfString = string.back() == AsciiChars::ESC;
+            buffer += string;
             if (buffer.length() >= 4096 || stateMachine.IsProcessingLastCharacter() || endOfString)
             {
                 // The end of the string is signaled with an escape, but for it
@@ -171,7 +171,8 @@ namespace Microsoft::Console::VirtualTerminal
             AllowDECCOLM,
             AllowDECSLRM,
             EraseColor,
-            RectangularChangeExtent
+            RectangularChangeExtent,
+            GraphemeCluster
         };
         enum class ScrollDirection
         {
@@ -276,6 +277,9 @@ namespace Microsoft::Console::VirtualTerminal
         RenderSettings& _renderSettings;
         TerminalInput& _terminalInput;
         TerminalOutput _termOutput;
+        // Scratch space for TerminalOutput::TranslateString(). It lives here rather than in
+        // _termOutput, because the latter gets copied whenever the cursor state is saved.
+        std::wstring _translationBuffer;
         std::unique_ptr<FontBuffer> _fontBuffer;
         std::shared_ptr<MacroBuffer> _macroBuffer;
         std::optional<unsigned int> _initialCodePage;
@@ -24,6 +24,7 @@ TerminalOutput::TerminalOutput() noexcept
     _gsetIds.at(1) = VTID("B");
     _gsetIds.at(2) = VTID("B");
     _gsetIds.at(3) = VTID("B");
+    _UpdateTranslationTable();
 }
 
 bool TerminalOutput::Designate94Charset(size_t gsetNumber, const VTID charset)
@@ -76,6 +77,7 @@ bool TerminalOutput::LockingShift(const size_t gsetNumber)
     {
         _glTranslationTable = {};
     }
+    _UpdateTranslationTable();
     return true;
 }
 
@@ -89,6 +91,7 @@ bool TerminalOutput::LockingShiftRight(const size_t gsetNumber)
     {
         _grTranslationTable = {};
     }
+    _UpdateTranslationTable();
     return true;
 }
 
@@ -153,20 +156,44 @@ wchar_t TerminalOutput::TranslateKey(const wchar_t wch) const noexcept
         }
         _ssSetNumber = 0;
     }
-    else
+    else if (wch < _translationTable.size())
     {
-        if (wch - 0x20u < _glTranslationTable.size())
-        {
-            wchFound = _glTranslationTable.at(wch - 0x20u);
-        }
-        else if (wch - 0xA0u < _grTranslationTable.size())
-        {
-            wchFound = _grTranslationTable.at(wch - 0xA0u);
-        }
+        wchFound = til::at(_translationTable, wch);
     }
     return wchFound;
 }
 
+// Routine Description:
+// - Translates an entire string with the active character sets. The result is
+//   stored in the given buffer, which the caller can reuse across calls to
+//   avoid allocating a new string every time.
+// Arguments:
+// - string - The text to translate.
+// - buffer - The buffer to store the translated text in.
+// Return Value:
+// - A view of the translated text in the buffer.
+std::wstring_view TerminalOutput::TranslateString(const std::wstring_view string, std::wstring& buffer) const
+{
+    buffer.resize(string.size());
+
+    auto it = string.begin();
+    auto out = buffer.begin();
+
+    // A single shift only applies to the first character.
+    if (_ssSetNumber != 0 && it != string.end())
+    {
+        *out++ = TranslateKey(*it++);
+    }
+
+    for (; it != string.end(); ++it, ++out)
+    {
+        const auto wch = *it;
+        *out = wch < _translationTable.size() ? til::at(_translationTable, wch) : wch;
+    }
+
+    return buffer;
+}
+
 const std::wstring_view TerminalOutput::_LookupTranslationTable94(const VTID charset) const
 {
     // Note that the DRCS set can be designated with either a 94 or 96 sequence,
@@ -303,3 +330,16 @@ void TerminalOutput::_ReplaceDrcsTable(const std::wstring_view oldTable, const s
         LockingShiftRight(_grSetNumber);
     }
 }
+
+void TerminalOutput::_UpdateTranslationTable() noexcept
+{
+    for (size_t i = 0; i < _translationTable.size(); i++)
+    {
+        til::at(_translationTable, i) = gsl::narrow_cast<wchar_t>(i);
+    }
+    // The GL set covers 0x20 to 0x7F, and the GR set covers 0xA0 to 0xFF.
+    const auto glCount = std::min<size_t>(_glTranslationTable.size(), 96);
+    const auto grCount = std::min<size_t>(_grTranslationTable.size(), 96);
+    std::copy_n(_glTranslationTable.begin(), glCount, _translationTable.begin() + 0x20);
+    std::copy_n(_grTranslationTable.begin(), grCount, _translationTable.begin() + 0xA0);
+}
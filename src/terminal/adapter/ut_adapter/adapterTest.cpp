@@ -1592,11 +1592,11 @@ public:
     {
         const auto requestSetting = [=](const std::wstring_view settingId = {}) {
             const auto stringHandler = _pDispatch->RequestSetting();
-            for (auto ch : settingId)
+            if (!settingId.empty())
             {
-                stringHandler(ch);
+                stringHandler(settingId);
             }
-            stringHandler(L'\033'); // String terminator
+            stringHandler(L"\033"); // String terminator
         };
 
         Log::Comment(L"Requesting DECSTBM margins (5 to 10).");
@@ -2892,6 +2892,32 @@ public:
         _testGetSet->ValidateInputEvent(expectedResponse.c_str());
     }
 
+    TEST_METHOD(CharsetTranslationTests)
+    {
+        const auto getBufferOutput = [&]() {
+            const auto& textBuffer = _testGetSet->GetTextBuffer();
+            const auto cursorPos = textBuffer.GetCursor().GetPosition();
+            return textBuffer.GetRowByOffset(cursorPos.y).GetText().substr(0, cursorPos.x);
+        };
+
+        Log::Comment(L"DEC Special Graphics in GL");
+        _testGetSet->PrepData();
+        _stateMachine->ProcessString(L"\033(0lqqk\033(Blqqk");
+        VERIFY_ARE_EQUAL(L"┌──┐lqqk", getBufferOutput());
+
+        Log::Comment(L"A single shift only applies to the first character");
+        _testGetSet->PrepData();
+        _stateMachine->ProcessString(L"\033*0\033Nqq");
+        VERIFY_ARE_EQUAL(L"─q", getBufferOutput());
+        _stateMachine->ProcessString(L"\033*B");
+
+        Log::Comment(L"Translated text in insert mode");
+        _testGetSet->PrepData();
+        _stateMachine->ProcessString(L"abc\r\033[4h\033(0qq\033(B\033[4l");
+        _stateMachine->ProcessString(L"\033[6G");
+        VERIFY_ARE_EQUAL(L"──abc", getBufferOutput());
+    }
+
 private:
     TerminalInput _terminalInput;
     std::unique_ptr<TestGetSet> _testGetSet;
@@ -20,7 +20,10 @@ namespace Microsoft::Console::VirtualTerminal
     class IStateMachineEngine
     {
     public:
-        using StringHandler = std::function<bool(const wchar_t)>;
+        // Receives the data of a DCS string in runs that are as long as the parser can make them.
+        // The end of the string is signaled with a run consisting of a single ESC.
+        // Returning false causes the remainder of the string to be ignored.
+        using StringHandler = std::function<bool(const std::wstring_view)>;
 
         virtual ~IStateMachineEngine() = 0;
         IStateMachineEngine(const IStateMachineEngine&) = default;
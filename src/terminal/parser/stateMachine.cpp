@@ -550,6 +550,7 @@ void StateMachine::_ActionClear()
 
     _oscString.clear();
     _oscParameter = 0;
+    _oscStringLimitReached = false;
 
     _dcsStringHandler = nullptr;
 
@@ -581,7 +582,8 @@ void StateMachine::_ActionInterrupt()
     if (_state == VTStates::DcsPassThrough)
     {
         // The ESC signals the end of the data string.
-        _dcsStringHandler(AsciiChars::ESC);
+        static constexpr wchar_t terminator = AsciiChars::ESC;
+        _dcsStringHandler({ &terminator, 1 });
         _dcsStringHandler = nullptr;
     }
 }
@@ -609,7 +611,33 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscPut");
 
-    _oscString.push_back(wch);
+    _ActionOscPutString({ &wch, 1 });
+}
+
+// Routine Description:
+// - Stores these characters as part of the OSC string. If the string grows larger than
+//   the maximum OSC string length, it's discarded and the sequence won't be dispatched.
+// Arguments:
+// - string - Characters to store.
+// Return Value:
+// - <none>
+void StateMachine::_ActionOscPutString(const std::wstring_view string)
+{
+    if (_oscStringLimitReached)
+    {
+        return;
+    }
+
+    if (string.size() > MAX_OSC_STRING_LENGTH - _oscString.size())
+    {
+        _oscStringLimitReached = true;
+        // Release the memory, as well as any parts of the sequence that were cached for passing it through.
+        _oscString = {};
+        _cachedSequence.reset();
+        return;
+    }
+
+    _oscString.append(string);
 }
 
 // Routine Description:
@@ -622,6 +650,14 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 void StateMachine::_ActionOscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscDispatch");
+
+    // Incomplete strings are ignored rather than being dispatched truncated.
+    if (_oscStringLimitReached)
+    {
+        _trace.DispatchSequenceTrace(false);
+        return;
+    }
+
     _trace.DispatchSequenceTrace(_SafeExecute([=]() {
         return _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
     }));
@@ -1650,7 +1686,7 @@ void StateMachine::_EventDcsPassThrough(const wchar_t wch)
     _trace.TraceOnEvent(L"DcsPassThrough");
     if (_isC0Code(wch) || _isDcsPassThroughValid(wch))
     {
-        if (!_dcsStringHandler(wch))
+        if (!_dcsStringHandler({ &wch, 1 }))
         {
             _EnterDcsIgnore();
         }
@@ -1919,8 +1955,153 @@ exitWithMask:
 #endif
 }
 
+// Returns true for the characters that end a run of DCS pass through data:
+// CAN, SUB and ESC which may terminate the string, as well as DEL and anything
+// beyond ASCII, which are either C1 controls or ignored in DCS strings.
+constexpr bool isActionableFromDcsPassThrough(const wchar_t wch) noexcept
+{
+    // This is equivalent to:
+    //   return wch == 0x18 || wch == 0x1a || wch == 0x1b || wch >= 0x7f;
+    return (wch == 0x18) | ((wch | 1) == 0x1b) | (wch >= 0x7f);
+}
+
+[[msvc::forceinline]] static size_t findActionableFromDcsPassThroughPlain(const wchar_t* beg, const wchar_t* end, const wchar_t* it) noexcept
+{
+#pragma loop(no_vector)
+    for (; it < end && !isActionableFromDcsPassThrough(*it); ++it)
+    {
+    }
+    return it - beg;
+}
+
+static size_t findActionableFromDcsPassThrough(const wchar_t* data, size_t count) noexcept
+{
+    // The following vectorized code replicates isActionableFromDcsPassThrough.
+#if defined(TIL_SSE_INTRINSICS)
+
+    auto it = data;
+
+    for (const auto end = data + (count & ~size_t{ 7 }); it < end; it += 8)
+    {
+        const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const auto z = _mm_setzero_si128();
+
+        // Check for (wch >= 0x7f) by subtracting 0x7e with saturation, which is only 0 for "wch <= 0x7e".
+        // Since that's the inverse of what we want, the bits are flipped after the comparison with 0.
+        auto a = _mm_cmpeq_epi16(_mm_subs_epu16(wch, _mm_set1_epi16(0x7e)), z);
+        a = _mm_xor_si128(a, _mm_set1_epi16(-1));
+        // Check for CAN, as well as SUB and ESC, which only differ in their lowest bit.
+        const auto b = _mm_cmpeq_epi16(wch, _mm_set1_epi16(0x18));
+        const auto c = _mm_cmpeq_epi16(_mm_or_si128(wch, _mm_set1_epi16(1)), _mm_set1_epi16(0x1b));
+
+        const auto d = _mm_or_si128(a, _mm_or_si128(b, c));
+        const auto mask = _mm_movemask_epi8(d);
+
+        if (mask)
+        {
+            unsigned long offset;
+            _BitScanForward(&offset, mask);
+            it += offset / 2;
+            return it - data;
+        }
+    }
+
+    return findActionableFromDcsPassThroughPlain(data, data + count, it);
+
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+
+    auto it = data;
+    uint64_t mask;
+
+    for (const auto end = data + (count & ~size_t{ 7 }); it < end;)
+    {
+        const auto wch = vld1q_u16(it);
+        const auto a = vcgtq_u16(wch, vdupq_n_u16(0x7e));
+        const auto b = vceqq_u16(wch, vdupq_n_u16(0x18));
+        const auto c = vceqq_u16(vorrq_u16(wch, vdupq_n_u16(1)), vdupq_n_u16(0x1b));
+        const auto d = vorrq_u16(a, vorrq_u16(b, c));
+
+        mask = vgetq_lane_u64(vreinterpretq_u64_u16(d), 0);
+        if (mask)
+        {
+            goto exitWithMask;
+        }
+        it += 4;
+
+        mask = vgetq_lane_u64(vreinterpretq_u64_u16(d), 1);
+        if (mask)
+        {
+            goto exitWithMask;
+        }
+        it += 4;
+    }
+
+    return findActionableFromDcsPassThroughPlain(data, data + count, it);
+
+exitWithMask:
+    unsigned long offset;
+    _BitScanForward64(&offset, mask);
+    it += offset / 16;
+    return it - data;
+
+#else
+
+    return findActionableFromDcsPassThroughPlain(data, data + count, data);
+
+#endif
+}
+
 #pragma warning(pop)
 
+// Routine Description:
+// - Processes the data of OSC, DCS and SOS/PM/APC strings in bulk, instead of one
+//   character at a time via ProcessCharacter(). It stops at the first character that
+//   may terminate the string or that needs to be handled by the current state's event.
+// Arguments:
+// - string - The remaining characters of the string given to ProcessString.
+// Return Value:
+// - The number of characters that were consumed.
+size_t StateMachine::_ProcessStringData(const std::wstring_view string)
+{
+    switch (_state)
+    {
+    case VTStates::OscString:
+    {
+        // Any C0 or C1 control either terminates OSC strings or is ignored in them. Like in the
+        // ground state, DEL is left to _EventOscString() even though it's part of the string.
+        const auto count = findActionableFromGround(string.data(), string.size());
+        if (count)
+        {
+            _processingLastCharacter = count >= string.size();
+            _trace.TraceOnAction(L"OscPut");
+            _ActionOscPutString(string.substr(0, count));
+        }
+        return count;
+    }
+    case VTStates::DcsPassThrough:
+    {
+        const auto count = findActionableFromDcsPassThrough(string.data(), string.size());
+        if (count)
+        {
+            // The passthrough handlers rely on IsProcessingLastCharacter() to flush their buffer.
+            _processingLastCharacter = count >= string.size();
+            _trace.TraceOnEvent(L"DcsPassThrough");
+            if (!_dcsStringHandler(string.substr(0, count)))
+            {
+                _EnterDcsIgnore();
+            }
+        }
+        return count;
+    }
+    case VTStates::DcsIgnore:
+    case VTStates::SosPmApcString:
+        // Everything but the terminators is ignored.
+        return findActionableFromGround(string.data(), string.size());
+    default:
+        return 0;
+    }
+}
+
 // Routine Description:
 // - Helper for entry to the state machine. Will take an array of characters
 //     and print as many as it can without encountering a character indicating
@@ -1975,6 +2156,15 @@ void StateMachine::ProcessString(const std::wstring_view string)
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(til::at(string, i));
             ++i;
+
+            // Data strings can be hundreds of KB long (for instance OSC 52 or DECDLD),
+            // so we hand them to the engine in runs instead of one character at a time.
+            if (i < string.size())
+            {
+                const auto consumed = _ProcessStringData(string.substr(i));
+                _runSize += consumed;
+                i += consumed;
+            }
         } while (i < string.size() && _state != VTStates::Ground);
     }
 
@@ -2044,7 +2234,7 @@ void StateMachine::ProcessString(const std::wstring_view string)
             // after dispatching the characters
             _EnterGround();
         }
-        else if (_state != VTStates::SosPmApcString && _state != VTStates::DcsPassThrough && _state != VTStates::DcsIgnore)
+        else if (_state != VTStates::SosPmApcString && _state != VTStates::DcsPassThrough && _state != VTStates::DcsIgnore && !_oscStringLimitReached)
         {
             // If the engine doesn't require flushing at the end of the string, we
             // want to cache the partial sequence in case we have to flush the whole
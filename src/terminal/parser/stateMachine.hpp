@@ -31,6 +31,11 @@ namespace Microsoft::Console::VirtualTerminal
     // that number.
     constexpr size_t MAX_PARAMETER_COUNT = 32;
 
+    // OSC strings are buffered in their entirety before they're dispatched.
+    // The largest ones are OSC 52 clipboard writes, for which this allows a
+    // few MB of base64 encoded text. Longer strings are discarded.
+    constexpr size_t MAX_OSC_STRING_LENGTH = 8 * 1024 * 1024;
+
     class StateMachine final
     {
 #ifdef UNIT_TESTING
@@ -88,6 +93,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionCsiDispatch(const wchar_t wch);
         void _ActionOscParam(const wchar_t wch) noexcept;
         void _ActionOscPut(const wchar_t wch);
+        void _ActionOscPutString(const std::wstring_view string);
         void _ActionOscDispatch(const wchar_t wch);
         void _ActionSs3Dispatch(const wchar_t wch);
         void _ActionDcsDispatch(const wchar_t wch);
@@ -136,6 +142,8 @@ namespace Microsoft::Console::VirtualTerminal
         void _EventDcsPassThrough(const wchar_t wch);
         void _EventSosPmApcString(const wchar_t wch) noexcept;
 
+        size_t _ProcessStringData(const std::wstring_view string);
+
         void _AccumulateTo(const wchar_t wch, VTInt& value) noexcept;
 
         template<typename TLambda>
@@ -194,6 +202,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         std::wstring _oscString;
         VTInt _oscParameter;
+        bool _oscStringLimitReached = false;
 
         IStateMachineEngine::StringHandler _dcsStringHandler;
 
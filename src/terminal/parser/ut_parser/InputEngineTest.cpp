@@ -333,7 +333,7 @@ public:
 
     virtual bool IsVtInputEnabled() const override;
 
-    virtual bool FocusChanged(const bool focused) const override;
+    virtual bool FocusChanged(const bool focused) override;
 
 private:
     std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> _pfnWriteInputCallback;
@@ -402,7 +402,7 @@ bool TestInteractDispatch::IsVtInputEnabled() const
     return true;
 }
 
-bool TestInteractDispatch::FocusChanged(const bool /*focused*/) const
+bool TestInteractDispatch::FocusChanged(const bool /*focused*/)
 {
     return false;
 }
@@ -38,6 +38,9 @@ public:
         dcsId = 0;
         dcsParams.clear();
         dcsDataString.clear();
+        dcsDataRuns = 0;
+        oscString.clear();
+        oscDispatched = false;
     }
 
     bool ActionExecute(const wchar_t wch) override
@@ -70,8 +73,10 @@ public:
 
     bool ActionOscDispatch(const wchar_t /* wch */,
                            const size_t /* parameter */,
-                           const std::wstring_view /* string */) override
+                           const std::wstring_view string) override
     {
+        oscString = string;
+        oscDispatched = true;
         if (pfnFlushToTerminal)
         {
             pfnFlushToTerminal();
@@ -110,7 +115,8 @@ public:
             dcsParams.push_back(parameters.at(i).value_or(0));
         }
         dcsDataString.clear();
-        return [=](const auto ch) { dcsDataString += ch; return true; };
+        dcsDataRuns = 0;
+        return [=](const auto run) { dcsDataString += run; dcsDataRuns++; return true; };
     }
 
     // These will only be populated if ActionCsiDispatch is called.
@@ -133,6 +139,11 @@ public:
     uint64_t dcsId = 0;
     std::vector<size_t> dcsParams;
     std::wstring dcsDataString;
+    size_t dcsDataRuns = 0;
+
+    // These will only be populated if ActionOscDispatch is called.
+    std::wstring oscString;
+    bool oscDispatched = false;
 };
 
 class Microsoft::Console::VirtualTerminal::StateMachineTest
@@ -157,6 +168,9 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
     TEST_METHOD(DcsDataStringsReceivedByHandler);
+    TEST_METHOD(DcsDataStringsReceivedInRuns);
+    TEST_METHOD(OscStringsSplitAcrossWrites);
+    TEST_METHOD(OscStringsLongerThanLimitAreIgnored);
 
     TEST_METHOD(VtParameterSubspanTest);
 };
@@ -340,6 +354,76 @@ void StateMachineTest::DcsDataStringsReceivedByHandler()
     VERIFY_ARE_EQUAL(expectedExecuted, engine.executed);
 }
 
+void StateMachineTest::DcsDataStringsReceivedInRuns()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    const std::wstring data(64 * 1024, L'x');
+
+    Log::Comment(L"Long data strings are passed to the handler in a single run");
+    machine.ProcessString(L"\033P1|" + data + L"\033\\");
+    VERIFY_ARE_EQUAL(data + L"\033", engine.dcsDataString);
+    VERIFY_ARE_EQUAL(2u, engine.dcsDataRuns);
+
+    Log::Comment(L"C0 controls are part of the data, but DEL and C1 controls are not");
+    engine.ResetTestState();
+    machine.ProcessString(L"\033P1|abc\r\ndef\x7f\x85ghi\033\\");
+    VERIFY_ARE_EQUAL(L"abc\r\ndefghi\033", engine.dcsDataString);
+
+    Log::Comment(L"Data strings split across writes are received in order");
+    engine.ResetTestState();
+    machine.ProcessString(L"\033P1|" + data);
+    machine.ProcessString(data);
+    machine.ProcessString(L"\033\\printed text");
+    VERIFY_ARE_EQUAL(data + data + L"\033", engine.dcsDataString);
+    VERIFY_ARE_EQUAL(L"printed text", engine.printed);
+}
+
+void StateMachineTest::OscStringsSplitAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    const std::wstring data(64 * 1024, L'x');
+
+    machine.ProcessString(L"\033]52;c;" + data);
+    VERIFY_IS_FALSE(engine.oscDispatched);
+    machine.ProcessString(L"\r\n" + data);
+    machine.ProcessString(L"\a");
+    VERIFY_IS_TRUE(engine.oscDispatched);
+    // C0 controls in the middle of the string are ignored.
+    VERIFY_ARE_EQUAL(L"c;" + data + data, engine.oscString);
+}
+
+void StateMachineTest::OscStringsLongerThanLimitAreIgnored()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    Log::Comment(L"Strings up to the limit are dispatched");
+    machine.ProcessString(L"\033]52;" + std::wstring(MAX_OSC_STRING_LENGTH, L'x') + L"\033\\");
+    VERIFY_IS_TRUE(engine.oscDispatched);
+    VERIFY_ARE_EQUAL(MAX_OSC_STRING_LENGTH, engine.oscString.size());
+
+    Log::Comment(L"Longer strings are ignored, even if split across writes");
+    engine.ResetTestState();
+    const std::wstring half(MAX_OSC_STRING_LENGTH / 2 + 1, L'x');
+    machine.ProcessString(L"\033]52;" + half);
+    machine.ProcessString(half);
+    machine.ProcessString(L"\033\\printed text");
+    VERIFY_IS_FALSE(engine.oscDispatched);
+    VERIFY_ARE_EQUAL(L"printed text", engine.printed);
+
+    Log::Comment(L"The following string is dispatched again");
+    machine.ProcessString(L"\033]0;title\a");
+    VERIFY_IS_TRUE(engine.oscDispatched);
+    VERIFY_ARE_EQUAL(L"title", engine.oscString);
+}
+
 void StateMachineTest::VtParameterSubspanTest()
 {
     const auto parameterList = std::vector<VTParameter>{ 12, 34, 56, 78 };
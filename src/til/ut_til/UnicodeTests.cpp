@@ -46,6 +46,40 @@ class UnicodeTests
         }
     }
 
+    TEST_METHOD(utf16_next_grapheme)
+    {
+        struct Test
+        {
+            std::wstring_view input;
+            std::wstring_view expected;
+        };
+
+        static constexpr std::array tests{
+            Test{ L"", L"" },
+            Test{ L"a", L"a" },
+            Test{ L"ab", L"a" },
+            Test{ L"\r\n", L"\r\n" }, // GB3
+            Test{ L"\n\r", L"\n" }, // GB4
+            Test{ L"a\x0301\x0302" L"b", L"a\x0301\x0302" }, // GB9
+            Test{ L"\r\x0301", L"\r" }, // GB4 takes precedence over GB9
+            Test{ L"\x1100\x1161\x11A8\x1100", L"\x1100\x1161\x11A8" }, // GB6, GB7 (L V T)
+            Test{ L"\xAC00\x11A8" L"a", L"\xAC00\x11A8" }, // GB7 (LV T)
+            Test{ L"\x0915\x093F", L"\x0915\x093F" }, // GB9a (SpacingMark)
+            Test{ L"\x0600" L"a", L"\x0600" L"a" }, // GB9b (Prepend)
+            Test{ L"\xD83D\xDC68\x200D\xD83D\xDC69" L"a", L"\xD83D\xDC68\x200D\xD83D\xDC69" }, // GB11
+            Test{ L"a\x200D\xD83D\xDC69", L"a\x200D" }, // GB11 requires a preceding Extended_Pictographic
+            Test{ L"\xD83C\xDDE9\xD83C\xDDEA\xD83C\xDDEB", L"\xD83C\xDDE9\xD83C\xDDEA" }, // GB12, GB13
+            Test{ LEADING L"\x0301" L"a", LEADING L"\x0301" }, // unpaired surrogates are Grapheme_Cluster_Break=Other
+            Test{ PAIR L"\x0301", PAIR L"\x0301" },
+        };
+
+        for (const auto& t : tests)
+        {
+            VERIFY_ARE_EQUAL(t.expected, til::utf16_next_grapheme(t.input));
+            VERIFY_ARE_EQUAL(t.input.substr(t.expected.size()), til::utf16_pop_grapheme(t.input));
+        }
+    }
+
     TEST_METHOD(utf16_iterator)
     {
         struct Test
@@ -17,6 +17,10 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16Invalid);
+    TEST_METHOD(TestU16ToU8Invalid);
+    TEST_METHOD(TestLongMixedRoundtrip);
+    TEST_METHOD(TestCallerProvidedBuffer);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +195,150 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16Invalid()
+{
+    // Each maximal subpart of an ill-formed sequence is replaced with a single U+FFFD.
+    // See "U+FFFD Substitution of Maximal Subparts" in chapter 3.9 of the Unicode standard.
+    const std::string u8String{
+        '\x61',
+        '\x80', // lone continuation byte
+        '\xC0', // overlong lead byte
+        '\xAF',
+        '\xE0', // overlong 3 byte sequence
+        '\x80',
+        '\xAF',
+        '\xED', // surrogate U+D800
+        '\xA0',
+        '\x80',
+        '\xF4', // past U+10FFFF
+        '\x90',
+        '\x80',
+        '\x80',
+        '\xE2', // EURO SIGN without its last byte
+        '\x82',
+        '\x62',
+        '\xF0', // CJK UNIFIED IDEOGRAPH-24F5C without its last byte
+        '\xA4',
+        '\xBD',
+    };
+
+    const std::wstring u16StringComp{
+        L'\x0061',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\xFFFD',
+        L'\x0062',
+        L'\xFFFD',
+    };
+
+    std::wstring u16Out{};
+    VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+    VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8Invalid()
+{
+    const std::wstring u16String{
+        L'\x0061',
+        L'\xDF5C', // lone low surrogate
+        L'\x0062',
+        L'\xD853', // high surrogate followed by a high surrogate
+        L'\xD853',
+        L'\xDF5C',
+        L'\xD853', // lone high surrogate at the end
+    };
+
+    const std::string u8StringComp{
+        '\x61',
+        '\xEF', // U+FFFD
+        '\xBF',
+        '\xBD',
+        '\x62',
+        '\xEF', // U+FFFD
+        '\xBF',
+        '\xBD',
+        '\xF0', // CJK UNIFIED IDEOGRAPH-24F5C
+        '\xA4',
+        '\xBD',
+        '\x9C',
+        '\xEF', // U+FFFD
+        '\xBF',
+        '\xBD',
+    };
+
+    std::string u8Out{};
+    VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+    VERIFY_ARE_EQUAL(u8StringComp, u8Out);
+}
+
+void Utf8Utf16ConvertTests::TestLongMixedRoundtrip()
+{
+    // ASCII runs of varying length are converted in blocks, so this
+    // tests non-ASCII characters at all offsets within such a block.
+    std::wstring u16String{};
+    for (size_t i = 0; i < 100; ++i)
+    {
+        u16String.append(i % 37, L'x');
+        u16String.append(i % 2 ? L"\x00f6" : L"\x20ac");
+        if (i % 5 == 0)
+        {
+            u16String.append(L"\xd853\xdf5c");
+        }
+    }
+
+    std::string u8Out{};
+    VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+    std::wstring u16Out{};
+    VERIFY_SUCCEEDED(til::u8u16(u8Out, u16Out));
+    VERIFY_ARE_EQUAL(u16String, u16Out);
+
+    // The same string split into chunks, which cut through the multi-byte sequences.
+    for (const size_t chunkSize : { 1u, 3u, 7u, 16u, 33u })
+    {
+        til::u8state state{};
+        std::wstring u16Chunks{};
+        for (size_t i = 0; i < u8Out.size(); i += chunkSize)
+        {
+            VERIFY_SUCCEEDED(til::u8u16(std::string_view{ u8Out }.substr(i, chunkSize), u16Out, state));
+            u16Chunks.append(u16Out);
+        }
+        VERIFY_ARE_EQUAL(u16String, u16Chunks);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestCallerProvidedBuffer()
+{
+    const std::string_view u8String{ "\xE2\x82\xAC abc" };
+    std::array<wchar_t, 8> u16Buffer{};
+    size_t written{};
+
+    VERIFY_ARE_EQUAL(E_NOT_SUFFICIENT_BUFFER, til::u8u16(u8String, std::span{ u16Buffer }.first(6), written));
+    VERIFY_ARE_EQUAL(0u, written);
+
+    VERIFY_SUCCEEDED(til::u8u16(u8String, u16Buffer, written));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"\x20ac abc" }, (std::wstring_view{ u16Buffer.data(), written }));
+
+    // The partial EURO SIGN is cached in the state and the next call needs room for it.
+    til::u8state state{};
+    VERIFY_SUCCEEDED(til::u8u16(u8String.substr(0, 2), u16Buffer, written, state));
+    VERIFY_ARE_EQUAL(0u, written);
+    VERIFY_ARE_EQUAL(E_NOT_SUFFICIENT_BUFFER, til::u8u16(u8String.substr(2), std::span{ u16Buffer }.first(6), written, state));
+    VERIFY_SUCCEEDED(til::u8u16(u8String.substr(2), std::span{ u16Buffer }.first(7), written, state));
+    VERIFY_ARE_EQUAL(std::wstring_view{ L"\x20ac abc" }, (std::wstring_view{ u16Buffer.data(), written }));
+
+    std::array<char, 24> u8Buffer{};
+    VERIFY_SUCCEEDED(til::u16u8(L"\x20ac abc", u8Buffer, written));
+    VERIFY_ARE_EQUAL(u8String, (std::string_view{ u8Buffer.data(), written }));
+}
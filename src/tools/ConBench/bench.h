@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+namespace bench
+{
+    using clock = std::chrono::steady_clock;
+
+    // Runs func() `iterations` times and returns the fastest run. The minimum is
+    // the most stable statistic for CPU-bound code, as noise only ever adds time.
+    template<typename Func>
+    clock::duration measure(size_t iterations, Func&& func)
+    {
+        auto best = clock::duration::max();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            const auto beg = clock::now();
+            func();
+            best = std::min(best, clock::now() - beg);
+        }
+        return best;
+    }
+
+    // Prints a single result line. If `bytes` is non-zero the throughput is printed as well.
+    inline void report(std::string_view name, clock::duration duration, size_t bytes = 0)
+    {
+        const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+        if (bytes)
+        {
+            const auto mbps = bytes / ns * 1e9 / (1024 * 1024);
+            fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.2f} MB/s {:>8.3f} ns/B\n"), name, ns / 1e6, mbps, ns / bytes);
+        }
+        else
+        {
+            fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms\n"), name, ns / 1e6);
+        }
+    }
+
+    // Like report(), but for `chars` UTF-16 code units of processed text, which is printed as ns/char.
+    inline void reportText(std::string_view name, clock::duration duration, size_t chars)
+    {
+        const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+        const auto mbps = chars * sizeof(wchar_t) / ns * 1e9 / (1024 * 1024);
+        fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.2f} MB/s {:>8.3f} ns/char\n"), name, ns / 1e6, mbps, ns / chars);
+    }
+}
+
+void benchBlit();
+void benchClipboard();
+void benchGeneration();
+void benchInput();
+void benchLineDrawing();
+void benchParser();
+void benchPatterns();
+void benchReflow();
+void benchRender();
+void benchScroll();
+void benchScrollback();
+void benchSgr();
+void benchUia();
+void benchUtf8();
+void benchWidth();
+void benchWrite();
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures WriteConsoleOutputW and ReadConsoleOutputW style full-screen redraws, the way
+// Far Manager and other Win32 TUIs paint every frame. Each "cells" variant goes through
+// OutputCellIterator / TextBufferCellIterator one cell at a time, like conhost used to,
+// and each "blit" variant uses TextBuffer::WriteCharInfos / ReadCharInfos.
+
+static constexpr til::size size{ 200, 60 };
+static constexpr size_t frames = 100;
+
+// A panel layout with a few differently colored areas and some wide glyphs, as leading/trailing pairs.
+static std::vector<CHAR_INFO> createFrame(size_t frame)
+{
+    static constexpr std::wstring_view words[]{ L"file.txt", L"README.md", L"\x65E5\x672C\x8A9E.doc", L"src", L"build.cmd", L"\x6F22\x5B57" };
+
+    std::vector<CHAR_INFO> cells;
+    cells.reserve(size.area<size_t>());
+
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        // Every other line is highlighted and a moving cursor bar marks the current file.
+        const auto cursor = gsl::narrow_cast<til::CoordType>(frame % size.height) == y;
+        const auto panel = gsl::narrow_cast<WORD>(cursor ? 0x30 : (y & 1 ? 0x1b : 0x1f));
+        auto word = words[(frame + y) % std::size(words)];
+        til::CoordType x = 0;
+
+        while (x < size.width)
+        {
+            const auto border = x == 0 || x == size.width / 2 || x == size.width - 1;
+            if (border)
+            {
+                cells.push_back({ { L'\x2551' }, 0x1e });
+                ++x;
+                continue;
+            }
+
+            const auto ch = word.empty() ? L' ' : word.front();
+            if (!word.empty())
+            {
+                word = word.substr(1);
+            }
+
+            // The CJK characters in the sample are all wide.
+            if (ch >= 0x3000 && x + 1 < size.width)
+            {
+                cells.push_back({ { ch }, gsl::narrow_cast<WORD>(panel | COMMON_LVB_LEADING_BYTE) });
+                cells.push_back({ { ch }, gsl::narrow_cast<WORD>(panel | COMMON_LVB_TRAILING_BYTE) });
+                x += 2;
+            }
+            else
+            {
+                cells.push_back({ { ch }, panel });
+                ++x;
+            }
+        }
+    }
+
+    return cells;
+}
+
+void benchBlit()
+{
+    std::vector<std::vector<CHAR_INFO>> input;
+    for (size_t i = 0; i < frames; ++i)
+    {
+        input.emplace_back(createFrame(i));
+    }
+
+    const auto bytes = frames * size.area<size_t>() * sizeof(CHAR_INFO);
+    const auto stride = gsl::narrow_cast<size_t>(size.width);
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    std::vector<CHAR_INFO> output(size.area<size_t>());
+
+    const auto writeCells = bench::measure(10, [&]() {
+        for (const auto& frame : input)
+        {
+            for (til::CoordType y = 0; y < size.height; ++y)
+            {
+                OutputCellIterator it{ std::span<const CHAR_INFO>{ frame }.subspan(y * stride, stride) };
+                buffer.Write(it, { 0, y });
+            }
+        }
+    });
+    bench::report("blit write cells", writeCells, bytes);
+
+    const auto writeBlit = bench::measure(10, [&]() {
+        for (const auto& frame : input)
+        {
+            buffer.WriteCharInfos(til::rect{ size }, frame, stride);
+        }
+    });
+    bench::report("blit write blit", writeBlit, bytes);
+
+    const auto readCells = bench::measure(10, [&]() {
+        for (size_t i = 0; i < frames; ++i)
+        {
+            auto out = output.begin();
+            for (auto it = buffer.GetCellDataAt({}); it; ++it, ++out)
+            {
+                const auto chars = it->Chars();
+                out->Char.UnicodeChar = chars.size() == 1 ? chars.front() : UNICODE_REPLACEMENT;
+                out->Attributes = it->TextAttr().GetLegacyAttributes();
+                out->Attributes |= GeneratePublicApiAttributeFormat(it->DbcsAttr());
+            }
+        }
+    });
+    bench::report("blit read cells", readCells, bytes);
+
+    const auto readBlit = bench::measure(10, [&]() {
+        for (size_t i = 0; i < frames; ++i)
+        {
+            buffer.ReadCharInfos(til::rect{ size }, output, stride);
+        }
+    });
+    bench::report("blit read blit", readBlit, bytes);
+}
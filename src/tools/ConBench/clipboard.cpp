@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures a "select all" copy with formatting of a 200x9001 buffer full of colored text. It compares the way
+// TextBuffer::GetText used to collect the selection (one string per row and a foreground and background color
+// per character, retrieved via TextBufferCellIterator) against TextBuffer::SerializeSelection, which generates
+// the plain text, HTML and RTF in one pass over the attribute runs. The former doesn't even include the time
+// and memory GenHTML/GenRTF needed to turn the colors into HTML and RTF afterwards.
+// The memory column is the size of the data that's alive when the copy is done.
+
+static constexpr til::size size{ 200, 9001 };
+
+static void fillBuffer(TextBuffer& buffer)
+{
+    static constexpr std::wstring_view words[]{ L"2023-08-01T12:34:56 ", L"INFO ", L"WARN ", L"request ", L"handled ", L"in ", L"12ms ", L"<GET /index.html> " };
+    static constexpr WORD colors[]{ 0x08, 0x0a, 0x0e, 0x07, 0x07, 0x07, 0x0b, 0x0d };
+
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        til::CoordType x = 0;
+        for (auto i = gsl::narrow_cast<size_t>(y); x < size.width; ++i)
+        {
+            const auto& word = words[i % std::size(words)];
+            buffer.WriteLine(OutputCellIterator{ word, TextAttribute{ colors[i % std::size(colors)] } }, { x, y });
+            x += gsl::narrow_cast<til::CoordType>(word.size());
+        }
+    }
+}
+
+static std::pair<COLORREF, COLORREF> getAttributeColors(const TextAttribute& attr)
+{
+    const auto legacy = attr.GetLegacyAttributes();
+    return { RGB(legacy & 0x0f, 0, 0), RGB(0, legacy >> 4, 0) };
+}
+
+static void reportCopy(std::string_view name, bench::clock::duration duration, size_t bytes)
+{
+    const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+    fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.1f} MB\n"), name, ns / 1e6, bytes / (1024.0 * 1024.0));
+}
+
+void benchClipboard()
+{
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    fillBuffer(buffer);
+
+    std::vector<til::inclusive_rect> selectionRects;
+    selectionRects.reserve(size.height);
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        selectionRects.emplace_back(til::inclusive_rect{ 0, y, size.width - 1, y });
+    }
+
+    {
+        size_t bytes = 0;
+        const auto duration = bench::measure(3, [&]() {
+            std::vector<std::wstring> text;
+            std::vector<std::vector<COLORREF>> fgAttr;
+            std::vector<std::vector<COLORREF>> bkAttr;
+
+            for (const auto& rect : selectionRects)
+            {
+                const auto highlight = Microsoft::Console::Types::Viewport::FromInclusive(rect);
+                auto& rowText = text.emplace_back();
+                auto& rowFg = fgAttr.emplace_back();
+                auto& rowBk = bkAttr.emplace_back();
+                rowText.reserve(gsl::narrow_cast<size_t>(highlight.Width()) + 2);
+                rowFg.reserve(gsl::narrow_cast<size_t>(highlight.Width()) + 2);
+                rowBk.reserve(gsl::narrow_cast<size_t>(highlight.Width()) + 2);
+
+                for (auto it = buffer.GetCellDataAt(highlight.Origin(), highlight); it; ++it)
+                {
+                    if (it->DbcsAttr() == DbcsAttribute::Trailing)
+                    {
+                        continue;
+                    }
+                    const auto chars = it->Chars();
+                    const auto [fg, bk] = getAttributeColors(it->TextAttr());
+                    rowText.append(chars);
+                    rowFg.insert(rowFg.end(), chars.size(), fg);
+                    rowBk.insert(rowBk.end(), chars.size(), bk);
+                }
+                rowText.append(L"\r\n");
+            }
+
+            bytes = 0;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                bytes += text[i].capacity() * sizeof(wchar_t) + (fgAttr[i].capacity() + bkAttr[i].capacity()) * sizeof(COLORREF);
+            }
+        });
+        reportCopy("clipboard per-cell colors", duration, bytes);
+    }
+
+    {
+        TextBuffer::ClipboardFormatting formatting;
+        formatting.GetAttributeColors = getAttributeColors;
+        formatting.fontHeightPoints = 12;
+        formatting.fontFaceName = L"Cascadia Mono";
+        formatting.html = true;
+        formatting.rtf = true;
+
+        size_t bytes = 0;
+        const auto duration = bench::measure(3, [&]() {
+            const auto data = buffer.SerializeSelection(true, true, selectionRects, formatting);
+            bytes = data.text.capacity() * sizeof(wchar_t) + data.html.capacity() + data.rtf.capacity();
+        });
+        reportCopy("clipboard SerializeSelection", duration, bytes);
+    }
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures the per-frame cost of keeping the URL patterns of a 120x30 viewport up to date, the way
+// Terminal::UpdatePatternsUnderLock does after every chunk of output and every cursor blink. It compares
+// calling GetPatterns() every frame (the way it used to work) against first asking the buffer whether
+// any of the visible rows changed since the last scan, via TextBuffer::HasChangedSince().
+// The "rows read" column counts the rows whose text had to be read per frame.
+
+static constexpr til::size size{ 120, 30 };
+static constexpr size_t frames = 10000;
+
+// The same as linkPattern in Terminal.hpp.
+static constexpr std::wstring_view linkPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
+
+enum class Activity
+{
+    Idle,
+    CursorBlink,
+    // A line of output every 10 frames.
+    Output,
+};
+
+static void writeLine(TextBuffer& buffer, til::CoordType y, size_t i)
+{
+    const auto line = fmt::format(FMT_COMPILE(L"{:>6} build: see https://example.com/builds/{} for details"), i, i);
+    OutputCellIterator it{ line, TextAttribute{ 0x07 } };
+    buffer.WriteLine(it, { 0, y });
+}
+
+static void benchGenerationFrames(std::string_view name, Activity activity, bool checkGeneration)
+{
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    buffer.AddPatternRecognizer(linkPattern);
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        writeLine(buffer, y, gsl::narrow_cast<size_t>(y));
+    }
+
+    const auto lastRow = size.height - 1;
+    size_t rowsRead = 0;
+
+    const auto duration = bench::measure(5, [&]() {
+        uint64_t generation = 0;
+        bool scanned = false;
+        rowsRead = 0;
+
+        for (size_t i = 0; i < frames; ++i)
+        {
+            switch (activity)
+            {
+            case Activity::CursorBlink:
+                buffer.GetCursor().SetIsOn(i % 2 != 0);
+                break;
+            case Activity::Output:
+                if (i % 10 == 0)
+                {
+                    writeLine(buffer, gsl::narrow_cast<til::CoordType>(i / 10 % size.height), i);
+                }
+                break;
+            default:
+                break;
+            }
+
+            if (checkGeneration && scanned && !buffer.HasChangedSince(generation, 0, lastRow))
+            {
+                continue;
+            }
+
+            generation = buffer.GetGeneration();
+            scanned = true;
+            std::ignore = buffer.GetPatterns(0, lastRow);
+            rowsRead += size.height;
+        }
+    });
+
+    const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+    fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.1f} ns/frame {:>6.2f} rows read/frame\n"), name, ns / 1e6, ns / frames, static_cast<double>(rowsRead) / frames);
+}
+
+void benchGeneration()
+{
+    benchGenerationFrames("generation idle rescan", Activity::Idle, false);
+    benchGenerationFrames("generation idle check", Activity::Idle, true);
+    benchGenerationFrames("generation cursor blink rescan", Activity::CursorBlink, false);
+    benchGenerationFrames("generation cursor blink check", Activity::CursorBlink, true);
+    benchGenerationFrames("generation output rescan", Activity::Output, false);
+    benchGenerationFrames("generation output check", Activity::Output, true);
+}
@@ -0,0 +1,185 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../terminal/adapter/IInteractDispatch.hpp"
+#include "../../terminal/parser/InputStateMachineEngine.hpp"
+#include "../../terminal/parser/stateMachine.hpp"
+
+// Measures how fast a 10 MB paste that a terminal forwards to ConPTY makes it from the input pipe into the
+// input buffer, as plain text and in win32-input-mode (one sequence per key down and up). It compares
+// 256 B reads, each key written individually (the way VtInputThread used to work) against adaptive reads
+// with a reused conversion buffer and the decoded events written once per read (the way it works now).
+// The input buffer is simulated by a vector of INPUT_RECORDs and an event that's signaled on each write.
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+namespace
+{
+    class InputBuffer
+    {
+    public:
+        InputBuffer() :
+            _event{ wil::EventOptions::ManualReset }
+        {
+        }
+
+        void Write(std::deque<std::unique_ptr<IInputEvent>>& events)
+        {
+            const auto records = IInputEvent::ToInputRecords(events);
+            events.clear();
+            _records.insert(_records.end(), records.begin(), records.end());
+            // Stands in for WakeUpReadersWaitingForData().
+            _event.SetEvent();
+        }
+
+        void Clear() noexcept
+        {
+            _records.clear();
+        }
+
+    private:
+        std::vector<INPUT_RECORD> _records;
+        wil::unique_event _event;
+    };
+
+    // Mirrors InteractDispatch, minus the parts that need a console.
+    class BenchInteractDispatch final : public IInteractDispatch
+    {
+    public:
+        BenchInteractDispatch(InputBuffer& buffer, bool batched) noexcept :
+            _buffer{ buffer },
+            _batched{ batched }
+        {
+        }
+
+        bool WriteInput(std::deque<std::unique_ptr<IInputEvent>>& inputEvents) override
+        {
+            if (_batched)
+            {
+                std::move(inputEvents.begin(), inputEvents.end(), std::back_inserter(_pendingInput));
+                inputEvents.clear();
+            }
+            else
+            {
+                _buffer.Write(inputEvents);
+            }
+            return true;
+        }
+
+        bool WriteCtrlKey(const KeyEvent& event) override
+        {
+            FlushInput();
+            std::deque<std::unique_ptr<IInputEvent>> events;
+            events.push_back(std::make_unique<KeyEvent>(event));
+            _buffer.Write(events);
+            return true;
+        }
+
+        bool WriteString(const std::wstring_view string) override
+        {
+            std::deque<std::unique_ptr<IInputEvent>> events;
+            for (const auto wch : string)
+            {
+                events.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
+                events.push_back(std::make_unique<KeyEvent>(false, 1ui16, 0ui16, 0ui16, wch, 0));
+            }
+            return WriteInput(events);
+        }
+
+        bool WindowManipulation(const DispatchTypes::WindowManipulationType, const VTParameter, const VTParameter) override { return true; }
+        bool MoveCursor(const VTInt, const VTInt) override { return true; }
+        bool IsVtInputEnabled() const override { return false; }
+        bool FocusChanged(const bool) override { return true; }
+
+        void FlushInput()
+        {
+            if (!_pendingInput.empty())
+            {
+                _buffer.Write(_pendingInput);
+            }
+        }
+
+    private:
+        InputBuffer& _buffer;
+        std::deque<std::unique_ptr<IInputEvent>> _pendingInput;
+        bool _batched;
+    };
+}
+
+static constexpr size_t pasteLength = 10 * 1024 * 1024;
+
+static std::string createPaste(bool win32InputMode)
+{
+    static constexpr std::string_view words[]{ "lorem ", "ipsum ", "dolor ", "sit ", "amet, ", "consectetur ", "adipiscing ", "elit\r" };
+
+    std::string text;
+    text.reserve(pasteLength + 64);
+    for (size_t i = 0; text.size() < pasteLength; ++i)
+    {
+        for (const auto ch : words[(i * 3) % std::size(words)])
+        {
+            if (win32InputMode)
+            {
+                // Vk;Sc;Uc;Kd;Cs;Rc_ with a made up virtual key and scan code.
+                fmt::format_to(std::back_inserter(text), FMT_COMPILE("\x1b[65;30;{};1;0;1_\x1b[65;30;{};0;0;1_"), int{ ch }, int{ ch });
+            }
+            else
+            {
+                text.push_back(ch);
+            }
+        }
+    }
+    return text;
+}
+
+static void benchInputPaste(std::string_view name, const std::string& paste, bool batched)
+{
+    InputBuffer buffer;
+
+    const auto duration = bench::measure(5, [&]() {
+        buffer.Clear();
+
+        auto dispatch = std::make_unique<BenchInteractDispatch>(buffer, batched);
+        const auto dispatchRef = dispatch.get();
+        StateMachine stateMachine{ std::make_unique<InputStateMachineEngine>(std::move(dispatch)) };
+
+        til::u8state u8State;
+        std::wstring wstr;
+        size_t readSize = batched ? 4 * 1024 : 256;
+
+        for (size_t i = 0; i < paste.size();)
+        {
+            const auto read = std::string_view{ paste }.substr(i, readSize);
+            i += read.size();
+
+            if (!batched)
+            {
+                wstr = {};
+            }
+            std::ignore = til::u8u16(read, wstr, u8State);
+            stateMachine.ProcessString(wstr);
+            dispatchRef->FlushInput();
+
+            if (batched && read.size() == readSize && readSize < 128 * 1024)
+            {
+                readSize *= 2;
+            }
+        }
+    });
+    bench::report(name, duration, paste.size());
+}
+
+void benchInput()
+{
+    const auto text = createPaste(false);
+    const auto win32InputMode = createPaste(true);
+
+    benchInputPaste("input paste 256 B reads", text, false);
+    benchInputPaste("input paste batched", text, true);
+    benchInputPaste("input win32-input-mode 256 B reads", win32InputMode, false);
+    benchInputPaste("input win32-input-mode batched", win32InputMode, true);
+}
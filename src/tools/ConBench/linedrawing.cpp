@@ -0,0 +1,69 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+#include "terminal.h"
+
+// Measures how fast box drawing via the DEC Special Graphics character set goes through the
+// parser, the charset translation and into the buffer. TUIs like htop, mc or tmux switch
+// between G0 = DEC Special Graphics and G0 = ASCII many times per frame for their borders.
+
+// Draws `frames` screens of boxes, the way a TUI would redraw its borders every frame.
+// If `lineDrawing` is false, the same frame is drawn with plain ASCII for comparison.
+static std::wstring createFrames(size_t frames, bool lineDrawing)
+{
+    const auto enter = lineDrawing ? L"\x1b(0" : L"";
+    const auto leave = lineDrawing ? L"\x1b(B" : L"";
+
+    std::wstring text;
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        text.append(L"\x1b[H");
+        for (size_t y = 0; y < 30; ++y)
+        {
+            // Four 30 column wide boxes per line, each with a label.
+            for (size_t box = 0; box < 4; ++box)
+            {
+                const auto edge = y == 0 || y == 29;
+                text.append(enter);
+                text.append(edge ? (y == 0 ? L"l" : L"m") : L"x");
+                if (edge)
+                {
+                    text.append(28, L'q');
+                }
+                text.append(leave);
+                if (!edge)
+                {
+                    fmt::format_to(std::back_inserter(text), L" {:<26} ", frame + y * 4 + box);
+                }
+                text.append(enter);
+                text.append(edge ? (y == 0 ? L"k" : L"j") : L"x");
+                text.append(leave);
+            }
+            text.append(L"\r\n");
+        }
+    }
+    return text;
+}
+
+static void benchLineDrawingText(std::string_view name, const std::wstring& text)
+{
+    const auto duration = bench::measure(10, [&]() {
+        bench::Terminal terminal{ { 120, 30 } };
+        terminal.Write(text);
+    });
+    bench::report(name, duration, text.size() * sizeof(wchar_t));
+}
+
+void benchLineDrawing()
+{
+    const auto ascii = createFrames(1000, false);
+    const auto lineDrawing = createFrames(1000, true);
+
+    benchLineDrawingText("linedrawing ASCII", ascii);
+    benchLineDrawingText("linedrawing DEC Special Graphics", lineDrawing);
+    // In insert mode (IRM) every printed run has to be measured before it's written.
+    benchLineDrawingText("linedrawing DEC Special Graphics IRM", L"\x1b[4h" + lineDrawing);
+}
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+// ConBench runs headless micro-benchmarks against the console's internal components.
+// Usage: ConBench.exe [name...]
+// Without arguments all benchmarks are run, otherwise only the named ones.
+
+struct Benchmark
+{
+    std::wstring_view name;
+    void (*func)();
+};
+
+static constexpr Benchmark benchmarks[]{
+    { L"blit", benchBlit },
+    { L"clipboard", benchClipboard },
+    { L"generation", benchGeneration },
+    { L"input", benchInput },
+    { L"linedrawing", benchLineDrawing },
+    { L"parser", benchParser },
+    { L"patterns", benchPatterns },
+    { L"reflow", benchReflow },
+    { L"render", benchRender },
+    { L"scroll", benchScroll },
+    { L"scrollback", benchScrollback },
+    { L"sgr", benchSgr },
+    { L"uia", benchUia },
+    { L"utf8", benchUtf8 },
+    { L"width", benchWidth },
+    { L"write", benchWrite },
+};
+
+int wmain(int argc, wchar_t* argv[])
+{
+    const std::span<wchar_t*> args{ argv + 1, gsl::narrow_cast<size_t>(argc - 1) };
+
+    for (const auto& arg : args)
+    {
+        if (std::none_of(std::begin(benchmarks), std::end(benchmarks), [&](const auto& b) { return b.name == arg; }))
+        {
+            fwprintf(stderr, L"unknown benchmark: %s\n", arg);
+            return 1;
+        }
+    }
+
+    for (const auto& b : benchmarks)
+    {
+        if (args.empty() || std::any_of(args.begin(), args.end(), [&](const auto& arg) { return b.name == arg; }))
+        {
+            b.func();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+#include "terminal.h"
+
+#include "../../terminal/adapter/termDispatch.hpp"
+
+// Measures VT output processing in three stages, so that regressions in each can be told apart:
+// * parse:  StateMachine + OutputStateMachineEngine with a dispatch that ignores everything.
+// * buffer: TextBuffer::Write() of just the printable text the parser produced.
+// * full:   StateMachine + OutputStateMachineEngine + AdaptDispatch into a TextBuffer.
+// The cost of AdaptDispatch itself is roughly full - parse - buffer.
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+namespace
+{
+    // Ignores all sequences. If `runs` is given, it records the printable text instead.
+    class NullDispatch final : public TermDispatch
+    {
+    public:
+        explicit NullDispatch(std::vector<std::wstring>* runs = nullptr) noexcept :
+            _runs{ runs }
+        {
+        }
+
+        void Print(const wchar_t wchPrintable) override
+        {
+            if (_runs)
+            {
+                _runs->emplace_back(1, wchPrintable);
+            }
+        }
+
+        void PrintString(const std::wstring_view string) override
+        {
+            if (_runs)
+            {
+                _runs->emplace_back(string);
+            }
+        }
+
+    private:
+        std::vector<std::wstring>* _runs;
+    };
+
+    struct Corpus
+    {
+        std::string_view name;
+        std::wstring text;
+    };
+}
+
+static constexpr size_t corpusLength = 4 * 1024 * 1024;
+
+// Appends `line` to `text` until it's at least `length` long, formatting
+// each line with its index, so that the lines aren't all identical.
+template<typename Func>
+static std::wstring createCorpus(size_t length, Func&& line)
+{
+    std::wstring text;
+    text.reserve(length + 1024);
+    for (size_t i = 0; text.size() < length; ++i)
+    {
+        line(text, i);
+    }
+    return text;
+}
+
+static std::vector<Corpus> createCorpora()
+{
+    static constexpr std::wstring_view words[]{ L"lorem", L"ipsum", L"dolor", L"sit", L"amet", L"consectetur", L"adipiscing", L"elit" };
+    static constexpr std::wstring_view levels[]{ L"\x1b[32mINFO\x1b[m", L"\x1b[33mWARN\x1b[m", L"\x1b[1;31mFAIL\x1b[m", L"\x1b[2mTRACE\x1b[m" };
+    static constexpr std::wstring_view cjk[]{ L"漢字", L"仮名", L"ひらがな", L"한글", L"中文", L"カタカナ" };
+
+    std::vector<Corpus> corpora;
+
+    // Plain text, as printed by compilers or `cat`.
+    corpora.push_back({ "ASCII", createCorpus(corpusLength, [&](std::wstring& text, size_t i) {
+        for (size_t j = 0; j < 12; ++j)
+        {
+            text.append(words[(i + j * 3) % std::size(words)]);
+            text.push_back(L' ');
+        }
+        text.append(L"\r\n");
+    }) });
+
+    // Colored log output with timestamps, levels and 256-color/RGB highlights.
+    corpora.push_back({ "SGR log", createCorpus(corpusLength, [&](std::wstring& text, size_t i) {
+        fmt::format_to(std::back_inserter(text), L"\x1b[90m12:{:02}:{:02}.{:03}\x1b[m ", i / 3600 % 60, i / 60 % 60, i % 1000);
+        text.append(levels[i % std::size(levels)]);
+        fmt::format_to(std::back_inserter(text), L" \x1b[38;5;{}m{}\x1b[m: ", 16 + i % 216, words[i % std::size(words)]);
+        for (size_t j = 0; j < 6; ++j)
+        {
+            fmt::format_to(std::back_inserter(text), L"\x1b[38;2;{};{};{}m{} ", i * 7 % 256, j * 40, 255 - i % 256, words[(i + j) % std::size(words)]);
+        }
+        text.append(L"\x1b[m\r\n");
+    }) });
+
+    // A full-screen TUI updating individual cells with absolute cursor addressing, like htop or vim.
+    corpora.push_back({ "TUI", createCorpus(corpusLength, [&](std::wstring& text, size_t i) {
+        fmt::format_to(std::back_inserter(text), L"\x1b[{};{}H\x1b[48;5;{}m\x1b[{}m{:>6}\x1b[m", i % 30 + 1, i * 7 % 110 + 1, 232 + i % 24, 30 + i % 8, i);
+        if (i % 30 == 0)
+        {
+            text.append(L"\x1b[?25l\x1b[1;1H\x1b[2K\x1b[7m  PID USER      PRI  NI  VIRT   RES\x1b[27m\x1b[?25h");
+        }
+    }) });
+
+    // OSC 8 hyperlinks, as printed by `ls --hyperlink` or modern compilers.
+    corpora.push_back({ "OSC 8 hyperlinks", createCorpus(corpusLength, [&](std::wstring& text, size_t i) {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const auto word = words[(i + j) % std::size(words)];
+            fmt::format_to(std::back_inserter(text), L"\x1b]8;id={0};file:///home/user/{1}/{0}.txt\x1b\\{1}{0}.txt\x1b]8;;\x1b\\  ", i * 4 + j, word);
+        }
+        text.append(L"\r\n");
+    }) });
+
+    // Large OSC 52 clipboard writes, as sent by tmux or vim when yanking over SSH.
+    corpora.push_back({ "OSC 52 clipboard", createCorpus(corpusLength, [&](std::wstring& text, size_t i) {
+        text.append(L"\x1b]52;c;");
+        for (size_t j = 0; j < 64 * 1024; j += 4)
+        {
+            text.append(words[(i + j) % std::size(words)].substr(0, 4));
+        }
+        text.append(L"\x1b\\");
+    }) });
+
+    // Wide CJK text, which can't use the ASCII fast paths.
+    corpora.push_back({ "CJK", createCorpus(corpusLength, [&](std::wstring& text, size_t i) {
+        for (size_t j = 0; j < 10; ++j)
+        {
+            text.append(cjk[(i + j * 5) % std::size(cjk)]);
+            text.push_back(j % 3 ? L'、' : L' ');
+        }
+        text.append(L"\r\n");
+    }) });
+
+    return corpora;
+}
+
+// Writes the printable runs one after another, wrapping at the end of each
+// row, just like the terminal would without any cursor movement.
+static void writeRuns(TextBuffer& buffer, const std::vector<std::wstring>& runs)
+{
+    const auto size = buffer.GetSize().Dimensions();
+    const auto& attributes = buffer.GetCurrentAttributes();
+    til::point pos;
+
+    for (const auto& run : runs)
+    {
+        RowWriteState state{ .text = run, .columnBegin = pos.x, .columnLimit = size.width };
+        for (;;)
+        {
+            buffer.Write(pos.y, attributes, state);
+            if (state.text.empty())
+            {
+                pos.x = state.columnEnd;
+                break;
+            }
+            pos = { 0, (pos.y + 1) % size.height };
+            state.columnBegin = 0;
+        }
+    }
+}
+
+void benchParser()
+{
+    static constexpr til::size size{ 120, 30 };
+
+    for (const auto& corpus : createCorpora())
+    {
+        const auto chars = corpus.text.size();
+
+        const auto parse = bench::measure(10, [&]() {
+            StateMachine stateMachine{ std::make_unique<OutputStateMachineEngine>(std::make_unique<NullDispatch>()) };
+            stateMachine.ProcessString(corpus.text);
+        });
+        bench::reportText(fmt::format(FMT_COMPILE("parser {} parse"), corpus.name), parse, chars);
+
+        std::vector<std::wstring> runs;
+        {
+            StateMachine stateMachine{ std::make_unique<OutputStateMachineEngine>(std::make_unique<NullDispatch>(&runs)) };
+            stateMachine.ProcessString(corpus.text);
+        }
+        const auto buffer = bench::measure(10, [&]() {
+            DummyRenderer renderer;
+            TextBuffer textBuffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+            writeRuns(textBuffer, runs);
+        });
+        bench::reportText(fmt::format(FMT_COMPILE("parser {} buffer"), corpus.name), buffer, chars);
+
+        const auto full = bench::measure(10, [&]() {
+            bench::Terminal terminal{ size };
+            terminal.Write(corpus.text);
+        });
+        bench::reportText(fmt::format(FMT_COMPILE("parser {} full"), corpus.name), full, chars);
+    }
+}
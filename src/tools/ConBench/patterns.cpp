@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures TextBuffer::GetPatterns() finding URLs in a 120x30 viewport of a buffer with 1000 rows of build
+// output, one URL every other line. Only the GetPatterns() calls are timed. GetPatterns() caches the matches
+// of each logical line until one of its rows changes, so the cost depends on how many rows changed:
+// * all rows: every row of the viewport is rewritten before each call, which means that every line is scanned
+// * output: one line of output scrolls the buffer up before each call, the way a running build does
+// * history: the viewport moves through the scrollback one row per call, up and down again
+// * idle: nothing changed, which is roughly the cost of checking the row generations
+
+static constexpr til::size size{ 120, 1000 };
+static constexpr til::CoordType viewportHeight = 30;
+static constexpr size_t frames = 10000;
+
+// The same as linkPattern in Terminal.hpp.
+static constexpr std::wstring_view linkPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
+
+enum class Activity
+{
+    AllRows,
+    Output,
+    History,
+    Idle,
+};
+
+static void writeLine(TextBuffer& buffer, til::CoordType y, size_t i)
+{
+    const auto line = i % 2 ? fmt::format(FMT_COMPILE(L"{:>6} compiling src/module{}/file{}.cpp"), i, i % 7, i) :
+                              fmt::format(FMT_COMPILE(L"{:>6} warning: see https://example.com/docs/warnings/{} for details"), i, i);
+    OutputCellIterator it{ line, TextAttribute{ 0x07 } };
+    buffer.WriteLine(it, { 0, y });
+}
+
+static void benchPatternsFrames(std::string_view name, Activity activity)
+{
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    std::ignore = buffer.AddPatternRecognizer(linkPattern);
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        writeLine(buffer, y, gsl::narrow_cast<size_t>(y));
+    }
+
+    const auto bottom = size.height - 1;
+    const auto maxTop = size.height - viewportHeight;
+    auto line = gsl::narrow_cast<size_t>(size.height);
+    auto top = maxTop;
+
+    // The first call scans the entire viewport in any case.
+    std::ignore = buffer.GetPatterns(top, top + viewportHeight - 1);
+
+    bench::clock::duration duration{};
+    for (size_t i = 0; i < frames; ++i)
+    {
+        switch (activity)
+        {
+        case Activity::AllRows:
+            for (auto y = top; y < top + viewportHeight; ++y)
+            {
+                writeLine(buffer, y, line++);
+            }
+            break;
+        case Activity::Output:
+            buffer.IncrementCircularBuffer();
+            writeLine(buffer, bottom, line++);
+            break;
+        case Activity::History:
+        {
+            // Moves from the bottom to the top and back down again.
+            const auto position = gsl::narrow_cast<til::CoordType>(i % (2 * maxTop));
+            top = position < maxTop ? maxTop - position : position - maxTop;
+            break;
+        }
+        default:
+            break;
+        }
+
+        const auto beg = bench::clock::now();
+        std::ignore = buffer.GetPatterns(top, top + viewportHeight - 1);
+        duration += bench::clock::now() - beg;
+    }
+
+    const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+    fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.1f} ns/frame\n"), name, ns / 1e6, ns / frames);
+}
+
+void benchPatterns()
+{
+    benchPatternsFrames("patterns all rows changed", Activity::AllRows);
+    benchPatternsFrames("patterns output", Activity::Output);
+    benchPatternsFrames("patterns history", Activity::History);
+    benchPatternsFrames("patterns idle", Activity::Idle);
+}
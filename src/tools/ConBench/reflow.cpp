@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures TextBuffer::Reflow() for a 80 -> 200 -> 80 column round trip over a full scrollback,
+// which is what happens when the user drags a window or pane edge back and forth.
+
+static constexpr til::CoordType scrollbackHeight = 9001;
+
+static std::unique_ptr<TextBuffer> createFilledBuffer(Microsoft::Console::Render::Renderer& renderer, til::CoordType width)
+{
+    const TextAttribute defaultAttr{ 0x07 };
+    auto buffer = std::make_unique<TextBuffer>(til::size{ width, scrollbackHeight }, defaultAttr, 0, false, renderer);
+
+    // Logical lines of varying length (up to 3 rows) with a couple of differently colored words,
+    // so that the reflow has to split text and attribute runs across rows.
+    static constexpr std::wstring_view words[]{ L"lorem ", L"ipsum ", L"dolor ", L"sit ", L"amet, ", L"consectetur ", L"adipiscing ", L"elit " };
+    std::wstring line;
+    size_t seed = 0;
+
+    for (til::CoordType y = 0; y < scrollbackHeight;)
+    {
+        line.clear();
+        const auto lineWidth = gsl::narrow_cast<size_t>(width) * (seed % 3) + (seed * 37) % gsl::narrow_cast<size_t>(width);
+        while (line.size() < lineWidth)
+        {
+            line.append(words[seed++ % std::size(words)]);
+        }
+        line.resize(lineWidth);
+        ++seed;
+
+        std::wstring_view remaining{ line };
+        do
+        {
+            RowWriteState state{ .text = remaining, .columnLimit = width };
+            buffer->Write(y, defaultAttr, state);
+            remaining = state.text;
+
+            auto& row = buffer->GetRowByOffset(y);
+            for (til::CoordType x = y % 7; x < state.columnEnd; x += 13)
+            {
+                row.ReplaceAttributes(x, x + 6, TextAttribute{ gsl::narrow_cast<WORD>(0x01 + x % 6) });
+            }
+            row.SetWrapForced(!remaining.empty());
+            ++y;
+        } while (!remaining.empty() && y < scrollbackHeight);
+    }
+
+    buffer->GetCursor().SetPosition({ 0, scrollbackHeight - 1 });
+    return buffer;
+}
+
+void benchReflow()
+{
+    DummyRenderer renderer;
+    const TextAttribute defaultAttr{ 0x07 };
+    const auto source = createFilledBuffer(renderer, 80);
+
+    // The buffers are allocated outside of the measured region, because we're only interested in Reflow() itself.
+    std::unique_ptr<TextBuffer> wide;
+    std::unique_ptr<TextBuffer> narrow;
+    const auto allocate = [&]() {
+        wide = std::make_unique<TextBuffer>(til::size{ 200, scrollbackHeight }, defaultAttr, 0, false, renderer);
+        narrow = std::make_unique<TextBuffer>(til::size{ 80, scrollbackHeight }, defaultAttr, 0, false, renderer);
+    };
+
+    auto widen = bench::clock::duration::max();
+    auto shrink = bench::clock::duration::max();
+
+    for (auto i = 0; i < 5; ++i)
+    {
+        allocate();
+        widen = std::min(widen, bench::measure(1, [&]() { TextBuffer::Reflow(*source, *wide, std::nullopt, std::nullopt); }));
+        shrink = std::min(shrink, bench::measure(1, [&]() { TextBuffer::Reflow(*wide, *narrow, std::nullopt, std::nullopt); }));
+    }
+
+    bench::report("reflow 80 -> 200 columns", widen);
+    bench::report("reflow 200 -> 80 columns", shrink);
+    bench::report("reflow 80 -> 200 -> 80 round trip", widen + shrink);
+}
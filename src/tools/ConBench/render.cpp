@@ -0,0 +1,267 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+#include "terminal.h"
+
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/inc/RenderEngineBase.hpp"
+
+// Measures how fast colorful output is ingested into a 120x30 terminal, while the Renderer paints the entire
+// viewport on another thread as often as it can (every 8 ms, like RenderEngineBase::WaitUntilCanRender()).
+// The ingesting and the painting thread share a lock, like the console lock. It compares an engine which
+// requires the lock for painting (the way every engine used to be painted) against one that's painted from
+// the Renderer's frame snapshot after the lock was released. The engine simulates the cost of shaping and
+// drawing text by spinning for 250 ns per cluster, which is roughly 1 ms for a full frame.
+// It also measures an application echoing one character at a time, where every character is its own
+// Renderer::TriggerRedraw() call, and how many of those invalidations are forwarded to the engine.
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+static constexpr til::size size{ 120, 30 };
+static constexpr size_t textLength = 16 * 1024 * 1024;
+static constexpr size_t chunkLength = 16 * 1024;
+static constexpr std::chrono::nanoseconds costPerCluster{ 250 };
+
+namespace
+{
+    class RenderData final : public IRenderData
+    {
+    public:
+        RenderData(const TextBuffer& buffer, til::ticket_lock& lock) noexcept :
+            _buffer{ buffer },
+            _lock{ lock }
+        {
+        }
+
+        Viewport GetViewport() noexcept override { return _buffer.GetSize(); }
+        til::point GetTextBufferEndPosition() const noexcept override { return {}; }
+        const TextBuffer& GetTextBuffer() const noexcept override { return _buffer; }
+        const FontInfo& GetFontInfo() const noexcept override { FAIL_FAST_HR(E_NOTIMPL); }
+        std::vector<Viewport> GetSelectionRects() noexcept override { return {}; }
+        void LockConsole() noexcept override { _lock.lock(); }
+        void UnlockConsole() noexcept override { _lock.unlock(); }
+
+        til::point GetCursorPosition() const noexcept override { return _buffer.GetCursor().GetPosition(); }
+        bool IsCursorVisible() const noexcept override { return true; }
+        bool IsCursorOn() const noexcept override { return true; }
+        ULONG GetCursorHeight() const noexcept override { return 25; }
+        CursorType GetCursorStyle() const noexcept override { return CursorType::Legacy; }
+        ULONG GetCursorPixelWidth() const noexcept override { return 1; }
+        bool IsCursorDoubleWidth() const override { return false; }
+        const std::vector<RenderOverlay> GetOverlays() const noexcept override { return {}; }
+        const bool IsGridLineDrawingAllowed() noexcept override { return true; }
+        const std::wstring_view GetConsoleTitle() const noexcept override { return L"ConBench"; }
+        const std::wstring GetHyperlinkUri(uint16_t) const override { return {}; }
+        const std::wstring GetHyperlinkCustomId(uint16_t) const override { return {}; }
+        const std::vector<size_t> GetPatternId(const til::point) const override { return {}; }
+
+        std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute&) const noexcept override { return {}; }
+        const bool IsSelectionActive() const override { return false; }
+        const bool IsBlockSelection() const override { return false; }
+        void ClearSelection() override {}
+        void SelectNewRegion(const til::point, const til::point) override {}
+        const til::point GetSelectionAnchor() const noexcept override { return {}; }
+        const til::point GetSelectionEnd() const noexcept override { return {}; }
+        void ColorSelection(const til::point, const til::point, const TextAttribute) override {}
+        const bool IsUiaDataInitialized() const noexcept override { return true; }
+
+    private:
+        const TextBuffer& _buffer;
+        til::ticket_lock& _lock;
+    };
+
+    // Repaints the entire viewport every frame, as the TextBuffer's invalidations go to bench::Terminal's DummyRenderer.
+    class BenchEngine final : public RenderEngineBase
+    {
+    public:
+        explicit BenchEngine(bool requiresLock) noexcept :
+            _requiresLock{ requiresLock }
+        {
+        }
+
+        size_t frames = 0;
+        size_t invalidations = 0;
+
+        [[nodiscard]] HRESULT StartPaint() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT EndPaint() noexcept override
+        {
+            frames++;
+            return S_OK;
+        }
+        [[nodiscard]] bool RequiresLockForPainting() noexcept override { return _requiresLock; }
+        [[nodiscard]] HRESULT Present() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT Invalidate(const til::rect*) noexcept override
+        {
+            invalidations++;
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT InvalidateCursor(const til::rect*) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSystem(const til::rect*) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<til::rect>&) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateScroll(const til::point*) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintBackground() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point, bool, bool) noexcept override
+        {
+            const auto deadline = bench::clock::now() + clusters.size() * costPerCluster;
+            while (bench::clock::now() < deadline)
+            {
+            }
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT PaintBufferGridLines(GridLineSet, COLORREF, size_t, til::point) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintSelection(const til::rect&) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions&) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*>, bool, bool) noexcept override
+        {
+            std::ignore = renderSettings.GetAttributeColors(textAttributes);
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired&, _Out_ FontInfo&) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateDpi(int) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateViewport(const til::inclusive_rect&) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired&, _Out_ FontInfo&, int) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept override
+        {
+            area = { &_dirty, 1 };
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT GetFontSize(_Out_ til::size* pFontSize) noexcept override
+        {
+            *pFontSize = { 8, 16 };
+            return S_OK;
+        }
+        [[nodiscard]] HRESULT IsGlyphWideByFont(std::wstring_view, _Out_ bool* pResult) noexcept override
+        {
+            *pResult = false;
+            return S_OK;
+        }
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view) noexcept override { return S_OK; }
+
+    private:
+        til::rect _dirty{ size };
+        bool _requiresLock;
+    };
+}
+
+static std::wstring createText()
+{
+    static constexpr std::wstring_view words[]{ L"lorem ", L"ipsum ", L"dolor ", L"sit ", L"amet, ", L"consectetur ", L"adipiscing ", L"elit " };
+
+    std::wstring text;
+    text.reserve(textLength + 64);
+    for (size_t i = 0; text.size() < textLength; ++i)
+    {
+        fmt::format_to(std::back_inserter(text), FMT_COMPILE(L"\x1b[3{}m{}"), i % 8, words[(i * 3) % std::size(words)]);
+        if (i % 12 == 11)
+        {
+            text.append(L"\x1b[m\r\n");
+        }
+    }
+    return text;
+}
+
+static void benchRenderIngest(std::string_view name, const std::wstring& text, bool requiresLock)
+{
+    bench::Terminal terminal{ size };
+    til::ticket_lock lock;
+    RenderData data{ terminal.GetTextBuffer(), lock };
+    BenchEngine engine{ requiresLock };
+    IRenderEngine* engines[]{ &engine };
+    RenderSettings settings;
+    Renderer renderer{ settings, &data, &engines[0], std::size(engines), nullptr };
+
+    auto best = bench::clock::duration::max();
+    size_t frames = 0;
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        std::atomic<bool> done{ false };
+        engine.frames = 0;
+
+        std::thread renderThread{ [&]() {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                LOG_IF_FAILED(renderer.PaintFrame());
+                renderer.WaitUntilCanRender();
+            }
+        } };
+
+        const auto beg = bench::clock::now();
+        for (size_t offset = 0; offset < text.size(); offset += chunkLength)
+        {
+            std::lock_guard guard{ lock };
+            terminal.Write(std::wstring_view{ text }.substr(offset, chunkLength));
+        }
+        const auto duration = bench::clock::now() - beg;
+
+        done.store(true, std::memory_order_relaxed);
+        renderThread.join();
+
+        if (duration < best)
+        {
+            best = duration;
+            frames = engine.frames;
+        }
+    }
+
+    const auto ns = std::chrono::duration<double, std::nano>(best).count();
+    const auto mbps = text.size() * sizeof(wchar_t) / ns * 1e9 / (1024 * 1024);
+    fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.2f} MB/s {:>8.1f} frames/s\n"), name, ns / 1e6, mbps, frames / ns * 1e9);
+}
+
+static void benchRenderInvalidate()
+{
+    static constexpr size_t chars = 100000;
+    static constexpr size_t charsPerFrame = 1000;
+
+    bench::Terminal terminal{ size };
+    til::ticket_lock lock;
+    RenderData data{ terminal.GetTextBuffer(), lock };
+    BenchEngine engine{ true };
+    IRenderEngine* engines[]{ &engine };
+    RenderSettings settings;
+    Renderer renderer{ settings, &data, &engines[0], std::size(engines), nullptr };
+
+    // The first frame picks up the viewport, which the invalidations are clipped to.
+    LOG_IF_FAILED(renderer.PaintFrame());
+
+    bench::clock::duration duration{};
+    for (size_t i = 0; i < chars; i += charsPerFrame)
+    {
+        const auto beg = bench::clock::now();
+        for (auto j = i; j < i + charsPerFrame; ++j)
+        {
+            const til::point pos{ gsl::narrow_cast<til::CoordType>(j % size.width), gsl::narrow_cast<til::CoordType>(j / size.width % size.height) };
+            renderer.TriggerRedraw(&pos);
+        }
+        duration += bench::clock::now() - beg;
+
+        LOG_IF_FAILED(renderer.PaintFrame());
+    }
+
+    const auto stats = renderer.GetInvalidationStats();
+    bench::reportText("render TriggerRedraw per char", duration, chars);
+    fmt::print(FMT_COMPILE("{:<40} {:>12} received {:>10} forwarded {:>10} Invalidate calls\n"), "render invalidations", stats.received, stats.forwarded, engine.invalidations);
+}
+
+void benchRender()
+{
+    const auto text = createText();
+
+    benchRenderIngest("render ingest, painting under the lock", text, true);
+    benchRenderIngest("render ingest, painting from snapshot", text, false);
+    benchRenderInvalidate();
+}
@@ -0,0 +1,72 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures scrolling inside DECSTBM margins, the way vim, less and tmux scroll a full-width region
+// of a 300x80 screen line by line. It compares copying each row into its destination with ROW::CopyFrom
+// (the way TextBuffer::ScrollRows used to work) against TextBuffer::ScrollRows, which swaps the rows.
+// Like AdaptDispatch, both variants erase the revealed line afterwards.
+
+static constexpr til::size size{ 300, 80 };
+static constexpr til::CoordType marginTop = 1;
+static constexpr til::CoordType marginBottom = size.height - 2;
+static constexpr size_t lines = 10000;
+
+// Syntax highlighted source code: a few differently colored words on every line.
+static void fillBuffer(TextBuffer& buffer)
+{
+    static constexpr std::wstring_view words[]{ L"static ", L"void ", L"scroll", L"(", L"TextBuffer& ", L"buffer", L") ", L"{ ", L"return; ", L"} " };
+    static constexpr WORD colors[]{ 0x09, 0x0b, 0x07, 0x07, 0x0a, 0x07, 0x07, 0x0e, 0x09, 0x0e };
+
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        til::CoordType x = 0;
+        for (auto i = gsl::narrow_cast<size_t>(y); x < size.width; ++i)
+        {
+            const auto& word = words[i % std::size(words)];
+            OutputCellIterator it{ word, TextAttribute{ colors[i % std::size(colors)] } };
+            buffer.WriteLine(it, { x, y });
+            x += gsl::narrow_cast<til::CoordType>(word.size());
+        }
+    }
+}
+
+static void benchScrollMargins(std::string_view name, bool swapRows)
+{
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    fillBuffer(buffer);
+
+    const auto duration = bench::measure(5, [&]() {
+        for (size_t i = 0; i < lines; ++i)
+        {
+            if (swapRows)
+            {
+                buffer.ScrollRows(marginTop + 1, marginBottom - marginTop, -1);
+            }
+            else
+            {
+                for (auto y = marginTop + 1; y <= marginBottom; ++y)
+                {
+                    buffer.GetRowByOffset(y - 1).CopyFrom(buffer.GetRowByOffset(y));
+                }
+            }
+            buffer.FillRect({ 0, marginBottom, size.width, marginBottom + 1 }, L" ", TextAttribute{ 0x07 });
+        }
+    });
+
+    const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+    fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.1f} ns/line\n"), name, ns / 1e6, ns / lines);
+}
+
+void benchScroll()
+{
+    benchScrollMargins("scroll margins copy rows", false);
+    benchScrollMargins("scroll margins ScrollRows", true);
+}
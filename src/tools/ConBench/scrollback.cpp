@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures the cost of a large scrollback: a 120 column buffer with the largest possible height of 32767 rows
+// is filled twice over with colored log output, the way a build or a `tail -f` fills it. It compares keeping every
+// row as a ROW (the way it used to work) against encoding rows that are far above the cursor (see
+// TextBuffer::SetHotRowCount). It reports the time it takes to write and scroll the lines, the memory used by
+// the rows afterwards and what that amounts to at 100k and 1M lines of scrollback. Since the buffer height
+// is limited to 32767 rows the latter is extrapolated from the per-line cost. Finally, it measures reading
+// the text of every row, which decodes all the cold rows again.
+
+static constexpr til::size size{ 120, SHRT_MAX };
+static constexpr size_t lines = 2 * size.height;
+
+static void writeLine(TextBuffer& buffer, til::CoordType y, size_t i)
+{
+    static constexpr std::wstring_view levels[]{ L"info ", L"info ", L"info ", L"warn ", L"error" };
+    static constexpr WORD colors[]{ 0x0a, 0x0a, 0x0a, 0x0e, 0x0c };
+
+    const auto level = i % std::size(levels);
+    const auto timestamp = fmt::format(FMT_COMPILE(L"{:02}:{:02}:{:02}.{:03} "), i / 3600000 % 24, i / 60000 % 60, i / 1000 % 60, i % 1000);
+    const auto message = fmt::format(FMT_COMPILE(L" worker {} processed request {} in {} ms"), i % 16, i, i % 997);
+
+    til::CoordType x = 0;
+    const auto write = [&](std::wstring_view text, WORD color) {
+        OutputCellIterator it{ text, TextAttribute{ color } };
+        buffer.WriteLine(it, { x, y });
+        x += gsl::narrow_cast<til::CoordType>(text.size());
+    };
+    write(timestamp, 0x08);
+    write(levels[level], colors[level]);
+    write(message, 0x07);
+}
+
+static void benchScrollbackFill(std::string_view name, til::CoordType hotRowCount)
+{
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    buffer.SetHotRowCount(hotRowCount);
+
+    const auto bottom = size.height - 1;
+    buffer.GetCursor().SetPosition({ 0, bottom });
+
+    const auto beg = bench::clock::now();
+    for (size_t i = 0; i < lines; ++i)
+    {
+        writeLine(buffer, bottom, i);
+        buffer.IncrementCircularBuffer();
+    }
+    const auto fillDuration = bench::clock::now() - beg;
+
+    const auto usage = buffer.GetMemoryUsage();
+    const auto bytes = usage.committed + usage.cold;
+    const auto bytesPerLine = static_cast<double>(bytes) / size.height;
+
+    const auto fillNs = std::chrono::duration<double, std::nano>(fillDuration).count();
+    fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>10.1f} ns/line\n"), name, fillNs / 1e6, fillNs / lines);
+    fmt::print(FMT_COMPILE("{:<40} {:>12.2f} MB {:>10.1f} B/line {:>8} cold rows\n"), "  memory", bytes / 1048576.0, bytesPerLine, usage.coldRows);
+    fmt::print(FMT_COMPILE("{:<40} {:>12.2f} MB at 100k lines {:>10.2f} MB at 1M lines\n"), "  extrapolated", bytesPerLine * 1e5 / 1048576.0, bytesPerLine * 1e6 / 1048576.0);
+
+    size_t chars = 0;
+    const auto readBeg = bench::clock::now();
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        chars += buffer.GetRowByOffset(y).GetText().size();
+    }
+    bench::reportText("  read all rows", bench::clock::now() - readBeg, chars);
+}
+
+void benchScrollback()
+{
+    benchScrollbackFill("scrollback all rows hot", til::CoordTypeMax);
+    benchScrollbackFill("scrollback cold rows encoded", TextBuffer::RecommendedHotRowCount);
+}
@@ -0,0 +1,221 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../renderer/vt/VtSgrEncoder.hpp"
+
+// Measures the cost of a single attribute change in the xterm-256color VtEngine, for the attribute
+// sequences of typical colorful output. It compares one SGR sequence per changed color and rendition
+// attribute, each written individually (the way Xterm256Engine used to work) against VtSgrEncoder,
+// which combines them into one sequence, with and without its cache of recent transitions.
+
+using namespace Microsoft::Console::Render;
+
+static constexpr size_t changes = 1024 * 1024;
+
+// `ls --color`: mostly plain names with the odd bold directory, executable or symlink.
+static std::vector<TextAttribute> createLs()
+{
+    TextAttribute dir;
+    dir.SetIndexedForeground(TextColor::BRIGHT_BLUE);
+    dir.SetIntense(true);
+    TextAttribute exe;
+    exe.SetIndexedForeground(TextColor::BRIGHT_GREEN);
+    exe.SetIntense(true);
+    TextAttribute link;
+    link.SetIndexedForeground(TextColor::BRIGHT_CYAN);
+    link.SetIntense(true);
+
+    const TextAttribute plain;
+    const TextAttribute entries[]{ dir, plain, plain, exe, plain, link, dir, plain };
+
+    std::vector<TextAttribute> attributes;
+    attributes.reserve(changes);
+    for (size_t i = 0; attributes.size() < changes; ++i)
+    {
+        attributes.emplace_back(entries[i % std::size(entries)]);
+    }
+    return attributes;
+}
+
+// `git diff`: bold headers, cyan hunk markers and red/green lines with reverse video trailing whitespace.
+static std::vector<TextAttribute> createDiff()
+{
+    TextAttribute header;
+    header.SetIntense(true);
+    TextAttribute hunk;
+    hunk.SetIndexedForeground(TextColor::DARK_CYAN);
+    TextAttribute removed;
+    removed.SetIndexedForeground(TextColor::DARK_RED);
+    TextAttribute added;
+    added.SetIndexedForeground(TextColor::DARK_GREEN);
+    auto whitespace = added;
+    whitespace.SetReverseVideo(true);
+
+    const TextAttribute plain;
+    const TextAttribute lines[]{ header, plain, hunk, plain, removed, removed, plain, added, whitespace, plain, added, plain };
+
+    std::vector<TextAttribute> attributes;
+    attributes.reserve(changes);
+    for (size_t i = 0; attributes.size() < changes; ++i)
+    {
+        attributes.emplace_back(lines[i % std::size(lines)]);
+    }
+    return attributes;
+}
+
+// A progress bar with a true color gradient: every cell has a different background,
+// which is the worst case for the cache, as no transition ever repeats within a line.
+static std::vector<TextAttribute> createRainbow()
+{
+    std::vector<TextAttribute> attributes;
+    attributes.reserve(changes);
+    for (size_t i = 0; attributes.size() < changes; ++i)
+    {
+        const auto x = gsl::narrow_cast<BYTE>(i * 7);
+        TextAttribute attr;
+        attr.SetForeground(RGB(255, 255, 255));
+        attr.SetBackground(RGB(x, 255 - x, (x * 3) & 0xff));
+        attr.SetIntense((i / 64) % 2 != 0);
+        attributes.emplace_back(attr);
+    }
+    return attributes;
+}
+
+// Mirrors the old Xterm256Engine::UpdateDrawingBrushes: one SGR sequence per
+// changed color or rendition attribute, each appended by its own _Write.
+static void appendSeparately(const TextAttribute& from, const TextAttribute& to, std::string& out, size_t& writes)
+{
+    const auto write = [&](const std::string_view sequence) {
+        out.append(sequence);
+        writes++;
+    };
+    const auto color = [&](const TextColor& c, bool isForeground) {
+        char buffer[32];
+        std::string_view sequence;
+        if (c.IsDefault())
+        {
+            sequence = isForeground ? "\x1b[39m" : "\x1b[49m";
+        }
+        else if (c.IsIndex16())
+        {
+            const auto prefix = WI_IsFlagSet(c.GetIndex(), FOREGROUND_INTENSITY) ? (isForeground ? 90 : 100) : (isForeground ? 30 : 40);
+            const auto end = fmt::format_to(&buffer[0], FMT_COMPILE("\x1b[{}m"), prefix + (c.GetIndex() & 7));
+            sequence = { &buffer[0], gsl::narrow_cast<size_t>(end - &buffer[0]) };
+        }
+        else if (c.IsIndex256())
+        {
+            const auto end = fmt::format_to(&buffer[0], FMT_COMPILE("\x1b[{}8;5;{}m"), isForeground ? '3' : '4', c.GetIndex());
+            sequence = { &buffer[0], gsl::narrow_cast<size_t>(end - &buffer[0]) };
+        }
+        else
+        {
+            const auto rgb = c.GetRGB();
+            const auto end = fmt::format_to(&buffer[0], FMT_COMPILE("\x1b[{}8;2;{};{};{}m"), isForeground ? '3' : '4', GetRValue(rgb), GetGValue(rgb), GetBValue(rgb));
+            sequence = { &buffer[0], gsl::narrow_cast<size_t>(end - &buffer[0]) };
+        }
+        write(sequence);
+    };
+
+    auto last = from;
+    if (to.GetForeground().IsDefault() && to.GetBackground().IsDefault() &&
+        !(last.GetForeground().IsDefault() && last.GetBackground().IsDefault()))
+    {
+        write("\x1b[m");
+        last = {};
+    }
+    if (to.GetForeground() != last.GetForeground())
+    {
+        color(to.GetForeground(), true);
+    }
+    if (to.GetBackground() != last.GetBackground())
+    {
+        color(to.GetBackground(), false);
+    }
+    if ((!to.IsIntense() && last.IsIntense()) || (!to.IsFaint() && last.IsFaint()))
+    {
+        write("\x1b[22m");
+        last.SetIntense(false);
+        last.SetFaint(false);
+    }
+    if (to.IsIntense() && !last.IsIntense())
+    {
+        write("\x1b[1m");
+    }
+    if (to.IsFaint() && !last.IsFaint())
+    {
+        write("\x1b[2m");
+    }
+    if (to.IsReverseVideo() != last.IsReverseVideo())
+    {
+        write(to.IsReverseVideo() ? "\x1b[7m" : "\x1b[27m");
+    }
+}
+
+static void benchSgrSequence(std::string_view name, const std::vector<TextAttribute>& attributes)
+{
+    std::string out;
+    out.reserve(attributes.size() * 32);
+    size_t writes = 0;
+
+    const auto print = [&](std::string_view variant, bench::clock::duration duration) {
+        const auto ns = std::chrono::duration<double, std::nano>(duration).count();
+        fmt::print(FMT_COMPILE("{:<40} {:>12.3f} ms {:>8.2f} ns/change {:>6.2f} B/change {:>6.2f} writes/change\n"),
+                   fmt::format(FMT_COMPILE("sgr {} {}"), name, variant),
+                   ns / 1e6,
+                   ns / attributes.size(),
+                   static_cast<double>(out.size()) / attributes.size(),
+                   static_cast<double>(writes) / attributes.size());
+    };
+
+    const auto separate = bench::measure(10, [&]() {
+        out.clear();
+        writes = 0;
+        TextAttribute last{ INVALID_COLOR, INVALID_COLOR };
+        for (const auto& attr : attributes)
+        {
+            appendSeparately(last, attr, out, writes);
+            last = attr;
+        }
+    });
+    print("separate", separate);
+
+    const auto uncached = bench::measure(10, [&]() {
+        out.clear();
+        writes = 0;
+        TextAttribute last{ INVALID_COLOR, INVALID_COLOR };
+        for (const auto& attr : attributes)
+        {
+            const auto size = out.size();
+            VtSgrEncoder::EncodeUncached(last, attr, out);
+            writes += out.size() != size;
+            last = attr;
+        }
+    });
+    print("combined", uncached);
+
+    VtSgrEncoder encoder;
+    const auto cached = bench::measure(10, [&]() {
+        out.clear();
+        writes = 0;
+        TextAttribute last{ INVALID_COLOR, INVALID_COLOR };
+        for (const auto& attr : attributes)
+        {
+            const auto size = out.size();
+            encoder.Encode(last, attr, out);
+            writes += out.size() != size;
+            last = attr;
+        }
+    });
+    print("combined cached", cached);
+}
+
+void benchSgr()
+{
+    benchSgrSequence("ls", createLs());
+    benchSgrSequence("diff", createDiff());
+    benchSgrSequence("rainbow", createRainbow());
+}
@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+#include "../../terminal/adapter/adaptDispatch.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../../terminal/parser/stateMachine.hpp"
+
+namespace bench
+{
+    // A minimal ITerminalApi that feeds VT output through StateMachine and AdaptDispatch into a TextBuffer,
+    // without a console, a window or a render engine. The buffer has no scrollback, so line feeds
+    // at the bottom of the screen rotate the buffer, just like they do in the alt buffer.
+    class Terminal final : public Microsoft::Console::VirtualTerminal::ITerminalApi
+    {
+    public:
+        explicit Terminal(const til::size size) :
+            _buffer{ size, TextAttribute{ 0x07 }, 0, false, _renderer }
+        {
+            using namespace Microsoft::Console::VirtualTerminal;
+            auto dispatch = std::make_unique<AdaptDispatch>(*this, _renderer, _renderer._renderSettings, _terminalInput);
+            auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+            _stateMachine = std::make_unique<StateMachine>(std::move(engine));
+        }
+
+        void Write(const std::wstring_view text)
+        {
+            _stateMachine->ProcessString(text);
+        }
+
+        void ReturnResponse(const std::wstring_view) override {}
+        Microsoft::Console::VirtualTerminal::StateMachine& GetStateMachine() override { return *_stateMachine; }
+        TextBuffer& GetTextBuffer() override { return _buffer; }
+        til::rect GetViewport() const override { return til::rect{ _buffer.GetSize().Dimensions() }; }
+        void SetViewportPosition(const til::point) override {}
+        bool IsVtInputEnabled() const override { return false; }
+        void SetTextAttributes(const TextAttribute& attrs) override { _buffer.SetCurrentAttributes(attrs); }
+        void SetSystemMode(const Mode mode, const bool enabled) override { _systemMode.set(mode, enabled); }
+        bool GetSystemMode(const Mode mode) const override { return _systemMode.test(mode); }
+        void WarningBell() override {}
+        void SetWindowTitle(const std::wstring_view) override {}
+        void UseAlternateScreenBuffer(const TextAttribute&) override {}
+        void UseMainScreenBuffer() override {}
+        CursorType GetUserDefaultCursorStyle() const override { return CursorType::Legacy; }
+        void ShowWindow(bool) override {}
+        void SetConsoleOutputCP(const unsigned int) override {}
+        unsigned int GetConsoleOutputCP() const override { return CP_UTF8; }
+        void CopyToClipboard(const std::wstring_view) override {}
+        void SetTaskbarProgress(const Microsoft::Console::VirtualTerminal::DispatchTypes::TaskbarState, const size_t) override {}
+        void SetWorkingDirectory(const std::wstring_view) override {}
+        void PlayMidiNote(const int, const int, const std::chrono::microseconds) override {}
+        bool ResizeWindow(const til::CoordType, const til::CoordType) override { return false; }
+        bool IsConsolePty() const override { return false; }
+        void NotifyAccessibilityChange(const til::rect&) override {}
+        void NotifyBufferRotation(const int) override {}
+        void MarkPrompt(const Microsoft::Console::VirtualTerminal::DispatchTypes::ScrollMark&) override {}
+        void MarkCommandStart() override {}
+        void MarkOutputStart() override {}
+        void MarkCommandFinish(std::optional<unsigned int>) override {}
+
+    private:
+        DummyRenderer _renderer;
+        Microsoft::Console::VirtualTerminal::TerminalInput _terminalInput;
+        TextBuffer _buffer;
+        std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _stateMachine;
+        til::enumset<Mode> _systemMode{ Mode::AutoWrap };
+    };
+}
@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures UIA's ITextRangeProvider::GetText() on a document range spanning a full 120x9001 buffer, like the
+// ones screen readers request when they're looking for the first few characters of the document. It compares
+// the way UiaTextRangeBase used to collect the text (one string per row via TextBuffer::GetTextRects and
+// TextBuffer::GetText, concatenated and then truncated to maxLength) against TextBuffer::GetTextRange, which
+// appends the text of each row straight into a single string and stops once maxLength is reached.
+
+static constexpr til::size size{ 120, 9001 };
+
+static void fillBuffer(TextBuffer& buffer)
+{
+    static constexpr std::wstring_view line = L"PS C:\\Users\\me\\source\\repos\\terminal> git log --oneline --graph --decorate ";
+
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        buffer.WriteLine(OutputCellIterator{ line, TextAttribute{ 0x07 } }, { 0, y });
+    }
+}
+
+static std::wstring getTextRects(const TextBuffer& buffer, til::point start, til::point end, size_t maxLength)
+{
+    std::wstring text;
+    for (const auto& str : buffer.GetText(true, false, buffer.GetTextRects(start, end, false, true)))
+    {
+        text += str;
+    }
+    if (text.size() > maxLength)
+    {
+        text.resize(maxLength);
+    }
+    return text;
+}
+
+static void benchUiaGetText(std::string_view oldName, std::string_view newName, const TextBuffer& buffer, size_t maxLength)
+{
+    static constexpr til::point start{ 0, 0 };
+    static constexpr til::point end{ size.width - 1, size.height - 1 };
+
+    auto duration = bench::measure(10, [&]() {
+        std::ignore = getTextRects(buffer, start, end, maxLength);
+    });
+    bench::report(oldName, duration);
+
+    duration = bench::measure(10, [&]() {
+        std::ignore = buffer.GetTextRange(start, end, false, maxLength);
+    });
+    bench::report(newName, duration);
+}
+
+void benchUia()
+{
+    DummyRenderer renderer;
+    TextBuffer buffer{ size, TextAttribute{ 0x07 }, 0, false, renderer };
+    fillBuffer(buffer);
+
+    benchUiaGetText("uia GetText(100) GetTextRects", "uia GetText(100) GetTextRange", buffer, 100);
+    benchUiaGetText("uia GetText(-1) GetTextRects", "uia GetText(-1) GetTextRange", buffer, SIZE_MAX);
+}
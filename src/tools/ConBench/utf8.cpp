@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+// Compares til::u8u16/u16u8 against MultiByteToWideChar/WideCharToMultiByte using the natural
+// language samples of src\tools\U8U16Test, which the build copies next to ConBench.exe.
+// The "chunked" variants convert 4 KiB at a time with a til::u8state, like ConPTY does for its pipe reads.
+
+static constexpr size_t corpusLength = 4 * 1024 * 1024;
+static constexpr size_t chunkLength = 4 * 1024;
+
+// Repeats the contents of `path` until it's at least `length` bytes long.
+// Returns an empty string if the file doesn't exist.
+static std::string loadCorpus(const std::filesystem::path& path, size_t length)
+{
+    std::ifstream file{ path, std::ios::binary };
+    const std::string sample{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    if (sample.empty())
+    {
+        return {};
+    }
+
+    std::string text;
+    text.reserve(length + sample.size());
+    while (text.size() < length)
+    {
+        text.append(sample);
+    }
+    return text;
+}
+
+void benchUtf8()
+{
+    const auto dir = std::filesystem::path{ wil::GetModuleFileNameW<std::wstring>(nullptr) }.parent_path() / L"U8U16Test";
+
+    for (const auto name : { "en", "fr", "ru", "zh" })
+    {
+        const auto u8 = loadCorpus(dir / fmt::format(FMT_COMPILE("{}.txt"), name), corpusLength);
+        if (u8.empty())
+        {
+            fmt::print(FMT_COMPILE("utf8 {}: sample not found in {}\n"), name, dir.string());
+            continue;
+        }
+
+        const auto u16 = til::u8u16(u8);
+        std::wstring u16Buffer(u8.size(), L'\0');
+        std::string u8Buffer(u16.size() * 3, '\0');
+        size_t written{};
+
+        const auto mb2wc = bench::measure(10, [&]() {
+            MultiByteToWideChar(CP_UTF8, 0, u8.data(), gsl::narrow<int>(u8.size()), u16Buffer.data(), gsl::narrow<int>(u16Buffer.size()));
+        });
+        bench::report(fmt::format(FMT_COMPILE("utf8 {} MultiByteToWideChar"), name), mb2wc, u8.size());
+
+        const auto tilU8U16 = bench::measure(10, [&]() {
+            std::ignore = til::u8u16(u8, u16Buffer, written);
+        });
+        bench::report(fmt::format(FMT_COMPILE("utf8 {} til::u8u16"), name), tilU8U16, u8.size());
+
+        const auto tilU8U16Chunked = bench::measure(10, [&]() {
+            til::u8state state{};
+            for (size_t i = 0; i < u8.size(); i += chunkLength)
+            {
+                std::ignore = til::u8u16(std::string_view{ u8 }.substr(i, chunkLength), u16Buffer, written, state);
+            }
+        });
+        bench::report(fmt::format(FMT_COMPILE("utf8 {} til::u8u16 chunked"), name), tilU8U16Chunked, u8.size());
+
+        const auto wc2mb = bench::measure(10, [&]() {
+            WideCharToMultiByte(CP_UTF8, 0, u16.data(), gsl::narrow<int>(u16.size()), u8Buffer.data(), gsl::narrow<int>(u8Buffer.size()), nullptr, nullptr);
+        });
+        bench::report(fmt::format(FMT_COMPILE("utf8 {} WideCharToMultiByte"), name), wc2mb, u8.size());
+
+        const auto tilU16U8 = bench::measure(10, [&]() {
+            std::ignore = til::u16u8(u16, u8Buffer, written);
+        });
+        bench::report(fmt::format(FMT_COMPILE("utf8 {} til::u16u8"), name), tilU16U8, u8.size());
+    }
+}
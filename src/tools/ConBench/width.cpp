@@ -0,0 +1,52 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+#include "../../types/inc/GlyphWidth.hpp"
+
+// Measures the glyph width lookup for CJK heavy text, once on its own and once as part of
+// writing the text into a TextBuffer, which is where the console spends its time for such output.
+
+static std::wstring createText(size_t length)
+{
+    // A mix of ASCII, Cyrillic (ambiguous), CJK ideographs, Hiragana, Hangul and emoji (surrogate pairs).
+    static constexpr std::wstring_view words[]{ L"INFO ", L"\x8FDE\x63A5\x5DF2\x5EFA\x7ACB ", L"\x0417\x0430\x043F\x0440\x043E\x0441 ", L"\x3053\x3093\x306B\x3061\x306F ", L"\xC11C\xBC84 ", L"\U0001F600 ", L"id=12345 " };
+    std::wstring text;
+    text.reserve(length + 16);
+    for (size_t i = 0; text.size() < length; ++i)
+    {
+        text.append(words[(i * 5) % std::size(words)]);
+    }
+    text.resize(length);
+    return text;
+}
+
+void benchWidth()
+{
+    const auto text = createText(1024 * 1024);
+    const auto bytes = text.size() * sizeof(wchar_t);
+
+    std::vector<uint8_t> widths(text.size());
+    const auto measured = bench::measure(10, [&]() { GetGlyphWidths(text, widths); });
+    bench::report("width GetGlyphWidths CJK", measured, bytes);
+
+    DummyRenderer renderer;
+    const TextAttribute defaultAttr{ 0x07 };
+    TextBuffer buffer{ til::size{ 120, 9001 }, defaultAttr, 0, false, renderer };
+
+    const auto written = bench::measure(10, [&]() {
+        std::wstring_view remaining{ text };
+        for (til::CoordType y = 0; !remaining.empty(); y = (y + 1) % 9001)
+        {
+            RowWriteState state{ .text = remaining, .columnLimit = 120 };
+            buffer.Write(y, defaultAttr, state);
+            remaining = state.text;
+        }
+    });
+    bench::report("width TextBuffer::Write CJK", written, bytes);
+}
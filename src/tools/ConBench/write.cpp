@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "bench.h"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
+
+// Measures TextBuffer::Write() for plain ASCII, which must stay on the fast path, and for text with
+// combining marks and emoji sequences, both per codepoint and in grapheme cluster mode (DECSET 2027).
+
+static std::wstring createText(std::span<const std::wstring_view> words, size_t length)
+{
+    std::wstring text;
+    text.reserve(length + 64);
+    for (size_t i = 0; text.size() < length; ++i)
+    {
+        text.append(words[(i * 3) % words.size()]);
+    }
+    text.resize(length);
+    return text;
+}
+
+static void benchWriteText(std::string_view name, const std::wstring& text, bool graphemeClusters)
+{
+    DummyRenderer renderer;
+    const TextAttribute defaultAttr{ 0x07 };
+    TextBuffer buffer{ til::size{ 120, 9001 }, defaultAttr, 0, false, renderer };
+
+    const auto duration = bench::measure(10, [&]() {
+        std::wstring_view remaining{ text };
+        for (til::CoordType y = 0; !remaining.empty(); y = (y + 1) % 9001)
+        {
+            RowWriteState state{ .text = remaining, .columnLimit = 120, .graphemeClusters = graphemeClusters };
+            buffer.Write(y, defaultAttr, state);
+            remaining = state.text;
+        }
+    });
+    bench::report(name, duration, text.size() * sizeof(wchar_t));
+}
+
+void benchWrite()
+{
+    static constexpr std::wstring_view ascii[]{ L"lorem ", L"ipsum ", L"dolor ", L"sit ", L"amet, ", L"consectetur ", L"adipiscing ", L"elit " };
+    // Decomposed accents, a ZWJ family emoji and a flag, mixed with ASCII.
+    static constexpr std::wstring_view graphemes[]{ L"cafe\x0301 ", L"nai\x0308ve ", L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67 ", L"\xD83C\xDDE9\xD83C\xDDEA ", L"text " };
+
+    const auto graphemeText = createText(graphemes, 4 * 1024 * 1024);
+
+    benchWriteText("write ASCII", createText(ascii, 4 * 1024 * 1024), false);
+    benchWriteText("write codepoints", graphemeText, false);
+    benchWriteText("write grapheme clusters", graphemeText, true);
+}
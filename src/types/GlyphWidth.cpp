@@ -25,6 +25,14 @@ bool IsGlyphFullWidth(const wchar_t wch) noexcept
     return wch < 0x80 ? false : IsGlyphFullWidth({ &wch, 1 });
 }
 
+// Function Description:
+// - measures all glyphs in the given text in a single call.
+//      See CodepointWidthDetector::GetWidths
+void GetGlyphWidths(const std::wstring_view& text, const std::span<uint8_t> widths) noexcept
+{
+    widthDetector.GetWidths(text, widths);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
@@ -21,6 +21,8 @@ class CodepointWidthDetector final
 public:
     CodepointWidth GetWidth(const std::wstring_view& glyph) noexcept;
     bool IsWide(const std::wstring_view& glyph) noexcept;
+    size_t NarrowPrefixLength(const std::wstring_view& text) const noexcept;
+    void GetWidths(const std::wstring_view& text, std::span<uint8_t> widths) noexcept;
     void SetFallbackMethod(std::function<bool(const std::wstring_view&)> pfnFallback) noexcept;
     void NotifyFontChanged() noexcept;
 
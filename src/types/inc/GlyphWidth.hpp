@@ -11,11 +11,13 @@ Abstract:
 #pragma once
 
 #include <functional>
+#include <span>
 #include <string_view>
 
 #include "convert.hpp"
 
 bool IsGlyphFullWidth(const std::wstring_view& glyph) noexcept;
 bool IsGlyphFullWidth(const wchar_t wch) noexcept;
+void GetGlyphWidths(const std::wstring_view& text, std::span<uint8_t> widths) noexcept;
 void SetGlyphWidthFallback(std::function<bool(const std::wstring_view&)> pfnFallback) noexcept;
 void NotifyGlyphWidthFontChanged() noexcept;
@@ -5,9 +5,10 @@
 # (we use the null coalescing operator)
 
 ################################################################################
-# This script generates the an array suitable for replacing the body of
+# This script generates the lookup tables suitable for replacing the body of
 # src/types/CodepointWidthDetector.cpp from a Unicode UCD XML document[1]
-# compliant with UAX#42[2].
+# compliant with UAX#42[2]. The tables form a 3-stage trie, which allows
+# looking up the width of any codepoint in constant time.
 #
 # This script supports a quasi-mandatory "overrides" file, overrides.xml.
 # If you do not have overrides, supply the -NoOverrides parameter. This was
@@ -255,6 +256,58 @@ ForEach($_ in $ranges) {
     $c += $_.End - $_.Start + 1
 }
 
+# Build the trie {{{
+# Flatten the ranges into one 2-bit value per codepoint: 0 = narrow, 1 = wide, 2 = ambiguous.
+$values = [byte[]]::new(0x110000)
+ForEach($_ in $ranges) {
+    $v = $_.Width -eq [CodepointWidth]::Ambiguous ? 2 : 1
+    For($i = $_.Start; $i -le $_.End; $i++) {
+        $values[$i] = $v
+    }
+}
+
+# Stage 3: Blocks of 64 codepoints, packed 4 per byte. Identical blocks are stored only once.
+$stage3 = [System.Collections.Generic.List[byte]]::new()
+$stage3Indices = [System.Collections.Generic.List[byte]]::new()
+$stage3Blocks = @{}
+For($i = 0; $i -lt 0x110000; $i += 64) {
+    $packed = [byte[]]::new(16)
+    For($j = 0; $j -lt 64; $j++) {
+        $packed[$j -shr 2] = [byte]($packed[$j -shr 2] -bor ($values[$i + $j] -shl (($j -band 3) * 2)))
+    }
+    $key = [BitConverter]::ToString($packed)
+    If (-not $stage3Blocks.ContainsKey($key)) {
+        $stage3Blocks[$key] = $stage3Blocks.Count
+        $stage3.AddRange($packed)
+    }
+    $stage3Indices.Add([byte]$stage3Blocks[$key])
+}
+
+# Stage 2: Blocks of 32 stage 3 indices (= 2048 codepoints), again deduplicated.
+# Stage 1: One stage 2 index per 2048 codepoints.
+$stage2 = [System.Collections.Generic.List[byte]]::new()
+$stage1 = [System.Collections.Generic.List[byte]]::new()
+$stage2Blocks = @{}
+For($i = 0; $i -lt $stage3Indices.Count; $i += 32) {
+    $block = $stage3Indices.GetRange($i, 32).ToArray()
+    $key = [BitConverter]::ToString($block)
+    If (-not $stage2Blocks.ContainsKey($key)) {
+        $stage2Blocks[$key] = $stage2Blocks.Count
+        $stage2.AddRange($block)
+    }
+    $stage1.Add([byte]$stage2Blocks[$key])
+}
+
+Function Format-ByteArray([string]$Name, [byte[]]$Bytes) {
+    "    static constexpr std::array<uint8_t, {0}> {1}{{" -f $Bytes.Count, $Name
+    For($i = 0; $i -lt $Bytes.Count; $i += 16) {
+        $line = $Bytes[$i..([Math]::Min($i + 16, $Bytes.Count) - 1)] | ForEach-Object { "0x{0:x2}," -f $_ }
+        "        " + ($line -join " ")
+    }
+    "    };"
+}
+# }}}
+
 # Emit Code
 "    // Generated by {0} -Pack:{1} -Full:{2} -NoOverrides:{3}" -f $MyInvocation.MyCommand.Name, $Pack, $Full, $NoOverrides
 "    // on {0} from {1}." -f (Get-Date -AsUTC -Format "u"), $InputObject.ucd.description
@@ -263,14 +316,6 @@ If (-not $NoOverrides) {
 "    // {0} (0x{0:X}) codepoints overridden." -f $overrideCount
 "    // Override path: {0}" -f $OverridePath
 }
-"    static constexpr std::array<UnicodeRange, {0}> s_wideAndAmbiguousTable{{" -f $ranges.Count
-ForEach($_ in $ranges) {
-    $isAmbiguous = $_.Width -eq [CodepointWidth]::Ambiguous
-    $comment = ""
-    if ($null -ne $_.Comment) {
-        # We only vend comments when we aren't packing tightly
-        $comment = " // {0}" -f $_.Comment
-    }
-"        UnicodeRange{{ 0x{0:x}, 0x{1:x}, {2} }},{3}" -f $_.Start, $_.End, [int]$isAmbiguous, $comment
-}
-"    };"
+Format-ByteArray "s_stage1" $stage1.ToArray()
+Format-ByteArray "s_stage2" $stage2.ToArray()
+Format-ByteArray "s_stage3" $stage3.ToArray()
@@ -0,0 +1,158 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+#Requires -Version 7
+
+################################################################################
+# This script generates the Grapheme_Cluster_Break lookup tables in
+# src/inc/til/unicode.h (grapheme_stage1, grapheme_stage2 and grapheme_stage3)
+# from a Unicode UCD XML document[1] compliant with UAX#42[2].
+#
+# The tables form a 3-stage trie analogous to the one generated by
+# Generate-CodepointWidthsFromUCD.ps1, but store 4 bits per codepoint: the
+# til::grapheme_cluster_break value of the codepoint. Extended_Pictographic
+# is folded into it, as all such codepoints are Grapheme_Cluster_Break=Other.
+#
+# The rules that decide whether two of these values join (grapheme_join_rules)
+# are not generated. They follow the numbered rules of UAX#29[3] and only need
+# to be updated if those change.
+#
+# This script was developed against the flat "no han unification" UCD
+# "ucd.nounihan.flat.xml".
+#
+# Invoke this script from the root of this repository as:
+#   .\tools\Generate-GraphemeClusterBreakFromUCD.ps1 -Path .\path\to\ucd.nounihan.flat.xml
+#
+# [1]: https://www.unicode.org/Public/UCD/latest/ucdxml/
+# [2]: https://www.unicode.org/reports/tr42/
+# [3]: https://www.unicode.org/reports/tr29/
+
+[Diagnostics.CodeAnalysis.SuppressMessageAttribute('PSAvoidUsingPositionalParameters', '')]
+[CmdletBinding()]
+Param(
+    [Parameter(Position=0, ValueFromPipeline=$true, ParameterSetName="Parsed")]
+    [System.Xml.XmlDocument]$InputObject,
+
+    [Parameter(Position=0, ValueFromPipelineByPropertyName=$true, ParameterSetName="Unparsed")]
+    [string]$Path = "ucd.nounihan.flat.xml"
+)
+
+# The values of til::grapheme_cluster_break, keyed by the UCD's abbreviations.
+$GraphemeClusterBreak = @{
+    "XX"  = 0;  # Other
+    "CR"  = 1;  # CR
+    "LF"  = 2;  # LF
+    "CN"  = 3;  # Control
+    "EX"  = 4;  # Extend
+    "ZWJ" = 5;  # ZWJ
+    "RI"  = 6;  # Regional_Indicator
+    "PP"  = 7;  # Prepend
+    "SM"  = 8;  # SpacingMark
+    "L"   = 9;  # L
+    "V"   = 10; # V
+    "T"   = 11; # T
+    "LV"  = 12; # LV
+    "LVT" = 13; # LVT
+}
+$ExtendedPictographic = 14
+
+# UCD Functions {{{
+Function Get-UCDEntryRange($entry) {
+    $s = $e = 0
+    if ($null -ne $entry.cp) {
+        # Individual Codepoint
+        $s = $e = [int]("0x"+$entry.cp)
+    } ElseIf ($null -ne $entry."first-cp") {
+        # Range of Codepoints
+        $s = [int]("0x"+$entry."first-cp")
+        $e = [int]("0x"+$entry."last-cp")
+    }
+    $s
+    $e
+}
+
+Function Get-UCDEntryValue($entry) {
+    $value = $GraphemeClusterBreak[$entry.GCB]
+    If ($null -eq $value) {
+        throw "Unexpected Grapheme_Cluster_Break property"
+    }
+    If ($entry.ExtPict -eq "Y") {
+        If ($value -ne 0) {
+            throw "Extended_Pictographic codepoint with Grapheme_Cluster_Break other than Other"
+        }
+        $value = $ExtendedPictographic
+    }
+    $value
+}
+# }}}
+
+# Ingest UCD
+If ($null -eq $InputObject) {
+    $InputObject = [xml](Get-Content $Path)
+}
+
+# Flatten the repertoire into one value per codepoint. Codepoints missing from it are Other.
+$values = [byte[]]::new(0x110000)
+ForEach($v in $InputObject.ucd.repertoire.ChildNodes) {
+    If ($v -isnot [System.Xml.XmlElement]) {
+        Continue
+    }
+    $s, $e = Get-UCDEntryRange $v
+    $value = Get-UCDEntryValue $v
+    If ($value -ne 0) {
+        For($i = $s; $i -le $e; $i++) {
+            $values[$i] = $value
+        }
+    }
+}
+
+# Build the trie {{{
+# Stage 3: Blocks of 64 codepoints, packed 2 per byte (the even codepoint in the low nibble).
+# Identical blocks are stored only once.
+$stage3 = [System.Collections.Generic.List[byte]]::new()
+$stage3Indices = [System.Collections.Generic.List[byte]]::new()
+$stage3Blocks = @{}
+For($i = 0; $i -lt 0x110000; $i += 64) {
+    $packed = [byte[]]::new(32)
+    For($j = 0; $j -lt 64; $j++) {
+        $packed[$j -shr 1] = [byte]($packed[$j -shr 1] -bor ($values[$i + $j] -shl (($j -band 1) * 4)))
+    }
+    $key = [BitConverter]::ToString($packed)
+    If (-not $stage3Blocks.ContainsKey($key)) {
+        $stage3Blocks[$key] = $stage3Blocks.Count
+        $stage3.AddRange($packed)
+    }
+    $stage3Indices.Add([byte]$stage3Blocks[$key])
+}
+
+# Stage 2: Blocks of 32 stage 3 indices (= 2048 codepoints), again deduplicated.
+# Stage 1: One stage 2 index per 2048 codepoints.
+$stage2 = [System.Collections.Generic.List[byte]]::new()
+$stage1 = [System.Collections.Generic.List[byte]]::new()
+$stage2Blocks = @{}
+For($i = 0; $i -lt $stage3Indices.Count; $i += 32) {
+    $block = $stage3Indices.GetRange($i, 32).ToArray()
+    $key = [BitConverter]::ToString($block)
+    If (-not $stage2Blocks.ContainsKey($key)) {
+        $stage2Blocks[$key] = $stage2Blocks.Count
+        $stage2.AddRange($block)
+    }
+    $stage1.Add([byte]$stage2Blocks[$key])
+}
+
+Function Format-ByteArray([string]$Name, [byte[]]$Bytes) {
+    "        inline constexpr std::array<uint8_t, {0}> {1}{{" -f $Bytes.Count, $Name
+    For($i = 0; $i -lt $Bytes.Count; $i += 16) {
+        $line = $Bytes[$i..([Math]::Min($i + 16, $Bytes.Count) - 1)] | ForEach-Object { "0x{0:x2}," -f $_ }
+        "            " + ($line -join " ")
+    }
+    "        };"
+}
+# }}}
+
+# Emit Code
+"        // Generated by {0}" -f $MyInvocation.MyCommand.Name
+"        // on {0} from {1}." -f (Get-Date -AsUTC -Format "u"), $InputObject.ucd.description
+Format-ByteArray "grapheme_stage1" $stage1.ToArray()
+Format-ByteArray "grapheme_stage2" $stage2.ToArray()
+Format-ByteArray "grapheme_stage3" $stage3.ToArray()